@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef DETOURFLOWFIELD_H
+#define DETOURFLOWFIELD_H
+
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourStatus.h"
+
+class dtNodePool;
+class dtNodeQueue;
+
+/// A shortest path tree toward a single goal over the polygon graph.
+/// Every polygon reached by the field knows the next polygon toward the goal,
+/// the point on the portal to it and its cost to go, so any number of agents
+/// sharing the goal can follow it without a path search each.
+/// @ingroup detour
+class dtFlowField
+{
+public:
+	dtFlowField();
+	~dtFlowField();
+
+	/// Initializes the field.
+	///  @param[in]	nav			The navigation mesh the field is built on.
+	///  @param[in]	maxPolys	Maximum number of polygons the field can reach. [Limit: 0 < value <= 65535]
+	/// @returns The status flags for the operation.
+	dtStatus init(const dtNavMesh* nav, const int maxPolys);
+
+	/// Builds the field with a Dijkstra search from the goal polygon.
+	///  @param[in]	goalRef		The reference of the polygon containing the goal.
+	///  @param[in]	goalPos		The goal position. [(x, y, z)]
+	///  @param[in]	radius		Polygons whose portal toward the goal is further than this from the goal are not reached.
+	///  @param[in]	filter		The polygon filter to apply. (Copied.)
+	/// @returns The status flags for the operation. #DT_OUT_OF_NODES is set when the field ran out of polygons.
+	dtStatus build(dtPolyRef goalRef, const float* goalPos, const float radius, const dtQueryFilter* filter);
+
+	/// Brings the field up to date with the tiles of the navigation mesh.
+	///  @returns The status flags for the operation. Fails when the goal polygon is no longer valid.
+	dtStatus update();
+
+	/// Gets where an agent in the polygon should head next.
+	///  @param[in]		ref			The reference of the polygon the agent is in.
+	///  @param[out]	nextRef		The next polygon toward the goal, or 0 in the goal polygon. [opt]
+	///  @param[out]	steerPos	The point on the portal to the next polygon, or the goal. [(x, y, z)] [opt]
+	///  @param[out]	costToGo	The cost from @p steerPos to the goal. [opt]
+	/// @returns True if the polygon is reached by the field.
+	bool getNextHop(dtPolyRef ref, dtPolyRef* nextRef, float* steerPos, float* costToGo) const;
+
+	/// Follows the next hops from the polygon toward the goal.
+	///  @param[in]		ref			The reference of the start polygon.
+	///  @param[out]	path		The polygons from @p ref toward the goal. [(polyRef) * @p pathCount]
+	///  @param[out]	pathCount	The number of polygons returned.
+	///  @param[in]		maxPath		The maximum number of polygons @p path can hold. [Limit: >= 1]
+	/// @returns The status flags for the operation. #DT_PARTIAL_RESULT is set when the path stops before the goal.
+	dtStatus getPath(dtPolyRef ref, dtPolyRef* path, int* pathCount, const int maxPath) const;
+
+	/// @returns The navigation mesh the field was initialized with.
+	const dtNavMesh* getNavMesh() const { return m_nav; }
+
+	/// @returns The reference of the goal polygon, or 0 if the field is not built.
+	dtPolyRef getGoalRef() const { return m_goalRef; }
+
+	/// @returns The goal position. [(x, y, z)]
+	const float* getGoalPos() const { return m_goalPos; }
+
+	/// @returns The number of polygons reached by the field.
+	int getPolyCount() const { return m_polyCount; }
+
+	/// @returns The filter the field was built with.
+	const dtQueryFilter* getFilter() const { return &m_filter; }
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	dtFlowField(const dtFlowField&);
+	dtFlowField& operator=(const dtFlowField&);
+
+	dtStatus expand();
+	int dropStaleNodes();
+	void seedOpenList();
+
+	const dtNavMesh* m_nav;
+	dtNodePool* m_nodePool;
+	dtNodeQueue* m_openList;
+	dtQueryFilter m_filter;
+	dtPolyRef m_goalRef;
+	float m_goalPos[3];
+	float m_radius;
+	int m_polyCount;
+	unsigned int m_generation;	///< Tile generation of the nav mesh the field is up to date with.
+};
+
+/// Allocates a flow field object using the Detour allocator.
+/// @return An allocated flow field object, or null on failure.
+/// @ingroup detour
+dtFlowField* dtAllocFlowField();
+
+/// Frees the specified flow field object using the Detour allocator.
+///  @param[in]		field		A flow field object allocated using #dtAllocFlowField
+/// @ingroup detour
+void dtFreeFlowField(dtFlowField* field);
+
+#endif // DETOURFLOWFIELD_H
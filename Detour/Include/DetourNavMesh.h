@@ -99,9 +99,23 @@ static const int DT_MAX_AREAS = 64;
 enum dtTileFlags
 {
 	/// The navigation mesh owns the tile memory and is responsible for freeing it.
-	DT_TILE_FREE_DATA = 0x01
+	DT_TILE_FREE_DATA = 0x01,
+
+	/// Inside a dtNavMesh::beginBatchAdd() / dtNavMesh::endBatchAdd() pair, skip the links to the
+	/// neighbour tiles until dtNavMesh::endBatchAdd().
+	DT_TILE_DEFER_LINKS = 0x02
 };
 
+/// A job run by #dtParallelForFn.
+///  @param[in]	jobData		The job data passed to the parallel for.
+///  @param[in]	jobIndex	The index of the job. [Limits: 0 <= value < jobCount]
+typedef void (*dtParallelJobFn)(void* jobData, int jobIndex);
+
+/// Runs @p jobCount independent jobs, possibly on several threads. Must call @p job once for every
+/// index in [0, jobCount) and return only when all of them are done.
+///  @param[in]	userData	The user data passed to dtNavMesh::endBatchAdd().
+typedef void (*dtParallelForFn)(void* userData, int jobCount, dtParallelJobFn job, void* jobData);
+
 /// Vertex flags returned by dtNavMeshQuery::findStraightPath.
 enum dtStraightPathFlags
 {
@@ -376,6 +390,27 @@ public:
 	/// @return The status flags for the operation.
 	dtStatus removeTile(dtTileRef ref, unsigned char** data, int* dataSize);
 
+	/// Replaces the tile at the data's location (x, y, layer) in a single step.
+	///  @param[in]		data		Data for the new tile mesh. (See: #dtCreateNavMeshData)
+	///  @param[in]		dataSize	Data size of the new tile mesh.
+	///  @param[in]		flags		Tile flags. (See: #dtTileFlags)
+	///  @param[out]	result		The tile reference. (If the tile was succesfully replaced.) [opt]
+	///  @param[out]	oldData		Data of the replaced (or lost, see #DT_TILE_LOST) tile, if it was not owned by the nav mesh. [opt]
+	///  @param[out]	oldDataSize	Size of the data of the replaced tile. [opt]
+	/// @return The status flags for the operation.
+	dtStatus replaceTile(unsigned char* data, int dataSize, int flags, dtTileRef* result,
+						 unsigned char** oldData = 0, int* oldDataSize = 0);
+
+	/// Starts a batch of tile additions. Tiles added with #DT_TILE_DEFER_LINKS are not linked
+	/// to their neighbours until #endBatchAdd.
+	void beginBatchAdd();
+
+	/// Links the tiles deferred since #beginBatchAdd to their neighbours, each shared border once.
+	///  @param[in]	parallelFor	Runs the per-tile link jobs, possibly concurrently. [opt]
+	///  @param[in]	userData	User data passed to @p parallelFor. [opt]
+	/// @return The status flags for the operation.
+	dtStatus endBatchAdd(dtParallelForFn parallelFor = 0, void* userData = 0);
+
 	/// @}
 
 	/// @{
@@ -431,6 +466,11 @@ public:
 	const dtMeshTile* getTile(int i) const;
 	dtMeshTile* getTile(int i);
 
+	/// A counter that changes whenever a tile is added, removed or linked to its neighbours.
+	/// Caches built over the polygon graph can compare it to know they may be stale.
+	/// @return The current tile generation.
+	unsigned int getTileGeneration() const { return m_tileGeneration; }
+
 	/// Gets the tile and polygon for the specified polygon reference.
 	///  @param[in]		ref		The reference for the a polygon.
 	///  @param[out]	tile	The tile containing the polygon.
@@ -626,9 +666,15 @@ private:
 							dtMeshTile** tiles, const int maxTiles) const;
 	
 	/// Returns all polygons in neighbour tile based on portal defined by the segment.
+	/// If @p portals is set, only those edges are tested. (See: #collectPortalEdges)
 	int findConnectingPolys(const float* va, const float* vb,
 							const dtMeshTile* tile, int side,
-							dtPolyRef* con, float* conarea, int maxcon) const;
+							dtPolyRef* con, float* conarea, int maxcon,
+							const unsigned int* portals = 0, const int nportals = 0) const;
+
+	/// Collects the portal edges of a tile pointing to 'side', packed as (poly << 3 | edge).
+	/// Returns -1 if they do not fit in @p portals.
+	int collectPortalEdges(const dtMeshTile* tile, int side, unsigned int* portals, const int maxPortals) const;
 	
 	/// Builds internal polygons links for a tile.
 	void connectIntLinks(dtMeshTile* tile);
@@ -642,6 +688,15 @@ private:
 	
 	/// Removes external links at specified side.
 	void unconnectLinks(dtMeshTile* tile, dtMeshTile* target);
+
+	/// Returns the layers at the tile's location and the tiles around it, with the side of each.
+	int getTileNeighbours(const dtMeshTile* tile, dtMeshTile** neis, int* sides, const int maxNeis) const;
+	/// Builds the links between a tile and its neighbours, skipping tiles with deferred links.
+	void connectTileNeighbours(dtMeshTile* tile);
+	/// Batch job: links a deferred tile to all its neighbours.
+	static void connectBatchTileJob(void* jobData, int jobIndex);
+	/// Batch job: links an already linked tile to its deferred neighbours.
+	static void connectBatchNeighbourJob(void* jobData, int jobIndex);
 	
 
 	// TODO: These methods are duplicates from dtNavMeshQuery, but are needed for off-mesh connection finding.
@@ -667,6 +722,8 @@ private:
 	dtMeshTile** m_posLookup;			///< Tile hash lookup.
 	dtMeshTile* m_nextFree;				///< Freelist of tiles.
 	dtMeshTile* m_tiles;				///< List of tiles.
+	bool m_batchAdd;					///< True between beginBatchAdd() and endBatchAdd().
+	unsigned int m_tileGeneration;		///< Incremented on every tile add, remove and batch link.
 		
 #ifndef DT_POLYREF64
 	unsigned int m_saltBits;			///< Number of salt bits in the tile ID.
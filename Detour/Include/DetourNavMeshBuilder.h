@@ -122,6 +122,25 @@ bool dtNavMeshHeaderSwapEndian(unsigned char* data, const int dataSize);
 ///  @param[in]		dataSize	The size of the data array.
 bool dtNavMeshDataSwapEndian(unsigned char* data, const int dataSize);
 
+static const int DT_COMPACT_NAVMESH_MAGIC = 'D'<<24 | 'N'<<16 | 'A'<<8 | 'Q'; ///< A magic number used to identify compact tile data.
+static const int DT_COMPACT_NAVMESH_VERSION = 1; ///< The current version of the compact tile format.
+
+/// Builds a compact copy of the tile data with quantized vertices and no link buffer.
+///  @param[in]		data		The tile data array. (As created by #dtCreateNavMeshData.)
+///  @param[in]		dataSize	The size of the tile data array.
+///  @param[out]	outData		The resulting compact data. (Allocated with #DT_ALLOC_PERM.)
+///  @param[out]	outDataSize	The size of the compact data array.
+/// @return True if the compact data was successfully created.
+bool dtCompactNavMeshData(const unsigned char* data, const int dataSize, unsigned char** outData, int* outDataSize);
+
+/// Expands compact data back into tile data that can be added to a navigation mesh.
+///  @param[in]		data		The compact data array. (As created by #dtCompactNavMeshData.)
+///  @param[in]		dataSize	The size of the compact data array.
+///  @param[out]	outData		The resulting tile data. (Allocated with #DT_ALLOC_PERM.)
+///  @param[out]	outDataSize	The size of the tile data array.
+/// @return True if the tile data was successfully expanded.
+bool dtExpandNavMeshData(const unsigned char* data, const int dataSize, unsigned char** outData, int* outDataSize);
+
 #endif // DETOURNAVMESHBUILDER_H
 
 // This section contains detailed documentation for members that don't have
@@ -20,6 +20,7 @@
 #define DETOURNODE_H
 
 #include "DetourNavMesh.h"
+#include "DetourAssert.h"
 
 enum dtNodeFlags
 {
@@ -41,11 +42,17 @@ struct dtNode
 	unsigned int pidx : DT_NODE_PARENT_BITS;	///< Index to parent node.
 	unsigned int state : DT_NODE_STATE_BITS;	///< extra state information. A polyRef can have multiple nodes with different extra info. see DT_MAX_STATES_PER_NODE
 	unsigned int flags : 3;						///< Node flags. A combination of dtNodeFlags.
+	unsigned int heapIdx;						///< Position in the open list heap. Only valid while DT_NODE_OPEN is set.
 	dtPolyRef id;								///< Polygon ref the node corresponds to.
 };
 
 static const int DT_MAX_STATES_PER_NODE = 1 << DT_NODE_STATE_BITS;	// number of extra states per node. See dtNode::state
 
+/// Node pool lookup uses an open addressed table (linear probing on the poly ref).
+/// Table slots carry a generation stamp, clear() bumps the generation instead of
+/// touching the table.
+static const int DT_NODE_STAMP_BITS = 16 - DT_NODE_STATE_BITS;
+
 class dtNodePool
 {
 public:
@@ -81,15 +88,14 @@ public:
 	{
 		return sizeof(*this) +
 			sizeof(dtNode)*m_maxNodes +
-			sizeof(dtNodeIndex)*m_maxNodes +
-			sizeof(dtNodeIndex)*m_hashSize;
+			sizeof(Slot)*m_hashSize;
 	}
 	
 	inline int getMaxNodes() const { return m_maxNodes; }
 	
+	/// Size of the lookup table (at least twice the node count, power of two).
 	inline int getHashSize() const { return m_hashSize; }
-	inline dtNodeIndex getFirst(int bucket) const { return m_first[bucket]; }
-	inline dtNodeIndex getNext(int i) const { return m_next[i]; }
+	/// Nodes are allocated in order, valid indices for getNodeAtIdx() are [1, getNodeCount()].
 	inline int getNodeCount() const { return m_nodeCount; }
 	
 private:
@@ -97,14 +103,23 @@ private:
 	dtNodePool(const dtNodePool&);
 	dtNodePool& operator=(const dtNodePool&);
 	
+	struct Slot
+	{
+		dtPolyRef id;
+		unsigned short tag;		///< (stamp << DT_NODE_STATE_BITS) | state, live only if stamp matches m_stamp.
+		dtNodeIndex idx;
+	};
+	
 	dtNode* m_nodes;
-	dtNodeIndex* m_first;
-	dtNodeIndex* m_next;
+	Slot* m_slots;
 	const int m_maxNodes;
 	const int m_hashSize;
 	int m_nodeCount;
+	unsigned short m_stamp;
 };
 
+/// Open list, a binary min heap on dtNode::total. Nodes track their heap position
+/// (dtNode::heapIdx) so modify() does not need to search.
 class dtNodeQueue
 {
 public:
@@ -129,16 +144,12 @@ public:
 		bubbleUp(m_size-1, node);
 	}
 	
+	/// Restores the heap after the node's total decreased.
 	inline void modify(dtNode* node)
 	{
-		for (int i = 0; i < m_size; ++i)
-		{
-			if (m_heap[i] == node)
-			{
-				bubbleUp(i, node);
-				return;
-			}
-		}
+		const int i = (int)node->heapIdx;
+		dtAssert(i < m_size && m_heap[i] == node);
+		bubbleUp(i, node);
 	}
 	
 	inline bool empty() const { return m_size == 0; }
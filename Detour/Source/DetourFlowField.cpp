@@ -0,0 +1,478 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <float.h>
+#include <string.h>
+#include "DetourFlowField.h"
+#include "DetourNode.h"
+#include "DetourCommon.h"
+#include "DetourAlloc.h"
+#include "DetourAssert.h"
+#include <new>
+
+dtFlowField* dtAllocFlowField()
+{
+	void* mem = dtAlloc(sizeof(dtFlowField), DT_ALLOC_PERM);
+	if (!mem) return 0;
+	return new(mem) dtFlowField;
+}
+
+void dtFreeFlowField(dtFlowField* field)
+{
+	if (!field) return;
+	field->~dtFlowField();
+	dtFree(field);
+}
+
+/// @class dtFlowField
+///
+/// The field is a Dijkstra search run backwards from the goal, kept in a node pool:
+/// for a reached polygon, dtNode::pos is the point the agent steers to (the middle of
+/// the portal to the next polygon, or the goal), dtNode::total is the cost from there
+/// to the goal and dtNode::pidx is the node of the next polygon.
+///
+/// When tiles are added or removed, #update repairs the field instead of rebuilding it:
+/// polygons that are gone, and the polygons routed through them, are dropped, and the
+/// search is resumed from the reached polygons bordering unreached ones. Distances only
+/// get shorter from there, so the repaired field matches a fresh #build.
+///
+/// @see dtNavMeshQuery::findPolysAroundCircle
+
+static const int DT_FLOWFIELD_STALE = 1;
+static const int DT_FLOWFIELD_LIVE = 2;
+
+dtFlowField::dtFlowField() :
+	m_nav(0),
+	m_nodePool(0),
+	m_openList(0),
+	m_goalRef(0),
+	m_radius(0),
+	m_polyCount(0),
+	m_generation(0)
+{
+	memset(m_goalPos, 0, sizeof(m_goalPos));
+}
+
+dtFlowField::~dtFlowField()
+{
+	if (m_nodePool)
+		m_nodePool->~dtNodePool();
+	if (m_openList)
+		m_openList->~dtNodeQueue();
+	dtFree(m_nodePool);
+	dtFree(m_openList);
+}
+
+dtStatus dtFlowField::init(const dtNavMesh* nav, const int maxPolys)
+{
+	if (!nav || maxPolys <= 0 || maxPolys > DT_NULL_IDX || maxPolys > (1 << DT_NODE_PARENT_BITS) - 1)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	m_nav = nav;
+	m_goalRef = 0;
+	m_polyCount = 0;
+
+	if (!m_nodePool || m_nodePool->getMaxNodes() < maxPolys)
+	{
+		if (m_nodePool)
+		{
+			m_nodePool->~dtNodePool();
+			dtFree(m_nodePool);
+			m_nodePool = 0;
+		}
+		m_nodePool = new (dtAlloc(sizeof(dtNodePool), DT_ALLOC_PERM)) dtNodePool(maxPolys, dtNextPow2(maxPolys/4));
+		if (!m_nodePool)
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	else
+	{
+		m_nodePool->clear();
+	}
+
+	if (!m_openList || m_openList->getCapacity() < maxPolys)
+	{
+		if (m_openList)
+		{
+			m_openList->~dtNodeQueue();
+			dtFree(m_openList);
+			m_openList = 0;
+		}
+		m_openList = new (dtAlloc(sizeof(dtNodeQueue), DT_ALLOC_PERM)) dtNodeQueue(maxPolys);
+		if (!m_openList)
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	else
+	{
+		m_openList->clear();
+	}
+
+	return DT_SUCCESS;
+}
+
+dtStatus dtFlowField::build(dtPolyRef goalRef, const float* goalPos, const float radius, const dtQueryFilter* filter)
+{
+	dtAssert(m_nav);
+	dtAssert(m_nodePool);
+	dtAssert(m_openList);
+
+	m_goalRef = 0;
+	m_polyCount = 0;
+	m_nodePool->clear();
+	m_openList->clear();
+
+	if (!m_nav->isValidPolyRef(goalRef) || !goalPos || !dtVisfinite(goalPos) ||
+		!filter || !(radius >= 0.0f) || !dtMathIsfinite(radius))
+	{
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
+
+	m_goalRef = goalRef;
+	dtVcopy(m_goalPos, goalPos);
+	m_radius = radius;
+	if (filter != &m_filter)
+		m_filter = *filter;
+	m_generation = m_nav->getTileGeneration();
+
+	dtNode* goalNode = m_nodePool->getNode(goalRef);
+	dtVcopy(goalNode->pos, goalPos);
+	goalNode->pidx = 0;
+	goalNode->cost = 0;
+	goalNode->total = 0;
+	goalNode->flags = DT_NODE_OPEN;
+	m_openList->push(goalNode);
+	m_polyCount = 1;
+
+	return expand();
+}
+
+dtStatus dtFlowField::update()
+{
+	if (!m_goalRef)
+		return DT_FAILURE;
+
+	const unsigned int generation = m_nav->getTileGeneration();
+	if (generation == m_generation)
+		return DT_SUCCESS;
+
+	if (!m_nav->isValidPolyRef(m_goalRef))
+	{
+		m_goalRef = 0;
+		m_polyCount = 0;
+		m_nodePool->clear();
+		return DT_FAILURE;
+	}
+
+	// Dropped polygons keep their slot in the pool (their references never come back).
+	// Start over once they take more room than the live ones.
+	const int dropped = dropStaleNodes();
+	if (dropped > 0 && m_nodePool->getNodeCount() - m_polyCount > m_polyCount)
+	{
+		float goalPos[3];
+		dtVcopy(goalPos, m_goalPos);
+		return build(m_goalRef, goalPos, m_radius, &m_filter);
+	}
+
+	m_generation = generation;
+	seedOpenList();
+	return expand();
+}
+
+// Drops the nodes of polygons that are no longer valid and every node routed through them.
+int dtFlowField::dropStaleNodes()
+{
+	const int nodeCount = m_nodePool->getNodeCount();
+	unsigned char* state = (unsigned char*)dtAlloc(sizeof(unsigned char)*(nodeCount+1), DT_ALLOC_TEMP);
+	unsigned int* stack = (unsigned int*)dtAlloc(sizeof(unsigned int)*(nodeCount+1), DT_ALLOC_TEMP);
+	if (!state || !stack)
+	{
+		dtFree(state);
+		dtFree(stack);
+		m_nodePool->clear();
+		m_polyCount = 0;
+		return 0;
+	}
+	memset(state, 0, sizeof(unsigned char)*(nodeCount+1));
+
+	int dropped = 0;
+	for (int i = 1; i <= nodeCount; ++i)
+	{
+		// Walk toward the goal until a node with a known state.
+		int nstack = 0;
+		unsigned int idx = (unsigned int)i;
+		unsigned char result = DT_FLOWFIELD_LIVE;
+		while (idx)
+		{
+			if (state[idx])
+			{
+				result = state[idx];
+				break;
+			}
+			const dtNode* node = m_nodePool->getNodeAtIdx(idx);
+			stack[nstack++] = idx;
+			if (!(node->flags & (DT_NODE_OPEN | DT_NODE_CLOSED)) || !m_nav->isValidPolyRef(node->id))
+			{
+				result = DT_FLOWFIELD_STALE;
+				break;
+			}
+			idx = node->pidx;
+		}
+
+		for (int j = 0; j < nstack; ++j)
+		{
+			state[stack[j]] = result;
+			if (result != DT_FLOWFIELD_STALE)
+				continue;
+			dtNode* node = m_nodePool->getNodeAtIdx(stack[j]);
+			if (node->flags & (DT_NODE_OPEN | DT_NODE_CLOSED))
+			{
+				m_polyCount--;
+				dropped++;
+			}
+			node->flags = 0;
+			node->pidx = 0;
+			node->total = FLT_MAX;
+		}
+	}
+
+	dtFree(state);
+	dtFree(stack);
+
+	// Open nodes may have been dropped, the search restarts from the seeds.
+	m_openList->clear();
+	for (int i = 1; i <= nodeCount; ++i)
+	{
+		dtNode* node = m_nodePool->getNodeAtIdx((unsigned int)i);
+		if (node->flags & DT_NODE_OPEN)
+		{
+			node->flags &= ~DT_NODE_OPEN;
+			node->flags |= DT_NODE_CLOSED;
+		}
+	}
+
+	return dropped;
+}
+
+// Reopens the reached polygons that have a neighbour the field does not reach.
+void dtFlowField::seedOpenList()
+{
+	const int nodeCount = m_nodePool->getNodeCount();
+	for (int i = 1; i <= nodeCount; ++i)
+	{
+		dtNode* node = m_nodePool->getNodeAtIdx((unsigned int)i);
+		if (!(node->flags & DT_NODE_CLOSED))
+			continue;
+
+		const dtMeshTile* tile = 0;
+		const dtPoly* poly = 0;
+		m_nav->getTileAndPolyByRefUnsafe(node->id, &tile, &poly);
+
+		bool frontier = false;
+		for (unsigned int j = poly->firstLink; j != DT_NULL_LINK && !frontier; j = tile->links[j].next)
+		{
+			const dtPolyRef neighbourRef = tile->links[j].ref;
+			if (!neighbourRef)
+				continue;
+			const dtNode* neighbourNode = m_nodePool->findNode(neighbourRef, 0);
+			frontier = !neighbourNode || !(neighbourNode->flags & (DT_NODE_OPEN | DT_NODE_CLOSED));
+		}
+
+		if (frontier)
+		{
+			node->flags &= ~DT_NODE_CLOSED;
+			node->flags |= DT_NODE_OPEN;
+			m_openList->push(node);
+		}
+	}
+}
+
+static bool hasLinkTo(const dtMeshTile* tile, const dtPoly* poly, dtPolyRef ref, unsigned char* edge)
+{
+	for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+	{
+		if (tile->links[i].ref == ref)
+		{
+			if (edge)
+				*edge = tile->links[i].edge;
+			return true;
+		}
+	}
+	return false;
+}
+
+dtStatus dtFlowField::expand()
+{
+	dtStatus status = DT_SUCCESS;
+	const float radiusSqr = dtSqr(m_radius);
+
+	while (!m_openList->empty())
+	{
+		dtNode* bestNode = m_openList->pop();
+		bestNode->flags &= ~DT_NODE_OPEN;
+		bestNode->flags |= DT_NODE_CLOSED;
+
+		const dtPolyRef bestRef = bestNode->id;
+		const dtMeshTile* bestTile = 0;
+		const dtPoly* bestPoly = 0;
+		m_nav->getTileAndPolyByRefUnsafe(bestRef, &bestTile, &bestPoly);
+
+		const dtNode* nextNode = m_nodePool->getNodeAtIdx(bestNode->pidx);
+		const dtPolyRef nextRef = nextNode ? nextNode->id : 0;
+
+		for (unsigned int i = bestPoly->firstLink; i != DT_NULL_LINK; i = bestTile->links[i].next)
+		{
+			const dtLink* link = &bestTile->links[i];
+			const dtPolyRef neighbourRef = link->ref;
+			if (!neighbourRef || neighbourRef == nextRef)
+				continue;
+
+			const dtMeshTile* neighbourTile = 0;
+			const dtPoly* neighbourPoly = 0;
+			m_nav->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);
+
+			if (!m_filter.passFilter(neighbourRef, neighbourTile, neighbourPoly))
+				continue;
+
+			// Agents move from the neighbour into the best polygon. Links are symmetric
+			// except around one-way off-mesh connections, so only those are checked.
+			float va[3], vb[3];
+			if (bestPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+			{
+				if (!hasLinkTo(neighbourTile, neighbourPoly, bestRef, 0))
+					continue;
+				dtVcopy(va, &bestTile->verts[bestPoly->verts[link->edge]*3]);
+				dtVcopy(vb, va);
+			}
+			else if (neighbourPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+			{
+				unsigned char edge = 0;
+				if (!hasLinkTo(neighbourTile, neighbourPoly, bestRef, &edge))
+					continue;
+				dtVcopy(va, &neighbourTile->verts[neighbourPoly->verts[edge]*3]);
+				dtVcopy(vb, va);
+			}
+			else
+			{
+				const int v0 = bestPoly->verts[link->edge];
+				const int v1 = bestPoly->verts[(link->edge+1) % (int)bestPoly->vertCount];
+				dtVcopy(va, &bestTile->verts[v0*3]);
+				dtVcopy(vb, &bestTile->verts[v1*3]);
+				// Portals to a neighbour tile can cover only part of the edge.
+				if (link->side != 0xff && (link->bmin != 0 || link->bmax != 255))
+				{
+					const float s = 1.0f/255.0f;
+					const float tmin = link->bmin*s;
+					const float tmax = link->bmax*s;
+					float ea[3], eb[3];
+					dtVcopy(ea, va);
+					dtVcopy(eb, vb);
+					dtVlerp(va, ea, eb, tmin);
+					dtVlerp(vb, ea, eb, tmax);
+				}
+			}
+
+			float tseg;
+			if (dtDistancePtSegSqr2D(m_goalPos, va, vb, tseg) > radiusSqr)
+				continue;
+
+			float portalPos[3];
+			dtVlerp(portalPos, va, vb, 0.5f);
+
+			const float cost = m_filter.getCost(portalPos, bestNode->pos,
+												neighbourRef, neighbourTile, neighbourPoly,
+												bestRef, bestTile, bestPoly,
+												0, 0, 0);
+			const float total = bestNode->total + cost;
+
+			dtNode* neighbourNode = m_nodePool->getNode(neighbourRef);
+			if (!neighbourNode)
+			{
+				status |= DT_OUT_OF_NODES;
+				continue;
+			}
+
+			const bool reached = (neighbourNode->flags & (DT_NODE_OPEN | DT_NODE_CLOSED)) != 0;
+			if (reached && total >= neighbourNode->total)
+				continue;
+
+			dtVcopy(neighbourNode->pos, portalPos);
+			neighbourNode->pidx = m_nodePool->getNodeIdx(bestNode);
+			neighbourNode->cost = cost;
+			neighbourNode->total = total;
+
+			if (neighbourNode->flags & DT_NODE_OPEN)
+			{
+				m_openList->modify(neighbourNode);
+			}
+			else
+			{
+				if (!reached)
+					m_polyCount++;
+				neighbourNode->flags &= ~DT_NODE_CLOSED;
+				neighbourNode->flags |= DT_NODE_OPEN;
+				m_openList->push(neighbourNode);
+			}
+		}
+	}
+
+	return status;
+}
+
+bool dtFlowField::getNextHop(dtPolyRef ref, dtPolyRef* nextRef, float* steerPos, float* costToGo) const
+{
+	if (!m_goalRef || !ref)
+		return false;
+	const dtNode* node = m_nodePool->findNode(ref, 0);
+	if (!node || !(node->flags & (DT_NODE_OPEN | DT_NODE_CLOSED)))
+		return false;
+
+	if (nextRef)
+	{
+		const dtNode* nextNode = m_nodePool->getNodeAtIdx(node->pidx);
+		*nextRef = nextNode ? nextNode->id : 0;
+	}
+	if (steerPos)
+		dtVcopy(steerPos, node->pos);
+	if (costToGo)
+		*costToGo = node->total;
+	return true;
+}
+
+dtStatus dtFlowField::getPath(dtPolyRef ref, dtPolyRef* path, int* pathCount, const int maxPath) const
+{
+	if (!path || !pathCount || maxPath <= 0)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	*pathCount = 0;
+
+	if (!m_goalRef || !ref)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	const dtNode* node = m_nodePool->findNode(ref, 0);
+	if (!node || !(node->flags & (DT_NODE_OPEN | DT_NODE_CLOSED)))
+		return DT_FAILURE;
+
+	int n = 0;
+	while (node && n < maxPath)
+	{
+		path[n++] = node->id;
+		node = m_nodePool->getNodeAtIdx(node->pidx);
+	}
+	*pathCount = n;
+
+	if (path[n-1] != m_goalRef)
+		return DT_SUCCESS | DT_PARTIAL_RESULT;
+	return DT_SUCCESS;
+}
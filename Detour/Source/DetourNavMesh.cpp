@@ -193,7 +193,9 @@ dtNavMesh::dtNavMesh() :
 	m_tileLutMask(0),
 	m_posLookup(0),
 	m_nextFree(0),
-	m_tiles(0)
+	m_tiles(0),
+	m_batchAdd(false),
+	m_tileGeneration(0)
 {
 #ifndef DT_POLYREF64
 	m_saltBits = 0;
@@ -303,7 +305,8 @@ const dtNavMeshParams* dtNavMesh::getParams() const
 //////////////////////////////////////////////////////////////////////////////////////////
 int dtNavMesh::findConnectingPolys(const float* va, const float* vb,
 								   const dtMeshTile* tile, int side,
-								   dtPolyRef* con, float* conarea, int maxcon) const
+								   dtPolyRef* con, float* conarea, int maxcon,
+								   const unsigned int* portals, const int nportals) const
 {
 	if (!tile) return 0;
 	
@@ -318,11 +321,18 @@ int dtNavMesh::findConnectingPolys(const float* va, const float* vb,
 	
 	dtPolyRef base = getPolyRefBase(tile);
 	
-	for (int i = 0; i < tile->header->polyCount; ++i)
+	const int count = portals ? nportals : tile->header->polyCount;
+	int lastPoly = -1;
+	for (int k = 0; k < count; ++k)
 	{
-		dtPoly* poly = &tile->polys[i];
+		const int i = portals ? (int)(portals[k] >> 3) : k;
+		// Only the first touching edge of a polygon is used.
+		if (i == lastPoly) continue;
+		const dtPoly* poly = &tile->polys[i];
 		const int nv = poly->vertCount;
-		for (int j = 0; j < nv; ++j)
+		const int jmin = portals ? (int)(portals[k] & 7) : 0;
+		const int jmax = portals ? jmin+1 : nv;
+		for (int j = jmin; j < jmax; ++j)
 		{
 			// Skip edges which do not point to the right side.
 			if (poly->neis[j] != m) continue;
@@ -348,12 +358,31 @@ int dtNavMesh::findConnectingPolys(const float* va, const float* vb,
 				con[n] = base | (dtPolyRef)i;
 				n++;
 			}
+			lastPoly = i;
 			break;
 		}
 	}
 	return n;
 }
 
+int dtNavMesh::collectPortalEdges(const dtMeshTile* tile, int side, unsigned int* portals, const int maxPortals) const
+{
+	const unsigned short m = DT_EXT_LINK | (unsigned short)side;
+	int n = 0;
+	for (int i = 0; i < tile->header->polyCount; ++i)
+	{
+		const dtPoly* poly = &tile->polys[i];
+		for (int j = 0; j < (int)poly->vertCount; ++j)
+		{
+			if (poly->neis[j] != m) continue;
+			if (n >= maxPortals)
+				return -1;
+			portals[n++] = ((unsigned int)i << 3) | (unsigned int)j;
+		}
+	}
+	return n;
+}
+
 void dtNavMesh::unconnectLinks(dtMeshTile* tile, dtMeshTile* target)
 {
 	if (!tile || !target) return;
@@ -388,10 +417,69 @@ void dtNavMesh::unconnectLinks(dtMeshTile* tile, dtMeshTile* target)
 	}
 }
 
+static const int DT_MAX_TILE_NEIS = 9*32;
+
+// Marks the linked tiles that border deferred tiles during endBatchAdd().
+static const int DT_TILE_BATCH_BORDER = 0x40000000;
+
+int dtNavMesh::getTileNeighbours(const dtMeshTile* tile, dtMeshTile** neis, int* sides, const int maxNeis) const
+{
+	const dtMeshHeader* header = tile->header;
+	
+	// Other layers in current tile.
+	int count = 0;
+	const int nlayers = getTilesAt(header->x, header->y, neis, maxNeis);
+	for (int j = 0; j < nlayers; ++j)
+	{
+		if (neis[j] == tile)
+			continue;
+		neis[count] = neis[j];
+		sides[count] = -1;
+		count++;
+	}
+	
+	// Neighbour tiles.
+	for (int i = 0; i < 8 && count < maxNeis; ++i)
+	{
+		const int nneis = getNeighbourTilesAt(header->x, header->y, i, neis + count, maxNeis - count);
+		for (int j = 0; j < nneis; ++j)
+			sides[count + j] = i;
+		count += nneis;
+	}
+	
+	return count;
+}
+
+void dtNavMesh::connectTileNeighbours(dtMeshTile* tile)
+{
+	dtMeshTile* neis[DT_MAX_TILE_NEIS];
+	int sides[DT_MAX_TILE_NEIS];
+	const int nneis = getTileNeighbours(tile, neis, sides, DT_MAX_TILE_NEIS);
+	for (int j = 0; j < nneis; ++j)
+	{
+		dtMeshTile* nei = neis[j];
+		// Deferred tiles link to this one in endBatchAdd().
+		if (nei->flags & DT_TILE_DEFER_LINKS)
+			continue;
+		const int side = sides[j];
+		const int opposite = side == -1 ? -1 : dtOppositeTile(side);
+		connectExtLinks(tile, nei, side);
+		connectExtLinks(nei, tile, opposite);
+		connectExtOffMeshLinks(tile, nei, side);
+		connectExtOffMeshLinks(nei, tile, opposite);
+	}
+}
+
 void dtNavMesh::connectExtLinks(dtMeshTile* tile, dtMeshTile* target, int side)
 {
 	if (!tile) return;
 	
+	// Portal edges of the target facing this tile, collected on first use, so each
+	// border edge does not scan every polygon of the target.
+	static const int MAX_PORTALS = 1024;
+	unsigned int portals[MAX_PORTALS];
+	int nportals = -2;
+	
 	// Connect border links.
 	for (int i = 0; i < tile->header->polyCount; ++i)
 	{
@@ -416,7 +504,11 @@ void dtNavMesh::connectExtLinks(dtMeshTile* tile, dtMeshTile* target, int side)
 			const float* vb = &tile->verts[poly->verts[(j+1) % nv]*3];
 			dtPolyRef nei[4];
 			float neia[4*2];
-			int nnei = findConnectingPolys(va,vb, target, dtOppositeTile(dir), nei,neia,4);
+			if (side != -1 && nportals == -2)
+				nportals = collectPortalEdges(target, dtOppositeTile(side), portals, MAX_PORTALS);
+			int nnei = nportals >= 0
+				? findConnectingPolys(va,vb, target, dtOppositeTile(dir), nei,neia,4, portals, nportals)
+				: findConnectingPolys(va,vb, target, dtOppositeTile(dir), nei,neia,4);
 			for (int k = 0; k < nnei; ++k)
 			{
 				unsigned int idx = allocLink(tile);
@@ -1021,37 +1113,19 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 	baseOffMeshLinks(tile);
 	connectExtOffMeshLinks(tile, tile, -1);
 
-	// Create connections with neighbour tiles.
-	static const int MAX_NEIS = 32;
-	dtMeshTile* neis[MAX_NEIS];
-	int nneis;
-	
-	// Connect with layers in current tile.
-	nneis = getTilesAt(header->x, header->y, neis, MAX_NEIS);
-	for (int j = 0; j < nneis; ++j)
+	// Create connections with neighbour tiles, unless deferred to endBatchAdd().
+	if (m_batchAdd && (flags & DT_TILE_DEFER_LINKS))
 	{
-		if (neis[j] == tile)
-			continue;
-	
-		connectExtLinks(tile, neis[j], -1);
-		connectExtLinks(neis[j], tile, -1);
-		connectExtOffMeshLinks(tile, neis[j], -1);
-		connectExtOffMeshLinks(neis[j], tile, -1);
+		tile->flags |= DT_TILE_DEFER_LINKS;
 	}
-	
-	// Connect with neighbour tiles.
-	for (int i = 0; i < 8; ++i)
+	else
 	{
-		nneis = getNeighbourTilesAt(header->x, header->y, i, neis, MAX_NEIS);
-		for (int j = 0; j < nneis; ++j)
-		{
-			connectExtLinks(tile, neis[j], i);
-			connectExtLinks(neis[j], tile, dtOppositeTile(i));
-			connectExtOffMeshLinks(tile, neis[j], i);
-			connectExtOffMeshLinks(neis[j], tile, dtOppositeTile(i));
-		}
+		tile->flags &= ~DT_TILE_DEFER_LINKS;
+		connectTileNeighbours(tile);
 	}
 	
+	m_tileGeneration++;
+	
 	if (result)
 		*result = getTileRef(tile);
 	
@@ -1333,6 +1407,244 @@ dtStatus dtNavMesh::removeTile(dtTileRef ref, unsigned char** data, int* dataSiz
 	tile->next = m_nextFree;
 	m_nextFree = tile;
 
+	m_tileGeneration++;
+
+	return DT_SUCCESS;
+}
+
+/// @par
+///
+/// The new data is validated before the current tile is touched, so a rejected
+/// tile leaves the nav mesh unchanged. If there is no tile at the location
+/// this behaves like #addTile.
+///
+/// The replacement reuses the tile index of the old tile (its salt is bumped, so
+/// old polygon references become invalid). Links to the neighbour tiles and
+/// layers are rebuilt the same way #addTile does. If adding the new tile fails
+/// anyway, the old tile is restored with its previous reference. If that restore
+/// fails too, the status has #DT_TILE_LOST set: the location is left empty and the
+/// old data is freed (owned) or returned through @p oldData.
+///
+/// @see addTile, removeTile
+dtStatus dtNavMesh::replaceTile(unsigned char* data, int dataSize, int flags, dtTileRef* result,
+								unsigned char** oldData, int* oldDataSize)
+{
+	if (oldData) *oldData = 0;
+	if (oldDataSize) *oldDataSize = 0;
+
+	if (!data)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	const dtMeshHeader* header = (const dtMeshHeader*)data;
+	if (header->magic != DT_NAVMESH_MAGIC)
+		return DT_FAILURE | DT_WRONG_MAGIC;
+	if (header->version != DT_NAVMESH_VERSION)
+		return DT_FAILURE | DT_WRONG_VERSION;
+#ifndef DT_POLYREF64
+	if (m_polyBits < dtIlog2(dtNextPow2((unsigned int)header->polyCount)))
+		return DT_FAILURE | DT_INVALID_PARAM;
+#endif
+
+	const dtMeshTile* found = getTileAt(header->x, header->y, header->layer);
+	if (!found)
+		return addTile(data, dataSize, flags, 0, result);
+	if (found->data == data)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	// Keep the old data alive until the new tile is in, so it can be restored.
+	dtMeshTile* oldTile = &m_tiles[found - m_tiles];
+	const dtTileRef oldRef = getTileRef(oldTile);
+	const int oldFlags = oldTile->flags;
+	oldTile->flags &= ~DT_TILE_FREE_DATA;
+
+	unsigned char* prevData = 0;
+	int prevDataSize = 0;
+	dtStatus status = removeTile(oldRef, &prevData, &prevDataSize);
+	if (dtStatusFailed(status))
+	{
+		oldTile->flags = oldFlags;
+		return status;
+	}
+
+	// The freed slot is at the head of the free list, so the index is reused.
+	status = addTile(data, dataSize, flags, 0, result);
+	if (dtStatusFailed(status))
+	{
+		if (dtStatusFailed(addTile(prevData, prevDataSize, oldFlags, oldRef, 0)))
+		{
+			if (oldFlags & DT_TILE_FREE_DATA)
+			{
+				dtFree(prevData);
+			}
+			else
+			{
+				if (oldData) *oldData = prevData;
+				if (oldDataSize) *oldDataSize = prevDataSize;
+			}
+			status |= DT_TILE_LOST;
+		}
+		return status;
+	}
+
+	if (oldFlags & DT_TILE_FREE_DATA)
+	{
+		dtFree(prevData);
+	}
+	else
+	{
+		if (oldData) *oldData = prevData;
+		if (oldDataSize) *oldDataSize = prevDataSize;
+	}
+
+	return status;
+}
+
+/// @par
+///
+/// Bulk loads (streaming in a block of tiles, preloading a cache) should add the tiles
+/// with #DT_TILE_DEFER_LINKS between #beginBatchAdd and #endBatchAdd. The tiles are
+/// inserted first and the borders are stitched once at the end, instead of every
+/// tile linking against whatever part of the block was already loaded.
+///
+/// The nav mesh must not be queried while a batch is open: deferred tiles have no
+/// links to their neighbours yet.
+///
+/// @see endBatchAdd, addTile
+void dtNavMesh::beginBatchAdd()
+{
+	m_batchAdd = true;
+}
+
+struct dtBatchLinkJobData
+{
+	dtNavMesh* mesh;
+	dtMeshTile** tiles;
+};
+
+void dtNavMesh::connectBatchTileJob(void* jobData, int jobIndex)
+{
+	dtBatchLinkJobData* job = (dtBatchLinkJobData*)jobData;
+	dtMeshTile* tile = job->tiles[jobIndex];
+	dtMeshTile* neis[DT_MAX_TILE_NEIS];
+	int sides[DT_MAX_TILE_NEIS];
+	const int nneis = job->mesh->getTileNeighbours(tile, neis, sides, DT_MAX_TILE_NEIS);
+	for (int j = 0; j < nneis; ++j)
+		job->mesh->connectExtLinks(tile, neis[j], sides[j]);
+}
+
+void dtNavMesh::connectBatchNeighbourJob(void* jobData, int jobIndex)
+{
+	dtBatchLinkJobData* job = (dtBatchLinkJobData*)jobData;
+	dtMeshTile* tile = job->tiles[jobIndex];
+	dtMeshTile* neis[DT_MAX_TILE_NEIS];
+	int sides[DT_MAX_TILE_NEIS];
+	const int nneis = job->mesh->getTileNeighbours(tile, neis, sides, DT_MAX_TILE_NEIS);
+	for (int j = 0; j < nneis; ++j)
+	{
+		if (neis[j]->flags & DT_TILE_DEFER_LINKS)
+			job->mesh->connectExtLinks(tile, neis[j], sides[j]);
+	}
+}
+
+/// @par
+///
+/// Without @p parallelFor the deferred tiles are linked one after the other. With it,
+/// the polygon links are built in two passes of independent jobs: first every deferred
+/// tile links to all its neighbours, then every already linked tile bordering the batch
+/// links to its deferred neighbours. A job only writes the links of its own tile, so
+/// the jobs of a pass may run concurrently. Off-mesh connections write to both tiles
+/// and are connected serially afterwards.
+///
+/// @see beginBatchAdd, addTile
+dtStatus dtNavMesh::endBatchAdd(dtParallelForFn parallelFor, void* userData)
+{
+	m_batchAdd = false;
+	
+	int ntiles = 0;
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		if (m_tiles[i].header && (m_tiles[i].flags & DT_TILE_DEFER_LINKS))
+			ntiles++;
+	}
+	if (!ntiles)
+		return DT_SUCCESS;
+	
+	m_tileGeneration++;
+	
+	dtMeshTile** batch = 0;
+	if (parallelFor)
+		batch = (dtMeshTile**)dtAlloc(sizeof(dtMeshTile*)*m_maxTiles, DT_ALLOC_TEMP);
+	
+	if (!batch)
+	{
+		// Link tile by tile, each one sees the deferred tiles linked before it.
+		for (int i = 0; i < m_maxTiles; ++i)
+		{
+			dtMeshTile* tile = &m_tiles[i];
+			if (!tile->header || !(tile->flags & DT_TILE_DEFER_LINKS))
+				continue;
+			tile->flags &= ~DT_TILE_DEFER_LINKS;
+			connectTileNeighbours(tile);
+		}
+		return DT_SUCCESS;
+	}
+	
+	// Deferred tiles at the front, the linked tiles bordering them at the back.
+	dtMeshTile* neis[DT_MAX_TILE_NEIS];
+	int sides[DT_MAX_TILE_NEIS];
+	ntiles = 0;
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		if (m_tiles[i].header && (m_tiles[i].flags & DT_TILE_DEFER_LINKS))
+			batch[ntiles++] = &m_tiles[i];
+	}
+	int nborder = 0;
+	for (int i = 0; i < ntiles; ++i)
+	{
+		const int nneis = getTileNeighbours(batch[i], neis, sides, DT_MAX_TILE_NEIS);
+		for (int j = 0; j < nneis; ++j)
+		{
+			dtMeshTile* nei = neis[j];
+			if (nei->flags & (DT_TILE_DEFER_LINKS | DT_TILE_BATCH_BORDER))
+				continue;
+			nei->flags |= DT_TILE_BATCH_BORDER;
+			nborder++;
+			batch[m_maxTiles - nborder] = nei;
+		}
+	}
+	
+	dtBatchLinkJobData job;
+	job.mesh = this;
+	job.tiles = batch;
+	parallelFor(userData, ntiles, connectBatchTileJob, &job);
+	if (nborder)
+	{
+		job.tiles = batch + m_maxTiles - nborder;
+		parallelFor(userData, nborder, connectBatchNeighbourJob, &job);
+	}
+	
+	// Off-mesh connections, in both directions for linked neighbours. A pair of
+	// deferred tiles is handled once from each side.
+	for (int i = 0; i < ntiles; ++i)
+	{
+		dtMeshTile* tile = batch[i];
+		const int nneis = getTileNeighbours(tile, neis, sides, DT_MAX_TILE_NEIS);
+		for (int j = 0; j < nneis; ++j)
+		{
+			dtMeshTile* nei = neis[j];
+			const int side = sides[j];
+			connectExtOffMeshLinks(tile, nei, side);
+			if (!(nei->flags & DT_TILE_DEFER_LINKS))
+				connectExtOffMeshLinks(nei, tile, side == -1 ? -1 : dtOppositeTile(side));
+		}
+	}
+	
+	for (int i = 0; i < ntiles; ++i)
+		batch[i]->flags &= ~DT_TILE_DEFER_LINKS;
+	for (int i = m_maxTiles - nborder; i < m_maxTiles; ++i)
+		batch[i]->flags &= ~DT_TILE_BATCH_BORDER;
+	
+	dtFree(batch);
+	
 	return DT_SUCCESS;
 }
 
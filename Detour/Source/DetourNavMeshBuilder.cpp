@@ -17,6 +17,7 @@
 //
 
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <float.h>
@@ -800,3 +801,402 @@ bool dtNavMeshDataSwapEndian(unsigned char* data, const int /*dataSize*/)
 	
 	return true;
 }
+
+// Compact tile format. The header is followed by the original dtMeshHeader and
+// the sections below, each 4-byte aligned.
+static const int DT_COMPACT_BVTREE_NONE = 0;
+static const int DT_COMPACT_BVTREE_LEAVES = 1;	// Leaf bounds per ground poly, the tree is rebuilt on expand.
+static const int DT_COMPACT_BVTREE_RAW = 2;		// Tree not built by createBVTree, stored as is.
+
+struct dtCompactMeshHeader
+{
+	int magic;
+	int version;
+	int bvTreeMode;
+	float quantMin[3];
+	float quantStep[3];
+};
+
+// dtPoly without the link index, which is rebuilt when the tile is added.
+static const int DT_COMPACT_POLY_OFFSET = (int)offsetof(dtPoly, verts);
+static const int DT_COMPACT_POLY_SIZE = (int)sizeof(dtPoly) - DT_COMPACT_POLY_OFFSET;
+
+struct dtTileLayout
+{
+	int headerSize;
+	int vertsSize;
+	int polysSize;
+	int linksSize;
+	int detailMeshesSize;
+	int detailVertsSize;
+	int detailTrisSize;
+	int bvTreeSize;
+	int offMeshConsSize;
+
+	int dataSize() const
+	{
+		return headerSize + vertsSize + polysSize + linksSize + detailMeshesSize +
+			   detailVertsSize + detailTrisSize + bvTreeSize + offMeshConsSize;
+	}
+};
+
+static void calcTileLayout(const dtMeshHeader* header, dtTileLayout& layout)
+{
+	layout.headerSize = dtAlign4(sizeof(dtMeshHeader));
+	layout.vertsSize = dtAlign4(sizeof(float)*3*header->vertCount);
+	layout.polysSize = dtAlign4(sizeof(dtPoly)*header->polyCount);
+	layout.linksSize = dtAlign4(sizeof(dtLink)*header->maxLinkCount);
+	layout.detailMeshesSize = dtAlign4(sizeof(dtPolyDetail)*header->detailMeshCount);
+	layout.detailVertsSize = dtAlign4(sizeof(float)*3*header->detailVertCount);
+	layout.detailTrisSize = dtAlign4(sizeof(unsigned char)*4*header->detailTriCount);
+	layout.bvTreeSize = dtAlign4(sizeof(dtBVNode)*header->bvNodeCount);
+	layout.offMeshConsSize = dtAlign4(sizeof(dtOffMeshConnection)*header->offMeshConCount);
+}
+
+static void calcCompactLayout(const dtMeshHeader* header, const int bvTreeMode, dtTileLayout& layout)
+{
+	const int meshVertCount = header->vertCount - header->offMeshConCount*2;
+	layout.headerSize = dtAlign4(sizeof(dtCompactMeshHeader)) + dtAlign4(sizeof(dtMeshHeader));
+	// Mesh vertices are quantized, off-mesh end points can lie far outside the tile and stay float.
+	layout.vertsSize = dtAlign4(sizeof(unsigned short)*3*meshVertCount) +
+					   dtAlign4(sizeof(float)*3*header->offMeshConCount*2);
+	layout.polysSize = dtAlign4(DT_COMPACT_POLY_SIZE*header->polyCount);
+	layout.linksSize = 0;
+	// Only the vertex and triangle counts, the bases are prefix sums.
+	layout.detailMeshesSize = dtAlign4(sizeof(unsigned char)*2*header->detailMeshCount);
+	layout.detailVertsSize = dtAlign4(sizeof(unsigned short)*3*header->detailVertCount);
+	layout.detailTrisSize = dtAlign4(sizeof(unsigned char)*4*header->detailTriCount);
+	if (bvTreeMode == DT_COMPACT_BVTREE_LEAVES)
+		layout.bvTreeSize = dtAlign4(sizeof(unsigned short)*6*header->offMeshBase);
+	else if (bvTreeMode == DT_COMPACT_BVTREE_RAW)
+		layout.bvTreeSize = dtAlign4(sizeof(dtBVNode)*header->bvNodeCount);
+	else
+		layout.bvTreeSize = 0;
+	layout.offMeshConsSize = dtAlign4(sizeof(dtOffMeshConnection)*header->offMeshConCount);
+}
+
+static bool isTileHeaderSane(const dtMeshHeader* header)
+{
+	return header->vertCount >= header->offMeshConCount*2 &&
+		   header->offMeshConCount >= 0 &&
+		   header->offMeshBase == header->polyCount - header->offMeshConCount &&
+		   header->detailMeshCount >= 0 && header->detailMeshCount <= header->polyCount &&
+		   header->detailVertCount >= 0 && header->detailTriCount >= 0 &&
+		   header->maxLinkCount >= 0 && header->bvNodeCount >= 0;
+}
+
+inline unsigned short quantizeCoord(const float v, const float vmin, const float step)
+{
+	if (step <= 0.0f)
+		return 0;
+	return (unsigned short)dtClamp((int)((v - vmin) / step + 0.5f), 0, 0xffff);
+}
+
+static void rebuildBVTreeFromLeaves(const unsigned short* leaves, const int nitems, dtBVNode* nodes)
+{
+	BVItem* items = (BVItem*)dtAlloc(sizeof(BVItem)*nitems, DT_ALLOC_TEMP);
+	if (!items)
+		return;
+	for (int i = 0; i < nitems; ++i)
+	{
+		items[i].i = i;
+		memcpy(items[i].bmin, &leaves[i*6+0], sizeof(unsigned short)*3);
+		memcpy(items[i].bmax, &leaves[i*6+3], sizeof(unsigned short)*3);
+	}
+	int curNode = 0;
+	subdivide(items, nitems, 0, nitems, curNode, nodes);
+	dtFree(items);
+}
+
+// Returns the leaf bounds when the tree is exactly what createBVTree builds from them.
+static unsigned short* extractBVTreeLeaves(const dtMeshHeader* header, const dtBVNode* tree)
+{
+	const int nitems = header->offMeshBase;
+	if (nitems <= 0 || header->bvNodeCount != nitems*2)
+		return 0;
+
+	unsigned short* leaves = (unsigned short*)dtAlloc(sizeof(unsigned short)*6*nitems, DT_ALLOC_TEMP);
+	unsigned char* seen = (unsigned char*)dtAlloc(sizeof(unsigned char)*nitems, DT_ALLOC_TEMP);
+	dtBVNode* rebuilt = (dtBVNode*)dtAlloc(sizeof(dtBVNode)*header->bvNodeCount, DT_ALLOC_TEMP);
+	bool ok = leaves && seen && rebuilt;
+	if (ok)
+	{
+		memset(seen, 0, sizeof(unsigned char)*nitems);
+		int leafCount = 0;
+		for (int i = 0; i < header->bvNodeCount - 1 && ok; ++i)
+		{
+			const dtBVNode& node = tree[i];
+			if (node.i < 0)
+				continue;
+			if (node.i >= nitems || seen[node.i])
+			{
+				ok = false;
+				break;
+			}
+			seen[node.i] = 1;
+			memcpy(&leaves[node.i*6+0], node.bmin, sizeof(unsigned short)*3);
+			memcpy(&leaves[node.i*6+3], node.bmax, sizeof(unsigned short)*3);
+			leafCount++;
+		}
+		ok = ok && leafCount == nitems;
+	}
+	if (ok)
+	{
+		memset(rebuilt, 0, sizeof(dtBVNode)*header->bvNodeCount);
+		rebuildBVTreeFromLeaves(leaves, nitems, rebuilt);
+		ok = memcmp(rebuilt, tree, sizeof(dtBVNode)*header->bvNodeCount) == 0;
+	}
+
+	dtFree(seen);
+	dtFree(rebuilt);
+	if (!ok)
+	{
+		dtFree(leaves);
+		return 0;
+	}
+	return leaves;
+}
+
+/// @par
+///
+/// The mesh and detail vertices are stored as 16-bit offsets within the bounds of the
+/// tile's own vertices, so the error is at most half a step of (extent / 65535) per axis.
+/// The link buffer is dropped and the BV-tree is reduced to the bounds of its leaves.
+/// A typical Recast tile shrinks to roughly a third.
+///
+/// The compact data is meant for keeping cold tiles in memory: it is in native
+/// endianness and the BV-tree is rebuilt with the same sort, so it should not be
+/// persisted across builds.
+///
+/// @see dtExpandNavMeshData
+bool dtCompactNavMeshData(const unsigned char* data, const int dataSize, unsigned char** outData, int* outDataSize)
+{
+	if (!data || !outData || !outDataSize || dataSize < (int)sizeof(dtMeshHeader))
+		return false;
+	const dtMeshHeader* header = (const dtMeshHeader*)data;
+	if (header->magic != DT_NAVMESH_MAGIC || header->version != DT_NAVMESH_VERSION)
+		return false;
+	if (!isTileHeaderSane(header))
+		return false;
+
+	dtTileLayout src;
+	calcTileLayout(header, src);
+	if (src.dataSize() > dataSize)
+		return false;
+
+	const unsigned char* s = data + src.headerSize;
+	const float* verts = (const float*)s; s += src.vertsSize;
+	const dtPoly* polys = (const dtPoly*)s; s += src.polysSize;
+	s += src.linksSize;
+	const dtPolyDetail* detailMeshes = (const dtPolyDetail*)s; s += src.detailMeshesSize;
+	const float* detailVerts = (const float*)s; s += src.detailVertsSize;
+	const unsigned char* detailTris = s; s += src.detailTrisSize;
+	const dtBVNode* bvTree = (const dtBVNode*)s; s += src.bvTreeSize;
+	const dtOffMeshConnection* offMeshCons = (const dtOffMeshConnection*)s;
+
+	// The detail bases must be prefix sums of the counts.
+	unsigned int vertBase = 0;
+	unsigned int triBase = 0;
+	for (int i = 0; i < header->detailMeshCount; ++i)
+	{
+		const dtPolyDetail& pd = detailMeshes[i];
+		if (pd.vertBase != vertBase || pd.triBase != triBase)
+			return false;
+		vertBase += pd.vertCount;
+		triBase += pd.triCount;
+	}
+	if ((int)vertBase != header->detailVertCount || (int)triBase != header->detailTriCount)
+		return false;
+
+	unsigned short* leaves = 0;
+	int bvTreeMode = DT_COMPACT_BVTREE_NONE;
+	if (header->bvNodeCount > 0)
+	{
+		leaves = extractBVTreeLeaves(header, bvTree);
+		bvTreeMode = leaves ? DT_COMPACT_BVTREE_LEAVES : DT_COMPACT_BVTREE_RAW;
+	}
+
+	dtTileLayout dst;
+	calcCompactLayout(header, bvTreeMode, dst);
+	const int compactSize = dst.dataSize();
+	unsigned char* compact = (unsigned char*)dtAlloc(sizeof(unsigned char)*compactSize, DT_ALLOC_PERM);
+	if (!compact)
+	{
+		dtFree(leaves);
+		return false;
+	}
+	memset(compact, 0, compactSize);
+
+	// Quantization box from the vertices themselves; the header's y range can be much larger.
+	const int meshVertCount = header->vertCount - header->offMeshConCount*2;
+	float qmin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float qmax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (int i = 0; i < meshVertCount; ++i)
+	{
+		dtVmin(qmin, &verts[i*3]);
+		dtVmax(qmax, &verts[i*3]);
+	}
+	for (int i = 0; i < header->detailVertCount; ++i)
+	{
+		dtVmin(qmin, &detailVerts[i*3]);
+		dtVmax(qmax, &detailVerts[i*3]);
+	}
+	if (qmin[0] > qmax[0])
+	{
+		dtVcopy(qmin, header->bmin);
+		dtVcopy(qmax, header->bmin);
+	}
+
+	unsigned char* d = compact;
+	dtCompactMeshHeader* compactHeader = (dtCompactMeshHeader*)d;
+	d += dtAlign4(sizeof(dtCompactMeshHeader));
+	compactHeader->magic = DT_COMPACT_NAVMESH_MAGIC;
+	compactHeader->version = DT_COMPACT_NAVMESH_VERSION;
+	compactHeader->bvTreeMode = bvTreeMode;
+	for (int j = 0; j < 3; ++j)
+	{
+		compactHeader->quantMin[j] = qmin[j];
+		compactHeader->quantStep[j] = (qmax[j] - qmin[j]) / 65535.0f;
+	}
+	memcpy(d, header, sizeof(dtMeshHeader));
+	d += dtAlign4(sizeof(dtMeshHeader));
+
+	const float* step = compactHeader->quantStep;
+	unsigned short* qverts = (unsigned short*)d;
+	for (int i = 0; i < meshVertCount*3; ++i)
+		qverts[i] = quantizeCoord(verts[i], qmin[i%3], step[i%3]);
+	d += dtAlign4(sizeof(unsigned short)*3*meshVertCount);
+	memcpy(d, &verts[meshVertCount*3], sizeof(float)*3*header->offMeshConCount*2);
+	d += dtAlign4(sizeof(float)*3*header->offMeshConCount*2);
+
+	for (int i = 0; i < header->polyCount; ++i)
+		memcpy(d + i*DT_COMPACT_POLY_SIZE, (const unsigned char*)&polys[i] + DT_COMPACT_POLY_OFFSET, DT_COMPACT_POLY_SIZE);
+	d += dst.polysSize;
+
+	for (int i = 0; i < header->detailMeshCount; ++i)
+	{
+		d[i*2+0] = detailMeshes[i].vertCount;
+		d[i*2+1] = detailMeshes[i].triCount;
+	}
+	d += dst.detailMeshesSize;
+
+	unsigned short* qdetail = (unsigned short*)d;
+	for (int i = 0; i < header->detailVertCount*3; ++i)
+		qdetail[i] = quantizeCoord(detailVerts[i], qmin[i%3], step[i%3]);
+	d += dst.detailVertsSize;
+
+	memcpy(d, detailTris, sizeof(unsigned char)*4*header->detailTriCount);
+	d += dst.detailTrisSize;
+
+	if (bvTreeMode == DT_COMPACT_BVTREE_LEAVES)
+		memcpy(d, leaves, sizeof(unsigned short)*6*header->offMeshBase);
+	else if (bvTreeMode == DT_COMPACT_BVTREE_RAW)
+		memcpy(d, bvTree, sizeof(dtBVNode)*header->bvNodeCount);
+	d += dst.bvTreeSize;
+	dtFree(leaves);
+
+	memcpy(d, offMeshCons, sizeof(dtOffMeshConnection)*header->offMeshConCount);
+
+	*outData = compact;
+	*outDataSize = compactSize;
+	return true;
+}
+
+/// @par
+///
+/// The expanded data can be added with dtNavMesh::addTile() like the output of
+/// #dtCreateNavMeshData. Vertices differ from the original by the quantization error,
+/// everything else (polys, detail triangles, BV-tree, off-mesh connections) is identical.
+///
+/// @see dtCompactNavMeshData
+bool dtExpandNavMeshData(const unsigned char* data, const int dataSize, unsigned char** outData, int* outDataSize)
+{
+	const int prefixSize = dtAlign4(sizeof(dtCompactMeshHeader));
+	if (!data || !outData || !outDataSize || dataSize < prefixSize + (int)sizeof(dtMeshHeader))
+		return false;
+	const dtCompactMeshHeader* compactHeader = (const dtCompactMeshHeader*)data;
+	if (compactHeader->magic != DT_COMPACT_NAVMESH_MAGIC || compactHeader->version != DT_COMPACT_NAVMESH_VERSION)
+		return false;
+	const dtMeshHeader* header = (const dtMeshHeader*)(data + prefixSize);
+	if (header->magic != DT_NAVMESH_MAGIC || header->version != DT_NAVMESH_VERSION)
+		return false;
+	if (!isTileHeaderSane(header))
+		return false;
+	const int bvTreeMode = compactHeader->bvTreeMode;
+	if (bvTreeMode != DT_COMPACT_BVTREE_NONE && bvTreeMode != DT_COMPACT_BVTREE_LEAVES && bvTreeMode != DT_COMPACT_BVTREE_RAW)
+		return false;
+
+	dtTileLayout src;
+	calcCompactLayout(header, bvTreeMode, src);
+	if (src.dataSize() > dataSize)
+		return false;
+
+	dtTileLayout dst;
+	calcTileLayout(header, dst);
+	const int tileSize = dst.dataSize();
+	unsigned char* tile = (unsigned char*)dtAlloc(sizeof(unsigned char)*tileSize, DT_ALLOC_PERM);
+	if (!tile)
+		return false;
+	memset(tile, 0, tileSize);
+
+	unsigned char* d = tile;
+	memcpy(d, header, sizeof(dtMeshHeader)); d += dst.headerSize;
+	float* verts = (float*)d; d += dst.vertsSize;
+	dtPoly* polys = (dtPoly*)d; d += dst.polysSize;
+	d += dst.linksSize;
+	dtPolyDetail* detailMeshes = (dtPolyDetail*)d; d += dst.detailMeshesSize;
+	float* detailVerts = (float*)d; d += dst.detailVertsSize;
+	unsigned char* detailTris = d; d += dst.detailTrisSize;
+	dtBVNode* bvTree = (dtBVNode*)d; d += dst.bvTreeSize;
+	dtOffMeshConnection* offMeshCons = (dtOffMeshConnection*)d;
+
+	const float* qmin = compactHeader->quantMin;
+	const float* step = compactHeader->quantStep;
+	const int meshVertCount = header->vertCount - header->offMeshConCount*2;
+	const unsigned char* s = data + src.headerSize;
+
+	const unsigned short* qverts = (const unsigned short*)s;
+	for (int i = 0; i < meshVertCount*3; ++i)
+		verts[i] = qmin[i%3] + qverts[i] * step[i%3];
+	s += dtAlign4(sizeof(unsigned short)*3*meshVertCount);
+	memcpy(&verts[meshVertCount*3], s, sizeof(float)*3*header->offMeshConCount*2);
+	s += dtAlign4(sizeof(float)*3*header->offMeshConCount*2);
+
+	for (int i = 0; i < header->polyCount; ++i)
+		memcpy((unsigned char*)&polys[i] + DT_COMPACT_POLY_OFFSET, s + i*DT_COMPACT_POLY_SIZE, DT_COMPACT_POLY_SIZE);
+	s += src.polysSize;
+
+	unsigned int vertBase = 0;
+	unsigned int triBase = 0;
+	for (int i = 0; i < header->detailMeshCount; ++i)
+	{
+		dtPolyDetail& pd = detailMeshes[i];
+		pd.vertBase = vertBase;
+		pd.triBase = triBase;
+		pd.vertCount = s[i*2+0];
+		pd.triCount = s[i*2+1];
+		vertBase += pd.vertCount;
+		triBase += pd.triCount;
+	}
+	s += src.detailMeshesSize;
+
+	const unsigned short* qdetail = (const unsigned short*)s;
+	for (int i = 0; i < header->detailVertCount*3; ++i)
+		detailVerts[i] = qmin[i%3] + qdetail[i] * step[i%3];
+	s += src.detailVertsSize;
+
+	memcpy(detailTris, s, sizeof(unsigned char)*4*header->detailTriCount);
+	s += src.detailTrisSize;
+
+	if (bvTreeMode == DT_COMPACT_BVTREE_LEAVES)
+		rebuildBVTreeFromLeaves((const unsigned short*)s, header->offMeshBase, bvTree);
+	else if (bvTreeMode == DT_COMPACT_BVTREE_RAW)
+		memcpy(bvTree, s, sizeof(dtBVNode)*header->bvNodeCount);
+	s += src.bvTreeSize;
+
+	memcpy(offMeshCons, s, sizeof(dtOffMeshConnection)*header->offMeshConCount);
+
+	*outData = tile;
+	*outDataSize = tileSize;
+	return true;
+}
@@ -48,105 +48,135 @@ inline unsigned int dtHashRef(dtPolyRef a)
 #endif
 
 //////////////////////////////////////////////////////////////////////////////////////////
+static const unsigned short DT_NODE_MAX_STAMP = (unsigned short)((1 << DT_NODE_STAMP_BITS) - 1);
+
+static int dtNodeTableSize(int maxNodes, int hashSize)
+{
+	// Keep the load factor at or below 0.5 so probe sequences stay short.
+	const int minSize = (int)dtNextPow2((unsigned int)maxNodes) * 2;
+	return hashSize > minSize ? (int)dtNextPow2((unsigned int)hashSize) : minSize;
+}
+
 dtNodePool::dtNodePool(int maxNodes, int hashSize) :
 	m_nodes(0),
-	m_first(0),
-	m_next(0),
+	m_slots(0),
 	m_maxNodes(maxNodes),
-	m_hashSize(hashSize),
-	m_nodeCount(0)
+	m_hashSize(dtNodeTableSize(maxNodes, hashSize)),
+	m_nodeCount(0),
+	m_stamp(1)
 {
-	dtAssert(dtNextPow2(m_hashSize) == (unsigned int)m_hashSize);
+	dtAssert(dtNextPow2(hashSize) == (unsigned int)hashSize);
 	// pidx is special as 0 means "none" and 1 is the first node. For that reason
 	// we have 1 fewer nodes available than the number of values it can contain.
 	dtAssert(m_maxNodes > 0 && m_maxNodes <= DT_NULL_IDX && m_maxNodes <= (1 << DT_NODE_PARENT_BITS) - 1);
 
 	m_nodes = (dtNode*)dtAlloc(sizeof(dtNode)*m_maxNodes, DT_ALLOC_PERM);
-	m_next = (dtNodeIndex*)dtAlloc(sizeof(dtNodeIndex)*m_maxNodes, DT_ALLOC_PERM);
-	m_first = (dtNodeIndex*)dtAlloc(sizeof(dtNodeIndex)*hashSize, DT_ALLOC_PERM);
+	m_slots = (Slot*)dtAlloc(sizeof(Slot)*m_hashSize, DT_ALLOC_PERM);
 
 	dtAssert(m_nodes);
-	dtAssert(m_next);
-	dtAssert(m_first);
+	dtAssert(m_slots);
 
-	memset(m_first, 0xff, sizeof(dtNodeIndex)*m_hashSize);
-	memset(m_next, 0xff, sizeof(dtNodeIndex)*m_maxNodes);
+	memset(m_slots, 0, sizeof(Slot)*m_hashSize);
 }
 
 dtNodePool::~dtNodePool()
 {
 	dtFree(m_nodes);
-	dtFree(m_next);
-	dtFree(m_first);
+	dtFree(m_slots);
 }
 
 void dtNodePool::clear()
 {
-	memset(m_first, 0xff, sizeof(dtNodeIndex)*m_hashSize);
+	// Slots from older generations read as empty, the table only needs
+	// wiping when the stamp wraps around.
 	m_nodeCount = 0;
+	if (m_stamp == DT_NODE_MAX_STAMP)
+	{
+		memset(m_slots, 0, sizeof(Slot)*m_hashSize);
+		m_stamp = 1;
+	}
+	else
+	{
+		m_stamp++;
+	}
 }
 
 unsigned int dtNodePool::findNodes(dtPolyRef id, dtNode** nodes, const int maxNodes)
 {
-	int n = 0;
-	unsigned int bucket = dtHashRef(id) & (m_hashSize-1);
-	dtNodeIndex i = m_first[bucket];
-	while (i != DT_NULL_IDX)
+	// All states of a ref share its probe sequence.
+	dtNodeIndex found[DT_MAX_STATES_PER_NODE];
+	int nfound = 0;
+	const unsigned int mask = (unsigned int)m_hashSize - 1;
+	unsigned int slot = dtHashRef(id) & mask;
+	while ((m_slots[slot].tag >> DT_NODE_STATE_BITS) == m_stamp)
 	{
-		if (m_nodes[i].id == id)
+		if (m_slots[slot].id == id)
 		{
-			if (n >= maxNodes)
-				return n;
-			nodes[n++] = &m_nodes[i];
+			// Newest first, same order as the previous chained buckets.
+			int j = nfound++;
+			while (j > 0 && found[j-1] < m_slots[slot].idx)
+			{
+				found[j] = found[j-1];
+				j--;
+			}
+			found[j] = m_slots[slot].idx;
+			if (nfound == DT_MAX_STATES_PER_NODE)
+				break;
 		}
-		i = m_next[i];
+		slot = (slot+1) & mask;
 	}
 
+	int n = 0;
+	for (int i = 0; i < nfound && n < maxNodes; ++i)
+		nodes[n++] = &m_nodes[found[i]];
 	return n;
 }
 
 dtNode* dtNodePool::findNode(dtPolyRef id, unsigned char state)
 {
-	unsigned int bucket = dtHashRef(id) & (m_hashSize-1);
-	dtNodeIndex i = m_first[bucket];
-	while (i != DT_NULL_IDX)
+	const unsigned int mask = (unsigned int)m_hashSize - 1;
+	const unsigned short tag = (unsigned short)((m_stamp << DT_NODE_STATE_BITS) | state);
+	unsigned int slot = dtHashRef(id) & mask;
+	while ((m_slots[slot].tag >> DT_NODE_STATE_BITS) == m_stamp)
 	{
-		if (m_nodes[i].id == id && m_nodes[i].state == state)
-			return &m_nodes[i];
-		i = m_next[i];
+		if (m_slots[slot].id == id && m_slots[slot].tag == tag)
+			return &m_nodes[m_slots[slot].idx];
+		slot = (slot+1) & mask;
 	}
 	return 0;
 }
 
 dtNode* dtNodePool::getNode(dtPolyRef id, unsigned char state)
 {
-	unsigned int bucket = dtHashRef(id) & (m_hashSize-1);
-	dtNodeIndex i = m_first[bucket];
-	dtNode* node = 0;
-	while (i != DT_NULL_IDX)
+	const unsigned int mask = (unsigned int)m_hashSize - 1;
+	const unsigned short tag = (unsigned short)((m_stamp << DT_NODE_STATE_BITS) | state);
+	unsigned int slot = dtHashRef(id) & mask;
+	while ((m_slots[slot].tag >> DT_NODE_STATE_BITS) == m_stamp)
 	{
-		if (m_nodes[i].id == id && m_nodes[i].state == state)
-			return &m_nodes[i];
-		i = m_next[i];
+		if (m_slots[slot].id == id && m_slots[slot].tag == tag)
+			return &m_nodes[m_slots[slot].idx];
+		slot = (slot+1) & mask;
 	}
 	
 	if (m_nodeCount >= m_maxNodes)
 		return 0;
 	
-	i = (dtNodeIndex)m_nodeCount;
+	const dtNodeIndex i = (dtNodeIndex)m_nodeCount;
 	m_nodeCount++;
 	
 	// Init node
-	node = &m_nodes[i];
+	dtNode* node = &m_nodes[i];
 	node->pidx = 0;
 	node->cost = 0;
 	node->total = 0;
 	node->id = id;
 	node->state = state;
 	node->flags = 0;
+	node->heapIdx = 0;
 	
-	m_next[i] = m_first[bucket];
-	m_first[bucket] = i;
+	m_slots[slot].id = id;
+	m_slots[slot].tag = tag;
+	m_slots[slot].idx = i;
 	
 	return node;
 }
@@ -176,10 +206,12 @@ void dtNodeQueue::bubbleUp(int i, dtNode* node)
 	while ((i > 0) && (m_heap[parent]->total > node->total))
 	{
 		m_heap[i] = m_heap[parent];
+		m_heap[i]->heapIdx = (unsigned int)i;
 		i = parent;
 		parent = (i-1)/2;
 	}
 	m_heap[i] = node;
+	node->heapIdx = (unsigned int)i;
 }
 
 void dtNodeQueue::trickleDown(int i, dtNode* node)
@@ -193,6 +225,7 @@ void dtNodeQueue::trickleDown(int i, dtNode* node)
 			child++;
 		}
 		m_heap[i] = m_heap[child];
+		m_heap[i]->heapIdx = (unsigned int)i;
 		i = child;
 		child = (i*2)+1;
 	}
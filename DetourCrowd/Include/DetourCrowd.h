@@ -51,6 +51,11 @@ static const int DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS = 8;
 ///		dtCrowdAgentParams::queryFilterType
 static const int DT_CROWD_MAX_QUERY_FILTER_TYPE = 16;
 
+/// The maximum number of jobs each phase of a parallel crowd update is split into.
+/// @ingroup crowd
+/// @see dtCrowd::setParallelFor()
+static const int DT_CROWD_MAX_JOBS = 64;
+
 /// Provides neighbor data for agents managed by the crowd.
 /// @ingroup crowd
 /// @see dtCrowdAgent::neis, dtCrowd
@@ -198,6 +203,8 @@ struct dtCrowdAgentDebugInfo
 	dtObstacleAvoidanceDebugData* vod;
 };
 
+struct dtCrowdUpdateJob;
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
@@ -227,6 +234,12 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
+	dtParallelForFn m_parallelFor;
+	void* m_parallelUserData;
+	int m_jobCount;
+	dtNavMeshQuery* m_jobNavQueries[DT_CROWD_MAX_JOBS];					///< Job 0 uses m_navquery.
+	dtObstacleAvoidanceQuery* m_jobObstacleQueries[DT_CROWD_MAX_JOBS];	///< Job 0 uses m_obstacleQuery.
+
 	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
 	void updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
@@ -235,6 +248,11 @@ class dtCrowd
 
 	bool requestMoveTargetReplan(const int idx, dtPolyRef ref, const float* pos);
 
+	void runUpdatePhase(dtCrowdUpdateJob* job, const int phase);
+	void updateAgents(dtCrowdUpdateJob* job, const int jobIndex);
+	static void updateAgentsJob(void* jobData, int jobIndex);
+	void freeJobQueries();
+
 	void purge();
 	
 public:
@@ -316,6 +334,14 @@ public:
 	///  @param[in]		dt		The time, in seconds, to update the simulation. [Limit: > 0]
 	///  @param[out]	debug	A debug object to load with debug information. [Opt]
 	void update(const float dt, dtCrowdAgentDebugInfo* debug);
+
+	/// Lets #update run its per-agent phases as parallel jobs.
+	/// Each job owns its query objects, so the results do not depend on the scheduler.
+	///  @param[in]		parallelFor	Runs the jobs of a phase and returns when they are done. Null updates serially.
+	///  @param[in]		userData	Passed to @p parallelFor.
+	///  @param[in]		jobCount	The number of jobs per phase. [Limits: 1 <= value <= #DT_CROWD_MAX_JOBS]
+	/// @return True if the query objects of the jobs could be allocated.
+	bool setParallelFor(dtParallelForFn parallelFor, void* userData, const int jobCount);
 	
 	/// Gets the filter used by the crowd.
 	/// @return The filter used by the crowd.
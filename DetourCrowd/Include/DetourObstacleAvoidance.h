@@ -130,7 +130,7 @@ private:
 	dtObstacleAvoidanceQuery(const dtObstacleAvoidanceQuery&);
 	dtObstacleAvoidanceQuery& operator=(const dtObstacleAvoidanceQuery&);
 
-	void prepare(const float* pos, const float* dvel);
+	void prepare(const float* pos, const float rad, const float* dvel);
 
 	float processSample(const float* vcand, const float cs,
 						const float* pos, const float rad,
@@ -138,6 +138,16 @@ private:
 						const float minPenalty,
 						dtObstacleAvoidanceDebugData* debug);
 
+	void processSampleBatch(const float* vcandx, const float* vcandz,
+							const float* vel, const float* dvel,
+							const float minPenalty, float* penalties);
+
+	int sampleBatch(float* vcandx, float* vcandz, const int nvcand,
+					const float cs, const float* pos, const float rad,
+					const float* vel, const float* dvel,
+					float& minPenalty, float* bestVel,
+					dtObstacleAvoidanceDebugData* debug);
+
 	dtObstacleAvoidanceParams m_params;
 	float m_invHorizTime;
 	float m_vmax;
@@ -150,6 +160,9 @@ private:
 	int m_maxSegments;
 	dtObstacleSegment* m_segments;
 	int m_nsegments;
+
+	float* m_circleLanes;	///< Circles relative to the agent, one array per field. (Filled by prepare().)
+	float* m_segmentLanes;	///< Segments relative to the agent, one array per field. (Filled by prepare().)
 };
 
 dtObstacleAvoidanceQuery* dtAllocObstacleAvoidanceQuery();
@@ -67,6 +67,92 @@ static int isectRaySeg(const float* ap, const float* u,
 	return 1;
 }
 
+// Candidate velocities are scored in batches against obstacles stored as
+// structure of arrays. A batch is DT_OA_BATCH / DT_OA_LANES vectors wide.
+// Without SSE2 or AVX the samples are scored one by one with processSample().
+static const int DT_OA_BATCH = 8;
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define DT_OA_SIMD
+#define DT_OA_LANES 8
+typedef __m256 dtOaFloat;
+typedef __m256 dtOaMask;
+static inline dtOaFloat oaLoad(const float* p) { return _mm256_loadu_ps(p); }
+static inline void oaStore(float* p, const dtOaFloat v) { _mm256_storeu_ps(p, v); }
+static inline dtOaFloat oaSet(const float v) { return _mm256_set1_ps(v); }
+static inline dtOaFloat oaAdd(const dtOaFloat a, const dtOaFloat b) { return _mm256_add_ps(a, b); }
+static inline dtOaFloat oaSub(const dtOaFloat a, const dtOaFloat b) { return _mm256_sub_ps(a, b); }
+static inline dtOaFloat oaMul(const dtOaFloat a, const dtOaFloat b) { return _mm256_mul_ps(a, b); }
+static inline dtOaFloat oaDiv(const dtOaFloat a, const dtOaFloat b) { return _mm256_div_ps(a, b); }
+static inline dtOaFloat oaSqrt(const dtOaFloat a) { return _mm256_sqrt_ps(a); }
+static inline dtOaFloat oaMin(const dtOaFloat a, const dtOaFloat b) { return _mm256_min_ps(a, b); }
+static inline dtOaFloat oaMax(const dtOaFloat a, const dtOaFloat b) { return _mm256_max_ps(a, b); }
+static inline dtOaFloat oaAbs(const dtOaFloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline dtOaMask oaLt(const dtOaFloat a, const dtOaFloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline dtOaMask oaLe(const dtOaFloat a, const dtOaFloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline dtOaMask oaGt(const dtOaFloat a, const dtOaFloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline dtOaMask oaGe(const dtOaFloat a, const dtOaFloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline dtOaMask oaAnd(const dtOaMask a, const dtOaMask b) { return _mm256_and_ps(a, b); }
+static inline dtOaMask oaOr(const dtOaMask a, const dtOaMask b) { return _mm256_or_ps(a, b); }
+static inline dtOaFloat oaSelect(const dtOaMask m, const dtOaFloat a, const dtOaFloat b) { return _mm256_blendv_ps(b, a, m); }
+static inline bool oaAll(const dtOaMask m) { return _mm256_movemask_ps(m) == 0xff; }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DT_OA_SIMD
+#define DT_OA_LANES 4
+typedef __m128 dtOaFloat;
+typedef __m128 dtOaMask;
+static inline dtOaFloat oaLoad(const float* p) { return _mm_loadu_ps(p); }
+static inline void oaStore(float* p, const dtOaFloat v) { _mm_storeu_ps(p, v); }
+static inline dtOaFloat oaSet(const float v) { return _mm_set1_ps(v); }
+static inline dtOaFloat oaAdd(const dtOaFloat a, const dtOaFloat b) { return _mm_add_ps(a, b); }
+static inline dtOaFloat oaSub(const dtOaFloat a, const dtOaFloat b) { return _mm_sub_ps(a, b); }
+static inline dtOaFloat oaMul(const dtOaFloat a, const dtOaFloat b) { return _mm_mul_ps(a, b); }
+static inline dtOaFloat oaDiv(const dtOaFloat a, const dtOaFloat b) { return _mm_div_ps(a, b); }
+static inline dtOaFloat oaSqrt(const dtOaFloat a) { return _mm_sqrt_ps(a); }
+static inline dtOaFloat oaMin(const dtOaFloat a, const dtOaFloat b) { return _mm_min_ps(a, b); }
+static inline dtOaFloat oaMax(const dtOaFloat a, const dtOaFloat b) { return _mm_max_ps(a, b); }
+static inline dtOaFloat oaAbs(const dtOaFloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline dtOaMask oaLt(const dtOaFloat a, const dtOaFloat b) { return _mm_cmplt_ps(a, b); }
+static inline dtOaMask oaLe(const dtOaFloat a, const dtOaFloat b) { return _mm_cmple_ps(a, b); }
+static inline dtOaMask oaGt(const dtOaFloat a, const dtOaFloat b) { return _mm_cmpgt_ps(a, b); }
+static inline dtOaMask oaGe(const dtOaFloat a, const dtOaFloat b) { return _mm_cmpge_ps(a, b); }
+static inline dtOaMask oaAnd(const dtOaMask a, const dtOaMask b) { return _mm_and_ps(a, b); }
+static inline dtOaMask oaOr(const dtOaMask a, const dtOaMask b) { return _mm_or_ps(a, b); }
+static inline dtOaFloat oaSelect(const dtOaMask m, const dtOaFloat a, const dtOaFloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline bool oaAll(const dtOaMask m) { return _mm_movemask_ps(m) == 0xf; }
+#endif
+
+// Fields of dtObstacleAvoidanceQuery::m_circleLanes, each an array of maxCircles floats.
+enum dtObstacleCircleLane
+{
+	DT_OA_CIR_SX,		// Obstacle position relative to the agent.
+	DT_OA_CIR_SZ,
+	DT_OA_CIR_C,		// Squared distance minus squared combined radius.
+	DT_OA_CIR_VELX,
+	DT_OA_CIR_VELZ,
+	DT_OA_CIR_DPX,
+	DT_OA_CIR_DPZ,
+	DT_OA_CIR_NPX,
+	DT_OA_CIR_NPZ,
+	DT_OA_CIR_FIELDS,
+};
+
+// Fields of dtObstacleAvoidanceQuery::m_segmentLanes, each an array of maxSegments floats.
+enum dtObstacleSegmentLane
+{
+	DT_OA_SEG_VX,		// Segment direction.
+	DT_OA_SEG_VZ,
+	DT_OA_SEG_WX,		// Agent position relative to the segment start.
+	DT_OA_SEG_WZ,
+	DT_OA_SEG_PERP,		// dtVperp2D(v, w)
+	DT_OA_SEG_NX,		// Segment normal, used when touching.
+	DT_OA_SEG_NZ,
+	DT_OA_SEG_TOUCH,
+	DT_OA_SEG_FIELDS,
+};
+
 
 
 dtObstacleAvoidanceDebugData* dtAllocObstacleAvoidanceDebugData()
@@ -215,7 +301,9 @@ dtObstacleAvoidanceQuery::dtObstacleAvoidanceQuery() :
 	m_ncircles(0),
 	m_maxSegments(0),
 	m_segments(0),
-	m_nsegments(0)
+	m_nsegments(0),
+	m_circleLanes(0),
+	m_segmentLanes(0)
 {
 }
 
@@ -223,6 +311,8 @@ dtObstacleAvoidanceQuery::~dtObstacleAvoidanceQuery()
 {
 	dtFree(m_circles);
 	dtFree(m_segments);
+	dtFree(m_circleLanes);
+	dtFree(m_segmentLanes);
 }
 
 bool dtObstacleAvoidanceQuery::init(const int maxCircles, const int maxSegments)
@@ -240,6 +330,13 @@ bool dtObstacleAvoidanceQuery::init(const int maxCircles, const int maxSegments)
 	if (!m_segments)
 		return false;
 	memset(m_segments, 0, sizeof(dtObstacleSegment)*m_maxSegments);
+
+	m_circleLanes = (float*)dtAlloc(sizeof(float)*DT_OA_CIR_FIELDS*dtMax(m_maxCircles, 1), DT_ALLOC_PERM);
+	if (!m_circleLanes)
+		return false;
+	m_segmentLanes = (float*)dtAlloc(sizeof(float)*DT_OA_SEG_FIELDS*dtMax(m_maxSegments, 1), DT_ALLOC_PERM);
+	if (!m_segmentLanes)
+		return false;
 	
 	return true;
 }
@@ -273,7 +370,7 @@ void dtObstacleAvoidanceQuery::addSegment(const float* p, const float* q)
 	dtVcopy(seg->q, q);
 }
 
-void dtObstacleAvoidanceQuery::prepare(const float* pos, const float* dvel)
+void dtObstacleAvoidanceQuery::prepare(const float* pos, const float rad, const float* dvel)
 {
 	// Prepare obstacles
 	for (int i = 0; i < m_ncircles; ++i)
@@ -312,6 +409,45 @@ void dtObstacleAvoidanceQuery::prepare(const float* pos, const float* dvel)
 		float t;
 		seg->touch = dtDistancePtSegSqr2D(pos, seg->p, seg->q, t) < dtSqr(r);
 	}	
+
+	// Lay the obstacles out for processSampleBatch(), with the terms that do not
+	// depend on the sampled velocity already computed.
+	float* cl = m_circleLanes;
+	const int nc = m_maxCircles;
+	for (int i = 0; i < m_ncircles; ++i)
+	{
+		const dtObstacleCircle* cir = &m_circles[i];
+		float sv[3];
+		dtVsub(sv, cir->p, pos);
+		const float r = rad + cir->rad;
+		cl[DT_OA_CIR_SX*nc + i] = sv[0];
+		cl[DT_OA_CIR_SZ*nc + i] = sv[2];
+		cl[DT_OA_CIR_C*nc + i] = dtVdot2D(sv, sv) - r*r;
+		cl[DT_OA_CIR_VELX*nc + i] = cir->vel[0];
+		cl[DT_OA_CIR_VELZ*nc + i] = cir->vel[2];
+		cl[DT_OA_CIR_DPX*nc + i] = cir->dp[0];
+		cl[DT_OA_CIR_DPZ*nc + i] = cir->dp[2];
+		cl[DT_OA_CIR_NPX*nc + i] = cir->np[0];
+		cl[DT_OA_CIR_NPZ*nc + i] = cir->np[2];
+	}
+
+	float* sl = m_segmentLanes;
+	const int ns = m_maxSegments;
+	for (int i = 0; i < m_nsegments; ++i)
+	{
+		const dtObstacleSegment* seg = &m_segments[i];
+		float v[3], w[3];
+		dtVsub(v, seg->q, seg->p);
+		dtVsub(w, pos, seg->p);
+		sl[DT_OA_SEG_VX*ns + i] = v[0];
+		sl[DT_OA_SEG_VZ*ns + i] = v[2];
+		sl[DT_OA_SEG_WX*ns + i] = w[0];
+		sl[DT_OA_SEG_WZ*ns + i] = w[2];
+		sl[DT_OA_SEG_PERP*ns + i] = dtVperp2D(v, w);
+		sl[DT_OA_SEG_NX*ns + i] = -v[2];
+		sl[DT_OA_SEG_NZ*ns + i] = v[0];
+		sl[DT_OA_SEG_TOUCH*ns + i] = seg->touch ? 1.0f : 0.0f;
+	}
 }
 
 
@@ -432,12 +568,195 @@ float dtObstacleAvoidanceQuery::processSample(const float* vcand, const float cs
 	return penalty;
 }
 
+#ifdef DT_OA_SIMD
+/* Calculate the penalties of DT_OA_BATCH sampled velocities at once.
+ * Same as processSample() for each of them, with the early out threshold
+ * taken from the penalty before the batch.
+ *
+ * @param vcandx, vcandz sampled velocities [DT_OA_BATCH]
+ * @param penalties resulting penalties, minPenalty when a sample bailed out [DT_OA_BATCH]
+ */
+void dtObstacleAvoidanceQuery::processSampleBatch(const float* vcandx, const float* vcandz,
+												  const float* vel, const float* dvel,
+												  const float minPenalty, float* penalties)
+{
+	static const float EPS = 0.0001f;
+
+	const dtOaFloat zero = oaSet(0.0f);
+	const dtOaFloat one = oaSet(1.0f);
+	const dtOaFloat half = oaSet(0.5f);
+	const dtOaFloat two = oaSet(2.0f);
+	const dtOaFloat eps = oaSet(EPS);
+	const dtOaFloat velx = oaSet(vel[0]);
+	const dtOaFloat velz = oaSet(vel[2]);
+	const dtOaFloat horizTime = oaSet(m_params.horizTime);
+	const dtOaFloat weightToi = oaSet(m_params.weightToi);
+	const dtOaFloat minPenaltyv = oaSet(minPenalty);
+
+	const float* cl = m_circleLanes;
+	const int nc = m_maxCircles;
+	const float* sl = m_segmentLanes;
+	const int nsl = m_maxSegments;
+
+	for (int lane = 0; lane < DT_OA_BATCH; lane += DT_OA_LANES)
+	{
+		const dtOaFloat vx = oaLoad(vcandx + lane);
+		const dtOaFloat vz = oaLoad(vcandz + lane);
+
+		// penalty for straying away from the desired and current velocities
+		const dtOaFloat ddx = oaSub(oaSet(dvel[0]), vx);
+		const dtOaFloat ddz = oaSub(oaSet(dvel[2]), vz);
+		const dtOaFloat dcx = oaSub(velx, vx);
+		const dtOaFloat dcz = oaSub(velz, vz);
+		const dtOaFloat vpen = oaMul(oaSet(m_params.weightDesVel),
+									 oaMul(oaSqrt(oaAdd(oaMul(ddx, ddx), oaMul(ddz, ddz))), oaSet(m_invVmax)));
+		const dtOaFloat vcpen = oaMul(oaSet(m_params.weightCurVel),
+									  oaMul(oaSqrt(oaAdd(oaMul(dcx, dcx), oaMul(dcz, dcz))), oaSet(m_invVmax)));
+
+		// find the threshold hit time to bail out based on the early out penalty
+		const dtOaFloat minPen = oaSub(oaSub(minPenaltyv, vpen), vcpen);
+		const dtOaFloat tThresold = oaMul(oaSub(oaDiv(weightToi, minPen), oaSet(0.1f)), horizTime);
+		const dtOaMask tooMuch = oaGt(oaSub(tThresold, horizTime), oaSet(-FLT_EPSILON));
+
+		dtOaFloat tmin = horizTime;
+		dtOaFloat side = zero;
+
+		for (int i = 0; i < m_ncircles; ++i)
+		{
+			// RVO
+			const dtOaFloat vabx = oaSub(oaSub(oaMul(vx, two), velx), oaSet(cl[DT_OA_CIR_VELX*nc + i]));
+			const dtOaFloat vabz = oaSub(oaSub(oaMul(vz, two), velz), oaSet(cl[DT_OA_CIR_VELZ*nc + i]));
+
+			// Side
+			const dtOaFloat dp = oaAdd(oaMul(oaSet(cl[DT_OA_CIR_DPX*nc + i]), vabx), oaMul(oaSet(cl[DT_OA_CIR_DPZ*nc + i]), vabz));
+			const dtOaFloat np = oaAdd(oaMul(oaSet(cl[DT_OA_CIR_NPX*nc + i]), vabx), oaMul(oaSet(cl[DT_OA_CIR_NPZ*nc + i]), vabz));
+			side = oaAdd(side, oaMin(oaMax(oaMin(oaAdd(oaMul(dp, half), half), oaMul(np, two)), zero), one));
+
+			// Sweep circle against circle.
+			const dtOaFloat a = oaAdd(oaMul(vabx, vabx), oaMul(vabz, vabz));
+			const dtOaFloat b = oaAdd(oaMul(vabx, oaSet(cl[DT_OA_CIR_SX*nc + i])), oaMul(vabz, oaSet(cl[DT_OA_CIR_SZ*nc + i])));
+			const dtOaFloat d = oaSub(oaMul(b, b), oaMul(a, oaSet(cl[DT_OA_CIR_C*nc + i])));
+			const dtOaMask hit = oaAnd(oaGe(a, eps), oaGe(d, zero));
+			const dtOaFloat ainv = oaDiv(one, oaMax(a, eps));
+			const dtOaFloat rd = oaSqrt(oaMax(d, zero));
+			dtOaFloat htmin = oaMul(oaSub(b, rd), ainv);
+			const dtOaFloat htmax = oaMul(oaAdd(b, rd), ainv);
+
+			// Handle overlapping obstacles, avoid more when overlapped.
+			htmin = oaSelect(oaAnd(oaLt(htmin, zero), oaGt(htmax, zero)), oaMul(oaSub(zero, htmin), half), htmin);
+
+			// The closest obstacle is somewhere ahead of us, keep track of nearest obstacle.
+			tmin = oaSelect(oaAnd(hit, oaAnd(oaGe(htmin, zero), oaLt(htmin, tmin))), htmin, tmin);
+			if (oaAll(oaOr(tooMuch, oaLt(tmin, tThresold))))
+				break;
+		}
+
+		for (int i = 0; i < m_nsegments; ++i)
+		{
+			if (oaAll(oaOr(tooMuch, oaLt(tmin, tThresold))))
+				break;
+
+			dtOaMask hit;
+			dtOaFloat htmin;
+			if (sl[DT_OA_SEG_TOUCH*nsl + i] != 0.0f)
+			{
+				// Special case when the agent is very close to the segment.
+				// If the velocity is pointing towards the segment, no collision, else immediate collision.
+				const dtOaFloat dn = oaAdd(oaMul(oaSet(sl[DT_OA_SEG_NX*nsl + i]), vx), oaMul(oaSet(sl[DT_OA_SEG_NZ*nsl + i]), vz));
+				hit = oaGe(dn, zero);
+				htmin = zero;
+			}
+			else
+			{
+				// Ray against segment.
+				const dtOaFloat segvx = oaSet(sl[DT_OA_SEG_VX*nsl + i]);
+				const dtOaFloat segvz = oaSet(sl[DT_OA_SEG_VZ*nsl + i]);
+				const dtOaFloat segwx = oaSet(sl[DT_OA_SEG_WX*nsl + i]);
+				const dtOaFloat segwz = oaSet(sl[DT_OA_SEG_WZ*nsl + i]);
+				const dtOaFloat d = oaSub(oaMul(vz, segvx), oaMul(vx, segvz));
+				const dtOaMask parallel = oaLt(oaAbs(d), oaSet(1e-6f));
+				const dtOaMask crossing = oaGe(oaAbs(d), oaSet(1e-6f));
+				const dtOaFloat dinv = oaDiv(one, oaSelect(parallel, one, d));
+				const dtOaFloat t = oaMul(oaSet(sl[DT_OA_SEG_PERP*nsl + i]), dinv);
+				const dtOaFloat s = oaMul(oaSub(oaMul(vz, segwx), oaMul(vx, segwz)), dinv);
+				hit = oaAnd(crossing, oaAnd(oaAnd(oaGe(t, zero), oaLe(t, one)), oaAnd(oaGe(s, zero), oaLe(s, one))));
+				htmin = t;
+			}
+
+			// Avoid less when facing walls.
+			htmin = oaMul(htmin, two);
+
+			// The closest obstacle is somewhere ahead of us, keep track of nearest obstacle.
+			tmin = oaSelect(oaAnd(hit, oaLt(htmin, tmin)), htmin, tmin);
+		}
+
+		// Normalize side bias, to prevent it dominating too much.
+		if (m_ncircles)
+			side = oaDiv(side, oaSet((float)m_ncircles));
+
+		const dtOaFloat spen = oaMul(oaSet(m_params.weightSide), side);
+		const dtOaFloat tpen = oaMul(weightToi, oaDiv(one, oaAdd(oaSet(0.1f), oaMul(tmin, oaSet(m_invHorizTime)))));
+		const dtOaFloat penalty = oaAdd(oaAdd(oaAdd(vpen, vcpen), spen), tpen);
+		oaStore(penalties + lane, oaSelect(oaOr(tooMuch, oaLt(tmin, tThresold)), minPenaltyv, penalty));
+	}
+}
+#endif
+
+/* Score the sampled velocities and keep the best one.
+ * Batches stop early out only at the batch boundary, which does not change
+ * the pick: a sample that would have bailed out scores above the best one.
+ */
+int dtObstacleAvoidanceQuery::sampleBatch(float* vcandx, float* vcandz, const int nvcand,
+										  const float cs, const float* pos, const float rad,
+										  const float* vel, const float* dvel,
+										  float& minPenalty, float* bestVel,
+										  dtObstacleAvoidanceDebugData* debug)
+{
+#ifdef DT_OA_SIMD
+	if (debug)
+#endif
+	{
+		// The debug data records every penalty term, score one sample at a time.
+		for (int i = 0; i < nvcand; ++i)
+		{
+			const float vcand[3] = { vcandx[i], 0, vcandz[i] };
+			const float penalty = processSample(vcand, cs, pos,rad,vel,dvel, minPenalty, debug);
+			if (penalty < minPenalty)
+			{
+				minPenalty = penalty;
+				dtVcopy(bestVel, vcand);
+			}
+		}
+		return nvcand;
+	}
+
+#ifdef DT_OA_SIMD
+	for (int i = nvcand; i < DT_OA_BATCH; ++i)
+	{
+		vcandx[i] = vcandx[0];
+		vcandz[i] = vcandz[0];
+	}
+
+	float penalties[DT_OA_BATCH];
+	processSampleBatch(vcandx, vcandz, vel, dvel, minPenalty, penalties);
+	for (int i = 0; i < nvcand; ++i)
+	{
+		if (penalties[i] < minPenalty)
+		{
+			minPenalty = penalties[i];
+			dtVset(bestVel, vcandx[i], 0, vcandz[i]);
+		}
+	}
+	return nvcand;
+#endif
+}
+
 int dtObstacleAvoidanceQuery::sampleVelocityGrid(const float* pos, const float rad, const float vmax,
 												 const float* vel, const float* dvel, float* nvel,
 												 const dtObstacleAvoidanceParams* params,
 												 dtObstacleAvoidanceDebugData* debug)
 {
-	prepare(pos, dvel);
+	prepare(pos, rad, dvel);
 	
 	memcpy(&m_params, params, sizeof(dtObstacleAvoidanceParams));
 	m_invHorizTime = 1.0f / m_params.horizTime;
@@ -456,6 +775,8 @@ int dtObstacleAvoidanceQuery::sampleVelocityGrid(const float* pos, const float r
 		
 	float minPenalty = FLT_MAX;
 	int ns = 0;
+	float bx[DT_OA_BATCH], bz[DT_OA_BATCH];
+	int nb = 0;
 		
 	for (int y = 0; y < m_params.gridSize; ++y)
 	{
@@ -468,15 +789,17 @@ int dtObstacleAvoidanceQuery::sampleVelocityGrid(const float* pos, const float r
 			
 			if (dtSqr(vcand[0])+dtSqr(vcand[2]) > dtSqr(vmax+cs/2)) continue;
 			
-			const float penalty = processSample(vcand, cs, pos,rad,vel,dvel, minPenalty, debug);
-			ns++;
-			if (penalty < minPenalty)
+			bx[nb] = vcand[0];
+			bz[nb] = vcand[2];
+			if (++nb == DT_OA_BATCH)
 			{
-				minPenalty = penalty;
-				dtVcopy(nvel, vcand);
+				ns += sampleBatch(bx, bz, nb, cs, pos,rad,vel,dvel, minPenalty, nvel, debug);
+				nb = 0;
 			}
 		}
 	}
+	if (nb)
+		ns += sampleBatch(bx, bz, nb, cs, pos,rad,vel,dvel, minPenalty, nvel, debug);
 	
 	return ns;
 }
@@ -509,7 +832,7 @@ int dtObstacleAvoidanceQuery::sampleVelocityAdaptive(const float* pos, const flo
 													 const dtObstacleAvoidanceParams* params,
 													 dtObstacleAvoidanceDebugData* debug)
 {
-	prepare(pos, dvel);
+	prepare(pos, rad, dvel);
 	
 	memcpy(&m_params, params, sizeof(dtObstacleAvoidanceParams));
 	m_invHorizTime = 1.0f / m_params.horizTime;
@@ -590,6 +913,9 @@ int dtObstacleAvoidanceQuery::sampleVelocityAdaptive(const float* pos, const flo
 		float bvel[3];
 		dtVset(bvel, 0,0,0);
 		
+		float bx[DT_OA_BATCH], bz[DT_OA_BATCH];
+		int nb = 0;
+		
 		for (int i = 0; i < npat; ++i)
 		{
 			float vcand[3];
@@ -599,14 +925,16 @@ int dtObstacleAvoidanceQuery::sampleVelocityAdaptive(const float* pos, const flo
 			
 			if (dtSqr(vcand[0])+dtSqr(vcand[2]) > dtSqr(vmax+0.001f)) continue;
 			
-			const float penalty = processSample(vcand,cr/10, pos,rad,vel,dvel, minPenalty, debug);
-			ns++;
-			if (penalty < minPenalty)
+			bx[nb] = vcand[0];
+			bz[nb] = vcand[2];
+			if (++nb == DT_OA_BATCH)
 			{
-				minPenalty = penalty;
-				dtVcopy(bvel, vcand);
+				ns += sampleBatch(bx, bz, nb, cr/10, pos,rad,vel,dvel, minPenalty, bvel, debug);
+				nb = 0;
 			}
 		}
+		if (nb)
+			ns += sampleBatch(bx, bz, nb, cr/10, pos,rad,vel,dvel, minPenalty, bvel, debug);
 
 		dtVcopy(res, bvel);
 
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef DETOURTILECACHECOMPRESSOR_H
+#define DETOURTILECACHECOMPRESSOR_H
+
+#include "DetourTileCacheBuilder.h"
+
+/// @name LZ block codec
+/// Byte-oriented LZ77 codec (LZ4 block layout: token, literals, 16-bit offset,
+/// match length). Greedy single-probe matching keeps compression cheap and
+/// decoding is a plain copy loop, fast enough to be hidden behind disk reads.
+/// Tile cache layers and navmesh tile blobs are both highly repetitive and
+/// usually shrink several times.
+/// @{
+
+/// Returns the worst case compressed size for @p srcSize input bytes.
+int dtLZCompressBound(const int srcSize);
+
+/// Compresses @p src into @p dst.
+/// @return The number of bytes written, or 0 if @p dstCapacity is too small.
+int dtLZCompress(const unsigned char* src, const int srcSize, unsigned char* dst, const int dstCapacity);
+
+/// Decompresses @p src into @p dst. Malformed input never reads or writes out of bounds.
+/// @return The number of bytes written, or -1 if the input is malformed or does not fit.
+int dtLZDecompress(const unsigned char* src, const int srcSize, unsigned char* dst, const int dstCapacity);
+
+/// @}
+
+/// Tile cache compressor backed by the built-in LZ codec.
+struct dtTileCacheLZCompressor : public dtTileCacheCompressor
+{
+	virtual ~dtTileCacheLZCompressor();
+
+	virtual int maxCompressedSize(const int bufferSize);
+	virtual dtStatus compress(const unsigned char* buffer, const int bufferSize,
+							  unsigned char* compressed, const int maxCompressedSize, int* compressedSize);
+	virtual dtStatus decompress(const unsigned char* compressed, const int compressedSize,
+								unsigned char* buffer, const int maxBufferSize, int* bufferSize);
+};
+
+#endif // DETOURTILECACHECOMPRESSOR_H
@@ -763,14 +763,11 @@ dtStatus dtTileCache::buildNavMeshTile(const dtCompressedTileRef ref, dtNavMesh*
 	if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
 		return DT_FAILURE;
 
-	// Remove existing tile.
-	navmesh->removeTile(navmesh->getTileRefAt(tile->header->tx,tile->header->ty,tile->header->tlayer),0,0);
-
-	// Add new tile, or leave the location empty.
+	// Swap the new tile in; the existing tile stays in place if this fails.
 	if (navData)
 	{
 		// Let the navmesh own the data.
-		status = navmesh->addTile(navData,navDataSize,DT_TILE_FREE_DATA,0,0);
+		status = navmesh->replaceTile(navData,navDataSize,DT_TILE_FREE_DATA,0);
 		if (dtStatusFailed(status))
 		{
 			dtFree(navData);
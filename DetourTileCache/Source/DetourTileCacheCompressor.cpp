@@ -0,0 +1,252 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "DetourTileCacheCompressor.h"
+#include "DetourStatus.h"
+#include <string.h>
+
+static const int LZ_MIN_MATCH = 4;
+static const int LZ_LAST_LITERALS = 5;		// Input tail that is always stored as literals.
+static const int LZ_MATCH_LIMIT = 12;		// No match may start this close to the end.
+static const int LZ_MAX_OFFSET = 0xffff;
+static const int LZ_HASH_BITS = 12;
+static const int LZ_RUN_MASK = 15;
+
+static inline unsigned int lzRead32(const unsigned char* p)
+{
+	unsigned int v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline unsigned int lzHash(const unsigned int v)
+{
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Writes the 255-run continuation of a length that did not fit the token nibble.
+static inline bool lzWriteLength(unsigned char*& op, const unsigned char* oend, int len)
+{
+	for (; len >= 255; len -= 255)
+	{
+		if (op >= oend)
+			return false;
+		*op++ = 255;
+	}
+	if (op >= oend)
+		return false;
+	*op++ = (unsigned char)len;
+	return true;
+}
+
+static bool lzEmitSequence(unsigned char*& op, const unsigned char* oend,
+						   const unsigned char* lit, const int litLen,
+						   const int offset, const int matchLen)
+{
+	if (op >= oend)
+		return false;
+	unsigned char* token = op++;
+	*token = (unsigned char)((litLen >= LZ_RUN_MASK ? LZ_RUN_MASK : litLen) << 4);
+	if (litLen >= LZ_RUN_MASK && !lzWriteLength(op, oend, litLen - LZ_RUN_MASK))
+		return false;
+	if (litLen > oend - op)
+		return false;
+	memcpy(op, lit, litLen);
+	op += litLen;
+
+	// Literal-only sequence terminates the stream.
+	if (matchLen == 0)
+		return true;
+
+	if (oend - op < 2)
+		return false;
+	*op++ = (unsigned char)(offset & 0xff);
+	*op++ = (unsigned char)(offset >> 8);
+	const int ml = matchLen - LZ_MIN_MATCH;
+	*token |= (unsigned char)(ml >= LZ_RUN_MASK ? LZ_RUN_MASK : ml);
+	if (ml >= LZ_RUN_MASK && !lzWriteLength(op, oend, ml - LZ_RUN_MASK))
+		return false;
+	return true;
+}
+
+int dtLZCompressBound(const int srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+int dtLZCompress(const unsigned char* src, const int srcSize, unsigned char* dst, const int dstCapacity)
+{
+	if ((!src && srcSize > 0) || !dst || srcSize < 0 || dstCapacity <= 0)
+		return 0;
+
+	unsigned char* op = dst;
+	const unsigned char* oend = dst + dstCapacity;
+	int anchor = 0;
+
+	if (srcSize > LZ_MATCH_LIMIT)
+	{
+		int table[1 << LZ_HASH_BITS];
+		memset(table, 0xff, sizeof(table));
+
+		const int limit = srcSize - LZ_MATCH_LIMIT;
+		const int matchEnd = srcSize - LZ_LAST_LITERALS;
+		int ip = 0;
+		while (ip < limit)
+		{
+			const unsigned int seq = lzRead32(src + ip);
+			const unsigned int h = lzHash(seq);
+			int ref = table[h];
+			table[h] = ip;
+
+			if (ref < 0 || ip - ref > LZ_MAX_OFFSET || lzRead32(src + ref) != seq)
+			{
+				// Step further the longer nothing matched, incompressible data stays cheap.
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+			{
+				ip--;
+				ref--;
+			}
+			int len = LZ_MIN_MATCH;
+			while (ip + len < matchEnd && src[ref + len] == src[ip + len])
+				len++;
+
+			if (!lzEmitSequence(op, oend, src + anchor, ip - anchor, ip - ref, len))
+				return 0;
+
+			ip += len;
+			anchor = ip;
+			if (ip - 2 < limit)
+				table[lzHash(lzRead32(src + ip - 2))] = ip - 2;
+		}
+	}
+
+	if (!lzEmitSequence(op, oend, src + anchor, srcSize - anchor, 0, 0))
+		return 0;
+	return (int)(op - dst);
+}
+
+int dtLZDecompress(const unsigned char* src, const int srcSize, unsigned char* dst, const int dstCapacity)
+{
+	if (!src || !dst || srcSize <= 0 || dstCapacity < 0)
+		return -1;
+
+	const unsigned char* ip = src;
+	const unsigned char* iend = src + srcSize;
+	unsigned char* op = dst;
+	unsigned char* oend = dst + dstCapacity;
+
+	while (ip < iend)
+	{
+		const unsigned int token = *ip++;
+
+		size_t litLen = token >> 4;
+		if (litLen == (size_t)LZ_RUN_MASK)
+		{
+			unsigned int b;
+			do
+			{
+				if (ip >= iend)
+					return -1;
+				b = *ip++;
+				litLen += b;
+			}
+			while (b == 255);
+		}
+		if (litLen > (size_t)(iend - ip) || litLen > (size_t)(oend - op))
+			return -1;
+		memcpy(op, ip, litLen);
+		ip += litLen;
+		op += litLen;
+
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return -1;
+		const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - dst))
+			return -1;
+
+		size_t matchLen = token & LZ_RUN_MASK;
+		if (matchLen == (size_t)LZ_RUN_MASK)
+		{
+			unsigned int b;
+			do
+			{
+				if (ip >= iend)
+					return -1;
+				b = *ip++;
+				matchLen += b;
+			}
+			while (b == 255);
+		}
+		matchLen += LZ_MIN_MATCH;
+		if (matchLen > (size_t)(oend - op))
+			return -1;
+
+		const unsigned char* match = op - offset;
+		if (offset >= matchLen)
+		{
+			memcpy(op, match, matchLen);
+			op += matchLen;
+		}
+		else
+		{
+			// Overlapping copy repeats the last 'offset' bytes (runs).
+			for (size_t i = 0; i < matchLen; ++i)
+				*op++ = *match++;
+		}
+	}
+
+	return (int)(op - dst);
+}
+
+dtTileCacheLZCompressor::~dtTileCacheLZCompressor()
+{
+	// Defined out of line to fix the weak v-tables warning
+}
+
+int dtTileCacheLZCompressor::maxCompressedSize(const int bufferSize)
+{
+	return dtLZCompressBound(bufferSize);
+}
+
+dtStatus dtTileCacheLZCompressor::compress(const unsigned char* buffer, const int bufferSize,
+										   unsigned char* compressed, const int maxCompressedSize, int* compressedSize)
+{
+	const int n = dtLZCompress(buffer, bufferSize, compressed, maxCompressedSize);
+	if (n <= 0)
+		return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+	*compressedSize = n;
+	return DT_SUCCESS;
+}
+
+dtStatus dtTileCacheLZCompressor::decompress(const unsigned char* compressed, const int compressedSize,
+											 unsigned char* buffer, const int maxBufferSize, int* bufferSize)
+{
+	const int n = dtLZDecompress(compressed, compressedSize, buffer, maxBufferSize);
+	if (n < 0)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	*bufferSize = n;
+	return DT_SUCCESS;
+}
@@ -1,9 +1,13 @@
 #include "GtaNavAPI.h"
 #include "InputGeom.h"
 #include "GtaNavTiles.h"
+#include "GtaNavGeometry.h"
+#include "GtaNavProps.h"
+#include "GtaNavTileAlloc.h"
 
 GTANAV_API NavMeshContext* GtaNav_InitNavMesh()
 {
+    GtaNavTileAlloc_Install();
     return GtaNav_CreateContext();
 }
 
@@ -34,6 +38,17 @@ GTANAV_API bool GtaNav_IsDynamicContextReady(NavMeshContext* ctx)
     return ctx->navMesh != nullptr && ctx->navQuery != nullptr;
 }
 
+GTANAV_API void GtaNav_SetMaxResidentTiles(NavMeshContext* ctx, int maxTiles)
+{
+    if (!ctx) return;
+    ctx->maxResidentTiles = maxTiles > 0 ? maxTiles : 0;
+}
+
+GTANAV_API int GtaNav_GetPolyRefBits()
+{
+    return (int)(sizeof(dtPolyRef) * 8);
+}
+
 GTANAV_API bool GtaNav_SetCombinedGeometry(NavMeshContext* ctx,
                                            const float* verts,
                                            int nverts,
@@ -52,9 +67,55 @@ GTANAV_API bool GtaNav_SetCombinedGeometry(NavMeshContext* ctx,
         return false;
     }
 
+    // Geometria externa ocupa a camada estática; não sobrescrever no próximo RebuildCombinedGeometry.
+    ctx->staticLayerDirty = false;
+    return true;
+}
+
+GTANAV_API bool GtaNav_SetPropTransform(NavMeshContext* ctx,
+                                        int propID,
+                                        const float* pos3,
+                                        const float* rot3,
+                                        bool rebuildTiles)
+{
+    if (!ctx || !pos3 || !rot3)
+        return false;
+
+    if (!GtaNavGeometry::SetPropTransform(ctx, propID, pos3, rot3))
+        return false;
+
+    // Só a camada dinâmica é refeita; o chunky do estático fica como está.
+    if (!GtaNavGeometry::RebuildDynamicLayer(ctx))
+        return false;
+
+    if (PropInstance* inst = GtaNavProps::FindProp(ctx, propID))
+        GtaNavTiles::MarkDirtyTilesForProp(ctx, *inst);
+
+    if (rebuildTiles)
+        GtaNavTiles::UpdateDirtyTiles(ctx, 0.0f);
+
     return true;
 }
 
+GTANAV_API int GtaNav_UpdateDirtyTiles(NavMeshContext* ctx, float budgetMs)
+{
+    return GtaNavTiles::UpdateDirtyTiles(ctx, budgetMs);
+}
+
+GTANAV_API int GtaNav_GetDirtyTileCount(NavMeshContext* ctx)
+{
+    return ctx ? (int)ctx->dirtyTiles.size() : 0;
+}
+
+GTANAV_API void GtaNav_SetDirtyTileFocus(NavMeshContext* ctx, const float* pos3)
+{
+    if (!ctx) return;
+
+    ctx->hasDirtyFocus = pos3 != nullptr;
+    if (pos3)
+        rcVcopy(ctx->dirtyFocus, pos3);
+}
+
 GTANAV_API bool GtaNav_BuildTilesAroundPositionAPI(NavMeshContext* ctx,
                                                    const float* pos,
                                                    int numTilesX,
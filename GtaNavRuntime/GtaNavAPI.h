@@ -26,6 +26,12 @@ GTANAV_API bool GtaNav_InitDynamicContext(NavMeshContext* ctx,
 // Consulta se está pronto
 GTANAV_API bool GtaNav_IsDynamicContextReady(NavMeshContext* ctx);
 
+// Capacidade de tiles residentes; chamar antes de GtaNav_InitDynamicContext.
+// Só tem efeito no build com dtPolyRef 64 bits (0 = grid inteiro).
+GTANAV_API void GtaNav_SetMaxResidentTiles(NavMeshContext* ctx, int maxTiles);
+// 32 ou 64, conforme o build (RECASTNAVIGATION_DT_POLYREF64).
+GTANAV_API int  GtaNav_GetPolyRefBits();
+
 // Geometria (por enquanto só um stub pra você ligar no seu pipeline atual)
 GTANAV_API bool GtaNav_SetCombinedGeometry(NavMeshContext* ctx,
                                            const float* verts,
@@ -33,6 +39,22 @@ GTANAV_API bool GtaNav_SetCombinedGeometry(NavMeshContext* ctx,
                                            const int* tris,
                                            int ntris);
 
+// Move um prop já adicionado: recalcula só os vértices dele e a camada dinâmica,
+// e marca como sujos os tiles da posição antiga e da nova.
+// rebuildTiles = esvazia a fila de tiles sujos na hora (sem budget).
+GTANAV_API bool GtaNav_SetPropTransform(NavMeshContext* ctx,
+                                        int propID,
+                                        const float* pos3,
+                                        const float* rot3,
+                                        bool rebuildTiles);
+
+// Rebuild incremental dos tiles sujos (props movidos), limitado por tempo.
+// Retorna quantos tiles foram processados; budgetMs <= 0 processa todos.
+GTANAV_API int  GtaNav_UpdateDirtyTiles(NavMeshContext* ctx, float budgetMs);
+GTANAV_API int  GtaNav_GetDirtyTileCount(NavMeshContext* ctx);
+// Tiles mais próximos de pos3 (coordenadas Recast) saem primeiro; nullptr = ordem de marcação.
+GTANAV_API void GtaNav_SetDirtyTileFocus(NavMeshContext* ctx, const float* pos3);
+
 // Tiles
 GTANAV_API bool GtaNav_BuildTilesAroundPositionAPI(NavMeshContext* ctx,
                                                    const float* pos,
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cmath>
 #include "DetourCommon.h"
+#include "GtaNavRefBits.h"
 
 NavMeshContext* GtaNav_CreateContext()
 {
@@ -51,6 +52,7 @@ void GtaNav_SetNavMeshDefinition(NavMeshContext* ctx, const NavMeshDefinition& d
     ctx->mapID = mapID;
 }
 
+#ifndef DT_POLYREF64
 // Helpers internos para bits
 static int ilog2i(int v)
 {
@@ -70,6 +72,7 @@ static int nextPow2i(int v)
     v++;
     return v;
 }
+#endif
 
 bool GtaNav_InitDynamicNavMesh(NavMeshContext* ctx, const float* bmin, const float* bmax)
 {
@@ -112,8 +115,22 @@ bool GtaNav_InitDynamicNavMesh(NavMeshContext* ctx, const float* bmin, const flo
     const int gh = rcMax(1, (int)ceilf(depth / tileWorld));
 
     const int totalTiles = gw * gh;
-    int tileBits = rcMin(ilog2i(nextPow2i(totalTiles)), 14);
-    int polyBits = 22 - tileBits;
+#ifdef DT_POLYREF64
+    // Tiles achados pelo hash de (x,y): só os residentes precisam caber em maxTiles.
+    const int maxTiles = ctx->maxResidentTiles > 0 ? rcMin(totalTiles, ctx->maxResidentTiles) : totalTiles;
+#else
+    const int maxTiles = 1 << rcMin(ilog2i(nextPow2i(totalTiles)), 14);
+#endif
+
+    // Polys ficam com todos os bits que sobram do tile.
+    GtaNavRefLayout layout;
+    if (!GtaNav_ComputeRefLayout(maxTiles, 1u << 31, layout))
+    {
+        printf("[GtaNav] InitDynamicNavMesh: maxTiles=%d nao cabe no dtPolyRef.\n", maxTiles);
+        dtFreeNavMesh(ctx->navMesh);
+        ctx->navMesh = nullptr;
+        return false;
+    }
 
     dtNavMeshParams params{};
     // Origem do grid – você pode usar bmin pra alinhar com o AABB
@@ -124,8 +141,8 @@ bool GtaNav_InitDynamicNavMesh(NavMeshContext* ctx, const float* bmin, const flo
     params.tileWidth  = tileWorld;
     params.tileHeight = tileWorld;
 
-    params.maxTiles = 1 << tileBits;
-    params.maxPolys = 1 << polyBits;
+    params.maxTiles = layout.maxTiles;
+    params.maxPolys = layout.maxPolys;
 
     if (dtStatusFailed(ctx->navMesh->init(&params)))
     {
@@ -148,8 +165,9 @@ bool GtaNav_InitDynamicNavMesh(NavMeshContext* ctx, const float* bmin, const flo
 
     ctx->navmeshGenerated = true;
 
-    printf("[GtaNav] InitDynamicNavMesh OK. grid=%dx%d maxTiles=%d tileWorld=%.2f\n",
-           gw, gh, params.maxTiles, tileWorld);
+    printf("[GtaNav] InitDynamicNavMesh OK. grid=%dx%d maxTiles=%d maxPolys=%d tileBits=%u polyBits=%u ref=%d bits tileWorld=%.2f\n",
+           gw, gh, params.maxTiles, params.maxPolys, layout.tileBits, layout.polyBits,
+           (int)(sizeof(dtPolyRef) * 8), tileWorld);
 
     return true;
 }
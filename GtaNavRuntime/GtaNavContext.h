@@ -4,10 +4,12 @@
 #include <string>
 #include <unordered_map>
 #include <cstdint>
+#include <cfloat>
 
 #include "Recast.h"
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
+#include "GtaNavProfile.h"
 
 // Se o NavMeshDefinition NÃO estiver mais em Sample.h, pode deixar aqui.
 // Se você ainda tiver uma cópia em Sample.h, comente uma delas para evitar redefinition.
@@ -44,6 +46,18 @@ struct PropInstance
     std::string modelName;
     float       pos[3]; // world-space
     float       rot[3]; // Euler ZYX em world-space
+
+    // Cache dos vértices em world-space: só recalculado quando o transform muda
+    // (uma matriz por instância, ver GtaNavGeometry::UpdatePropWorldVerts).
+    std::vector<float> worldVerts;
+    float              worldBMin[3] = {FLT_MAX,FLT_MAX,FLT_MAX};
+    float              worldBMax[3] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
+    bool               worldDirty = true;
+
+    // AABB que os tiles já refletem (ou vão refletir quando a fila de dirty esvaziar).
+    float              builtBMin[3] = {0,0,0};
+    float              builtBMax[3] = {0,0,0};
+    bool               hasBuiltBounds = false;
 };
 
 struct NavMeshContext
@@ -55,10 +69,8 @@ struct NavMeshContext
     dtNavMesh*        navMesh  = nullptr;
     dtNavMeshQuery*   navQuery = nullptr;
 
-    // Contexto de build (pode ser rcContext ou BuildContext, conforme seu projeto)
-    // Se você já tem BuildContext em Sample.h, pode usar:
-    //   BuildContext buildCtx;
-    rcContext         buildCtx;
+    // Contexto de build: coleta os RC_TIMER_* do Recast (ver GtaNavProfile.h)
+    GtaNavProfilingContext buildCtx;
 
     // Geometria combinada que o InputGeom enxerga
     class InputGeom*  geom     = nullptr;
@@ -86,6 +98,7 @@ struct NavMeshContext
     float staticBMin[3] = {FLT_MAX,FLT_MAX,FLT_MAX};
     float staticBMax[3] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
     bool               staticBuilt = false;
+    bool               staticLayerDirty = true; // InputGeom precisa receber o estático de novo
 
     // ------------------------------
     // Dinâmicos (props instanciados)
@@ -96,10 +109,17 @@ struct NavMeshContext
     float dynamicBMax[3] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
 
     // ------------------------------
-    // Buffer combinado (static + dynamic)
+    // Tiles sujos (rebuild incremental por prop, ver GtaNavTiles::UpdateDirtyTiles)
     // ------------------------------
-    std::vector<float> combinedVerts;
-    std::vector<int>   combinedTris;
+    std::unordered_map<uint64_t, uint32_t> dirtyTiles;   // tileKey -> ordem de marcação (dedup)
+    uint32_t dirtyTileSeq = 0;
+    float    dirtyFocus[3] = {0,0,0};                    // tiles mais perto saem primeiro
+    bool     hasDirtyFocus = false;
+
+    // Capacidade de tiles do dtNavMesh (build com dtPolyRef 64 bits).
+    // 0 = grid inteiro. Com refs de 32 bits o grid fica limitado a 2^14 tiles.
+    int      maxResidentTiles = 0;
+
 };
 
 
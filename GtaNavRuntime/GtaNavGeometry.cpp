@@ -1,8 +1,10 @@
 #include "GtaNavGeometry.h"
+#include "GtaNavTrace.h"
 #include "GtaNavTransform.h"
 #include "InputGeom.h"
 #include "RecastAssert.h"
 #include <unordered_map>
+#include <algorithm>
 #include <cstdio>
 #include <cfloat>
 #include <cmath>
@@ -103,6 +105,7 @@ bool GtaNavGeometry::BuildStaticMergedData(NavMeshContext* ctx)
     rcVcopy(ctx->staticBMax, bmax);
 
     ctx->staticBuilt = true;
+    ctx->staticLayerDirty = true;
 
     printf("[Geom] BuildStaticMergedData OK. Verts=%zu Tris=%zu\n",
         ctx->staticVerts.size()/3, ctx->staticTris.size()/3);
@@ -111,6 +114,93 @@ bool GtaNavGeometry::BuildStaticMergedData(NavMeshContext* ctx)
 }
 
 
+// ============================================================================
+//  PROPS: modelo + cache world-space por instância
+// ============================================================================
+CachedModel* GtaNavGeometry::GetOrLoadPropModel(NavMeshContext* ctx, const std::string& modelName)
+{
+    auto it = ctx->propCache.find(modelName);
+    if (it != ctx->propCache.end())
+        return &it->second;
+
+    rcMeshLoaderObj loader;
+    if (!loader.tryLoadBIN(modelName))
+    {
+        printf("[Geom] (Dynamic) Erro ao carregar %s\n", modelName.c_str());
+        return nullptr;
+    }
+
+    CachedModel temp;
+    temp.baseVerts.assign(loader.getVerts(),
+                          loader.getVerts() + loader.getVertCount()*3);
+    temp.baseTris.assign(loader.getTris(),
+                         loader.getTris() + loader.getTriCount()*3);
+
+    CachedModel& mdl = ctx->propCache[modelName];
+    mdl = std::move(temp);
+    return &mdl;
+}
+
+bool GtaNavGeometry::UpdatePropWorldVerts(NavMeshContext* ctx, PropInstance& inst)
+{
+    if (!ctx) return false;
+    if (!inst.worldDirty)
+        return !inst.worldVerts.empty();
+
+    const CachedModel* mdl = GetOrLoadPropModel(ctx, inst.modelName);
+    if (!mdl)
+    {
+        inst.worldVerts.clear();
+        return false;
+    }
+
+    // Uma matriz por instância (antes: uma eulerAngleYXZ por vértice).
+    const glm::mat4 t = MakeTransformZYX(inst.pos, inst.rot);
+    const glm::vec3 c0(t[0]), c1(t[1]), c2(t[2]), c3(t[3]);
+
+    float bmin[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    float bmax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    const int vc = (int)mdl->baseVerts.size() / 3;
+    inst.worldVerts.resize(mdl->baseVerts.size());
+    for (int i = 0; i < vc; i++)
+    {
+        const float* v = &mdl->baseVerts[i*3];
+        const glm::vec3 w = c0 * v[0] + c1 * v[1] + c2 * v[2] + c3;
+
+        inst.worldVerts[i*3+0] = w.x;
+        inst.worldVerts[i*3+1] = w.y;
+        inst.worldVerts[i*3+2] = w.z;
+
+        ExpandAABB(bmin, bmax, w.x, w.y, w.z);
+    }
+
+    rcVcopy(inst.worldBMin, bmin);
+    rcVcopy(inst.worldBMax, bmax);
+    inst.worldDirty = false;
+    return vc > 0;
+}
+
+bool GtaNavGeometry::SetPropTransform(NavMeshContext* ctx,
+                                      int propID,
+                                      const float pos[3],
+                                      const float rot[3])
+{
+    if (!ctx || !pos || !rot) return false;
+
+    auto it = std::find_if(ctx->props.begin(), ctx->props.end(),
+                           [propID](const PropInstance& p) { return p.id == propID; });
+    if (it == ctx->props.end())
+        return false;
+
+    PropInstance& inst = *it;
+    rcVcopy(inst.pos, pos);
+    rcVcopy(inst.rot, rot);
+    inst.worldDirty = true;
+    return UpdatePropWorldVerts(ctx, inst);
+}
+
+
 // ============================================================================
 //  DYNAMIC MERGED DATA
 // ============================================================================
@@ -126,51 +216,25 @@ bool GtaNavGeometry::BuildDynamicMergedData(NavMeshContext* ctx)
 
     int vertOffset = 0;
 
+    // Só concatena: vértices já transformados ficam no cache de cada instância.
     for (auto& inst : ctx->props)
     {
-        CachedModel* mdl = nullptr;
+        if (!UpdatePropWorldVerts(ctx, inst))
+            continue;
 
-        auto it = ctx->propCache.find(inst.modelName);
-        if (it == ctx->propCache.end())
-        {
-            rcMeshLoaderObj loader;
+        const CachedModel* mdl = GetOrLoadPropModel(ctx, inst.modelName);
+        if (!mdl)
+            continue;
 
-            if (!loader.tryLoadBIN(inst.modelName))
-            {
-                printf("[Geom] (Dynamic) Erro ao carregar %s\n", inst.modelName.c_str());
-                continue;
-            }
-
-            CachedModel temp;
-            temp.baseVerts.assign(loader.getVerts(),
-                                  loader.getVerts() + loader.getVertCount()*3);
-            temp.baseTris.assign(loader.getTris(),
-                                 loader.getTris() + loader.getTriCount()*3);
-
-            ctx->propCache[inst.modelName] = std::move(temp);
-            mdl = &ctx->propCache[inst.modelName];
-        }
-        else mdl = &it->second;
-
-        int vc = (int)mdl->baseVerts.size() / 3;
+        int vc = (int)inst.worldVerts.size() / 3;
         int tc = (int)mdl->baseTris.size() / 3;
 
-        // transformar vértices
-        for (int i = 0; i < vc; i++)
-        {
-            float x = mdl->baseVerts[i*3+0];
-            float y = mdl->baseVerts[i*3+1];
-            float z = mdl->baseVerts[i*3+2];
-
-            float xt, yt, zt;
-            TransformVertexZYX(x, y, z, inst.pos, inst.rot, xt, yt, zt);
+        ctx->dynamicVerts.insert(ctx->dynamicVerts.end(),
+                                 inst.worldVerts.begin(),
+                                 inst.worldVerts.end());
 
-            ctx->dynamicVerts.push_back(xt);
-            ctx->dynamicVerts.push_back(yt);
-            ctx->dynamicVerts.push_back(zt);
-
-            ExpandAABB(bmin, bmax, xt, yt, zt);
-        }
+        rcVmin(bmin, inst.worldBMin);
+        rcVmax(bmax, inst.worldBMax);
 
         for (int i = 0; i < tc; i++)
         {
@@ -192,125 +256,88 @@ bool GtaNavGeometry::BuildDynamicMergedData(NavMeshContext* ctx)
 }
 
 
-
 // ============================================================================
-//  UNIFICAR STATIC + DYNAMIC
+//  CAMADA DINÂMICA DO InputGeom
 // ============================================================================
-bool GtaNavGeometry::RebuildCombinedGeometry(NavMeshContext* ctx)
+bool GtaNavGeometry::RebuildDynamicLayer(NavMeshContext* ctx)
 {
     if (!ctx) return false;
 
-    const bool hasStatic  = ctx->staticBuilt && !ctx->staticVerts.empty();
-    const bool hasDynamic = !ctx->dynamicVerts.empty();
-
-    ctx->combinedVerts.clear();
-    ctx->combinedTris.clear();
-
-    if (hasStatic)
-    {
-        ctx->combinedVerts.insert(ctx->combinedVerts.end(),
-                                  ctx->staticVerts.begin(),
-                                  ctx->staticVerts.end());
-
-        ctx->combinedTris.insert(ctx->combinedTris.end(),
-                                 ctx->staticTris.begin(),
-                                 ctx->staticTris.end());
-    }
-
-    int staticVertCount = hasStatic ? (int)(ctx->staticVerts.size() / 3) : 0;
-
-    if (hasDynamic)
-    {
-        ctx->combinedVerts.insert(ctx->combinedVerts.end(),
-                                  ctx->dynamicVerts.begin(),
-                                  ctx->dynamicVerts.end());
-
-        for (int t : ctx->dynamicTris)
-            ctx->combinedTris.push_back(t + staticVertCount);
-    }
-
-    if (ctx->combinedVerts.empty() || ctx->combinedTris.empty())
-    {
-        printf("[Geom] RebuildCombinedGeometry: nenhuma geometria presente.\n");
+    if (!BuildDynamicMergedData(ctx))
         return false;
-    }
 
     if (!ctx->geom)
         ctx->geom = new InputGeom();
 
-    int totalVerts = (int)ctx->combinedVerts.size() / 3;
-    int totalTris  = (int)ctx->combinedTris.size() / 3;
-
-    bool ok = ctx->geom->initMeshFromArrays(
+    return ctx->geom->setDynamicMeshFromArrays(
         &ctx->buildCtx,
-        ctx->combinedVerts.data(),
-        totalVerts,
-        ctx->combinedTris.data(),
-        totalTris
-    );
-
-    printf("[Geom] RebuildCombinedGeometry -> %s  (verts=%d tris=%d)\n",
-           ok ? "OK" : "FAIL", totalVerts, totalTris);
-
-    return ok;
+        ctx->dynamicVerts.data(), (int)ctx->dynamicVerts.size() / 3,
+        ctx->dynamicTris.data(), (int)ctx->dynamicTris.size() / 3);
 }
 
 
 // ============================================================================
-//  SOMENTE DINÂMICO + (estático opcional)
+//  UNIFICAR STATIC + DYNAMIC
 // ============================================================================
-bool GtaNavGeometry::DynamicOnly_RebuildCombinedGeometry(NavMeshContext* ctx)
+// InputGeom guarda duas camadas (estático + props), cada uma com seu chunky.
+// O estático só é reenviado quando muda; mexer em props custa O(props).
+bool GtaNavGeometry::RebuildCombinedGeometry(NavMeshContext* ctx)
 {
     if (!ctx) return false;
 
     const bool hasStatic  = ctx->staticBuilt && !ctx->staticVerts.empty();
     const bool hasDynamic = !ctx->dynamicVerts.empty();
 
-    ctx->combinedVerts.clear();
-    ctx->combinedTris.clear();
-
-    int staticVertCount = 0;
-
-    if (hasStatic)
+    if (!hasStatic && !hasDynamic)
     {
-        ctx->combinedVerts.insert(ctx->combinedVerts.end(),
-                                  ctx->staticVerts.begin(),
-                                  ctx->staticVerts.end());
-
-        ctx->combinedTris.insert(ctx->combinedTris.end(),
-                                 ctx->staticTris.begin(),
-                                 ctx->staticTris.end());
-
-        staticVertCount = (int)(ctx->staticVerts.size() / 3);
+        printf("[Geom] RebuildCombinedGeometry: nenhuma geometria presente.\n");
+        return false;
     }
 
-    if (hasDynamic)
-    {
-        ctx->combinedVerts.insert(ctx->combinedVerts.end(),
-                                  ctx->dynamicVerts.begin(),
-                                  ctx->dynamicVerts.end());
+    if (!ctx->geom)
+        ctx->geom = new InputGeom();
 
-        for (int t : ctx->dynamicTris)
-            ctx->combinedTris.push_back(t + staticVertCount);
+    bool ok = true;
+    if (ctx->staticLayerDirty)
+    {
+        if (hasStatic)
+        {
+            ok = ctx->geom->initMeshFromArrays(
+                &ctx->buildCtx,
+                ctx->staticVerts.data(), (int)ctx->staticVerts.size() / 3,
+                ctx->staticTris.data(), (int)ctx->staticTris.size() / 3);
+        }
+        else
+        {
+            ctx->geom->clearMesh();
+        }
+        ctx->staticLayerDirty = !ok;
     }
 
-    if (ctx->combinedVerts.empty() || ctx->combinedTris.empty())
+    if (ok)
     {
-        printf("[Geom] DynamicOnly_RebuildCombinedGeometry: sem geometria.\n");
-        return false;
+        ok = ctx->geom->setDynamicMeshFromArrays(
+            &ctx->buildCtx,
+            ctx->dynamicVerts.data(), (int)ctx->dynamicVerts.size() / 3,
+            ctx->dynamicTris.data(), (int)ctx->dynamicTris.size() / 3);
     }
 
-    if (!ctx->geom)
-        ctx->geom = new InputGeom();
+    printf("[Geom] RebuildCombinedGeometry -> %s  (staticTris=%zu dynamicTris=%zu)\n",
+           ok ? "OK" : "FAIL", ctx->staticTris.size() / 3, ctx->dynamicTris.size() / 3);
 
-    int totalVerts = (int)ctx->combinedVerts.size() / 3;
-    int totalTris  = (int)ctx->combinedTris.size() / 3;
+    return ok;
+}
 
-    bool ok = ctx->geom->initMeshFromArrays(
-        &ctx->buildCtx,
-        ctx->combinedVerts.data(), totalVerts,
-        ctx->combinedTris.data(), totalTris);
 
+// ============================================================================
+//  SOMENTE DINÂMICO + (estático opcional)
+// ============================================================================
+bool GtaNavGeometry::DynamicOnly_RebuildCombinedGeometry(NavMeshContext* ctx)
+{
+    if (!ctx) return false;
+
+    // Com as camadas separadas, só a dinâmica é refeita (o estático só se estiver sujo).
+    const bool ok = RebuildCombinedGeometry(ctx);
     printf("[Geom] DynamicOnly_RebuildCombinedGeometry -> %s\n", ok ? "OK" : "FAIL");
     return ok;
 }
@@ -345,24 +372,21 @@ bool GtaNavGeometry::BuildTileGeometry(
 
     if (!ctx || !ctx->geom)
     {
-        std::printf("[GtaNavGeometry] BuildTileGeometry: ctx ou geom nulos.\n");
+        GTANAV_TRACE_MSG(GTANAV_TRACE_ERROR, "GtaNavGeometry", "BuildTileGeometry", "ctx ou geom nulos.");
         return false;
     }
 
     const rcMeshLoaderObj* mesh = ctx->geom->getMesh();
     const rcChunkyTriMesh* chunky = ctx->geom->getChunkyMesh();
+    const rcMeshLoaderObj* dynMesh = ctx->geom->getDynamicMesh();
+    const rcChunkyTriMesh* dynChunky = ctx->geom->getDynamicChunkyMesh();
 
-    if (!mesh || !chunky)
+    if ((!mesh || !chunky) && (!dynMesh || !dynChunky))
     {
-        std::printf("[GtaNavGeometry] BuildTileGeometry: mesh ou chunkyMesh nulos.\n");
+        GTANAV_TRACE_MSG(GTANAV_TRACE_ERROR, "GtaNavGeometry", "BuildTileGeometry", "mesh ou chunkyMesh nulos.");
         return false;
     }
 
-    const float* verts = mesh->getVerts();
-    const int    nverts = mesh->getVertCount();
-
-    (void)nverts; // só pra não dar warning se não usar
-
     // Projeção XZ do tile para consulta no ChunkyTriMesh
     float tbmin[2], tbmax[2];
     tbmin[0] = tileBMin[0];
@@ -370,65 +394,80 @@ bool GtaNavGeometry::BuildTileGeometry(
     tbmax[0] = tileBMax[0];
     tbmax[1] = tileBMax[2];
 
-    int cid[512];
-    const int ncid = rcGetChunksOverlappingRect(chunky, tbmin, tbmax, cid, 512);
-    if (!ncid)
-    {
-        // Sem triângulos nesse tile — é válido (tile vazio)
-        std::printf("[GtaNavGeometry] BuildTileGeometry: nenhum chunk encontrado para tile.\n");
-        return false;
-    }
-
     outVerts.reserve(1024);
     outTris.reserve(2048);
 
-    // Remap globalIndex -> localIndex
+    // Remap globalIndex -> localIndex (por camada)
     std::unordered_map<int,int> vertRemap;
     vertRemap.reserve(1024);
 
-    auto remapVertex = [&](int globalIndex) -> int
+    int ncid = 0;
+    auto appendLayer = [&](const rcMeshLoaderObj* layerMesh, const rcChunkyTriMesh* layerChunky)
     {
-        auto it = vertRemap.find(globalIndex);
-        if (it != vertRemap.end())
-            return it->second;
+        if (!layerMesh || !layerChunky)
+            return;
 
-        int newIndex = static_cast<int>(outVerts.size() / 3);
+        int cid[512];
+        const int layerNcid = rcGetChunksOverlappingRect(layerChunky, tbmin, tbmax, cid, 512);
+        if (!layerNcid)
+            return;
+        ncid += layerNcid;
 
-        const float* v = &verts[globalIndex * 3];
-        outVerts.push_back(v[0]);
-        outVerts.push_back(v[1]);
-        outVerts.push_back(v[2]);
+        const float* verts = layerMesh->getVerts();
+        vertRemap.clear();
 
-        vertRemap[globalIndex] = newIndex;
-        return newIndex;
-    };
+        auto remapVertex = [&](int globalIndex) -> int
+        {
+            auto it = vertRemap.find(globalIndex);
+            if (it != vertRemap.end())
+                return it->second;
 
-    // Percorre cada chunk que intersecta o tile
-    for (int i = 0; i < ncid; ++i)
-    {
-        const rcChunkyTriMeshNode& node = chunky->nodes[cid[i]];
-        const int* ctris = &chunky->tris[node.i * 3];
-        const int nctris = node.n;
+            int newIndex = static_cast<int>(outVerts.size() / 3);
 
-        for (int t = 0; t < nctris; ++t)
+            const float* v = &verts[globalIndex * 3];
+            outVerts.push_back(v[0]);
+            outVerts.push_back(v[1]);
+            outVerts.push_back(v[2]);
+
+            vertRemap[globalIndex] = newIndex;
+            return newIndex;
+        };
+
+        // Percorre cada chunk que intersecta o tile
+        for (int i = 0; i < layerNcid; ++i)
         {
-            const int ga = ctris[t*3 + 0];
-            const int gb = ctris[t*3 + 1];
-            const int gc = ctris[t*3 + 2];
-
-            // Remap para índices locais
-            const int la = remapVertex(ga);
-            const int lb = remapVertex(gb);
-            const int lc = remapVertex(gc);
-
-            outTris.push_back(la);
-            outTris.push_back(lb);
-            outTris.push_back(lc);
+            const rcChunkyTriMeshNode& node = layerChunky->nodes[cid[i]];
+            const int* ctris = &layerChunky->tris[node.i * 3];
+            const int nctris = node.n;
+
+            for (int t = 0; t < nctris; ++t)
+            {
+                // Remap para índices locais
+                const int la = remapVertex(ctris[t*3 + 0]);
+                const int lb = remapVertex(ctris[t*3 + 1]);
+                const int lc = remapVertex(ctris[t*3 + 2]);
+
+                outTris.push_back(la);
+                outTris.push_back(lb);
+                outTris.push_back(lc);
+            }
         }
+    };
+
+    appendLayer(mesh, chunky);
+    appendLayer(dynMesh, dynChunky);
+
+    if (!ncid)
+    {
+        // Sem triângulos nesse tile — é válido (tile vazio)
+        GTANAV_TRACE_MSG(GTANAV_TRACE_DEBUG, "GtaNavGeometry", "BuildTileGeometry", "nenhum chunk encontrado para tile.");
+        return false;
     }
 
-    std::printf("[GtaNavGeometry] BuildTileGeometry OK. Verts=%zu Tris=%zu\n",
-        outVerts.size() / 3, outTris.size() / 3);
+    GTANAV_TRACE(GTANAV_TRACE_DEBUG, "GtaNavGeometry", "BuildTileGeometry", nullptr,
+                 {"chunks", ncid},
+                 {"verts", outVerts.size() / 3},
+                 {"tris", outTris.size() / 3});
 
     return !outTris.empty();
 }
\ No newline at end of file
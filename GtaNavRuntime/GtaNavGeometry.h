@@ -17,6 +17,19 @@ public:
     // --- dinâmico ---
     static bool BuildDynamicMergedData(NavMeshContext* ctx);
 
+    // Recalcula o cache world-space de um prop (no-op se o transform não mudou).
+    static bool UpdatePropWorldVerts(NavMeshContext* ctx, PropInstance& inst);
+
+    // Move um prop: O(tamanho do prop). Os tiles sujos saem de
+    // GtaNavTiles::MarkDirtyTilesForProp (AABB antigo e novo separados).
+    static bool SetPropTransform(NavMeshContext* ctx,
+                                 int propID,
+                                 const float pos[3],
+                                 const float rot[3]);
+
+    // Reenvia só a camada dinâmica (props) para o InputGeom.
+    static bool RebuildDynamicLayer(NavMeshContext* ctx);
+
     // --- unificação estático + dinâmico ---
     static bool RebuildCombinedGeometry(NavMeshContext* ctx);
 
@@ -35,4 +48,5 @@ public:
 
 private:
     static void ExpandAABB(float* bmin, float* bmax, float x, float y, float z);
+    static CachedModel* GetOrLoadPropModel(NavMeshContext* ctx, const std::string& modelName);
 };
@@ -0,0 +1,248 @@
+#include "GtaNavProfile.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Perfil global: só recebe fetch_add relaxed (merge de contextos/threads).
+    struct GlobalProfile
+    {
+        std::atomic<int64_t> timerNs[RC_MAX_TIMERS];
+        std::atomic<int64_t> timerCalls[RC_MAX_TIMERS];
+        std::atomic<int64_t> counterNs[GTANAV_PROF_MAX_COUNTERS];
+        std::atomic<int64_t> counterCalls[GTANAV_PROF_MAX_COUNTERS];
+        std::atomic<int64_t> counterBytes[GTANAV_PROF_MAX_COUNTERS];
+    };
+
+    GlobalProfile g_profile{};
+    std::atomic<bool> g_enabled{true};
+
+    int64_t ElapsedNs(const std::chrono::steady_clock::time_point& start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Mesma ordem/labels de duLogBuildTimes (DebugUtils/Source/RecastDump.cpp).
+    struct StageLabel
+    {
+        rcTimerLabel label;
+        const char*  name;
+        const char*  key;
+        int          depth;
+    };
+
+    const StageLabel kStages[] =
+    {
+        { RC_TIMER_RASTERIZE_TRIANGLES,      "Rasterize",               "rasterize",              0 },
+        { RC_TIMER_BUILD_COMPACTHEIGHTFIELD, "Build Compact",           "buildCompact",           0 },
+        { RC_TIMER_FILTER_BORDER,            "Filter Border",           "filterBorder",           0 },
+        { RC_TIMER_FILTER_WALKABLE,          "Filter Walkable",         "filterWalkable",         0 },
+        { RC_TIMER_ERODE_AREA,               "Erode Area",              "erodeArea",              0 },
+        { RC_TIMER_MEDIAN_AREA,              "Median Area",             "medianArea",             0 },
+        { RC_TIMER_MARK_BOX_AREA,            "Mark Box Area",           "markBoxArea",            0 },
+        { RC_TIMER_MARK_CONVEXPOLY_AREA,     "Mark Convex Area",        "markConvexArea",         0 },
+        { RC_TIMER_MARK_CYLINDER_AREA,       "Mark Cylinder Area",      "markCylinderArea",       0 },
+        { RC_TIMER_BUILD_DISTANCEFIELD,      "Build Distance Field",    "buildDistanceField",     0 },
+        { RC_TIMER_BUILD_DISTANCEFIELD_DIST, "Distance",                "distanceFieldDist",      1 },
+        { RC_TIMER_BUILD_DISTANCEFIELD_BLUR, "Blur",                    "distanceFieldBlur",      1 },
+        { RC_TIMER_BUILD_REGIONS,            "Build Regions",           "buildRegions",           0 },
+        { RC_TIMER_BUILD_REGIONS_WATERSHED,  "Watershed",               "regionsWatershed",       1 },
+        { RC_TIMER_BUILD_REGIONS_EXPAND,     "Expand",                  "regionsExpand",          2 },
+        { RC_TIMER_BUILD_REGIONS_FLOOD,      "Find Basins",             "regionsFlood",           2 },
+        { RC_TIMER_BUILD_REGIONS_FILTER,     "Filter",                  "regionsFilter",          1 },
+        { RC_TIMER_BUILD_LAYERS,             "Build Layers",            "buildLayers",            0 },
+        { RC_TIMER_BUILD_CONTOURS,           "Build Contours",          "buildContours",          0 },
+        { RC_TIMER_BUILD_CONTOURS_TRACE,     "Trace",                   "contoursTrace",          1 },
+        { RC_TIMER_BUILD_CONTOURS_SIMPLIFY,  "Simplify",                "contoursSimplify",       1 },
+        { RC_TIMER_BUILD_POLYMESH,           "Build Polymesh",          "buildPolymesh",          0 },
+        { RC_TIMER_BUILD_POLYMESHDETAIL,     "Build Polymesh Detail",   "buildPolymeshDetail",    0 },
+        { RC_TIMER_MERGE_POLYMESH,           "Merge Polymeshes",        "mergePolymesh",          0 },
+        { RC_TIMER_MERGE_POLYMESHDETAIL,     "Merge Polymesh Details",  "mergePolymeshDetail",    0 },
+    };
+
+    void AppendFormat(std::string& out, const char* fmt, ...)
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, fmt);
+        const int n = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        if (n > 0)
+            out.append(buf, static_cast<size_t>(n < (int)sizeof(buf) ? n : (int)sizeof(buf) - 1));
+    }
+}
+
+// ======================================================================
+// GtaNavProfilingContext
+// ======================================================================
+GtaNavProfilingContext::GtaNavProfilingContext()
+    : rcContext(true)
+{
+    memset(m_accumNs, 0, sizeof(m_accumNs));
+}
+
+GtaNavProfilingContext::~GtaNavProfilingContext()
+{
+    flushProfile();
+}
+
+void GtaNavProfilingContext::flushProfile()
+{
+    for (int i = 0; i < RC_MAX_TIMERS; ++i)
+    {
+        if (m_pending.timerCalls[i] == 0)
+            continue;
+        g_profile.timerNs[i].fetch_add(m_pending.timerNs[i], std::memory_order_relaxed);
+        g_profile.timerCalls[i].fetch_add(m_pending.timerCalls[i], std::memory_order_relaxed);
+    }
+    m_pending = GtaNavBuildProfile{};
+}
+
+void GtaNavProfilingContext::doResetTimers()
+{
+    memset(m_accumNs, 0, sizeof(m_accumNs));
+}
+
+void GtaNavProfilingContext::doStartTimer(const rcTimerLabel label)
+{
+    m_start[label] = std::chrono::steady_clock::now();
+}
+
+void GtaNavProfilingContext::doStopTimer(const rcTimerLabel label)
+{
+    const int64_t ns = ElapsedNs(m_start[label]);
+    m_accumNs[label] += ns;
+    if (!g_enabled.load(std::memory_order_relaxed))
+        return;
+    m_pending.timerNs[label] += ns;
+    m_pending.timerCalls[label] += 1;
+}
+
+int GtaNavProfilingContext::doGetAccumulatedTime(const rcTimerLabel label) const
+{
+    return static_cast<int>(m_accumNs[label] / 1000);
+}
+
+// ======================================================================
+// GtaNavProfileScope
+// ======================================================================
+GtaNavProfileScope::GtaNavProfileScope(GtaNavProfileCounter counter, int64_t bytes)
+    : m_counter(counter)
+    , m_bytes(bytes)
+    , m_active(g_enabled.load(std::memory_order_relaxed))
+{
+    if (m_active)
+        m_start = std::chrono::steady_clock::now();
+}
+
+GtaNavProfileScope::~GtaNavProfileScope()
+{
+    if (!m_active)
+        return;
+    g_profile.counterNs[m_counter].fetch_add(ElapsedNs(m_start), std::memory_order_relaxed);
+    g_profile.counterCalls[m_counter].fetch_add(1, std::memory_order_relaxed);
+    if (m_bytes != 0)
+        g_profile.counterBytes[m_counter].fetch_add(m_bytes, std::memory_order_relaxed);
+}
+
+// ======================================================================
+// Perfil global
+// ======================================================================
+void GtaNavProfile_SetEnabled(bool enabled)
+{
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool GtaNavProfile_IsEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void GtaNavProfile_GetSnapshot(GtaNavBuildProfile& out)
+{
+    for (int i = 0; i < RC_MAX_TIMERS; ++i)
+    {
+        out.timerNs[i] = g_profile.timerNs[i].load(std::memory_order_relaxed);
+        out.timerCalls[i] = g_profile.timerCalls[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < GTANAV_PROF_MAX_COUNTERS; ++i)
+    {
+        out.counterNs[i] = g_profile.counterNs[i].load(std::memory_order_relaxed);
+        out.counterCalls[i] = g_profile.counterCalls[i].load(std::memory_order_relaxed);
+        out.counterBytes[i] = g_profile.counterBytes[i].load(std::memory_order_relaxed);
+    }
+}
+
+void GtaNavProfile_Reset()
+{
+    for (int i = 0; i < RC_MAX_TIMERS; ++i)
+    {
+        g_profile.timerNs[i].store(0, std::memory_order_relaxed);
+        g_profile.timerCalls[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < GTANAV_PROF_MAX_COUNTERS; ++i)
+    {
+        g_profile.counterNs[i].store(0, std::memory_order_relaxed);
+        g_profile.counterCalls[i].store(0, std::memory_order_relaxed);
+        g_profile.counterBytes[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* GtaNavProfile_CounterName(GtaNavProfileCounter counter)
+{
+    switch (counter)
+    {
+    case GTANAV_PROF_GATHER:        return "gather";
+    case GTANAV_PROF_DETOUR_CREATE: return "detourCreate";
+    case GTANAV_PROF_ADD_TILE:      return "addTile";
+    case GTANAV_PROF_CACHE_READ:    return "cacheRead";
+    case GTANAV_PROF_CACHE_WRITE:   return "cacheWrite";
+    default: break;
+    }
+    return "unknown";
+}
+
+std::string GtaNavProfile_ToJson(const GtaNavBuildProfile& profile)
+{
+    // Total segue duLogBuildTimes: RC_TIMER_TOTAL (pipeline Recast por tile).
+    const double totalMs = profile.timerNs[RC_TIMER_TOTAL] / 1.0e6;
+    const double pc = totalMs > 0.0 ? 100.0 / totalMs : 0.0;
+
+    std::string out;
+    out.reserve(4096);
+    out += "{\n  \"version\": 1,\n";
+    AppendFormat(out, "  \"totalMs\": %.3f,\n", totalMs);
+    AppendFormat(out, "  \"tiles\": %lld,\n", static_cast<long long>(profile.timerCalls[RC_TIMER_TOTAL]));
+
+    out += "  \"stages\": [\n";
+    const int stageCount = static_cast<int>(sizeof(kStages) / sizeof(kStages[0]));
+    for (int i = 0; i < stageCount; ++i)
+    {
+        const StageLabel& s = kStages[i];
+        const double ms = profile.timerNs[s.label] / 1.0e6;
+        AppendFormat(out,
+                     "    {\"key\": \"%s\", \"label\": \"%s\", \"depth\": %d, \"ms\": %.3f, \"calls\": %lld, \"pct\": %.2f}%s\n",
+                     s.key, s.name, s.depth, ms,
+                     static_cast<long long>(profile.timerCalls[s.label]),
+                     ms * pc,
+                     (i + 1 < stageCount) ? "," : "");
+    }
+    out += "  ],\n";
+
+    out += "  \"counters\": {\n";
+    for (int i = 0; i < GTANAV_PROF_MAX_COUNTERS; ++i)
+    {
+        AppendFormat(out,
+                     "    \"%s\": {\"ms\": %.3f, \"calls\": %lld, \"bytes\": %lld}%s\n",
+                     GtaNavProfile_CounterName(static_cast<GtaNavProfileCounter>(i)),
+                     profile.counterNs[i] / 1.0e6,
+                     static_cast<long long>(profile.counterCalls[i]),
+                     static_cast<long long>(profile.counterBytes[i]),
+                     (i + 1 < GTANAV_PROF_MAX_COUNTERS) ? "," : "");
+    }
+    out += "  }\n}\n";
+    return out;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+#include "Recast.h"
+
+// ======================================================================
+// Profiler de build por estágio.
+//
+// Os estágios do Recast (RC_TIMER_*) são coletados por GtaNavProfilingContext.
+// Etapas fora do Recast (montagem de geometria, dtCreateNavMeshData, addTile,
+// I/O de cache) usam GtaNavProfileScope.
+//
+// Cada contexto (um por thread de build) acumula localmente; o merge no perfil
+// global acontece em flushProfile() (ou no destrutor) via contadores atômicos.
+// ======================================================================
+
+enum GtaNavProfileCounter
+{
+    GTANAV_PROF_GATHER = 0,      // recorte/montagem da geometria do tile
+    GTANAV_PROF_DETOUR_CREATE,   // dtCreateNavMeshData
+    GTANAV_PROF_ADD_TILE,        // dtNavMesh::addTile
+    GTANAV_PROF_CACHE_READ,      // leitura de tiles do cache (TileDB / GridDB)
+    GTANAV_PROF_CACHE_WRITE,     // escrita de tiles no cache
+    GTANAV_PROF_MAX_COUNTERS
+};
+
+struct GtaNavBuildProfile
+{
+    int64_t timerNs[RC_MAX_TIMERS];
+    int64_t timerCalls[RC_MAX_TIMERS];
+    int64_t counterNs[GTANAV_PROF_MAX_COUNTERS];
+    int64_t counterCalls[GTANAV_PROF_MAX_COUNTERS];
+    int64_t counterBytes[GTANAV_PROF_MAX_COUNTERS];
+};
+
+class GtaNavProfilingContext : public rcContext
+{
+public:
+    GtaNavProfilingContext();
+    ~GtaNavProfilingContext() override;
+
+    // Envia o que foi acumulado desde o último flush para o perfil global.
+    void flushProfile();
+
+protected:
+    void doResetTimers() override;
+    void doStartTimer(const rcTimerLabel label) override;
+    void doStopTimer(const rcTimerLabel label) override;
+    int  doGetAccumulatedTime(const rcTimerLabel label) const override;
+
+private:
+    std::chrono::steady_clock::time_point m_start[RC_MAX_TIMERS];
+    int64_t            m_accumNs[RC_MAX_TIMERS]; // desde o último resetTimers (duLogBuildTimes)
+    GtaNavBuildProfile m_pending{};              // desde o último flush
+
+    GtaNavProfilingContext(const GtaNavProfilingContext&) = delete;
+    GtaNavProfilingContext& operator=(const GtaNavProfilingContext&) = delete;
+};
+
+class GtaNavProfileScope
+{
+public:
+    explicit GtaNavProfileScope(GtaNavProfileCounter counter, int64_t bytes = 0);
+    ~GtaNavProfileScope();
+
+    void addBytes(int64_t bytes) { m_bytes += bytes; }
+
+private:
+    GtaNavProfileCounter                  m_counter;
+    int64_t                               m_bytes;
+    bool                                  m_active;
+    std::chrono::steady_clock::time_point m_start;
+
+    GtaNavProfileScope(const GtaNavProfileScope&) = delete;
+    GtaNavProfileScope& operator=(const GtaNavProfileScope&) = delete;
+};
+
+// Liga/desliga a coleta em runtime (padrão: ligado).
+void GtaNavProfile_SetEnabled(bool enabled);
+bool GtaNavProfile_IsEnabled();
+
+// Snapshot do perfil global (contextos ainda vivos só entram após flushProfile()).
+void GtaNavProfile_GetSnapshot(GtaNavBuildProfile& out);
+void GtaNavProfile_Reset();
+
+// Nome do contador ("gather", "detourCreate", ...).
+const char* GtaNavProfile_CounterName(GtaNavProfileCounter counter);
+
+// JSON com os mesmos estágios/labels de duLogBuildTimes (RecastDump) + contadores.
+std::string GtaNavProfile_ToJson(const GtaNavBuildProfile& profile);
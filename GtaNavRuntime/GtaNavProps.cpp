@@ -1,4 +1,5 @@
 #include "GtaNavProps.h"
+#include "GtaNavTiles.h"
 #include <algorithm>
 #include <cstdio>
 #include "DetourCommon.h"
@@ -68,6 +69,7 @@ void GtaNavProps::ClearAllStatics(NavMeshContext* ctx, bool clearCache)
     ctx->staticTris.clear();
 
     ctx->staticBuilt = false;
+    ctx->staticLayerDirty = true;
 
     ctx->staticVerts.shrink_to_fit();
     ctx->staticTris.shrink_to_fit();
@@ -86,6 +88,16 @@ void GtaNavProps::ClearAllProps(NavMeshContext* ctx, bool clearCache)
 
     printf("[Props] Limpando PROPS dinâmicos (clearCache=%d)...\n", clearCache);
 
+    // Tiles onde os props já foram carvados precisam ser refeitos sem eles.
+    if (ctx->navMesh)
+    {
+        for (const PropInstance& inst : ctx->props)
+        {
+            if (inst.hasBuiltBounds)
+                GtaNavTiles::MarkDirtyTilesInAABB(ctx, inst.builtBMin, inst.builtBMax);
+        }
+    }
+
     ctx->props.clear();
     ctx->props.shrink_to_fit();
 
@@ -114,3 +126,12 @@ int GtaNavProps::GetPropCount(const NavMeshContext* ctx)
 {
     return ctx ? (int)ctx->props.size() : 0;
 }
+
+PropInstance* GtaNavProps::FindProp(NavMeshContext* ctx, int propID)
+{
+    if (!ctx) return nullptr;
+
+    auto it = std::find_if(ctx->props.begin(), ctx->props.end(),
+                           [propID](const PropInstance& p) { return p.id == propID; });
+    return it != ctx->props.end() ? &*it : nullptr;
+}
@@ -35,4 +35,5 @@ public:
     //
     static int GetStaticCount(const NavMeshContext* ctx);
     static int GetPropCount(const NavMeshContext* ctx);
+    static PropInstance* FindProp(NavMeshContext* ctx, int propID);
 };
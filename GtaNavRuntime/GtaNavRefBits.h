@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+
+#include "DetourCommon.h"
+#include "DetourNavMesh.h"
+
+// Divisão dos bits do dtPolyRef entre tile e poly.
+//
+// 32 bits: tile+poly dividem 22 bits (o Detour exige salt >= 10), então um grid
+// grande rouba bits dos polys e vice-versa.
+// 64 bits (RECASTNAVIGATION_DT_POLYREF64): larguras fixas do Detour
+// (DT_TILE_BITS/DT_POLY_BITS). maxTiles vira só a capacidade de tiles residentes:
+// o m_posLookup acha o tile pelo hash de (x,y), então o grid do mundo pode ser
+// bem maior que maxTiles sem reinicializar a navmesh.
+static constexpr unsigned int GTANAV_REF32_TILE_POLY_BITS = 22;
+
+struct GtaNavRefLayout
+{
+    int maxTiles = 0;
+    int maxPolys = 0;
+    unsigned int tileBits = 0;
+    unsigned int polyBits = 0;
+};
+
+inline constexpr bool GtaNav_UsesPolyRef64()
+{
+    return sizeof(dtPolyRef) == 8;
+}
+
+// Calcula maxTiles/maxPolys para o dtNavMeshParams.
+// 32 bits: polyBits = min(desejado, 22 - tileBits); falha se o grid consumir todos os bits.
+// 64 bits: só limita aos campos fixos do Detour.
+inline bool GtaNav_ComputeRefLayout(int maxTiles, unsigned int desiredMaxPolys, GtaNavRefLayout& out)
+{
+    out = GtaNavRefLayout{};
+    if (maxTiles <= 0)
+        return false;
+
+    out.tileBits = dtIlog2(dtNextPow2(static_cast<unsigned int>(maxTiles)));
+    const unsigned int desiredPolyBits = dtIlog2(dtNextPow2(std::max(1u, desiredMaxPolys)));
+
+#ifdef DT_POLYREF64
+    if (out.tileBits > DT_TILE_BITS)
+        return false;
+    const unsigned int maxPolyBitsAllowed = DT_POLY_BITS;
+#else
+    if (out.tileBits >= GTANAV_REF32_TILE_POLY_BITS)
+        return false;
+    const unsigned int maxPolyBitsAllowed = GTANAV_REF32_TILE_POLY_BITS - out.tileBits;
+#endif
+
+    out.polyBits = std::min(desiredPolyBits, maxPolyBitsAllowed);
+    out.maxTiles = maxTiles;
+    out.maxPolys = 1 << out.polyBits;
+    return true;
+}
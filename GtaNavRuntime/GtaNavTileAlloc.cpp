@@ -0,0 +1,439 @@
+#include "GtaNavTileAlloc.h"
+
+#include "DetourAlloc.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace
+{
+    constexpr size_t kMinBlockSize = 1024;
+    constexpr size_t kMaxBlockSize = 1024 * 1024;
+    constexpr int    kStepsPerDoubling = 4;           // desperdício interno <= 25%
+    constexpr size_t kMinPageBytes = 256 * 1024;
+    constexpr int    kMinBlocksPerPage = 4;
+
+    // Mapa endereço -> página em grânulos de 64 KB, em dois níveis como uma tabela de
+    // páginas. Páginas e blocos grandes são alinhados e arredondados ao grânulo, então um
+    // grânulo mapeado é inteiro nosso e o free acha a página sem lock.
+    constexpr int       kGranuleShift = 16;
+    constexpr size_t    kGranuleBytes = size_t(1) << kGranuleShift;
+    constexpr int       kAddressBits = sizeof(void*) == 8 ? 48 : 32;
+    constexpr int       kLeafBits = 16;
+    constexpr int       kRootBits = kAddressBits - kGranuleShift - kLeafBits;
+    constexpr uintptr_t kLeafMask = (uintptr_t(1) << kLeafBits) - 1;
+
+    size_t RoundToGranule(size_t bytes)
+    {
+        return (bytes + kGranuleBytes - 1) & ~(kGranuleBytes - 1);
+    }
+
+    struct SlabBlock
+    {
+        SlabBlock* next;
+    };
+
+    struct SlabPage
+    {
+        unsigned char* base = nullptr;
+        size_t         bytes = 0;
+        int            classIndex = 0;  // -1 = alocação grande (um bloco só, fora das classes)
+        uint32_t       blockCount = 0;
+        uint32_t       used = 0;
+        uint32_t       carved = 0;      // blocos já entregues ao menos uma vez (o resto nunca foi tocado)
+        SlabBlock*     freeList = nullptr;
+        SlabPage*      prev = nullptr;  // lista de páginas com espaço da classe
+        SlabPage*      next = nullptr;
+    };
+
+    struct SlabClass
+    {
+        std::mutex lock;                // uma por classe: threads de bake em tamanhos diferentes não disputam
+        size_t    blockSize = 0;
+        uint32_t  blocksPerPage = 0;
+        uint32_t  pageCount = 0;
+        uint32_t  blocksInUse = 0;
+        SlabPage* partial = nullptr;
+        SlabPage* spare = nullptr;      // uma página vazia guardada para não oscilar malloc/free
+    };
+
+    struct PageMapLeaf
+    {
+        std::atomic<SlabPage*> pages[size_t(1) << kLeafBits] = {};
+    };
+
+    struct SlabState
+    {
+        SlabClass classes[GTANAV_TILE_ALLOC_MAX_CLASSES];
+        int classCount = 0;
+        std::atomic<PageMapLeaf*> pageMap[size_t(1) << kRootBits] = {};
+        std::mutex pageMapLock;         // só para criar folhas do mapa
+        std::mutex largeLock;
+        uint32_t largeCount = 0;
+        std::atomic<uint64_t> bytesInUse{ 0 };
+        std::atomic<uint64_t> bytesReserved{ 0 };
+        std::atomic<uint64_t> peakBytesInUse{ 0 };
+        std::atomic<uint64_t> largeBytes{ 0 };
+        std::mutex installLock;
+        bool installed = false;
+
+        SlabState()
+        {
+            for (size_t base = kMinBlockSize; base < kMaxBlockSize; base *= 2)
+            {
+                for (int step = 0; step < kStepsPerDoubling; ++step)
+                    AddClass(base + step * (base / kStepsPerDoubling));
+            }
+            AddClass(kMaxBlockSize);
+        }
+
+        void AddClass(size_t blockSize)
+        {
+            SlabClass& c = classes[classCount++];
+            c.blockSize = blockSize;
+            const size_t pageBytes = RoundToGranule(std::max(kMinPageBytes, blockSize * kMinBlocksPerPage));
+            c.blocksPerPage = static_cast<uint32_t>(pageBytes / blockSize);
+        }
+    };
+
+    // Nunca destruído: tiles podem ser liberados depois dos destrutores estáticos.
+    SlabState& State()
+    {
+        static SlabState* state = new SlabState();
+        return *state;
+    }
+
+    void* GranuleAlloc(size_t bytes)
+    {
+#if defined(_WIN32)
+        return _aligned_malloc(bytes, kGranuleBytes);
+#else
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, kGranuleBytes, bytes) == 0 ? ptr : nullptr;
+#endif
+    }
+
+    void GranuleFree(void* ptr)
+    {
+#if defined(_WIN32)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+
+    void AddBytesInUse(SlabState& s, uint64_t bytes)
+    {
+        const uint64_t now = s.bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t peak = s.peakBytesInUse.load(std::memory_order_relaxed);
+        while (now > peak && !s.peakBytesInUse.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    bool InAddressRange(uintptr_t p)
+    {
+        return (static_cast<uint64_t>(p) >> kAddressBits) == 0;
+    }
+
+    // Grânulos de cada página só são escritos por quem criou/libera a página.
+    bool MapPage(SlabState& s, SlabPage* page, SlabPage* value)
+    {
+        const uintptr_t first = reinterpret_cast<uintptr_t>(page->base);
+        const uintptr_t last = first + page->bytes - 1;
+        if (!InAddressRange(last))
+            return false;
+        for (uintptr_t g = first >> kGranuleShift; g <= (last >> kGranuleShift); ++g)
+        {
+            std::atomic<PageMapLeaf*>& root = s.pageMap[g >> kLeafBits];
+            PageMapLeaf* leaf = root.load(std::memory_order_acquire);
+            if (!leaf)
+            {
+                std::lock_guard<std::mutex> guard(s.pageMapLock);
+                leaf = root.load(std::memory_order_relaxed);
+                if (!leaf)
+                {
+                    leaf = new PageMapLeaf();
+                    root.store(leaf, std::memory_order_release);
+                }
+            }
+            leaf->pages[g & kLeafMask].store(value, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Sem lock: um ponteiro vivo não pode ter a página liberada enquanto está sendo solto.
+    SlabPage* FindPage(SlabState& s, void* ptr)
+    {
+        const uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+        if (!InAddressRange(p))
+            return nullptr;
+        const uintptr_t g = p >> kGranuleShift;
+        const PageMapLeaf* leaf = s.pageMap[g >> kLeafBits].load(std::memory_order_acquire);
+        if (!leaf)
+            return nullptr;
+        SlabPage* page = leaf->pages[g & kLeafMask].load(std::memory_order_acquire);
+        if (!page)
+            return nullptr;
+        const uintptr_t base = reinterpret_cast<uintptr_t>(page->base);
+        return p >= base && p < base + page->bytes ? page : nullptr;
+    }
+
+    int FindClass(const SlabState& s, size_t size)
+    {
+        int lo = 0;
+        int hi = s.classCount - 1;
+        while (lo < hi)
+        {
+            const int mid = (lo + hi) / 2;
+            if (s.classes[mid].blockSize < size)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    void UnlinkPartial(SlabClass& c, SlabPage* page)
+    {
+        if (page->prev) page->prev->next = page->next;
+        else c.partial = page->next;
+        if (page->next) page->next->prev = page->prev;
+        page->prev = page->next = nullptr;
+    }
+
+    void LinkPartial(SlabClass& c, SlabPage* page)
+    {
+        page->prev = nullptr;
+        page->next = c.partial;
+        if (c.partial) c.partial->prev = page;
+        c.partial = page;
+    }
+
+    void ReleasePage(SlabState& s, SlabClass& c, SlabPage* page)
+    {
+        MapPage(s, page, nullptr);
+        s.bytesReserved.fetch_sub(page->bytes, std::memory_order_relaxed);
+        --c.pageCount;
+        GranuleFree(page->base);
+        delete page;
+    }
+
+    SlabPage* NewPage(SlabState& s, int classIndex)
+    {
+        SlabClass& c = s.classes[classIndex];
+        const size_t bytes = RoundToGranule(c.blockSize * c.blocksPerPage);
+        unsigned char* base = static_cast<unsigned char*>(GranuleAlloc(bytes));
+        if (!base)
+            return nullptr;
+        SlabPage* page = new SlabPage();
+        page->base = base;
+        page->bytes = bytes;
+        page->classIndex = classIndex;
+        page->blockCount = c.blocksPerPage;
+        if (!MapPage(s, page, page))
+        {
+            GranuleFree(base);
+            delete page;
+            return nullptr;
+        }
+        s.bytesReserved.fetch_add(bytes, std::memory_order_relaxed);
+        ++c.pageCount;
+        return page;
+    }
+
+    void* SlabAlloc(SlabState& s, int classIndex)
+    {
+        SlabClass& c = s.classes[classIndex];
+        std::lock_guard<std::mutex> guard(c.lock);
+        SlabPage* page = c.partial;
+        if (!page)
+        {
+            page = c.spare;
+            c.spare = nullptr;
+            if (!page)
+                page = NewPage(s, classIndex);
+            if (!page)
+                return nullptr;
+            LinkPartial(c, page);
+        }
+
+        void* ptr;
+        if (page->freeList)
+        {
+            ptr = page->freeList;
+            page->freeList = page->freeList->next;
+        }
+        else
+        {
+            ptr = page->base + static_cast<size_t>(page->carved) * c.blockSize;
+            ++page->carved;
+        }
+
+        if (++page->used == page->blockCount)
+            UnlinkPartial(c, page);
+        ++c.blocksInUse;
+        AddBytesInUse(s, c.blockSize);
+        return ptr;
+    }
+
+    void SlabFree(SlabState& s, SlabPage* page, void* ptr)
+    {
+        SlabClass& c = s.classes[page->classIndex];
+        std::lock_guard<std::mutex> guard(c.lock);
+        const bool wasFull = page->used == page->blockCount;
+        SlabBlock* block = static_cast<SlabBlock*>(ptr);
+        block->next = page->freeList;
+        page->freeList = block;
+        --page->used;
+        --c.blocksInUse;
+        s.bytesInUse.fetch_sub(c.blockSize, std::memory_order_relaxed);
+
+        if (wasFull)
+            LinkPartial(c, page);
+        if (page->used > 0)
+            return;
+
+        // Página vazia: guarda uma como reserva, devolve o resto.
+        UnlinkPartial(c, page);
+        page->freeList = nullptr;
+        page->carved = 0;
+        if (!c.spare)
+            c.spare = page;
+        else
+            ReleasePage(s, c, page);
+    }
+
+    // Maiores que 1 MB: bloco próprio, mas registrado no mapa para o free achar sem lock.
+    void* LargeAlloc(SlabState& s, size_t requested)
+    {
+        const size_t size = RoundToGranule(requested);
+        unsigned char* base = static_cast<unsigned char*>(GranuleAlloc(size));
+        if (!base)
+            return nullptr;
+        SlabPage* page = new SlabPage();
+        page->base = base;
+        page->bytes = size;
+        page->classIndex = -1;
+        if (!MapPage(s, page, page))
+        {
+            GranuleFree(base);
+            delete page;
+            return nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> guard(s.largeLock);
+            ++s.largeCount;
+        }
+        s.largeBytes.fetch_add(size, std::memory_order_relaxed);
+        s.bytesReserved.fetch_add(size, std::memory_order_relaxed);
+        AddBytesInUse(s, size);
+        return base;
+    }
+
+    void LargeFree(SlabState& s, SlabPage* page)
+    {
+        MapPage(s, page, nullptr);
+        {
+            std::lock_guard<std::mutex> guard(s.largeLock);
+            --s.largeCount;
+        }
+        s.largeBytes.fetch_sub(page->bytes, std::memory_order_relaxed);
+        s.bytesReserved.fetch_sub(page->bytes, std::memory_order_relaxed);
+        s.bytesInUse.fetch_sub(page->bytes, std::memory_order_relaxed);
+        GranuleFree(page->base);
+        delete page;
+    }
+
+    void* TileAlloc(size_t size, dtAllocHint hint)
+    {
+        if (hint != DT_ALLOC_PERM || size < kMinBlockSize)
+            return malloc(size);
+
+        SlabState& s = State();
+        if (size > kMaxBlockSize)
+            return LargeAlloc(s, size);
+        return SlabAlloc(s, FindClass(s, size));
+    }
+
+    void TileFree(void* ptr)
+    {
+        if (!ptr)
+            return;
+        SlabState& s = State();
+        SlabPage* page = FindPage(s, ptr);
+        if (!page)
+        {
+            // Temporários, pequenos e ponteiros de antes do install: direto para o free.
+            free(ptr);
+            return;
+        }
+        if (page->classIndex < 0)
+            LargeFree(s, page);
+        else
+            SlabFree(s, page, ptr);
+    }
+}
+
+void GtaNavTileAlloc_Install()
+{
+    SlabState& s = State();
+    std::lock_guard<std::mutex> guard(s.installLock);
+    if (s.installed)
+        return;
+    dtAllocSetCustom(TileAlloc, TileFree);
+    s.installed = true;
+}
+
+bool GtaNavTileAlloc_IsInstalled()
+{
+    SlabState& s = State();
+    std::lock_guard<std::mutex> guard(s.installLock);
+    return s.installed;
+}
+
+void GtaNavTileAlloc_GetStats(GtaNavTileAllocStats& out)
+{
+    out = GtaNavTileAllocStats{};
+    SlabState& s = State();
+    out.classCount = s.classCount;
+    for (int i = 0; i < s.classCount; ++i)
+    {
+        SlabClass& c = s.classes[i];
+        std::lock_guard<std::mutex> guard(c.lock);
+        GtaNavTileAllocClassStats& cs = out.classes[i];
+        cs.blockSize = static_cast<uint32_t>(c.blockSize);
+        cs.pageCount = c.pageCount;
+        cs.blocksInUse = c.blocksInUse;
+        cs.blocksFree = c.pageCount * c.blocksPerPage - c.blocksInUse;
+    }
+    {
+        std::lock_guard<std::mutex> guard(s.largeLock);
+        out.largeCount = s.largeCount;
+    }
+    out.bytesInUse = s.bytesInUse.load(std::memory_order_relaxed);
+    out.bytesReserved = s.bytesReserved.load(std::memory_order_relaxed);
+    out.peakBytesInUse = s.peakBytesInUse.load(std::memory_order_relaxed);
+    out.largeBytes = s.largeBytes.load(std::memory_order_relaxed);
+}
+
+void GtaNavTileAlloc_Trim()
+{
+    SlabState& s = State();
+    for (int i = 0; i < s.classCount; ++i)
+    {
+        SlabClass& c = s.classes[i];
+        std::lock_guard<std::mutex> guard(c.lock);
+        if (c.spare)
+        {
+            ReleasePage(s, c, c.spare);
+            c.spare = nullptr;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+// ======================================================================
+// Alocador por classes de tamanho (slabs) para os blobs de tile do Detour.
+//
+// Instalado via dtAllocSetCustom. Blocos DT_ALLOC_PERM entre 1 KB e 1 MB
+// (dados de tile do TileDB/GridDB e do dtCreateNavMeshData) saem de páginas
+// de uma classe só, então carregar/descarregar tiles o jogo inteiro reaproveita
+// os mesmos blocos em vez de picotar o heap. O resto (temporários, pequenos,
+// maiores que 1 MB) cai no malloc; os maiores entram nas estatísticas.
+//
+// Instalar antes de criar qualquer dtNavMesh. Ponteiros que não são do slab
+// (inclusive os alocados antes do install) vão para free(), então a ordem
+// não quebra nada, só deixa esses blocos fora das estatísticas.
+// ======================================================================
+
+static constexpr int GTANAV_TILE_ALLOC_MAX_CLASSES = 48;
+
+struct GtaNavTileAllocClassStats
+{
+    uint32_t blockSize = 0;
+    uint32_t pageCount = 0;
+    uint32_t blocksInUse = 0;
+    uint32_t blocksFree = 0;
+};
+
+struct GtaNavTileAllocStats
+{
+    uint64_t bytesInUse = 0;       // blocos de slab entregues + alocações grandes
+    uint64_t bytesReserved = 0;    // páginas de slab + alocações grandes
+    uint64_t peakBytesInUse = 0;
+    uint64_t largeBytes = 0;
+    uint32_t largeCount = 0;
+    int32_t  classCount = 0;
+    GtaNavTileAllocClassStats classes[GTANAV_TILE_ALLOC_MAX_CLASSES];
+};
+
+// Idempotente; nunca desinstala (blocos vivos do slab não podem ir para free()).
+void GtaNavTileAlloc_Install();
+bool GtaNavTileAlloc_IsInstalled();
+
+void GtaNavTileAlloc_GetStats(GtaNavTileAllocStats& out);
+
+// Devolve ao sistema as páginas vazias guardadas como reserva.
+void GtaNavTileAlloc_Trim();
@@ -3,6 +3,8 @@
 // ======================================================================
 
 #include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cmath>
 #include <cstring>
@@ -11,6 +13,8 @@
 #include "GtaNavContext.h"
 #include "GtaNavGeometry.h"
 #include "InputGeom.h"
+#include "GtaNavProfile.h"
+#include "GtaNavTrace.h"
 
 #include "Recast.h"
 #include "DetourNavMesh.h"
@@ -18,6 +22,15 @@
 #include "DetourCommon.h"
 #include "DetourNavMeshBuilder.h"
 
+namespace
+{
+    // Tile confirmado vazio pelo build: só então o antigo sai do navMesh.
+    void RemoveTileIfPresent(NavMeshContext* ctx, int tx, int tz)
+    {
+        if (dtTileRef oldRef = ctx->navMesh->getTileRefAt(tx, tz, 0))
+            ctx->navMesh->removeTile(oldRef, nullptr, nullptr);
+    }
+}
 
 // =======================================================================
 // CALCULATE TILE BOUNDS
@@ -94,22 +107,23 @@ bool GtaNavTiles::BuildTile(
         return false;
     }
 
-    // Remove tile antigo se existir
-    if (dtTileRef oldRef = ctx->navMesh->getTileRefAt(tx, tz, 0))
-        ctx->navMesh->removeTile(oldRef, nullptr, nullptr);
+    // O tile antigo continua no navMesh durante o build (queries seguem
+    // funcionando) e só é trocado no final; falhas mantêm o tile antigo.
 
     // 1) Obter geometria recortada
     std::vector<float> verts;
     std::vector<int>   tris;
 
-    if (!GtaNavGeometry::BuildTileGeometry(
-            ctx,
-            tileBMin,
-            tileBMax,
-            verts,
-            tris))
+    bool hasGeom = false;
+    {
+        GtaNavProfileScope gatherScope(GTANAV_PROF_GATHER);
+        hasGeom = GtaNavGeometry::BuildTileGeometry(ctx, tileBMin, tileBMax, verts, tris);
+    }
+    if (!hasGeom)
     {
         // Sem geometria → tile vazio (ok)
+        if (rebuildDetourData)
+            RemoveTileIfPresent(ctx, tx, tz);
         return true;
     }
 
@@ -117,7 +131,11 @@ bool GtaNavTiles::BuildTile(
     int ntris  = (int)tris.size() / 3;
 
     if (nverts == 0 || ntris == 0)
+    {
+        if (rebuildDetourData)
+            RemoveTileIfPresent(ctx, tx, tz);
         return true;
+    }
 
     // =====================================================================
     // 2) CONFIG RECAST
@@ -160,7 +178,8 @@ bool GtaNavTiles::BuildTile(
     // =====================================================================
     // 3) FULL RECAST PIPELINE
     // =====================================================================
-    rcContext& bc = ctx->buildCtx;
+    GtaNavProfilingContext& bc = ctx->buildCtx;
+    rcScopedTimer totalTimer(&bc, RC_TIMER_TOTAL);
 
     // Heightfield
     rcHeightfield* solid = rcAllocHeightfield();
@@ -292,6 +311,8 @@ bool GtaNavTiles::BuildTile(
     {
         rcFreePolyMeshDetail(dmesh);
         rcFreePolyMesh(pmesh);
+        if (rebuildDetourData)
+            RemoveTileIfPresent(ctx, tx, tz);
         return true;
     }
 
@@ -332,7 +353,12 @@ bool GtaNavTiles::BuildTile(
     unsigned char* navData = nullptr;
     int navDataSize = 0;
 
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
+    bool created = false;
+    {
+        GtaNavProfileScope createScope(GTANAV_PROF_DETOUR_CREATE);
+        created = dtCreateNavMeshData(&params, &navData, &navDataSize);
+    }
+    if (!created)
     {
         printf("[Tiles] dtCreateNavMeshData falhou no tile %d,%d\n", tx, tz);
         rcFreePolyMeshDetail(dmesh);
@@ -349,12 +375,18 @@ bool GtaNavTiles::BuildTile(
         return true;
     }
 
-    dtStatus status =
-        ctx->navMesh->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr);
+    dtStatus status;
+    {
+        GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, navDataSize);
+        // remove+add num passo só; se falhar, o tile antigo continua
+        status = ctx->navMesh->replaceTile(navData, navDataSize, DT_TILE_FREE_DATA, nullptr);
+    }
 
     if (dtStatusFailed(status))
     {
-        printf("[Tiles] addTile falhou (%d,%d)\n", tx, tz);
+        printf("[Tiles] replaceTile falhou (%d,%d) status=0x%x\n", tx, tz, status);
+        if (status & DT_TILE_LOST)
+            printf("[Tiles] tile antigo (%d,%d) perdido, area fica sem navmesh.\n", tx, tz);
         dtFree(navData);
         return false;
     }
@@ -383,6 +415,7 @@ bool GtaNavTiles::BuildTilesInBounds(
             BuildTile(ctx, tx, tz, tbmin, tbmax);
         }
 
+    ctx->buildCtx.flushProfile();
     return true;
 }
 
@@ -392,24 +425,139 @@ bool GtaNavTiles::BuildTilesInBounds(
 // =======================================================================
 bool GtaNavTiles::RebuildTilesAffectedByDynamic(NavMeshContext* ctx)
 {
-    if (ctx->dynamicVerts.empty())
-        return true;
+    if (!ctx || !ctx->navMesh)
+        return false;
 
+    // Tiles de cada prop (atual + onde estava), não o AABB união de todos:
+    // dois carros em pontas opostas do mapa não rebuildam o mapa inteiro.
+    for (PropInstance& inst : ctx->props)
+        MarkDirtyTilesForProp(ctx, inst);
+
+    UpdateDirtyTiles(ctx, 0.0f);
+    return true;
+}
+
+
+// =======================================================================
+// DIRTY TILES
+// =======================================================================
+int GtaNavTiles::MarkDirtyTilesInAABB(
+    NavMeshContext* ctx,
+    const float bmin[3],
+    const float bmax[3])
+{
     int tx0, tz0, tx1, tz1;
-    if (!CalcTileRangeForAABB(ctx,
-                              ctx->dynamicBMin, ctx->dynamicBMax,
-                              tx0, tz0, tx1, tz1))
-        return false;
+    if (!CalcTileRangeForAABB(ctx, bmin, bmax, tx0, tz0, tx1, tz1))
+        return 0;
 
+    int marked = 0;
     for (int tz = tz0; tz <= tz1; tz++)
         for (int tx = tx0; tx <= tx1; tx++)
         {
-            float tbmin[3], tbmax[3];
-            CalcTileBounds(ctx, tx, tz, tbmin, tbmax);
-            BuildTile(ctx, tx, tz, tbmin, tbmax);
+            if (ctx->dirtyTiles.emplace(MakeTileKey(tx, tz), ctx->dirtyTileSeq).second)
+            {
+                ++ctx->dirtyTileSeq;
+                ++marked;
+            }
         }
+    return marked;
+}
 
-    return true;
+int GtaNavTiles::MarkDirtyTilesForProp(NavMeshContext* ctx, PropInstance& inst)
+{
+    if (!ctx || !ctx->navMesh)
+        return 0;
+
+    const bool hasWorld = !inst.worldDirty && !inst.worldVerts.empty();
+    const bool sameBounds = inst.hasBuiltBounds && hasWorld &&
+        dtVequal(inst.builtBMin, inst.worldBMin) && dtVequal(inst.builtBMax, inst.worldBMax);
+
+    int marked = 0;
+    if (inst.hasBuiltBounds && !sameBounds)
+        marked += MarkDirtyTilesInAABB(ctx, inst.builtBMin, inst.builtBMax);
+
+    // Mesmo AABB ainda pode ter rotação diferente: a posição atual sempre entra.
+    if (hasWorld)
+        marked += MarkDirtyTilesInAABB(ctx, inst.worldBMin, inst.worldBMax);
+
+    inst.hasBuiltBounds = hasWorld;
+    if (hasWorld)
+    {
+        rcVcopy(inst.builtBMin, inst.worldBMin);
+        rcVcopy(inst.builtBMax, inst.worldBMax);
+    }
+    return marked;
+}
+
+int GtaNavTiles::UpdateDirtyTiles(NavMeshContext* ctx, float budgetMs)
+{
+    if (!ctx || !ctx->navMesh || !ctx->geom || ctx->dirtyTiles.empty())
+        return 0;
+
+    GtaNavTraceScope traceScope(GTANAV_TRACE_INFO, "Tiles", "UpdateDirtyTiles");
+    const auto start = std::chrono::steady_clock::now();
+
+    struct DirtyEntry
+    {
+        uint64_t key;
+        float    dist2;
+        uint32_t seq;
+    };
+
+    const dtNavMeshParams* params = ctx->navMesh->getParams();
+    std::vector<DirtyEntry> order;
+    order.reserve(ctx->dirtyTiles.size());
+    for (const auto& kv : ctx->dirtyTiles)
+    {
+        float dist2 = 0.0f;
+        if (ctx->hasDirtyFocus)
+        {
+            const int tx = static_cast<int>(kv.first >> 32);
+            const int tz = static_cast<int>(kv.first & 0xffffffffu);
+            const float cx = params->orig[0] + (tx + 0.5f) * params->tileWidth;
+            const float cz = params->orig[2] + (tz + 0.5f) * params->tileHeight;
+            const float dx = cx - ctx->dirtyFocus[0];
+            const float dz = cz - ctx->dirtyFocus[2];
+            dist2 = dx * dx + dz * dz;
+        }
+        order.push_back({ kv.first, dist2, kv.second });
+    }
+
+    std::sort(order.begin(), order.end(), [](const DirtyEntry& a, const DirtyEntry& b)
+    {
+        if (a.dist2 != b.dist2)
+            return a.dist2 < b.dist2;
+        return a.seq < b.seq;
+    });
+
+    int built = 0;
+    double elapsedMs = 0.0;
+    for (const DirtyEntry& e : order)
+    {
+        if (built > 0 && budgetMs > 0.0f && elapsedMs >= budgetMs)
+            break;
+
+        // Sai da fila mesmo se falhar: o replaceTile mantém o tile antigo no lugar e
+        // reenfileirar só repetiria a mesma falha a cada frame. A próxima mudança na
+        // área marca o tile de novo.
+        ctx->dirtyTiles.erase(e.key);
+
+        const int tx = static_cast<int>(e.key >> 32);
+        const int tz = static_cast<int>(e.key & 0xffffffffu);
+        float tbmin[3], tbmax[3];
+        CalcTileBounds(ctx, tx, tz, tbmin, tbmax);
+        BuildTile(ctx, tx, tz, tbmin, tbmax);
+        ++built;
+
+        elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    ctx->buildCtx.flushProfile();
+
+    traceScope.arg("built", built);
+    traceScope.arg("remaining", ctx->dirtyTiles.size());
+    traceScope.arg("budgetMs", budgetMs);
+    return built;
 }
 
 
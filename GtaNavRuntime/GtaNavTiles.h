@@ -9,6 +9,7 @@ public:
     // ================================================================
     // 1) Construir 1 tile (tx,tz)
     // ================================================================
+    // O tile antigo só é trocado depois do build; em falha ele é mantido.
     static bool BuildTile(
         NavMeshContext* ctx,
         int tx, int tz,
@@ -41,8 +42,29 @@ public:
     );
 
     // ================================================================
-    // 5) Utilitários internos
+    // 5) Tiles sujos: marcação exata por prop + fila priorizada
     // ================================================================
+    static int MarkDirtyTilesInAABB(
+        NavMeshContext* ctx,
+        const float bmin[3],
+        const float bmax[3]
+    );
+
+    // Marca os tiles do AABB já construído (se mudou) e do AABB atual do prop.
+    static int MarkDirtyTilesForProp(NavMeshContext* ctx, PropInstance& inst);
+
+    // Rebuild dos tiles sujos, mais próximos do foco primeiro, até estourar
+    // budgetMs (<= 0: sem limite). Sempre processa ao menos 1 tile.
+    static int UpdateDirtyTiles(NavMeshContext* ctx, float budgetMs);
+
+    // ================================================================
+    // 6) Utilitários internos
+    // ================================================================
+    static uint64_t MakeTileKey(int tx, int tz)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(tz);
+    }
+
     static void CalcTileBounds(
         const NavMeshContext* ctx,
         int tx, int tz,
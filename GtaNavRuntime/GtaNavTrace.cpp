@@ -0,0 +1,311 @@
+#include "GtaNavTrace.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace GtaNavTraceDetail
+{
+    std::atomic<int> g_level{GTANAV_TRACE_WARN};
+}
+
+namespace
+{
+    // Potência de 2; ~1.1 MB.
+    constexpr uint64_t kRingCapacity = 4096;
+    constexpr uint64_t kRingMask = kRingCapacity - 1;
+    constexpr uint64_t kSlotBusy = ~0ull;
+
+    // seq == índice global + 1 quando o slot está completo (seqlock por slot).
+    struct Slot
+    {
+        std::atomic<uint64_t> seq{0};
+        GtaNavTraceEvent      ev;
+    };
+
+    Slot                  g_ring[kRingCapacity];
+    std::atomic<uint64_t> g_head{0};
+    std::atomic<int>      g_echoLevel{GTANAV_TRACE_WARN};
+
+    const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+    uint32_t CurrentThreadId()
+    {
+        thread_local const uint32_t tid =
+            static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return tid;
+    }
+
+    void CopyText(char* dst, const char* src)
+    {
+        if (!src)
+        {
+            dst[0] = '\0';
+            return;
+        }
+        size_t n = strlen(src);
+        if (n >= static_cast<size_t>(GTANAV_TRACE_MAX_TEXT))
+            n = GTANAV_TRACE_MAX_TEXT - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+
+    const char* LevelTag(int level)
+    {
+        switch (level)
+        {
+        case GTANAV_TRACE_ERROR: return "erro";
+        case GTANAV_TRACE_WARN:  return "aviso";
+        default: break;
+        }
+        return nullptr;
+    }
+
+    void EchoEvent(const GtaNavTraceEvent& ev)
+    {
+        char line[512];
+        int len = 0;
+        const char* tag = LevelTag(ev.level);
+        len += snprintf(line + len, sizeof(line) - len, "[%s]%s%s%s %s",
+                        ev.category, tag ? "[" : "", tag ? tag : "", tag ? "]" : "", ev.name);
+        for (int i = 0; i < ev.argCount && len < static_cast<int>(sizeof(line)); ++i)
+            len += snprintf(line + len, sizeof(line) - len, " %s=%.17g", ev.args[i].key, ev.args[i].value);
+        if (ev.phase == 'X' && len < static_cast<int>(sizeof(line)))
+            len += snprintf(line + len, sizeof(line) - len, " ms=%.3f", ev.durNs / 1.0e6);
+        if (ev.text[0] && len < static_cast<int>(sizeof(line)))
+            snprintf(line + len, sizeof(line) - len, " %s", ev.text);
+        printf("%s\n", line);
+    }
+
+    void AppendFormat(std::string& out, const char* fmt, ...)
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, fmt);
+        const int n = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        if (n > 0)
+            out.append(buf, static_cast<size_t>(n < (int)sizeof(buf) ? n : (int)sizeof(buf) - 1));
+    }
+
+    void AppendJsonString(std::string& out, const char* s)
+    {
+        out += '"';
+        for (; s && *s; ++s)
+        {
+            const unsigned char c = static_cast<unsigned char>(*s);
+            switch (c)
+            {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20)
+                    AppendFormat(out, "\\u%04x", c);
+                else
+                    out += static_cast<char>(c);
+                break;
+            }
+        }
+        out += '"';
+    }
+
+    // Copia consistente dos eventos vivos, em ordem de gravação.
+    void Snapshot(std::vector<GtaNavTraceEvent>& out)
+    {
+        const uint64_t head = g_head.load(std::memory_order_acquire);
+        const uint64_t first = head > kRingCapacity ? head - kRingCapacity : 0;
+        out.clear();
+        out.reserve(static_cast<size_t>(head - first));
+        for (uint64_t idx = first; idx < head; ++idx)
+        {
+            const Slot& slot = g_ring[idx & kRingMask];
+            const uint64_t s1 = slot.seq.load(std::memory_order_acquire);
+            if (s1 != idx + 1)
+                continue;
+            GtaNavTraceEvent ev;
+            memcpy(&ev, &slot.ev, sizeof(ev));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != s1)
+                continue;
+            out.push_back(ev);
+        }
+    }
+}
+
+void GtaNavTrace_SetLevel(int level)
+{
+    GtaNavTraceDetail::g_level.store(level, std::memory_order_relaxed);
+}
+
+int GtaNavTrace_GetLevel()
+{
+    return GtaNavTraceDetail::g_level.load(std::memory_order_relaxed);
+}
+
+void GtaNavTrace_SetEchoLevel(int level)
+{
+    g_echoLevel.store(level, std::memory_order_relaxed);
+}
+
+int64_t GtaNavTrace_NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+void GtaNavTrace_Emit(int level,
+                      char phase,
+                      const char* category,
+                      const char* name,
+                      int64_t tsNs,
+                      int64_t durNs,
+                      const GtaNavTraceArg* args,
+                      int argCount,
+                      const char* text)
+{
+    const uint64_t idx = g_head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = g_ring[idx & kRingMask];
+
+    slot.seq.store(kSlotBusy, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    GtaNavTraceEvent& ev = slot.ev;
+    ev.category = category ? category : "";
+    ev.name = name ? name : "";
+    ev.tsNs = tsNs;
+    ev.durNs = durNs;
+    ev.tid = CurrentThreadId();
+    ev.level = static_cast<uint8_t>(level);
+    ev.phase = phase;
+    if (argCount > GTANAV_TRACE_MAX_ARGS)
+        argCount = GTANAV_TRACE_MAX_ARGS;
+    if (!args || argCount < 0)
+        argCount = 0;
+    ev.argCount = static_cast<uint8_t>(argCount);
+    for (int i = 0; i < argCount; ++i)
+        ev.args[i] = args[i];
+    CopyText(ev.text, text);
+
+    slot.seq.store(idx + 1, std::memory_order_release);
+
+    if (level <= g_echoLevel.load(std::memory_order_relaxed))
+        EchoEvent(ev);
+}
+
+void GtaNavTrace_Clear()
+{
+    // seq zerado invalida o slot (o snapshot só aceita seq == idx + 1).
+    for (uint64_t i = 0; i < kRingCapacity; ++i)
+        g_ring[i].seq.store(0, std::memory_order_relaxed);
+}
+
+int GtaNavTrace_GetEventCount()
+{
+    std::vector<GtaNavTraceEvent> events;
+    Snapshot(events);
+    return static_cast<int>(events.size());
+}
+
+std::string GtaNavTrace_ToChromeJson()
+{
+    std::vector<GtaNavTraceEvent> events;
+    Snapshot(events);
+
+    std::string out;
+    out.reserve(events.size() * 160 + 64);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const GtaNavTraceEvent& ev = events[i];
+        out += "{\"name\":";
+        AppendJsonString(out, ev.name);
+        out += ",\"cat\":";
+        AppendJsonString(out, ev.category);
+        AppendFormat(out, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+                     ev.phase, ev.tid, ev.tsNs / 1.0e3);
+        if (ev.phase == 'X')
+            AppendFormat(out, ",\"dur\":%.3f", ev.durNs / 1.0e3);
+        else
+            out += ",\"s\":\"t\"";
+        AppendFormat(out, ",\"args\":{\"level\":%d", static_cast<int>(ev.level));
+        for (int a = 0; a < ev.argCount; ++a)
+        {
+            out += ',';
+            AppendJsonString(out, ev.args[a].key);
+            AppendFormat(out, ":%.17g", ev.args[a].value);
+        }
+        if (ev.text[0])
+        {
+            out += ",\"text\":";
+            AppendJsonString(out, ev.text);
+        }
+        out += "}}";
+        out += (i + 1 < events.size()) ? ",\n" : "\n";
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool GtaNavTrace_SaveChromeJson(const char* path)
+{
+    if (!path || !path[0])
+        return false;
+
+    const std::filesystem::path outPath(path);
+    std::error_code ec;
+    if (outPath.has_parent_path())
+        std::filesystem::create_directories(outPath.parent_path(), ec);
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out.is_open())
+    {
+        printf("[Trace] Falha ao abrir %s\n", path);
+        return false;
+    }
+    out << GtaNavTrace_ToChromeJson();
+    return out.good();
+}
+
+// ======================================================================
+// GtaNavTraceScope
+// ======================================================================
+GtaNavTraceScope::GtaNavTraceScope(int level, const char* category, const char* name)
+    : m_category(category)
+    , m_name(name)
+    , m_startNs(0)
+    , m_level(level)
+    , m_argCount(0)
+    , m_active(level <= GTANAV_TRACE_COMPILE_LEVEL && GtaNavTrace_IsEnabled(level))
+{
+    m_text[0] = '\0';
+    if (m_active)
+        m_startNs = GtaNavTrace_NowNs();
+}
+
+GtaNavTraceScope::~GtaNavTraceScope()
+{
+    if (!m_active)
+        return;
+    GtaNavTrace_Emit(m_level, 'X', m_category, m_name, m_startNs, GtaNavTrace_NowNs() - m_startNs,
+                     m_args, m_argCount, m_text);
+}
+
+void GtaNavTraceScope::arg(const char* key, double value)
+{
+    if (!m_active || m_argCount >= GTANAV_TRACE_MAX_ARGS)
+        return;
+    m_args[m_argCount++] = GtaNavTraceArg(key, value);
+}
+
+void GtaNavTraceScope::text(const char* value)
+{
+    if (m_active)
+        CopyText(m_text, value);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+// ======================================================================
+// Tracer de eventos estruturados (substitui printf em hot paths).
+//
+// Eventos vão para um ring buffer lock-free de tamanho fixo (os mais antigos
+// são sobrescritos). Exporta no formato Chrome trace (chrome://tracing,
+// Perfetto). Filtro por nível:
+//   - compilação: GTANAV_TRACE_COMPILE_LEVEL (eventos acima viram código morto)
+//   - runtime:    GtaNavTrace_SetLevel (padrão: WARN)
+// Eventos com nível <= echo level também são impressos no stdout (padrão: WARN),
+// para erros continuarem aparecendo no console.
+//
+// Nomes, categorias e chaves de args devem ser literais (só o ponteiro é
+// guardado). O texto opcional é copiado (truncado).
+// ======================================================================
+
+enum GtaNavTraceLevel
+{
+    GTANAV_TRACE_OFF = 0,
+    GTANAV_TRACE_ERROR,
+    GTANAV_TRACE_WARN,
+    GTANAV_TRACE_INFO,
+    GTANAV_TRACE_DEBUG,
+};
+
+#ifndef GTANAV_TRACE_COMPILE_LEVEL
+#define GTANAV_TRACE_COMPILE_LEVEL GTANAV_TRACE_DEBUG
+#endif
+
+static constexpr int GTANAV_TRACE_MAX_ARGS = 8;
+static constexpr int GTANAV_TRACE_MAX_TEXT = 96;
+
+struct GtaNavTraceArg
+{
+    const char* key = nullptr;
+    double      value = 0.0;
+
+    GtaNavTraceArg() = default;
+    template <typename T>
+    GtaNavTraceArg(const char* k, T v) : key(k), value(static_cast<double>(v)) {}
+};
+
+struct GtaNavTraceEvent
+{
+    const char*    category;
+    const char*    name;
+    int64_t        tsNs;      // desde o início do processo
+    int64_t        durNs;     // só para phase 'X'
+    uint32_t       tid;
+    uint8_t        level;
+    char           phase;     // 'i' instantâneo, 'X' completo (com duração)
+    uint8_t        argCount;
+    GtaNavTraceArg args[GTANAV_TRACE_MAX_ARGS];
+    char           text[GTANAV_TRACE_MAX_TEXT];
+};
+
+void GtaNavTrace_SetLevel(int level);
+int  GtaNavTrace_GetLevel();
+void GtaNavTrace_SetEchoLevel(int level);
+
+inline bool GtaNavTrace_IsEnabled(int level);
+
+int64_t GtaNavTrace_NowNs();
+
+void GtaNavTrace_Emit(int level,
+                      char phase,
+                      const char* category,
+                      const char* name,
+                      int64_t tsNs,
+                      int64_t durNs,
+                      const GtaNavTraceArg* args,
+                      int argCount,
+                      const char* text);
+
+// Descarta os eventos gravados.
+void GtaNavTrace_Clear();
+// Quantidade de eventos ainda disponíveis no ring (no máximo a capacidade).
+int  GtaNavTrace_GetEventCount();
+
+// JSON no formato Chrome trace ({"traceEvents": [...]}).
+std::string GtaNavTrace_ToChromeJson();
+bool        GtaNavTrace_SaveChromeJson(const char* path);
+
+// Evento 'X' cobrindo o escopo; args/texto podem ser definidos antes do fim.
+class GtaNavTraceScope
+{
+public:
+    GtaNavTraceScope(int level, const char* category, const char* name);
+    ~GtaNavTraceScope();
+
+    bool active() const { return m_active; }
+    void arg(const char* key, double value);
+    void text(const char* value);
+
+private:
+    const char*    m_category;
+    const char*    m_name;
+    int64_t        m_startNs;
+    int            m_level;
+    int            m_argCount;
+    bool           m_active;
+    GtaNavTraceArg m_args[GTANAV_TRACE_MAX_ARGS];
+    char           m_text[GTANAV_TRACE_MAX_TEXT];
+
+    GtaNavTraceScope(const GtaNavTraceScope&) = delete;
+    GtaNavTraceScope& operator=(const GtaNavTraceScope&) = delete;
+};
+
+namespace GtaNavTraceDetail
+{
+    extern std::atomic<int> g_level;
+}
+
+inline bool GtaNavTrace_IsEnabled(int level)
+{
+    return level <= GtaNavTraceDetail::g_level.load(std::memory_order_relaxed);
+}
+
+#define GTANAV_TRACE_ENABLED(level) \
+    ((level) <= GTANAV_TRACE_COMPILE_LEVEL && GtaNavTrace_IsEnabled(level))
+
+// Args: GTANAV_TRACE(GTANAV_TRACE_INFO, "WorldTile", "BuildTile", nullptr, {"tx", tx}, {"ty", ty});
+// Nada (nem os args, nem o texto) é avaliado com o nível desligado.
+#define GTANAV_TRACE(level, category, name, textExpr, ...)                                        \
+    do {                                                                                          \
+        if (GTANAV_TRACE_ENABLED(level))                                                          \
+        {                                                                                         \
+            const GtaNavTraceArg gtanavTraceArgs_[] = { __VA_ARGS__ };                            \
+            GtaNavTrace_Emit((level), 'i', (category), (name), GtaNavTrace_NowNs(), 0,            \
+                             gtanavTraceArgs_,                                                    \
+                             static_cast<int>(sizeof(gtanavTraceArgs_) / sizeof(gtanavTraceArgs_[0])), \
+                             (textExpr));                                                         \
+        }                                                                                         \
+    } while (0)
+
+#define GTANAV_TRACE_MSG(level, category, name, textExpr)                                         \
+    do {                                                                                          \
+        if (GTANAV_TRACE_ENABLED(level))                                                          \
+            GtaNavTrace_Emit((level), 'i', (category), (name), GtaNavTrace_NowNs(), 0,            \
+                             nullptr, 0, (textExpr));                                             \
+    } while (0)
@@ -4,11 +4,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
-inline void TransformVertexZYX(
-    float x, float y, float z,
-    const float pos[3],
-    const float rotDeg[3],
-    float& ox, float& oy, float& oz)
+// Matriz local -> world de um prop (rotação + translação).
+inline glm::mat4 MakeTransformZYX(const float pos[3], const float rotDeg[3])
 {
     // Ordem de rotação escolhida: YXZ → Z,Y,X (GTA geralmente usa ZYX)
     glm::mat4 t =
@@ -18,10 +15,21 @@ inline void TransformVertexZYX(
             glm::radians(rotDeg[1])  // X
         );
 
-    glm::vec4 v(x, y, z, 1.0f);
-    glm::vec4 r = t * v;
+    t[3] = glm::vec4(pos[0], pos[1], pos[2], 1.0f);
+    return t;
+}
+
+inline void TransformVertexZYX(
+    float x, float y, float z,
+    const float pos[3],
+    const float rotDeg[3],
+    float& ox, float& oy, float& oz)
+{
+    // Monta a matriz a cada chamada; para malhas inteiras use MakeTransformZYX uma vez.
+    const glm::mat4 t = MakeTransformZYX(pos, rotDeg);
+    const glm::vec4 r = t * glm::vec4(x, y, z, 1.0f);
 
-    ox = r.x + pos[0];
-    oy = r.y + pos[1];
-    oz = r.z + pos[2];
+    ox = r.x;
+    oy = r.y;
+    oz = r.z;
 }
@@ -106,19 +106,56 @@ static char* parseRow(char* buf, char* bufEnd, char* row, int len)
 
 
 
+static void setZero3(float* v)
+{
+	v[0] = v[1] = v[2] = 0.0f;
+}
+
 InputGeom::InputGeom() :
 	m_chunkyMesh(0),
 	m_mesh(0),
+	m_dynChunkyMesh(0),
+	m_dynMesh(0),
 	m_hasBuildSettings(false),
 	m_offMeshConCount(0),
 	m_volumeCount(0)
 {
+	setZero3(m_meshBMin);
+	setZero3(m_meshBMax);
+	setZero3(m_staticBMin);
+	setZero3(m_staticBMax);
+	setZero3(m_dynBMin);
+	setZero3(m_dynBMax);
 }
 
 InputGeom::~InputGeom()
 {
 	delete m_chunkyMesh;
 	delete m_mesh;
+	delete m_dynChunkyMesh;
+	delete m_dynMesh;
+}
+
+// AABB exposto = união das camadas presentes.
+void InputGeom::updateMeshBounds()
+{
+	if (m_mesh && m_dynMesh)
+	{
+		rcVcopy(m_meshBMin, m_staticBMin);
+		rcVcopy(m_meshBMax, m_staticBMax);
+		rcVmin(m_meshBMin, m_dynBMin);
+		rcVmax(m_meshBMax, m_dynBMax);
+	}
+	else if (m_dynMesh)
+	{
+		rcVcopy(m_meshBMin, m_dynBMin);
+		rcVcopy(m_meshBMax, m_dynBMax);
+	}
+	else
+	{
+		rcVcopy(m_meshBMin, m_staticBMin);
+		rcVcopy(m_meshBMax, m_staticBMax);
+	}
 }
 		
 bool InputGeom::loadMesh(rcContext* ctx, const std::string& filepath)
@@ -145,7 +182,8 @@ bool InputGeom::loadMesh(rcContext* ctx, const std::string& filepath)
 		return false;
 	}
 
-	rcCalcBounds(m_mesh->getVerts(), m_mesh->getVertCount(), m_meshBMin, m_meshBMax);
+	rcCalcBounds(m_mesh->getVerts(), m_mesh->getVertCount(), m_staticBMin, m_staticBMax);
+	updateMeshBounds();
 
 	m_chunkyMesh = new rcChunkyTriMesh;
 	if (!m_chunkyMesh)
@@ -421,31 +459,24 @@ static bool isectSegAABB(const float* sp, const float* sq,
 }
 
 
-bool InputGeom::raycastMesh(float* src, float* dst, float& tmin)
+static bool raycastChunkyMesh(const rcChunkyTriMesh* chunky, const rcMeshLoaderObj* mesh,
+							  float* src, float* dst, float* p, float* q, float& tmin)
 {
-	// Prune hit ray.
-	float btmin, btmax;
-	if (!isectSegAABB(src, dst, m_meshBMin, m_meshBMax, btmin, btmax))
+	if (!chunky || !mesh)
 		return false;
-	float p[2], q[2];
-	p[0] = src[0] + (dst[0]-src[0])*btmin;
-	p[1] = src[2] + (dst[2]-src[2])*btmin;
-	q[0] = src[0] + (dst[0]-src[0])*btmax;
-	q[1] = src[2] + (dst[2]-src[2])*btmax;
-	
+
 	int cid[512];
-	const int ncid = rcGetChunksOverlappingSegment(m_chunkyMesh, p, q, cid, 512);
+	const int ncid = rcGetChunksOverlappingSegment(chunky, p, q, cid, 512);
 	if (!ncid)
 		return false;
 	
-	tmin = 1.0f;
 	bool hit = false;
-	const float* verts = m_mesh->getVerts();
+	const float* verts = mesh->getVerts();
 	
 	for (int i = 0; i < ncid; ++i)
 	{
-		const rcChunkyTriMeshNode& node = m_chunkyMesh->nodes[cid[i]];
-		const int* tris = &m_chunkyMesh->tris[node.i*3];
+		const rcChunkyTriMeshNode& node = chunky->nodes[cid[i]];
+		const int* tris = &chunky->tris[node.i*3];
 		const int ntris = node.n;
 
 		for (int j = 0; j < ntris*3; j += 3)
@@ -466,6 +497,24 @@ bool InputGeom::raycastMesh(float* src, float* dst, float& tmin)
 	return hit;
 }
 
+bool InputGeom::raycastMesh(float* src, float* dst, float& tmin)
+{
+	// Prune hit ray.
+	float btmin, btmax;
+	if (!isectSegAABB(src, dst, m_meshBMin, m_meshBMax, btmin, btmax))
+		return false;
+	float p[2], q[2];
+	p[0] = src[0] + (dst[0]-src[0])*btmin;
+	p[1] = src[2] + (dst[2]-src[2])*btmin;
+	q[0] = src[0] + (dst[0]-src[0])*btmax;
+	q[1] = src[2] + (dst[2]-src[2])*btmax;
+	
+	tmin = 1.0f;
+	const bool hitStatic = raycastChunkyMesh(m_chunkyMesh, m_mesh, src, dst, p, q, tmin);
+	const bool hitDynamic = raycastChunkyMesh(m_dynChunkyMesh, m_dynMesh, src, dst, p, q, tmin);
+	return hitStatic || hitDynamic;
+}
+
 void InputGeom::addOffMeshConnection(const float* spos, const float* epos, const float rad,
 									 unsigned char bidir, unsigned char area, unsigned short flags)
 {
@@ -620,11 +669,8 @@ bool InputGeom::initMeshFromArrays(rcContext* ctx,
 	delete m_mesh;
 	m_mesh = 0;
 
-	if (m_chunkyMesh)
-	{
-		rcFreeChunkyTriMesh(m_chunkyMesh);
-		m_chunkyMesh = 0;
-	}
+	delete m_chunkyMesh;
+	m_chunkyMesh = 0;
 
 	if (!verts || !tris || nverts <= 0 || ntris <= 0)
 	{
@@ -652,7 +698,8 @@ bool InputGeom::initMeshFromArrays(rcContext* ctx,
 	}
 
 	// Atualiza AABB do mesh (usado por buildTileMesh)
-	rcCalcBounds(verts, nverts, m_meshBMin, m_meshBMax);
+	rcCalcBounds(verts, nverts, m_staticBMin, m_staticBMax);
+	updateMeshBounds();
 
 	// Cria ChunkyTriMesh para queries por tile
 	m_chunkyMesh = new rcChunkyTriMesh;
@@ -668,11 +715,72 @@ bool InputGeom::initMeshFromArrays(rcContext* ctx,
 	{
 		if (ctx)
 			ctx->log(RC_LOG_ERROR, "initMeshFromArrays: rcCreateChunkyTriMesh falhou.");
-		rcFreeChunkyTriMesh(m_chunkyMesh);
+		delete m_chunkyMesh;
 		m_chunkyMesh = 0;
 		return false;
 	}
 
 	// Convex volumes / off-mesh connections continuam os mesmos (já estão em m_meshLoaderData)
 	return true;
-}
\ No newline at end of file
+}
+
+void InputGeom::clearMesh()
+{
+	delete m_mesh;
+	m_mesh = 0;
+
+	delete m_chunkyMesh;
+	m_chunkyMesh = 0;
+
+	setZero3(m_staticBMin);
+	setZero3(m_staticBMax);
+	updateMeshBounds();
+}
+
+bool InputGeom::setDynamicMeshFromArrays(rcContext* ctx,
+										 const float* verts, int nverts,
+										 const int* tris, int ntris)
+{
+	clearDynamicMesh();
+
+	// Sem props: camada vazia é estado válido.
+	if (!verts || !tris || nverts <= 0 || ntris <= 0)
+		return true;
+
+	m_dynMesh = new rcMeshLoaderObj();
+	if (!m_dynMesh->loadFromArrays(verts, nverts, tris, ntris))
+	{
+		if (ctx)
+			ctx->log(RC_LOG_ERROR, "setDynamicMeshFromArrays: loadFromArrays falhou.");
+		clearDynamicMesh();
+		return false;
+	}
+
+	rcCalcBounds(verts, nverts, m_dynBMin, m_dynBMax);
+
+	// Chunky separado: custo proporcional só aos props, o estático fica intacto.
+	m_dynChunkyMesh = new rcChunkyTriMesh;
+	if (!rcCreateChunkyTriMesh(verts, tris, ntris, 256, m_dynChunkyMesh))
+	{
+		if (ctx)
+			ctx->log(RC_LOG_ERROR, "setDynamicMeshFromArrays: rcCreateChunkyTriMesh falhou.");
+		clearDynamicMesh();
+		return false;
+	}
+
+	updateMeshBounds();
+	return true;
+}
+
+void InputGeom::clearDynamicMesh()
+{
+	delete m_dynMesh;
+	m_dynMesh = 0;
+
+	delete m_dynChunkyMesh;
+	m_dynChunkyMesh = 0;
+
+	setZero3(m_dynBMin);
+	setZero3(m_dynBMax);
+	updateMeshBounds();
+}
@@ -74,6 +74,12 @@ class InputGeom
 	rcChunkyTriMesh* m_chunkyMesh;
 	rcMeshLoaderObj* m_mesh;
 	float m_meshBMin[3], m_meshBMax[3];
+
+	// Camada dinâmica (props): malha e chunky próprios, trocados sem tocar no estático.
+	rcChunkyTriMesh* m_dynChunkyMesh;
+	rcMeshLoaderObj* m_dynMesh;
+	float m_staticBMin[3], m_staticBMax[3];
+	float m_dynBMin[3], m_dynBMax[3];
 	BuildSettings m_buildSettings;
 	bool m_hasBuildSettings;
 	
@@ -97,6 +103,7 @@ class InputGeom
 	///@}
 	
 	bool loadMesh(class rcContext* ctx, const std::string& filepath);
+	void updateMeshBounds();
 	bool loadGeomSet(class rcContext* ctx, const std::string& filepath);
 public:
 	InputGeom();
@@ -142,6 +149,18 @@ public:
 	bool initMeshFromArrays(rcContext* ctx,
 						const float* verts, int nverts,
 						const int* tris, int ntris);
+	void clearMesh();
+	///@}
+
+	/// @name Camada dinâmica.
+	/// getMeshBoundsMin/Max passam a ser a união estático + dinâmico.
+	///@{
+	bool setDynamicMeshFromArrays(rcContext* ctx,
+							  const float* verts, int nverts,
+							  const int* tris, int ntris);
+	void clearDynamicMesh();
+	const rcMeshLoaderObj* getDynamicMesh() const { return m_dynMesh; }
+	const rcChunkyTriMesh* getDynamicChunkyMesh() const { return m_dynChunkyMesh; }
 	///@}
 	
 private:
@@ -1,11 +1,17 @@
 #include "ExternC.h"
 #include "NavMesh_TileCacheDB.h"
+#include "NavMesh_TileBuildScheduler.h"
 #include "NavMesh_TileCacheGridDB.h"
+#include "NavMesh_WorldManifest.h"
+#include "GtaNavProfile.h"
+#include "GtaNavTileAlloc.h"
+#include "GtaNavTrace.h"
 #include "json.hpp"
 
 #include <DetourNavMesh.h>
 #include <DetourNavMeshQuery.h>
 #include <DetourCommon.h>
+#include <DetourFlowField.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cfloat>
@@ -16,6 +22,7 @@
 #include <deque>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <limits>
 #include <memory>
 #include <set>
@@ -25,7 +32,11 @@
 #include <unordered_set>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 namespace
 {
@@ -51,6 +62,14 @@ namespace
         glm::vec3 rotation{0.0f}; // graus
         glm::vec3 worldBMin{0.0f};
         glm::vec3 worldBMax{0.0f};
+
+        // Segmento já transformado (e recortado pelo bbox) que entra no rebuild incremental.
+        std::vector<glm::vec3> segmentVerts;
+        std::vector<unsigned int> segmentIndices;
+        glm::vec3 segmentBMin{FLT_MAX};
+        glm::vec3 segmentBMax{-FLT_MAX};
+        std::vector<uint64_t> segmentTiles;     // tiles onde está registrado no índice
+        bool segmentDirty = true;
     };
 
     enum : std::uint8_t
@@ -119,8 +138,13 @@ namespace
         float halfX = 0.0f;
         float halfZ = 0.0f;
         float height = 0.0f;
+        unsigned int carveRef = 0;  // dtObstacleRef no tile cache (modo carving)
+        bool carvePending = false;  // fila de pedidos cheia; tenta de novo no update
     };
 
+    constexpr uint32_t kInvalidGeomHandle = 0xffffffffu;
+    constexpr uint64_t kWorldJournalCompactMinBytes = 1024 * 1024;
+
     struct ExternNavmeshContext
     {
         NavmeshGenerationSettings genSettings{};
@@ -135,14 +159,26 @@ namespace
         glm::vec3 bboxMax{0.0f};
         bool rebuildAll = false;
         std::vector<std::pair<glm::vec3, glm::vec3>> dirtyBounds;
+        // Índice tile -> posição em geometries (modo não-world): o rebuild incremental junta
+        // só a geometria dos tiles sujos. Refeito quando geometries perde itens ou a malha muda.
+        std::unordered_map<uint64_t, std::vector<uint32_t>> geometryTileIndex;
+        bool geometryTileIndexValid = false;
+        uint32_t geometryTileIndexEpoch = 0;
+        bool segmentsHaveBBox = false;
+        glm::vec3 segmentsBBoxMin{0.0f};
+        glm::vec3 segmentsBBoxMax{0.0f};
+        bool combinedGeometryStale = false;     // cache do NavMeshData atrás das instâncias
         float cachedExtents[3]{20.0f, 10.0f, 20.0f};
         std::string cacheRoot;
         std::string sessionId;
         int maxResidentTiles = 256;
+        uint64_t maxResidentBytes = 0;  // 0 = só o limite por contagem
         bool streamingEnabled = false;
         bool worldTileStreamingEnabled = false;
         bool worldUnloadBuiltTilesAfterSave = false;
         bool useTileCacheGridDB = false;
+        uint32_t tileCacheCodec = TILE_DB_CODEC_LZ;
+        int worldBuildThreads = 1;      // threads do Recast em BuildQueuedWorldTiles
         std::unordered_map<uint64_t, uint32_t> residentStamp;
         std::unordered_set<uint64_t> residentTiles;
         std::unordered_map<uint32_t, std::unordered_set<uint64_t>> agentResidentTiles;
@@ -168,6 +204,7 @@ namespace
                 std::unordered_map<uint64_t, std::vector<int>> cellToChunks;
             };
             std::string id;
+            uint32_t handle = 0;
             std::string path;
             glm::vec3 position{0.0f};
             glm::vec3 rotation{0.0f};
@@ -188,33 +225,129 @@ namespace
             uint64_t transformedHash = 0;
             LoadedGeometry source;
         };
-        std::unordered_map<std::string, WorldGeomRecord> worldGeometry;
-        std::vector<std::string> pendingWorldGeometryQueue;
-        std::unordered_set<std::string> pendingWorldGeometrySet;
-        std::unordered_map<uint64_t, std::vector<std::string>> tileToGeometryIds;
-        std::unordered_map<std::string, std::unordered_set<uint64_t>> geomToTiles;
+        struct WorldGeomLoad
+        {
+            LoadedGeometry source;
+            glm::vec3 worldBMin{0.0f};
+            glm::vec3 worldBMax{0.0f};
+            uint64_t fileMTime = 0;
+            uint64_t fileSize = 0;
+            uint64_t geomHash = 0;
+        };
+        // Ids de geometria internados em handles densos; só voltam a zero no clear do mundo.
+        struct GeomIdTable
+        {
+            std::vector<std::string> names;
+            std::vector<uint64_t> nameHashes; // std::hash do id, entra no hash do tile
+            std::unordered_map<std::string, uint32_t> handles;
+
+            uint32_t Intern(const std::string& id)
+            {
+                auto it = handles.find(id);
+                if (it != handles.end())
+                    return it->second;
+                const uint32_t handle = static_cast<uint32_t>(names.size());
+                handles.emplace(id, handle);
+                names.push_back(id);
+                nameHashes.push_back(std::hash<std::string>{}(id));
+                return handle;
+            }
+
+            uint32_t Find(const std::string& id) const
+            {
+                auto it = handles.find(id);
+                return it != handles.end() ? it->second : kInvalidGeomHandle;
+            }
+
+            void Clear()
+            {
+                names.clear();
+                nameHashes.clear();
+                handles.clear();
+            }
+        };
+        GeomIdTable geomIds;
+        std::unordered_map<uint32_t, WorldGeomRecord> worldGeometry;
+        std::deque<uint32_t> pendingWorldGeometryQueue;
+        std::vector<char> pendingWorldGeometry; // por handle: está em pendingWorldGeometryQueue
+        std::unordered_map<uint32_t, WorldGeomLoad> loadedWorldGeometry; // já carregadas pelo pool, esperando o commit
+        std::unordered_map<uint64_t, std::vector<uint32_t>> tileToGeometryIds; // ordenado pelo id, não pelo handle
+        std::vector<std::vector<uint64_t>> geomToTiles; // por handle, ordenado
+        std::unordered_map<uint64_t, uint64_t> worldTileHashCache;
+        uint64_t worldTileHashSettings = 0;
         std::unordered_set<uint64_t> dirtyWorldTiles;
         std::unordered_map<uint64_t, std::vector<OffmeshLink>> worldOffmeshLinksByTile;
         std::unordered_set<uint64_t> dirtyWorldOffmeshTiles;
         bool worldAutoGenerateOffmeshLinks = false;
-        std::deque<uint64_t> pendingTileBuildQueue;
-        std::unordered_set<uint64_t> pendingTileBuildSet;
+        WorldTileBuildScheduler pendingTileBuildQueue; // mais perto dos agents de streaming primeiro
         std::unordered_set<uint64_t> emptyWorldTiles;
         std::unordered_map<uint64_t, uint64_t> emptyWorldTileHashes;
         std::unordered_set<uint64_t> failedWorldTiles;
         bool worldManifestLoaded = false;
         bool worldAutoSaveManifest = false;
+        // Base binário + journal: cada save grava só o que mudou desde o anterior.
+        std::unordered_set<uint32_t> manifestDirtyGeoms;
+        std::unordered_set<uint32_t> manifestSavedGeoms; // handles presentes no base+journal
+        std::unordered_map<uint64_t, WorldManifestTile> manifestSavedTiles;
+        bool manifestFullSaveNeeded = true;
+        uint64_t manifestSeq = 0;
+        uint64_t manifestBaseBytes = 0;
+        uint64_t manifestJournalBytes = 0;
+        std::future<bool> manifestCompaction;
+        uint64_t manifestCompactSeq = 0;
+        std::filesystem::path manifestCompactJournalPath;
         std::unordered_map<std::uint32_t, SimAgentState> simAgents;
         std::vector<std::uint32_t> simAgentIds;
         std::unordered_map<std::uint32_t, DynObstacleState> dynObstacles;
         std::vector<std::uint32_t> dynObstacleIds;
+        bool worldObstacleCarving = false;
+        int worldCarveMaxObstacles = 1024;
+        int worldCarveMaxLayers = 4;
         HeightSampler heightSampler;
         SimParamsFFI lastSimParams{};
         bool hasLastSimParams = false;
+        struct FlowFieldEntry
+        {
+            std::unique_ptr<dtFlowField, void(*)(dtFlowField*)> field{nullptr, dtFreeFlowField};
+            glm::vec3 target{0.0f};
+            float radius = 0.0f;
+            int flags = 0;
+            uint32_t navEpoch = 0;
+        };
+        std::unordered_map<uint32_t, FlowFieldEntry> flowFields;
+        uint32_t nextFlowFieldId = 1;
+        uint32_t navMeshEpoch = 0;  // muda quando o dtNavMesh é recriado (mesmo endereço pode voltar)
+
+        // Log de mudanças por tile para os consumidores de GetNavMeshPolygons (deltas por geração).
+        struct NavTileSlot
+        {
+            bool present = false;
+            int tx = 0;
+            int ty = 0;
+            int layer = 0;
+            unsigned int salt = 0;
+            uint64_t polyRefBase = 0;
+        };
+        struct NavTileLogEntry
+        {
+            uint64_t generation = 0;
+            int tileIndex = 0;
+            int kind = NAV_TILE_CHANGE_ADDED;
+            NavTileSlot slot;
+        };
+        std::vector<NavTileSlot> navTileSlots;      // por índice de tile do dtNavMesh
+        std::deque<NavTileLogEntry> navTileLog;
+        uint64_t navGeneration = 0;
+        uint64_t navGenerationFloor = 0;            // since abaixo disso recebe resync completo
+        unsigned int navObservedTileGeneration = 0;
+        uint32_t navObservedEpoch = 0;
+        const dtNavMesh* navObservedMesh = nullptr;
     };
 
     std::filesystem::path GetSessionCachePath(const ExternNavmeshContext& ctx);
     std::filesystem::path GetWorldManifestPath(const ExternNavmeshContext& ctx);
+    std::filesystem::path GetWorldManifestJsonPath(const ExternNavmeshContext& ctx);
+    std::filesystem::path GetWorldJournalPath(const ExternNavmeshContext& ctx);
     std::filesystem::path GetSessionGridCacheRoot(const ExternNavmeshContext& ctx);
     bool EnsureNavQuery(ExternNavmeshContext& ctx);
     bool UpdateNavmeshState(ExternNavmeshContext& ctx, bool forceFullBuild);
@@ -224,6 +357,108 @@ namespace
     void EnqueueTileBuild(ExternNavmeshContext& ctx, uint64_t tileKey);
     bool BuildWorldTileGeometry(ExternNavmeshContext& ctx, int tx, int ty, std::vector<glm::vec3>& outVerts, std::vector<unsigned int>& outIndices, bool* outAbortedByTriLimit);
 
+    ExternNavmeshContext::WorldGeomRecord* FindWorldGeometry(ExternNavmeshContext& ctx, const std::string& id)
+    {
+        const uint32_t handle = ctx.geomIds.Find(id);
+        if (handle == kInvalidGeomHandle)
+            return nullptr;
+        auto it = ctx.worldGeometry.find(handle);
+        return it != ctx.worldGeometry.end() ? &it->second : nullptr;
+    }
+
+    bool QueueWorldGeometryHandle(ExternNavmeshContext& ctx, uint32_t handle)
+    {
+        if (ctx.pendingWorldGeometry.size() <= handle)
+            ctx.pendingWorldGeometry.resize(static_cast<size_t>(handle) + 1, 0);
+        if (ctx.pendingWorldGeometry[handle])
+            return false;
+        ctx.pendingWorldGeometry[handle] = 1;
+        ctx.pendingWorldGeometryQueue.push_back(handle);
+        ctx.manifestDirtyGeoms.insert(handle);
+        return true;
+    }
+
+    // eraseFromQueue=false quando quem chama já tirou o handle da fila.
+    void UnqueueWorldGeometryHandle(ExternNavmeshContext& ctx, uint32_t handle, bool eraseFromQueue)
+    {
+        if (handle < ctx.pendingWorldGeometry.size())
+            ctx.pendingWorldGeometry[handle] = 0;
+        ctx.manifestDirtyGeoms.insert(handle);
+        if (eraseFromQueue)
+        {
+            ctx.pendingWorldGeometryQueue.erase(
+                std::remove(ctx.pendingWorldGeometryQueue.begin(), ctx.pendingWorldGeometryQueue.end(), handle),
+                ctx.pendingWorldGeometryQueue.end());
+        }
+    }
+
+    const std::vector<uint64_t>& GetWorldGeometryTiles(const ExternNavmeshContext& ctx, uint32_t handle)
+    {
+        static const std::vector<uint64_t> kNoTiles;
+        return handle < ctx.geomToTiles.size() ? ctx.geomToTiles[handle] : kNoTiles;
+    }
+
+    void AddGeometryToWorldTile(ExternNavmeshContext& ctx, uint32_t handle, uint64_t tileKey)
+    {
+        // Ordem pelo id (string): é a ordem do hash do tile e não depende da ordem de carga.
+        const auto& names = ctx.geomIds.names;
+        auto& ids = ctx.tileToGeometryIds[tileKey];
+        auto pos = std::lower_bound(ids.begin(), ids.end(), handle,
+                                    [&](uint32_t a, uint32_t b) { return names[a] < names[b]; });
+        if (pos == ids.end() || *pos != handle)
+        {
+            ids.insert(pos, handle);
+            ctx.worldTileHashCache.erase(tileKey);
+        }
+
+        if (ctx.geomToTiles.size() <= handle)
+            ctx.geomToTiles.resize(static_cast<size_t>(handle) + 1);
+        auto& tiles = ctx.geomToTiles[handle];
+        auto tilePos = std::lower_bound(tiles.begin(), tiles.end(), tileKey);
+        if (tilePos == tiles.end() || *tilePos != tileKey)
+        {
+            tiles.insert(tilePos, tileKey);
+            ctx.manifestDirtyGeoms.insert(handle);
+        }
+    }
+
+    void RemoveGeometryFromWorldIndex(ExternNavmeshContext& ctx, uint32_t handle)
+    {
+        ctx.manifestDirtyGeoms.insert(handle);
+        if (handle >= ctx.geomToTiles.size())
+            return;
+
+        for (uint64_t tileKey : ctx.geomToTiles[handle])
+        {
+            auto itVec = ctx.tileToGeometryIds.find(tileKey);
+            if (itVec == ctx.tileToGeometryIds.end())
+                continue;
+
+            auto& ids = itVec->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), handle), ids.end());
+            if (ids.empty())
+                ctx.tileToGeometryIds.erase(itVec);
+            ctx.worldTileHashCache.erase(tileKey);
+        }
+        std::vector<uint64_t>().swap(ctx.geomToTiles[handle]);
+    }
+
+    void ClearWorldGeometryIndex(ExternNavmeshContext& ctx)
+    {
+        ctx.worldGeometry.clear();
+        ctx.geomIds.Clear();
+        ctx.pendingWorldGeometryQueue.clear();
+        ctx.pendingWorldGeometry.clear();
+        ctx.loadedWorldGeometry.clear();
+        ctx.tileToGeometryIds.clear();
+        ctx.geomToTiles.clear();
+        ctx.worldTileHashCache.clear();
+        // Handles foram invalidados; o próximo save reescreve o base inteiro.
+        ctx.manifestDirtyGeoms.clear();
+        ctx.manifestSavedGeoms.clear();
+        ctx.manifestFullSaveNeeded = true;
+    }
+
     uint64_t WorldHashCombine64(uint64_t seed, uint64_t v)
     {
         seed ^= v + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
@@ -285,13 +520,29 @@ namespace
         return static_cast<uint64_t>(size);
     }
 
-    std::filesystem::path GetWorldManifestPath(const ExternNavmeshContext& ctx)
+    std::filesystem::path GetWorldManifestBasePath(const ExternNavmeshContext& ctx, const char* extension)
     {
         std::string session = ctx.sessionId.empty() ? "Navmesh_01" : ctx.sessionId;
         std::filesystem::path root = ctx.cacheRoot.empty()
             ? std::filesystem::current_path()
             : std::filesystem::path(ctx.cacheRoot);
-        return root / (session + ".worldmanifest.json");
+        return root / (session + extension);
+    }
+
+    std::filesystem::path GetWorldManifestPath(const ExternNavmeshContext& ctx)
+    {
+        return GetWorldManifestBasePath(ctx, ".worldmanifest.bin");
+    }
+
+    std::filesystem::path GetWorldJournalPath(const ExternNavmeshContext& ctx)
+    {
+        return GetWorldManifestBasePath(ctx, ".worldmanifest.journal");
+    }
+
+    // Formato antigo; só lido como fallback e escrito pelo export de debug.
+    std::filesystem::path GetWorldManifestJsonPath(const ExternNavmeshContext& ctx)
+    {
+        return GetWorldManifestBasePath(ctx, ".worldmanifest.json");
     }
 
     uint64_t ComputeSettingsHash(const NavmeshGenerationSettings& s)
@@ -320,6 +571,10 @@ namespace
         h = WorldHashCombine64(h, static_cast<uint64_t>(s.tileSize));
         h = WorldHashCombine64(h, static_cast<uint64_t>(s.maxTilesOverride));
         h = WorldHashCombine64(h, static_cast<uint64_t>(s.desiredMaxPolysPerTile));
+#ifdef DT_POLYREF64
+        // Tiles gravados com dtPolyRef 32 bits têm outro layout (dtLink), não reaproveitar.
+        h = WorldHashCombine64(h, static_cast<uint64_t>(sizeof(dtPolyRef) * 8));
+#endif
         return h;
     }
 
@@ -370,21 +625,30 @@ namespace
         return true;
     }
 
-    void UpdateWorldBounds(GeometryInstance& instance)
+    void ComputeWorldBounds(const LoadedGeometry& source,
+                            const glm::vec3& position,
+                            const glm::vec3& rotation,
+                            glm::vec3& outBMin,
+                            glm::vec3& outBMax)
     {
         glm::vec3 bmin(FLT_MAX);
         glm::vec3 bmax(-FLT_MAX);
-        glm::mat3 rot = GetRotationMatrix(instance.rotation);
+        glm::mat3 rot = GetRotationMatrix(rotation);
 
-        for (const auto& v : instance.source.vertices)
+        for (const auto& v : source.vertices)
         {
-            glm::vec3 world = rot * v + instance.position;
+            glm::vec3 world = rot * v + position;
             bmin = glm::min(bmin, world);
             bmax = glm::max(bmax, world);
         }
 
-        instance.worldBMin = bmin;
-        instance.worldBMax = bmax;
+        outBMin = bmin;
+        outBMax = bmax;
+    }
+
+    void UpdateWorldBounds(GeometryInstance& instance)
+    {
+        ComputeWorldBounds(instance.source, instance.position, instance.rotation, instance.worldBMin, instance.worldBMax);
     }
 
     LoadedGeometry LoadBin(const std::filesystem::path& path)
@@ -405,6 +669,13 @@ namespace
         if (!in.good() || version != 1)
             return LoadedGeometry{};
 
+        // Arquivo com tamanho diferente do header = BIN truncado/corrompido, volta para o OBJ.
+        std::error_code ec;
+        const uint64_t headerSize = sizeof(version) + sizeof(vertexCount) + sizeof(indexCount) + sizeof(geom.bmin) + sizeof(geom.bmax);
+        const uint64_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec || fileSize != headerSize + sizeof(glm::vec3) * vertexCount + sizeof(unsigned int) * indexCount)
+            return LoadedGeometry{};
+
         geom.vertices.resize(vertexCount);
         geom.indices.resize(indexCount);
         in.read(reinterpret_cast<char*>(geom.vertices.data()), sizeof(glm::vec3) * vertexCount);
@@ -434,12 +705,15 @@ namespace
         return tv;
     }
 
+    // Grava num temporário e renomeia: jobs de carga do mundo podem salvar o mesmo BIN ao mesmo tempo.
     bool SaveGeometryToBin(const std::filesystem::path& path, const LoadedGeometry& geom)
     {
-        std::ofstream out(path, std::ios::binary);
+        std::filesystem::path tmpPath = path;
+        tmpPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
         if (!out.is_open())
         {
-            std::cout << "BIN: failed to open for write " << path << "\n";
+            std::cout << "BIN: failed to open for write " << tmpPath << "\n";
             return false;
         }
 
@@ -455,7 +729,22 @@ namespace
 
         out.write(reinterpret_cast<const char*>(geom.vertices.data()), sizeof(glm::vec3) * vertexCount);
         out.write(reinterpret_cast<const char*>(geom.indices.data()), sizeof(unsigned int) * indexCount);
+        const bool written = out.good();
+        out.close();
 
+        std::error_code ec;
+        if (!written)
+        {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            // Outro job renomeou primeiro (Windows não sobrescreve no rename).
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
         return true;
     }
 
@@ -580,7 +869,92 @@ namespace
         return {};
     }
 
-    bool CombineGeometry(const ExternNavmeshContext& ctx,
+    // Transforma a instância e guarda só os triângulos dentro do bbox (índices locais ao segmento).
+    void BuildGeometrySegment(const ExternNavmeshContext& ctx, GeometryInstance& inst)
+    {
+        inst.segmentVerts.clear();
+        inst.segmentIndices.clear();
+        inst.segmentBMin = glm::vec3(FLT_MAX);
+        inst.segmentBMax = glm::vec3(-FLT_MAX);
+        inst.segmentDirty = false;
+        if (!inst.source.Valid())
+            return;
+
+        glm::mat3 rot = GetRotationMatrix(inst.rotation);
+        std::vector<glm::vec3> transformed;
+        transformed.reserve(inst.source.vertices.size());
+        for (const auto& v : inst.source.vertices)
+            transformed.push_back(rot * v + inst.position);
+
+        if (!ctx.hasBoundingBox)
+        {
+            inst.segmentVerts = std::move(transformed);
+            inst.segmentIndices = inst.source.indices;
+            for (const auto& v : inst.segmentVerts)
+            {
+                inst.segmentBMin = glm::min(inst.segmentBMin, v);
+                inst.segmentBMax = glm::max(inst.segmentBMax, v);
+            }
+            return;
+        }
+
+        auto triOverlapsBBox = [&](const glm::vec3& triMin, const glm::vec3& triMax)
+        {
+            if (triMin.x > ctx.bboxMax.x || triMax.x < ctx.bboxMin.x) return false;
+            if (triMin.y > ctx.bboxMax.y || triMax.y < ctx.bboxMin.y) return false;
+            if (triMin.z > ctx.bboxMax.z || triMax.z < ctx.bboxMin.z) return false;
+            return true;
+        };
+
+        const unsigned int unmapped = std::numeric_limits<unsigned int>::max();
+        std::vector<unsigned int> remap(transformed.size(), unmapped);
+        auto mapVertex = [&](unsigned int localIdx) -> unsigned int
+        {
+            if (remap[localIdx] != unmapped)
+                return remap[localIdx];
+            const unsigned int newIdx = static_cast<unsigned int>(inst.segmentVerts.size());
+            remap[localIdx] = newIdx;
+            inst.segmentVerts.push_back(transformed[localIdx]);
+            inst.segmentBMin = glm::min(inst.segmentBMin, transformed[localIdx]);
+            inst.segmentBMax = glm::max(inst.segmentBMax, transformed[localIdx]);
+            return newIdx;
+        };
+
+        for (size_t i = 0; i < inst.source.indices.size(); i += 3)
+        {
+            unsigned int i0 = inst.source.indices[i + 0];
+            unsigned int i1 = inst.source.indices[i + 1];
+            unsigned int i2 = inst.source.indices[i + 2];
+
+            const glm::vec3& v0 = transformed[i0];
+            const glm::vec3& v1 = transformed[i1];
+            const glm::vec3& v2 = transformed[i2];
+            glm::vec3 triMin = glm::min(glm::min(v0, v1), v2);
+            glm::vec3 triMax = glm::max(glm::max(v0, v1), v2);
+            if (!triOverlapsBBox(triMin, triMax))
+                continue;
+
+            inst.segmentIndices.push_back(mapVertex(i0));
+            inst.segmentIndices.push_back(mapVertex(i1));
+            inst.segmentIndices.push_back(mapVertex(i2));
+        }
+    }
+
+    // O bbox do contexto mudou desde a última montagem: todos os segmentos ficam sujos.
+    void SyncGeometrySegmentsBBox(ExternNavmeshContext& ctx)
+    {
+        const bool same = ctx.segmentsHaveBBox == ctx.hasBoundingBox &&
+                          (!ctx.hasBoundingBox || (ctx.segmentsBBoxMin == ctx.bboxMin && ctx.segmentsBBoxMax == ctx.bboxMax));
+        if (same)
+            return;
+        for (auto& inst : ctx.geometries)
+            inst.segmentDirty = true;
+        ctx.segmentsHaveBBox = ctx.hasBoundingBox;
+        ctx.segmentsBBoxMin = ctx.bboxMin;
+        ctx.segmentsBBoxMax = ctx.bboxMax;
+    }
+
+    bool CombineGeometry(ExternNavmeshContext& ctx,
                          std::vector<glm::vec3>& outVerts,
                          std::vector<unsigned int>& outIndices)
     {
@@ -590,84 +964,34 @@ namespace
         if (ctx.geometries.empty())
             return false;
 
-        for (const auto& inst : ctx.geometries)
+        SyncGeometrySegmentsBBox(ctx);
+        for (auto& inst : ctx.geometries)
         {
-            if (!inst.source.Valid())
-                continue;
-
-            const unsigned int baseIndex = static_cast<unsigned int>(outVerts.size());
-            glm::mat3 rot = GetRotationMatrix(inst.rotation);
-            std::vector<glm::vec3> transformed;
-            transformed.reserve(inst.source.vertices.size());
-            for (const auto& v : inst.source.vertices)
-                transformed.push_back(rot * v + inst.position);
-
-            if (!ctx.hasBoundingBox)
+            if (inst.segmentDirty)
             {
-                outVerts.insert(outVerts.end(), transformed.begin(), transformed.end());
-                for (size_t i = 0; i < inst.source.indices.size(); i += 3)
-                {
-                    unsigned int i0 = inst.source.indices[i + 0];
-                    unsigned int i1 = inst.source.indices[i + 1];
-                    unsigned int i2 = inst.source.indices[i + 2];
-                    outIndices.push_back(baseIndex + i0);
-                    outIndices.push_back(baseIndex + i1);
-                    outIndices.push_back(baseIndex + i2);
-                }
-                continue;
+                BuildGeometrySegment(ctx, inst);
+                ctx.geometryTileIndexValid = false;
             }
+            if (inst.segmentIndices.empty())
+                continue;
 
-            auto triOverlapsBBox = [&](const glm::vec3& triMin, const glm::vec3& triMax)
-            {
-                if (triMin.x > ctx.bboxMax.x || triMax.x < ctx.bboxMin.x) return false;
-                if (triMin.y > ctx.bboxMax.y || triMax.y < ctx.bboxMin.y) return false;
-                if (triMin.z > ctx.bboxMax.z || triMax.z < ctx.bboxMin.z) return false;
-                return true;
-            };
-
-            std::unordered_map<unsigned int, unsigned int> remap;
-            remap.reserve(inst.source.vertices.size());
-            auto mapVertex = [&](unsigned int localIdx) -> unsigned int
-            {
-                auto it = remap.find(localIdx);
-                if (it != remap.end())
-                    return it->second;
-                unsigned int newIdx = static_cast<unsigned int>(outVerts.size());
-                remap.emplace(localIdx, newIdx);
-                outVerts.push_back(transformed[localIdx]);
-                return newIdx;
-            };
-
-            for (size_t i = 0; i < inst.source.indices.size(); i += 3)
-            {
-                unsigned int i0 = inst.source.indices[i + 0];
-                unsigned int i1 = inst.source.indices[i + 1];
-                unsigned int i2 = inst.source.indices[i + 2];
-
-                const glm::vec3& v0 = transformed[i0];
-                const glm::vec3& v1 = transformed[i1];
-                const glm::vec3& v2 = transformed[i2];
-                glm::vec3 triMin = glm::min(glm::min(v0, v1), v2);
-                glm::vec3 triMax = glm::max(glm::max(v0, v1), v2);
-                if (!triOverlapsBBox(triMin, triMax))
-                    continue;
-
-                unsigned int ni0 = mapVertex(i0);
-                unsigned int ni1 = mapVertex(i1);
-                unsigned int ni2 = mapVertex(i2);
-                outIndices.push_back(ni0);
-                outIndices.push_back(ni1);
-                outIndices.push_back(ni2);
-            }
+            const unsigned int baseIndex = static_cast<unsigned int>(outVerts.size());
+            outVerts.insert(outVerts.end(), inst.segmentVerts.begin(), inst.segmentVerts.end());
+            for (unsigned int idx : inst.segmentIndices)
+                outIndices.push_back(baseIndex + idx);
         }
 
         return !outVerts.empty() && !outIndices.empty();
     }
 
-
     static constexpr uint32_t RUNTIME_CACHE_MAGIC = ('G' << 24) | ('N' << 16) | ('R' << 8) | 'C';
-    static constexpr uint32_t RUNTIME_CACHE_VERSION = 1;
+    static constexpr uint32_t RUNTIME_CACHE_VERSION = 3; // 2: NavmeshGenerationSettings::compactTiles; 3: payloads alinhados por offset
+    static constexpr uint64_t RUNTIME_CACHE_PAYLOAD_ALIGN = 16;
+    static constexpr uint64_t RUNTIME_CACHE_TILEDB_ALIGN = 4096;
 
+    // v3: tabela das geometrias com offsets, depois um bloco com os vértices/índices
+    // alinhados e por fim o tile DB inteiro alinhado a página. Vértices e índices
+    // são lidos direto do offset; o tile DB é copiado por região, sem passar pela RAM.
     struct RuntimeCacheHeader
     {
         uint32_t magic = RUNTIME_CACHE_MAGIC;
@@ -678,8 +1002,32 @@ namespace
         uint8_t hasTileDb = 0;
         uint16_t reserved = 0;
         int32_t maxResidentTiles = 0;
+        uint64_t payloadOffset = 0;
+        uint64_t payloadBytes = 0;
+        uint64_t tileDbOffset = 0;
+        uint64_t tileDbBytes = 0;
     };
 
+    uint64_t AlignRuntimeCacheOffset(uint64_t offset, uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    bool PadRuntimeCacheTo(std::ofstream& out, uint64_t offset)
+    {
+        const uint64_t cur = static_cast<uint64_t>(out.tellp());
+        if (cur > offset)
+            return false;
+        static const char zeros[RUNTIME_CACHE_TILEDB_ALIGN] = {};
+        for (uint64_t left = offset - cur; left > 0;)
+        {
+            const uint64_t chunk = std::min<uint64_t>(left, sizeof(zeros));
+            out.write(zeros, static_cast<std::streamsize>(chunk));
+            left -= chunk;
+        }
+        return out.good();
+    }
+
     template <typename T>
     bool WriteValue(std::ofstream& out, const T& value)
     {
@@ -731,101 +1079,120 @@ namespace
             return false;
         }
 
-        std::vector<char> tileDbBytes;
         std::filesystem::path tileDbPath = GetSessionCachePath(ctx);
-        if (std::filesystem::exists(tileDbPath))
-        {
-            std::ifstream tileDbIn(tileDbPath, std::ios::binary);
-            if (tileDbIn.is_open())
-            {
-                tileDbIn.seekg(0, std::ios::end);
-                const auto tileDbSize = tileDbIn.tellg();
-                if (tileDbSize > 0)
-                {
-                    tileDbIn.seekg(0, std::ios::beg);
-                    tileDbBytes.resize(static_cast<size_t>(tileDbSize));
-                    tileDbIn.read(tileDbBytes.data(), tileDbBytes.size());
-                    if (!tileDbIn.good())
-                        tileDbBytes.clear();
-                }
-            }
-        }
-
-        if (tileDbBytes.empty())
+        std::error_code tileDbEc;
+        const uint64_t tileDbSize = std::filesystem::exists(tileDbPath)
+            ? static_cast<uint64_t>(std::filesystem::file_size(tileDbPath, tileDbEc))
+            : 0;
+        const bool hasTileDb = !tileDbEc && tileDbSize > 0;
+        if (!hasTileDb)
             printf("[ExternC] SaveRuntimeCacheFile: tile DB ausente/invalido; cache sera salvo sem snapshot de tiles (fallback por rebuild no load).\n");
 
         if (cacheFilePath.has_parent_path())
             std::filesystem::create_directories(cacheFilePath.parent_path());
 
-        std::ofstream out(cacheFilePath, std::ios::binary);
-        if (!out.is_open())
-            return false;
-
         RuntimeCacheHeader header{};
         header.geometryCount = static_cast<uint32_t>(ctx.geometries.size());
         header.offmeshCount = static_cast<uint32_t>(ctx.offmeshLinks.size());
         header.hasBoundingBox = ctx.hasBoundingBox ? 1 : 0;
-        header.hasTileDb = tileDbBytes.empty() ? 0 : 1;
+        header.hasTileDb = hasTileDb ? 1 : 0;
         header.maxResidentTiles = ctx.maxResidentTiles;
 
-        if (!WriteValue(out, header) ||
-            !WriteValue(out, ctx.genSettings) ||
-            !WriteValue(out, ctx.autoOffmeshParams) ||
-            !WriteValue(out, ctx.bboxMin) ||
-            !WriteValue(out, ctx.bboxMax) ||
-            !WriteValue(out, ctx.cachedExtents))
+        // Offsets relativos ao bloco de payload; cada array começa alinhado.
+        std::vector<uint64_t> payloadOffsets;
+        payloadOffsets.reserve(ctx.geometries.size());
+        uint64_t payloadBytes = 0;
+        for (const auto& geom : ctx.geometries)
         {
-            return false;
+            payloadOffsets.push_back(payloadBytes);
+            payloadBytes += sizeof(glm::vec3) * geom.source.vertices.size();
+            payloadBytes = AlignRuntimeCacheOffset(payloadBytes, RUNTIME_CACHE_PAYLOAD_ALIGN);
+            payloadBytes += sizeof(unsigned int) * geom.source.indices.size();
+            payloadBytes = AlignRuntimeCacheOffset(payloadBytes, RUNTIME_CACHE_PAYLOAD_ALIGN);
         }
 
-        for (const auto& geom : ctx.geometries)
         {
-            const uint64_t vertexCount = static_cast<uint64_t>(geom.source.vertices.size());
-            const uint64_t indexCount = static_cast<uint64_t>(geom.source.indices.size());
-            if (!WriteString(out, geom.id) ||
-                !WriteValue(out, geom.position) ||
-                !WriteValue(out, geom.rotation) ||
-                !WriteValue(out, geom.source.bmin) ||
-                !WriteValue(out, geom.source.bmax) ||
-                !WriteValue(out, vertexCount) ||
-                !WriteValue(out, indexCount))
+            std::ofstream out(cacheFilePath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return false;
+
+            if (!WriteValue(out, header) ||
+                !WriteValue(out, ctx.genSettings) ||
+                !WriteValue(out, ctx.autoOffmeshParams) ||
+                !WriteValue(out, ctx.bboxMin) ||
+                !WriteValue(out, ctx.bboxMax) ||
+                !WriteValue(out, ctx.cachedExtents))
             {
                 return false;
             }
 
-            if (vertexCount > 0)
+            for (size_t i = 0; i < ctx.geometries.size(); ++i)
             {
-                out.write(reinterpret_cast<const char*>(geom.source.vertices.data()), sizeof(glm::vec3) * vertexCount);
-                if (!out.good())
+                const auto& geom = ctx.geometries[i];
+                const uint64_t vertexCount = static_cast<uint64_t>(geom.source.vertices.size());
+                const uint64_t indexCount = static_cast<uint64_t>(geom.source.indices.size());
+                if (!WriteString(out, geom.id) ||
+                    !WriteValue(out, geom.position) ||
+                    !WriteValue(out, geom.rotation) ||
+                    !WriteValue(out, geom.source.bmin) ||
+                    !WriteValue(out, geom.source.bmax) ||
+                    !WriteValue(out, vertexCount) ||
+                    !WriteValue(out, indexCount) ||
+                    !WriteValue(out, payloadOffsets[i]))
+                {
+                    return false;
+                }
+            }
+
+            for (const auto& link : ctx.offmeshLinks)
+            {
+                if (!WriteValue(out, link))
                     return false;
             }
 
-            if (indexCount > 0)
+            header.payloadOffset = AlignRuntimeCacheOffset(static_cast<uint64_t>(out.tellp()), RUNTIME_CACHE_PAYLOAD_ALIGN);
+            header.payloadBytes = payloadBytes;
+            for (size_t i = 0; i < ctx.geometries.size(); ++i)
             {
-                out.write(reinterpret_cast<const char*>(geom.source.indices.data()), sizeof(unsigned int) * indexCount);
+                const auto& geom = ctx.geometries[i];
+                const uint64_t vertexBytes = sizeof(glm::vec3) * geom.source.vertices.size();
+                const uint64_t indexBytes = sizeof(unsigned int) * geom.source.indices.size();
+                const uint64_t vertexAt = header.payloadOffset + payloadOffsets[i];
+                const uint64_t indexAt = AlignRuntimeCacheOffset(vertexAt + vertexBytes, RUNTIME_CACHE_PAYLOAD_ALIGN);
+                if (!PadRuntimeCacheTo(out, vertexAt))
+                    return false;
+                out.write(reinterpret_cast<const char*>(geom.source.vertices.data()), static_cast<std::streamsize>(vertexBytes));
+                if (!PadRuntimeCacheTo(out, indexAt))
+                    return false;
+                out.write(reinterpret_cast<const char*>(geom.source.indices.data()), static_cast<std::streamsize>(indexBytes));
                 if (!out.good())
                     return false;
             }
-        }
 
-        for (const auto& link : ctx.offmeshLinks)
-        {
-            if (!WriteValue(out, link))
+            if (hasTileDb)
+            {
+                header.tileDbOffset = AlignRuntimeCacheOffset(header.payloadOffset + payloadBytes, RUNTIME_CACHE_TILEDB_ALIGN);
+                header.tileDbBytes = tileDbSize;
+                if (!PadRuntimeCacheTo(out, header.tileDbOffset))
+                    return false;
+            }
+
+            out.seekp(0);
+            if (!WriteValue(out, header))
                 return false;
         }
 
-        const uint64_t tileDbSizeU64 = static_cast<uint64_t>(tileDbBytes.size());
-        if (!WriteValue(out, tileDbSizeU64))
-            return false;
-        out.write(tileDbBytes.data(), tileDbBytes.size());
-        if (!out.good())
+        if (hasTileDb &&
+            !TileDbCopyRegion(tileDbPath.string().c_str(), 0, cacheFilePath.string().c_str(), header.tileDbOffset, tileDbSize))
+        {
             return false;
+        }
 
         printf("[ExternC] SaveRuntimeCacheFile: cache salvo em %s (geoms=%u links=%u tileDbBytes=%llu).\n",
                cacheFilePath.string().c_str(),
                header.geometryCount,
                header.offmeshCount,
-               static_cast<unsigned long long>(tileDbSizeU64));
+               static_cast<unsigned long long>(header.tileDbBytes));
         return true;
     }
 
@@ -860,6 +1227,8 @@ namespace
 
         if (!ctx.navData.BuildFromMesh(verts, indices, ctx.genSettings, isTiled, nullptr, true, cachePath.string().c_str(), forcedBMin, forcedBMax))
             return false;
+        ctx.navMeshEpoch++;
+        ctx.combinedGeometryStale = false;
 
         return EnsureNavQuery(ctx);
     }
@@ -898,39 +1267,28 @@ namespace
         loaded.sessionId = ctx.sessionId;
         loaded.streamingEnabled = loaded.genSettings.mode == NavmeshBuildMode::Tiled;
 
-        loaded.geometries.reserve(header.geometryCount);
-        for (uint32_t i = 0; i < header.geometryCount; ++i)
+        struct PayloadRef
         {
-            GeometryInstance geom{};
             uint64_t vertexCount = 0;
             uint64_t indexCount = 0;
+            uint64_t offset = 0;
+        };
+        std::vector<PayloadRef> payloads(header.geometryCount);
+        loaded.geometries.resize(header.geometryCount);
+        for (uint32_t i = 0; i < header.geometryCount; ++i)
+        {
+            GeometryInstance& geom = loaded.geometries[i];
             if (!ReadString(in, geom.id) ||
                 !ReadValue(in, geom.position) ||
                 !ReadValue(in, geom.rotation) ||
                 !ReadValue(in, geom.source.bmin) ||
                 !ReadValue(in, geom.source.bmax) ||
-                !ReadValue(in, vertexCount) ||
-                !ReadValue(in, indexCount))
+                !ReadValue(in, payloads[i].vertexCount) ||
+                !ReadValue(in, payloads[i].indexCount) ||
+                !ReadValue(in, payloads[i].offset))
             {
                 return false;
             }
-
-            geom.source.vertices.resize(static_cast<size_t>(vertexCount));
-            geom.source.indices.resize(static_cast<size_t>(indexCount));
-            if (vertexCount > 0)
-            {
-                in.read(reinterpret_cast<char*>(geom.source.vertices.data()), sizeof(glm::vec3) * vertexCount);
-                if (!in.good())
-                    return false;
-            }
-            if (indexCount > 0)
-            {
-                in.read(reinterpret_cast<char*>(geom.source.indices.data()), sizeof(unsigned int) * indexCount);
-                if (!in.good())
-                    return false;
-            }
-            UpdateWorldBounds(geom);
-            loaded.geometries.push_back(std::move(geom));
         }
 
         loaded.offmeshLinks.resize(header.offmeshCount);
@@ -940,16 +1298,31 @@ namespace
                 return false;
         }
 
-        uint64_t tileDbSize = 0;
-        if (!ReadValue(in, tileDbSize))
-            return false;
-        std::vector<char> tileDbBytes(static_cast<size_t>(tileDbSize));
-        if (tileDbSize > 0)
+        for (uint32_t i = 0; i < header.geometryCount; ++i)
         {
-            in.read(tileDbBytes.data(), static_cast<std::streamsize>(tileDbSize));
+            GeometryInstance& geom = loaded.geometries[i];
+            const PayloadRef& ref = payloads[i];
+            const uint64_t vertexBytes = sizeof(glm::vec3) * ref.vertexCount;
+            const uint64_t indexBytes = sizeof(unsigned int) * ref.indexCount;
+            const uint64_t indexOffset = AlignRuntimeCacheOffset(ref.offset + vertexBytes, RUNTIME_CACHE_PAYLOAD_ALIGN);
+            if (ref.offset > header.payloadBytes || vertexBytes > header.payloadBytes - ref.offset ||
+                indexOffset > header.payloadBytes || indexBytes > header.payloadBytes - indexOffset)
+            {
+                printf("[ExternC] LoadRuntimeCacheFile: payload da geometria %s fora do bloco.\n", geom.id.c_str());
+                return false;
+            }
+
+            geom.source.vertices.resize(static_cast<size_t>(ref.vertexCount));
+            geom.source.indices.resize(static_cast<size_t>(ref.indexCount));
+            in.seekg(static_cast<std::streamoff>(header.payloadOffset + ref.offset));
+            in.read(reinterpret_cast<char*>(geom.source.vertices.data()), static_cast<std::streamsize>(vertexBytes));
+            in.seekg(static_cast<std::streamoff>(header.payloadOffset + indexOffset));
+            in.read(reinterpret_cast<char*>(geom.source.indices.data()), static_cast<std::streamsize>(indexBytes));
             if (!in.good())
                 return false;
+            UpdateWorldBounds(geom);
         }
+        in.close();
 
         const float forcedMin[3] = { loaded.hasBoundingBox ? loaded.bboxMin.x : 0.0f,
                                      loaded.hasBoundingBox ? loaded.bboxMin.y : 0.0f,
@@ -982,7 +1355,7 @@ namespace
         }
 
         bool loadedFromTileDb = false;
-        if (header.hasTileDb != 0 && !tileDbBytes.empty())
+        if (header.hasTileDb != 0 && header.tileDbBytes > 0)
         {
             loaded.navData.SetOffmeshLinks(loaded.offmeshLinks);
             if (!loaded.navData.InitTiledGrid(loaded.genSettings, runtimeMin, runtimeMax))
@@ -992,19 +1365,13 @@ namespace
             if (tileDbPath.has_parent_path())
                 std::filesystem::create_directories(tileDbPath.parent_path());
 
+            std::error_code ec;
+            std::filesystem::remove(tileDbPath, ec);
+            if (!TileDbCopyRegion(cacheFilePath.string().c_str(), header.tileDbOffset,
+                                  tileDbPath.string().c_str(), 0, header.tileDbBytes))
             {
-                std::ofstream tileDbOut(tileDbPath, std::ios::binary);
-                if (!tileDbOut.is_open())
-                {
-                    printf("[ExternC] LoadRuntimeCacheFile: falha ao escrever tile DB em %s\n", tileDbPath.string().c_str());
-                    return false;
-                }
-                tileDbOut.write(tileDbBytes.data(), static_cast<std::streamsize>(tileDbBytes.size()));
-                if (!tileDbOut.good())
-                {
-                    printf("[ExternC] LoadRuntimeCacheFile: escrita incompleta do tile DB em %s\n", tileDbPath.string().c_str());
-                    return false;
-                }
+                printf("[ExternC] LoadRuntimeCacheFile: falha ao escrever tile DB em %s\n", tileDbPath.string().c_str());
+                return false;
             }
 
             int loadedCount = 0;
@@ -1038,6 +1405,13 @@ namespace
         if (ctx.navQuery)
             dtFreeNavMeshQuery(ctx.navQuery);
 
+        // Flow fields sobrevivem à troca do contexto e são refeitos no próximo uso.
+        loaded.flowFields = std::move(ctx.flowFields);
+        loaded.nextFlowFieldId = ctx.nextFlowFieldId;
+        loaded.navMeshEpoch = ctx.navMeshEpoch + 1;
+        // A geração continua subindo; a malha nova vira resync completo para os consumidores.
+        loaded.navGeneration = ctx.navGeneration;
+
         ctx = std::move(loaded);
         return true;
     }
@@ -1060,11 +1434,9 @@ namespace
         return single.parent_path() / (stem + "_tilegrid");
     }
 
-    bool SaveWorldTileManifestInternal(ExternNavmeshContext& ctx)
+    // Export de debug no formato JSON antigo; o manifesto da sessão é o binário.
+    bool ExportWorldTileManifestJsonInternal(const ExternNavmeshContext& ctx, const std::filesystem::path& manifestPath)
     {
-        if (!ctx.worldTileStreamingEnabled)
-            return false;
-
         nlohmann::json j;
         j["version"] = 2;
         j["cacheRoot"] = ctx.cacheRoot;
@@ -1092,8 +1464,8 @@ namespace
             {"desiredMaxPolysPerTile", ctx.genSettings.desiredMaxPolysPerTile}
         };
 
-        auto isPersistentManifestGeom = [&](const std::string& id) -> bool {
-            auto it = ctx.worldGeometry.find(id);
+        auto isPersistentManifestGeom = [&](uint32_t handle) -> bool {
+            auto it = ctx.worldGeometry.find(handle);
             if (it == ctx.worldGeometry.end())
                 return false;
             const auto& r = it->second;
@@ -1133,10 +1505,10 @@ namespace
         }
 
         std::vector<std::string> pendingPersistentGeoms;
-        for (const auto& id : ctx.pendingWorldGeometryQueue)
+        for (uint32_t handle : ctx.pendingWorldGeometryQueue)
         {
-            if (isPersistentManifestGeom(id))
-                pendingPersistentGeoms.push_back(id);
+            if (isPersistentManifestGeom(handle))
+                pendingPersistentGeoms.push_back(ctx.geomIds.names[handle]);
         }
         j["pendingWorldGeometryQueue"] = std::move(pendingPersistentGeoms);
 
@@ -1149,7 +1521,7 @@ namespace
         j["dirtyWorldTiles"] = std::move(dirtyPersistentTiles);
 
         std::vector<uint64_t> pendingPersistentTiles;
-        for (uint64_t key : ctx.pendingTileBuildQueue)
+        for (uint64_t key : ctx.pendingTileBuildQueue.Ordered())
         {
             if (persistentTileKeys.find(key) != persistentTileKeys.end())
                 pendingPersistentTiles.push_back(key);
@@ -1182,10 +1554,10 @@ namespace
         for (const auto& kv : ctx.tileToGeometryIds)
         {
             std::vector<std::string> filtered;
-            for (const auto& id : kv.second)
+            for (uint32_t handle : kv.second)
             {
-                if (isPersistentManifestGeom(id))
-                    filtered.push_back(id);
+                if (isPersistentManifestGeom(handle))
+                    filtered.push_back(ctx.geomIds.names[handle]);
             }
             if (!filtered.empty())
                 tileToGeom[std::to_string(kv.first)] = std::move(filtered);
@@ -1197,7 +1569,6 @@ namespace
             allIndexedTileKeys.push_back(kv.first);
         j["allIndexedTileKeys"] = std::move(allIndexedTileKeys);
 
-        const std::filesystem::path manifestPath = GetWorldManifestPath(ctx);
         if (manifestPath.has_parent_path())
             std::filesystem::create_directories(manifestPath.parent_path());
         std::ofstream out(manifestPath);
@@ -1207,40 +1578,265 @@ namespace
         if (!out.good())
             return false;
 
-        printf("[WorldTile] Save manifest: persistentGeoms=%zu totalGeoms=%zu dirtySaved=%zu pendingSaved=%zu tileToGeomSaved=%zu path=%s\n",
+        printf("[WorldTile] Export manifest JSON: persistentGeoms=%zu totalGeoms=%zu dirtySaved=%zu pendingSaved=%zu tileToGeomSaved=%zu path=%s\n",
                persistentGeoms, ctx.worldGeometry.size(), j["dirtyWorldTiles"].size(), j["pendingTileBuildQueue"].size(), j["tileToGeometryIds"].size(), manifestPath.string().c_str());
         return true;
     }
 
-    bool EnsureDbIndexLoaded(ExternNavmeshContext& ctx, const std::filesystem::path& cachePath)
+    bool IsPersistentWorldGeometry(const ExternNavmeshContext& ctx, uint32_t handle)
     {
-        if (!ctx.navData.GetNavMesh())
+        auto it = ctx.worldGeometry.find(handle);
+        if (it == ctx.worldGeometry.end())
             return false;
+        const auto& r = it->second;
+        return (r.flags & WORLD_GEOM_PERSISTENT) != 0 &&
+               (r.flags & WORLD_GEOM_DYNAMIC) == 0;
+    }
 
-        if (ctx.useTileCacheGridDB)
+    bool IsPersistentWorldTile(const ExternNavmeshContext& ctx, uint64_t tileKey)
+    {
+        auto it = ctx.tileToGeometryIds.find(tileKey);
+        if (it == ctx.tileToGeometryIds.end())
+            return false;
+        for (uint32_t handle : it->second)
         {
-            const std::filesystem::path gridRoot = GetSessionGridCacheRoot(ctx);
-            const std::filesystem::path tilesDir = gridRoot / "tiles";
-            if (!std::filesystem::exists(tilesDir))
-            {
-                ctx.dbIndexCache.clear();
-                ctx.dbIndexLoaded = false;
-                ctx.dbMTime = {};
-                return false;
-            }
+            if (IsPersistentWorldGeometry(ctx, handle))
+                return true;
+        }
+        return false;
+    }
 
-            ctx.dbIndexCache.clear();
-            if (!TileGridDbLoadIndex(gridRoot.string().c_str(), ctx.navData.GetNavMesh(), ctx.dbIndexCache))
+    void FillWorldManifestGeom(const ExternNavmeshContext& ctx, const ExternNavmeshContext::WorldGeomRecord& rec, WorldManifestGeom& out)
+    {
+        out.id = rec.id;
+        out.path = rec.path;
+        out.groupId = rec.groupId;
+        std::memcpy(out.position, &rec.position.x, sizeof(out.position));
+        std::memcpy(out.rotation, &rec.rotation.x, sizeof(out.rotation));
+        std::memcpy(out.worldBMin, &rec.worldBMin.x, sizeof(out.worldBMin));
+        std::memcpy(out.worldBMax, &rec.worldBMax.x, sizeof(out.worldBMax));
+        out.geomHash = rec.geomHash;
+        out.fileMTime = rec.fileMTime;
+        out.fileSize = rec.fileSize;
+        out.flags = rec.flags;
+        out.preferBin = rec.preferBin;
+        out.indexed = rec.indexed;
+        out.pending = rec.handle < ctx.pendingWorldGeometry.size() && ctx.pendingWorldGeometry[rec.handle] != 0;
+        out.tileKeys = GetWorldGeometryTiles(ctx, rec.handle);
+    }
+
+    // Estado dos tiles que tocam alguma geometria persistente, no formato do manifesto.
+    std::unordered_map<uint64_t, WorldManifestTile> CollectWorldManifestTiles(const ExternNavmeshContext& ctx)
+    {
+        std::unordered_map<uint64_t, WorldManifestTile> tiles;
+        auto mark = [&](uint64_t key, uint8_t bit) -> WorldManifestTile* {
+            auto it = tiles.find(key);
+            if (it == tiles.end())
             {
-                ctx.dbIndexLoaded = false;
-                return false;
+                if (!IsPersistentWorldTile(ctx, key))
+                    return nullptr;
+                it = tiles.emplace(key, WorldManifestTile{}).first;
+                it->second.key = key;
             }
-            ctx.dbIndexLoaded = true;
-            ctx.dbMTime = {};
-            return true;
-        }
-
-        if (!std::filesystem::exists(cachePath))
+            it->second.bits |= bit;
+            return &it->second;
+        };
+        for (uint64_t key : ctx.dirtyWorldTiles)
+            mark(key, WORLD_TILE_DIRTY);
+        for (uint64_t key : ctx.pendingTileBuildQueue.Ordered())
+            mark(key, WORLD_TILE_PENDING_BUILD);
+        for (uint64_t key : ctx.emptyWorldTiles)
+            mark(key, WORLD_TILE_EMPTY);
+        for (uint64_t key : ctx.failedWorldTiles)
+            mark(key, WORLD_TILE_FAILED);
+        for (const auto& kv : ctx.emptyWorldTileHashes)
+        {
+            if (WorldManifestTile* t = mark(kv.first, WORLD_TILE_EMPTY_HASH))
+                t->emptyHash = kv.second;
+        }
+        return tiles;
+    }
+
+    WorldManifest BuildWorldManifestSnapshot(const ExternNavmeshContext& ctx,
+                                             const std::unordered_map<uint64_t, WorldManifestTile>& tiles)
+    {
+        WorldManifest manifest;
+        manifest.settingsHash = ComputeSettingsHash(ctx.genSettings);
+        manifest.lastSeq = ctx.manifestSeq;
+        std::memcpy(manifest.bboxMin, &ctx.bboxMin.x, sizeof(manifest.bboxMin));
+        std::memcpy(manifest.bboxMax, &ctx.bboxMax.x, sizeof(manifest.bboxMax));
+
+        manifest.geometries.reserve(ctx.worldGeometry.size());
+        for (const auto& kv : ctx.worldGeometry)
+        {
+            if (!IsPersistentWorldGeometry(ctx, kv.first))
+                continue;
+            manifest.geometries.emplace_back();
+            FillWorldManifestGeom(ctx, kv.second, manifest.geometries.back());
+        }
+        std::sort(manifest.geometries.begin(), manifest.geometries.end(),
+                  [](const WorldManifestGeom& a, const WorldManifestGeom& b) { return a.id < b.id; });
+
+        manifest.tiles.reserve(tiles.size());
+        for (const auto& kv : tiles)
+            manifest.tiles.push_back(kv.second);
+        std::sort(manifest.tiles.begin(), manifest.tiles.end(),
+                  [](const WorldManifestTile& a, const WorldManifestTile& b) { return a.key < b.key; });
+        return manifest;
+    }
+
+    // wait=false só colhe uma compactação que já terminou.
+    void PollWorldManifestCompaction(ExternNavmeshContext& ctx, bool wait)
+    {
+        if (!ctx.manifestCompaction.valid())
+            return;
+        if (!wait && ctx.manifestCompaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        if (!ctx.manifestCompaction.get())
+        {
+            printf("[WorldTile] Compactacao do manifesto falhou; journal mantido. path=%s\n",
+                   ctx.manifestCompactJournalPath.string().c_str());
+            return;
+        }
+        WorldJournalDropThrough(ctx.manifestCompactJournalPath, ctx.manifestCompactSeq, &ctx.manifestJournalBytes);
+        std::error_code ec;
+        const auto baseBytes = std::filesystem::file_size(GetWorldManifestPath(ctx), ec);
+        if (!ec)
+            ctx.manifestBaseBytes = static_cast<uint64_t>(baseBytes);
+    }
+
+    bool SaveWorldTileManifestInternal(ExternNavmeshContext& ctx)
+    {
+        if (!ctx.worldTileStreamingEnabled)
+            return false;
+
+        PollWorldManifestCompaction(ctx, false);
+
+        const std::filesystem::path manifestPath = GetWorldManifestPath(ctx);
+        const std::filesystem::path journalPath = GetWorldJournalPath(ctx);
+        auto tiles = CollectWorldManifestTiles(ctx);
+
+        if (ctx.manifestFullSaveNeeded || !std::filesystem::exists(manifestPath) || !std::filesystem::exists(journalPath))
+        {
+            PollWorldManifestCompaction(ctx, true);
+            if (manifestPath.has_parent_path())
+                std::filesystem::create_directories(manifestPath.parent_path());
+
+            const WorldManifest snapshot = BuildWorldManifestSnapshot(ctx, tiles);
+            if (!WorldManifestWrite(manifestPath, snapshot) || !WorldJournalReset(journalPath))
+            {
+                printf("[WorldTile] Save manifest: falha ao gravar %s\n", manifestPath.string().c_str());
+                return false;
+            }
+
+            ctx.manifestSavedGeoms.clear();
+            for (const auto& kv : ctx.worldGeometry)
+            {
+                if (IsPersistentWorldGeometry(ctx, kv.first))
+                    ctx.manifestSavedGeoms.insert(kv.first);
+            }
+            ctx.manifestSavedTiles = std::move(tiles);
+            ctx.manifestDirtyGeoms.clear();
+            ctx.manifestFullSaveNeeded = false;
+            std::error_code ec;
+            ctx.manifestBaseBytes = static_cast<uint64_t>(std::filesystem::file_size(manifestPath, ec));
+            ctx.manifestJournalBytes = static_cast<uint64_t>(std::filesystem::file_size(journalPath, ec));
+            printf("[WorldTile] Save manifest (base): persistentGeoms=%zu totalGeoms=%zu tilesSaved=%zu bytes=%llu path=%s\n",
+                   snapshot.geometries.size(), ctx.worldGeometry.size(), snapshot.tiles.size(),
+                   static_cast<unsigned long long>(ctx.manifestBaseBytes), manifestPath.string().c_str());
+            return true;
+        }
+
+        WorldManifestDelta delta;
+        delta.seq = ctx.manifestSeq + 1;
+        for (uint32_t handle : ctx.manifestDirtyGeoms)
+        {
+            if (IsPersistentWorldGeometry(ctx, handle))
+            {
+                delta.upserts.emplace_back();
+                FillWorldManifestGeom(ctx, ctx.worldGeometry.at(handle), delta.upserts.back());
+                ctx.manifestSavedGeoms.insert(handle);
+            }
+            else if (ctx.manifestSavedGeoms.erase(handle) != 0)
+            {
+                delta.removals.push_back(ctx.geomIds.names[handle]);
+            }
+        }
+        for (const auto& kv : tiles)
+        {
+            auto itSaved = ctx.manifestSavedTiles.find(kv.first);
+            if (itSaved == ctx.manifestSavedTiles.end() ||
+                itSaved->second.bits != kv.second.bits ||
+                itSaved->second.emptyHash != kv.second.emptyHash)
+                delta.tiles.push_back(kv.second);
+        }
+        for (const auto& kv : ctx.manifestSavedTiles)
+        {
+            if (tiles.find(kv.first) == tiles.end())
+                delta.tiles.push_back(WorldManifestTile{ kv.first, 0, 0 });
+        }
+        ctx.manifestDirtyGeoms.clear();
+
+        if (delta.upserts.empty() && delta.removals.empty() && delta.tiles.empty())
+            return true;
+
+        if (!WorldJournalAppend(journalPath, delta, &ctx.manifestJournalBytes))
+        {
+            printf("[WorldTile] Save manifest: falha no journal %s, proximo save grava o base.\n", journalPath.string().c_str());
+            ctx.manifestFullSaveNeeded = true;
+            return false;
+        }
+        ctx.manifestSeq = delta.seq;
+        ctx.manifestSavedTiles = std::move(tiles);
+
+        // Journal passou da metade do base: reescreve o base em background e depois corta o journal.
+        const uint64_t compactThreshold = std::max<uint64_t>(kWorldJournalCompactMinBytes, ctx.manifestBaseBytes / 2);
+        if (!ctx.manifestCompaction.valid() && ctx.manifestJournalBytes > compactThreshold)
+        {
+            WorldManifest snapshot = BuildWorldManifestSnapshot(ctx, ctx.manifestSavedTiles);
+            ctx.manifestCompactSeq = ctx.manifestSeq;
+            ctx.manifestCompactJournalPath = journalPath;
+            ctx.manifestCompaction = std::async(std::launch::async, [manifestPath, snapshot = std::move(snapshot)]() {
+                return WorldManifestWrite(manifestPath, snapshot);
+            });
+        }
+
+        printf("[WorldTile] Save manifest (journal): seq=%llu upserts=%zu removals=%zu tiles=%zu journalBytes=%llu\n",
+               static_cast<unsigned long long>(delta.seq), delta.upserts.size(), delta.removals.size(), delta.tiles.size(),
+               static_cast<unsigned long long>(ctx.manifestJournalBytes));
+        return true;
+    }
+
+    bool EnsureDbIndexLoaded(ExternNavmeshContext& ctx, const std::filesystem::path& cachePath)
+    {
+        if (!ctx.navData.GetNavMesh())
+            return false;
+
+        if (ctx.useTileCacheGridDB)
+        {
+            const std::filesystem::path gridRoot = GetSessionGridCacheRoot(ctx);
+            const std::filesystem::path tilesDir = gridRoot / "tiles";
+            if (!std::filesystem::exists(tilesDir))
+            {
+                ctx.dbIndexCache.clear();
+                ctx.dbIndexLoaded = false;
+                ctx.dbMTime = {};
+                return false;
+            }
+
+            ctx.dbIndexCache.clear();
+            if (!TileGridDbLoadIndex(gridRoot.string().c_str(), ctx.navData.GetNavMesh(), ctx.dbIndexCache))
+            {
+                ctx.dbIndexLoaded = false;
+                return false;
+            }
+            ctx.dbIndexLoaded = true;
+            ctx.dbMTime = {};
+            return true;
+        }
+
+        if (!std::filesystem::exists(cachePath))
         {
             ctx.dbIndexCache.clear();
             ctx.dbIndexLoaded = false;
@@ -1267,25 +1863,38 @@ namespace
 
     uint64_t ComputeWorldTileHash(ExternNavmeshContext& ctx, int tx, int ty)
     {
-        uint64_t h = ComputeSettingsHash(ctx.genSettings);
-        h = WorldHashCombine64(h, static_cast<uint64_t>(static_cast<uint32_t>(tx)));
-        h = WorldHashCombine64(h, static_cast<uint64_t>(static_cast<uint32_t>(ty)));
+        const uint64_t settingsHash = ComputeSettingsHash(ctx.genSettings);
+        if (settingsHash != ctx.worldTileHashSettings)
+        {
+            ctx.worldTileHashCache.clear();
+            ctx.worldTileHashSettings = settingsHash;
+        }
 
+        // A parte das geometrias fica em cache até o conjunto do tile mudar; os offmesh links são poucos e entram sempre.
         const uint64_t key = MakeTileKey(tx, ty);
-        auto it = ctx.tileToGeometryIds.find(key);
-        if (it != ctx.tileToGeometryIds.end())
+        uint64_t h = 0;
+        auto itCached = ctx.worldTileHashCache.find(key);
+        if (itCached != ctx.worldTileHashCache.end())
         {
-            std::vector<std::string> ids = it->second;
-            std::sort(ids.begin(), ids.end());
-            for (const std::string& id : ids)
+            h = itCached->second;
+        }
+        else
+        {
+            h = WorldHashCombine64(settingsHash, static_cast<uint64_t>(static_cast<uint32_t>(tx)));
+            h = WorldHashCombine64(h, static_cast<uint64_t>(static_cast<uint32_t>(ty)));
+            auto it = ctx.tileToGeometryIds.find(key);
+            if (it != ctx.tileToGeometryIds.end())
             {
-                auto gIt = ctx.worldGeometry.find(id);
-                if (gIt == ctx.worldGeometry.end())
-                    continue;
-                const auto& rec = gIt->second;
-                h = WorldHashCombine64(h, rec.geomHash);
-                h = WorldHashCombine64(h, std::hash<std::string>{}(rec.id));
+                for (uint32_t handle : it->second)
+                {
+                    auto gIt = ctx.worldGeometry.find(handle);
+                    if (gIt == ctx.worldGeometry.end())
+                        continue;
+                    h = WorldHashCombine64(h, gIt->second.geomHash);
+                    h = WorldHashCombine64(h, ctx.geomIds.nameHashes[handle]);
+                }
             }
+            ctx.worldTileHashCache.emplace(key, h);
         }
 
         for (const auto& link : ctx.offmeshLinks)
@@ -1309,55 +1918,179 @@ namespace
         return h;
     }
 
-    bool LoadWorldTileManifestInternal(ExternNavmeshContext& ctx)
+    // Converte o manifesto JSON antigo (version 2) para a mesma estrutura do binário.
+    bool ReadWorldManifestJson(const std::filesystem::path& manifestPath, WorldManifest& out)
     {
-        if (!ctx.worldTileStreamingEnabled)
-            return false;
-        const std::filesystem::path manifestPath = GetWorldManifestPath(ctx);
-        if (!std::filesystem::exists(manifestPath))
-            return false;
-
-        nlohmann::json j;
+        out = {};
         try
         {
+            nlohmann::json j;
             std::ifstream in(manifestPath);
             if (!in.is_open())
                 return false;
             in >> j;
+
+            const auto bboxMinJson = j.value("bboxMin", nlohmann::json::array());
+            const auto bboxMaxJson = j.value("bboxMax", nlohmann::json::array());
+            if (bboxMinJson.size() != 3 || bboxMaxJson.size() != 3)
+                return false;
+            out.settingsHash = j.value("settingsHash", 0ull);
+            for (int i = 0; i < 3; ++i)
+            {
+                out.bboxMin[i] = bboxMinJson[i].get<float>();
+                out.bboxMax[i] = bboxMaxJson[i].get<float>();
+            }
+
+            std::unordered_map<std::string, size_t> geomIndex;
+            const auto geoms = j.value("geometries", nlohmann::json::array());
+            for (const auto& g : geoms)
+            {
+                WorldManifestGeom geom;
+                geom.id = g.value("customID", "");
+                geom.path = g.value("path", "");
+                geom.preferBin = g.value("preferBIN", false);
+                geom.flags = g.value("flags", static_cast<uint32_t>(WORLD_GEOM_PERSISTENT));
+                geom.groupId = g.value("groupId", std::string("default"));
+                const auto p = g.value("position", nlohmann::json::array());
+                const auto r = g.value("rotation", nlohmann::json::array());
+                const auto bmin = g.value("worldBMin", nlohmann::json::array());
+                const auto bmax = g.value("worldBMax", nlohmann::json::array());
+                if (geom.id.empty() || p.size() != 3 || r.size() != 3 || bmin.size() != 3 || bmax.size() != 3)
+                    continue;
+                for (int i = 0; i < 3; ++i)
+                {
+                    geom.position[i] = p[i].get<float>();
+                    geom.rotation[i] = r[i].get<float>();
+                    geom.worldBMin[i] = bmin[i].get<float>();
+                    geom.worldBMax[i] = bmax[i].get<float>();
+                }
+                geom.geomHash = g.value("geomHash", 0ull);
+                geom.fileMTime = g.value("fileMTime", 0ull);
+                geom.fileSize = g.value("fileSize", 0ull);
+                geom.indexed = g.value("indexed", false);
+                geom.tileKeys = g.value("tileKeys", std::vector<uint64_t>{});
+                geomIndex.emplace(geom.id, out.geometries.size());
+                out.geometries.push_back(std::move(geom));
+            }
+
+            if (j.contains("tileToGeometryIds") && j["tileToGeometryIds"].is_object())
+            {
+                for (auto& geom : out.geometries)
+                    geom.tileKeys.clear();
+                const auto& tileToGeomJson = j["tileToGeometryIds"];
+                for (auto it = tileToGeomJson.begin(); it != tileToGeomJson.end(); ++it)
+                {
+                    if (!it.value().is_array())
+                        continue;
+                    const uint64_t tileKey = std::stoull(it.key());
+                    for (const auto& idJson : it.value())
+                    {
+                        if (!idJson.is_string())
+                            continue;
+                        auto itGeom = geomIndex.find(idJson.get<std::string>());
+                        if (itGeom != geomIndex.end())
+                            out.geometries[itGeom->second].tileKeys.push_back(tileKey);
+                    }
+                }
+            }
+
+            for (const auto& id : j.value("pendingWorldGeometryQueue", std::vector<std::string>{}))
+            {
+                auto itGeom = geomIndex.find(id);
+                if (itGeom != geomIndex.end())
+                    out.geometries[itGeom->second].pending = true;
+            }
+
+            // Na ordem do JSON, para a fila de build voltar na mesma ordem.
+            std::unordered_map<uint64_t, size_t> tileIndex;
+            auto mark = [&](uint64_t key, uint8_t bit) -> WorldManifestTile& {
+                auto it = tileIndex.find(key);
+                if (it == tileIndex.end())
+                {
+                    it = tileIndex.emplace(key, out.tiles.size()).first;
+                    out.tiles.push_back(WorldManifestTile{ key, 0, 0 });
+                }
+                WorldManifestTile& t = out.tiles[it->second];
+                t.bits |= bit;
+                return t;
+            };
+            for (uint64_t key : j.value("pendingTileBuildQueue", std::vector<uint64_t>{}))
+                mark(key, WORLD_TILE_PENDING_BUILD);
+            for (uint64_t key : j.value("dirtyWorldTiles", std::vector<uint64_t>{}))
+                mark(key, WORLD_TILE_DIRTY);
+            for (uint64_t key : j.value("emptyWorldTiles", std::vector<uint64_t>{}))
+                mark(key, WORLD_TILE_EMPTY);
+            for (uint64_t key : j.value("failedWorldTiles", std::vector<uint64_t>{}))
+                mark(key, WORLD_TILE_FAILED);
+            const auto emptyHashesJson = j.value("emptyWorldTileHashes", nlohmann::json::object());
+            if (emptyHashesJson.is_object())
+            {
+                for (auto it = emptyHashesJson.begin(); it != emptyHashesJson.end(); ++it)
+                    mark(std::stoull(it.key()), WORLD_TILE_EMPTY_HASH).emptyHash = it.value().get<uint64_t>();
+            }
         }
         catch (...)
         {
             printf("[WorldTile] Load manifest: arquivo invalido %s\n", manifestPath.string().c_str());
+            out = {};
+            return false;
+        }
+        return true;
+    }
+
+    bool LoadWorldTileManifestInternal(ExternNavmeshContext& ctx)
+    {
+        if (!ctx.worldTileStreamingEnabled)
+            return false;
+
+        PollWorldManifestCompaction(ctx, true);
+
+        const std::filesystem::path manifestPath = GetWorldManifestPath(ctx);
+        const std::filesystem::path journalPath = GetWorldJournalPath(ctx);
+        const std::filesystem::path jsonPath = GetWorldManifestJsonPath(ctx);
+        WorldManifest manifest;
+        bool journalOk = false;
+        uint64_t journalBytes = 0;
+        if (std::filesystem::exists(manifestPath))
+        {
+            if (!WorldManifestRead(manifestPath, manifest))
+            {
+                printf("[WorldTile] Load manifest: arquivo invalido %s\n", manifestPath.string().c_str());
+                return false;
+            }
+            journalOk = WorldJournalReplay(journalPath, manifest, &journalBytes);
+        }
+        else if (std::filesystem::exists(jsonPath))
+        {
+            if (!ReadWorldManifestJson(jsonPath, manifest))
+            {
+                printf("[WorldTile] Load manifest: incompativel (settings/bounds). iniciando nova sessao.\n");
+                return false;
+            }
+        }
+        else
+        {
             return false;
         }
 
-        const uint64_t settingsHashSaved = j.value("settingsHash", 0ull);
         const uint64_t settingsHashCurrent = ComputeSettingsHash(ctx.genSettings);
-        const auto bboxMinJson = j.value("bboxMin", nlohmann::json::array());
-        const auto bboxMaxJson = j.value("bboxMax", nlohmann::json::array());
-        if (settingsHashSaved != settingsHashCurrent ||
-            bboxMinJson.size() != 3 || bboxMaxJson.size() != 3)
+        if (manifest.settingsHash != settingsHashCurrent)
         {
             printf("[WorldTile] Load manifest: incompativel (settings/bounds). iniciando nova sessao.\n");
             return false;
         }
 
-        const glm::vec3 savedMin(bboxMinJson[0].get<float>(), bboxMinJson[1].get<float>(), bboxMinJson[2].get<float>());
-        const glm::vec3 savedMax(bboxMaxJson[0].get<float>(), bboxMaxJson[1].get<float>(), bboxMaxJson[2].get<float>());
+        const glm::vec3 savedMin(manifest.bboxMin[0], manifest.bboxMin[1], manifest.bboxMin[2]);
+        const glm::vec3 savedMax(manifest.bboxMax[0], manifest.bboxMax[1], manifest.bboxMax[2]);
         if (glm::distance(savedMin, ctx.bboxMin) > 0.01f || glm::distance(savedMax, ctx.bboxMax) > 0.01f)
         {
             printf("[WorldTile] Load manifest: bounds diferentes, ignorando manifesto.\n");
             return false;
         }
 
-        ctx.worldGeometry.clear();
-        ctx.tileToGeometryIds.clear();
-        ctx.geomToTiles.clear();
+        ClearWorldGeometryIndex(ctx);
         ctx.dirtyWorldTiles.clear();
-        ctx.pendingTileBuildQueue.clear();
-        ctx.pendingTileBuildSet.clear();
-        ctx.pendingWorldGeometryQueue.clear();
-        ctx.pendingWorldGeometrySet.clear();
+        ctx.pendingTileBuildQueue.Clear();
         ctx.emptyWorldTiles.clear();
         ctx.emptyWorldTileHashes.clear();
         ctx.failedWorldTiles.clear();
@@ -1365,42 +2098,37 @@ namespace
         int changed = 0;
         int removed = 0;
         int loadedCount = 0;
-        std::unordered_set<std::string> disabledGeometries;
-        const auto geoms = j.value("geometries", nlohmann::json::array());
-        const bool hasTileToGeometryIds = j.contains("tileToGeometryIds") && j["tileToGeometryIds"].is_object();
-        int indexedGeometries = 0;
-        for (const auto& g : geoms)
+        std::unordered_set<uint32_t> savedHandles;
+        std::unordered_set<uint32_t> changedHandles;
+        for (const WorldManifestGeom& g : manifest.geometries)
         {
-            ExternNavmeshContext::WorldGeomRecord rec{};
-            rec.id = g.value("customID", "");
-            rec.path = g.value("path", "");
-            rec.preferBin = g.value("preferBIN", false);
-            rec.flags = g.value("flags", static_cast<uint32_t>(WORLD_GEOM_PERSISTENT));
-            rec.groupId = g.value("groupId", std::string("default"));
-            const auto p = g.value("position", nlohmann::json::array());
-            const auto r = g.value("rotation", nlohmann::json::array());
-            const auto bmin = g.value("worldBMin", nlohmann::json::array());
-            const auto bmax = g.value("worldBMax", nlohmann::json::array());
-            if (rec.id.empty() || p.size() != 3 || r.size() != 3 || bmin.size() != 3 || bmax.size() != 3)
+            if ((g.flags & WORLD_GEOM_DYNAMIC) != 0)
                 continue;
-            if ((rec.flags & WORLD_GEOM_DYNAMIC) != 0)
+            if ((g.flags & WORLD_GEOM_PERSISTENT) == 0)
                 continue;
-            if ((rec.flags & WORLD_GEOM_PERSISTENT) == 0)
-                continue;
-            rec.position = glm::vec3(p[0].get<float>(), p[1].get<float>(), p[2].get<float>());
-            rec.rotation = glm::vec3(r[0].get<float>(), r[1].get<float>(), r[2].get<float>());
-            rec.worldBMin = glm::vec3(bmin[0].get<float>(), bmin[1].get<float>(), bmin[2].get<float>());
-            rec.worldBMax = glm::vec3(bmax[0].get<float>(), bmax[1].get<float>(), bmax[2].get<float>());
-            rec.geomHash = g.value("geomHash", 0ull);
-            rec.fileMTime = g.value("fileMTime", 0ull);
-            rec.fileSize = g.value("fileSize", 0ull);
+
+            ExternNavmeshContext::WorldGeomRecord rec{};
+            rec.id = g.id;
+            rec.path = g.path;
+            rec.preferBin = g.preferBin;
+            rec.flags = g.flags;
+            rec.groupId = g.groupId;
+            rec.position = glm::vec3(g.position[0], g.position[1], g.position[2]);
+            rec.rotation = glm::vec3(g.rotation[0], g.rotation[1], g.rotation[2]);
+            rec.worldBMin = glm::vec3(g.worldBMin[0], g.worldBMin[1], g.worldBMin[2]);
+            rec.worldBMax = glm::vec3(g.worldBMax[0], g.worldBMax[1], g.worldBMax[2]);
+            rec.geomHash = g.geomHash;
+            rec.fileMTime = g.fileMTime;
+            rec.fileSize = g.fileSize;
             rec.loaded = false;
-            rec.indexed = g.value("indexed", false);
-            rec.touchedTileKeys = g.value("tileKeys", std::vector<uint64_t>{});
+            rec.indexed = g.indexed;
+            rec.touchedTileKeys = g.tileKeys;
+            rec.handle = ctx.geomIds.Intern(rec.id);
+            savedHandles.insert(rec.handle);
 
             if (!std::filesystem::exists(rec.path))
             {
-                disabledGeometries.insert(rec.id);
+                changedHandles.insert(rec.handle);
                 ++removed;
                 for (uint64_t k : rec.touchedTileKeys)
                 {
@@ -1417,7 +2145,7 @@ namespace
                 {
                     printf("[WorldTile] Load manifest: desabilitando geometria invalida id=%s path=%s (arquivo existe, LoadGeometry falhou)\n",
                            rec.id.c_str(), rec.path.c_str());
-                    disabledGeometries.insert(rec.id);
+                    changedHandles.insert(rec.handle);
                     ++removed;
                     for (uint64_t k : rec.touchedTileKeys)
                     {
@@ -1427,94 +2155,55 @@ namespace
                     continue;
                 }
                 ++changed;
+                changedHandles.insert(rec.handle);
                 for (uint64_t k : rec.touchedTileKeys)
                 {
                     ctx.dirtyWorldTiles.insert(k);
                     ctx.dirtyWorldOffmeshTiles.insert(k);
                 }
-                if (ctx.pendingWorldGeometrySet.insert(rec.id).second)
-                    ctx.pendingWorldGeometryQueue.push_back(rec.id);
+                QueueWorldGeometryHandle(ctx, rec.handle);
             }
             else
             {
                 ++loadedCount;
-                if (!hasTileToGeometryIds)
-                {
-                    for (uint64_t k : rec.touchedTileKeys)
-                    {
-                        auto& vec = ctx.tileToGeometryIds[k];
-                        if (std::find(vec.begin(), vec.end(), rec.id) == vec.end())
-                            vec.push_back(rec.id);
-                        ctx.geomToTiles[rec.id].insert(k);
-                    }
-                    if (rec.indexed)
-                        ++indexedGeometries;
-                }
             }
 
-            ctx.worldGeometry[rec.id] = std::move(rec);
+            for (uint64_t k : rec.touchedTileKeys)
+                AddGeometryToWorldTile(ctx, rec.handle, k);
+            const uint32_t handle = rec.handle;
+            ctx.worldGeometry[handle] = std::move(rec);
         }
 
-
-        if (hasTileToGeometryIds)
+        int indexedGeometries = 0;
+        for (auto& kv : ctx.worldGeometry)
         {
-            const auto& tileToGeomJson = j["tileToGeometryIds"];
-            for (auto it = tileToGeomJson.begin(); it != tileToGeomJson.end(); ++it)
-            {
-                const uint64_t tileKey = std::stoull(it.key());
-                if (!it.value().is_array())
-                    continue;
-                auto& vec = ctx.tileToGeometryIds[tileKey];
-                for (const auto& idJson : it.value())
-                {
-                    if (!idJson.is_string())
-                        continue;
-                    const std::string geomId = idJson.get<std::string>();
-                    if (ctx.worldGeometry.find(geomId) == ctx.worldGeometry.end())
-                        continue;
-                    if (std::find(vec.begin(), vec.end(), geomId) == vec.end())
-                        vec.push_back(geomId);
-                    ctx.geomToTiles[geomId].insert(tileKey);
-                }
-            }
-
-            for (auto& kv : ctx.worldGeometry)
+            const auto& geomTiles = GetWorldGeometryTiles(ctx, kv.first);
+            kv.second.touchedTileKeys.assign(geomTiles.begin(), geomTiles.end());
+            if (!kv.second.touchedTileKeys.empty())
             {
-                auto itGeomTiles = ctx.geomToTiles.find(kv.first);
-                kv.second.touchedTileKeys.clear();
-                if (itGeomTiles != ctx.geomToTiles.end())
-                {
-                    kv.second.touchedTileKeys.assign(itGeomTiles->second.begin(), itGeomTiles->second.end());
-                    if (!kv.second.touchedTileKeys.empty())
-                    {
-                        kv.second.indexed = true;
-                        ++indexedGeometries;
-                    }
-                }
+                kv.second.indexed = true;
+                ++indexedGeometries;
             }
         }
-        const auto pendingGeom = j.value("pendingWorldGeometryQueue", std::vector<std::string>{});
-        for (const auto& id : pendingGeom)
+
+        for (const WorldManifestGeom& g : manifest.geometries)
         {
-            if (ctx.worldGeometry.find(id) == ctx.worldGeometry.end())
+            if (!g.pending)
                 continue;
-            if (disabledGeometries.find(id) != disabledGeometries.end())
+            const auto* geom = FindWorldGeometry(ctx, g.id);
+            if (!geom)
                 continue;
-            if (ctx.pendingWorldGeometrySet.insert(id).second)
-                ctx.pendingWorldGeometryQueue.push_back(id);
+            QueueWorldGeometryHandle(ctx, geom->handle);
         }
 
-        const auto emptyTiles = j.value("emptyWorldTiles", std::vector<uint64_t>{});
-        for (uint64_t key : emptyTiles)
-            ctx.emptyWorldTiles.insert(key);
-        const auto failedTiles = j.value("failedWorldTiles", std::vector<uint64_t>{});
-        for (uint64_t key : failedTiles)
-            ctx.failedWorldTiles.insert(key);
-        const auto emptyHashesJson = j.value("emptyWorldTileHashes", nlohmann::json::object());
-        if (emptyHashesJson.is_object())
+        for (const WorldManifestTile& t : manifest.tiles)
         {
-            for (auto it = emptyHashesJson.begin(); it != emptyHashesJson.end(); ++it)
-                ctx.emptyWorldTileHashes[std::stoull(it.key())] = it.value().get<uint64_t>();
+            if ((t.bits & WORLD_TILE_EMPTY) != 0)
+                ctx.emptyWorldTiles.insert(t.key);
+            if ((t.bits & WORLD_TILE_FAILED) != 0)
+                ctx.failedWorldTiles.insert(t.key);
+            if ((t.bits & WORLD_TILE_EMPTY_HASH) != 0)
+                ctx.emptyWorldTileHashes[t.key] = t.emptyHash;
         }
 
         std::filesystem::path cachePath = GetSessionCachePath(ctx);
@@ -1545,76 +2234,72 @@ namespace
         size_t knownEmpty = 0;
         size_t queuedMissing = 0;
 
-        for (const auto& kv : ctx.tileToGeometryIds)
-        {
-            const uint64_t tileKey = kv.first;
+        auto isTileUpToDate = [&](uint64_t tileKey) -> bool {
             const int tx = static_cast<int>(tileKey >> 32);
             const int ty = static_cast<int>(tileKey & 0xffffffffu);
             const uint64_t expectedHash = ComputeWorldTileHash(ctx, tx, ty);
-
             auto itDb = ctx.dbIndexCache.find(tileKey);
             if (itDb != ctx.dbIndexCache.end() && itDb->second.geomHash == expectedHash)
             {
                 ++cachedOk;
-                continue;
+                return true;
             }
-
             auto itEmpty = ctx.emptyWorldTileHashes.find(tileKey);
             if (itEmpty != ctx.emptyWorldTileHashes.end() && itEmpty->second == expectedHash)
             {
                 ++knownEmpty;
-                continue;
+                return true;
             }
+            return false;
+        };
 
-            ctx.dirtyWorldTiles.insert(tileKey);
-            EnqueueTileBuild(ctx, tileKey);
+        for (const auto& kv : ctx.tileToGeometryIds)
+        {
+            if (isTileUpToDate(kv.first))
+                continue;
+            ctx.dirtyWorldTiles.insert(kv.first);
+            EnqueueTileBuild(ctx, kv.first);
             ++queuedMissing;
         }
+        // Os contadores do resume scan valem só para o índice.
+        const size_t scanCachedOk = cachedOk;
+        const size_t scanKnownEmpty = knownEmpty;
 
-        const auto pendingTiles = j.value("pendingTileBuildQueue", std::vector<uint64_t>{});
         size_t pendingFromManifest = 0;
-        for (uint64_t tileKey : pendingTiles)
+        for (const uint8_t bit : { static_cast<uint8_t>(WORLD_TILE_PENDING_BUILD), static_cast<uint8_t>(WORLD_TILE_DIRTY) })
         {
-            const int tx = static_cast<int>(tileKey >> 32);
-            const int ty = static_cast<int>(tileKey & 0xffffffffu);
-            const uint64_t expectedHash = ComputeWorldTileHash(ctx, tx, ty);
-            auto itDb = ctx.dbIndexCache.find(tileKey);
-            if (itDb != ctx.dbIndexCache.end() && itDb->second.geomHash == expectedHash)
-                continue;
-
-            auto itEmpty = ctx.emptyWorldTileHashes.find(tileKey);
-            if (itEmpty != ctx.emptyWorldTileHashes.end() && itEmpty->second == expectedHash)
-                continue;
-
-            if (ctx.pendingTileBuildSet.find(tileKey) == ctx.pendingTileBuildSet.end())
-                ++pendingFromManifest;
-            ctx.dirtyWorldTiles.insert(tileKey);
-            EnqueueTileBuild(ctx, tileKey);
+            for (const WorldManifestTile& t : manifest.tiles)
+            {
+                if ((t.bits & bit) == 0 || isTileUpToDate(t.key))
+                    continue;
+                if (bit == WORLD_TILE_PENDING_BUILD && !ctx.pendingTileBuildQueue.Contains(t.key))
+                    ++pendingFromManifest;
+                ctx.dirtyWorldTiles.insert(t.key);
+                EnqueueTileBuild(ctx, t.key);
+            }
         }
 
-        const auto dirtyTiles = j.value("dirtyWorldTiles", std::vector<uint64_t>{});
-        for (uint64_t tileKey : dirtyTiles)
-        {
-            const int tx = static_cast<int>(tileKey >> 32);
-            const int ty = static_cast<int>(tileKey & 0xffffffffu);
-            const uint64_t expectedHash = ComputeWorldTileHash(ctx, tx, ty);
-            auto itDb = ctx.dbIndexCache.find(tileKey);
-            if (itDb != ctx.dbIndexCache.end() && itDb->second.geomHash == expectedHash)
-                continue;
-
-            auto itEmpty = ctx.emptyWorldTileHashes.find(tileKey);
-            if (itEmpty != ctx.emptyWorldTileHashes.end() && itEmpty->second == expectedHash)
-                continue;
-
-            ctx.dirtyWorldTiles.insert(tileKey);
-            EnqueueTileBuild(ctx, tileKey);
-        }
+        // Estado gravado = base + journal; o que o load mudou sai no próximo save.
+        ctx.manifestSeq = manifest.lastSeq;
+        ctx.manifestSavedGeoms = std::move(savedHandles);
+        ctx.manifestSavedTiles.clear();
+        for (const WorldManifestTile& t : manifest.tiles)
+            ctx.manifestSavedTiles[t.key] = t;
+        ctx.manifestDirtyGeoms = std::move(changedHandles);
+        // Journal com cauda truncada não aceita mais append; o próximo save reescreve base e journal.
+        std::error_code ec;
+        const auto journalFileBytes = std::filesystem::file_size(journalPath, ec);
+        ctx.manifestFullSaveNeeded = !journalOk || ec || static_cast<uint64_t>(journalFileBytes) != journalBytes;
+        ctx.manifestJournalBytes = journalBytes;
+        const auto baseBytes = std::filesystem::file_size(manifestPath, ec);
+        ctx.manifestBaseBytes = ec ? 0 : static_cast<uint64_t>(baseBytes);
 
         ctx.worldManifestLoaded = true;
         printf("[WorldTile] Resume scan: indexedTiles=%zu dbTiles=%zu cachedOk=%zu knownEmpty=%zu queuedMissing=%zu pendingFromManifest=%zu pendingFinal=%zu dirtyFinal=%zu\n",
-               ctx.tileToGeometryIds.size(), dbTiles, cachedOk, knownEmpty, queuedMissing, pendingFromManifest, ctx.pendingTileBuildQueue.size(), ctx.dirtyWorldTiles.size());
-        printf("[WorldTile] Load manifest: loaded=%d changed=%d removed=%d pendingGeoms=%zu indexedGeometries=%d dirtyTiles=%zu pendingTiles=%zu\n",
-               loadedCount, changed, removed, ctx.pendingWorldGeometryQueue.size(), indexedGeometries, ctx.dirtyWorldTiles.size(), ctx.pendingTileBuildQueue.size());
+               ctx.tileToGeometryIds.size(), dbTiles, scanCachedOk, scanKnownEmpty, queuedMissing, pendingFromManifest, ctx.pendingTileBuildQueue.Size(), ctx.dirtyWorldTiles.size());
+        printf("[WorldTile] Load manifest: loaded=%d changed=%d removed=%d pendingGeoms=%zu indexedGeometries=%d dirtyTiles=%zu pendingTiles=%zu journalSeq=%llu\n",
+               loadedCount, changed, removed, ctx.pendingWorldGeometryQueue.size(), indexedGeometries, ctx.dirtyWorldTiles.size(), ctx.pendingTileBuildQueue.Size(),
+               static_cast<unsigned long long>(manifest.lastSeq));
         return true;
     }
 
@@ -1643,6 +2328,45 @@ namespace
         return true;
     }
 
+    dtQueryFilter MakeAgentPathFilter(int flags)
+    {
+        dtQueryFilter filter{};
+        filter.setIncludeFlags(static_cast<unsigned short>(flags));
+        filter.setExcludeFlags(0);
+        filter.setAreaCost(AREA_JUMP, 4.0f);
+        filter.setAreaCost(AREA_DROP, 1.5f);
+        filter.setAreaCost(AREA_OFFMESH, 2.0f);
+        return filter;
+    }
+
+    constexpr int kFlowFieldMaxPolys = 65535;  // limite do dtNodePool
+
+    // Atualiza o flow field com os tiles residentes; refaz do alvo salvo se o navmesh mudou.
+    bool RefreshFlowField(ExternNavmeshContext& ctx, ExternNavmeshContext::FlowFieldEntry& entry)
+    {
+        const dtNavMesh* nav = ctx.navData.GetNavMesh();
+        if (!nav || !EnsureNavQuery(ctx))
+            return false;
+
+        if (entry.navEpoch == ctx.navMeshEpoch && entry.field->getNavMesh() == nav &&
+            dtStatusSucceed(entry.field->update()))
+        {
+            return true;
+        }
+
+        if (dtStatusFailed(entry.field->init(nav, kFlowFieldMaxPolys)))
+            return false;
+        entry.navEpoch = ctx.navMeshEpoch;
+
+        const dtQueryFilter filter = MakeAgentPathFilter(entry.flags);
+        const float targetPos[3] = { entry.target.x, entry.target.y, entry.target.z };
+        dtPolyRef goalRef = 0;
+        float goalNearest[3]{};
+        if (dtStatusFailed(ctx.navQuery->findNearestPoly(targetPos, ctx.cachedExtents, &filter, &goalRef, goalNearest)) || goalRef == 0)
+            return false;
+        return !dtStatusFailed(entry.field->build(goalRef, goalNearest, entry.radius, &filter));
+    }
+
     GeometryInstance* FindGeometry(ExternNavmeshContext& ctx, const char* id)
     {
         if (!id) return nullptr;
@@ -1661,8 +2385,197 @@ namespace
 
     void EnqueueTileBuild(ExternNavmeshContext& ctx, uint64_t tileKey)
     {
-        if (ctx.pendingTileBuildSet.insert(tileKey).second)
-            ctx.pendingTileBuildQueue.push_back(tileKey);
+        ctx.pendingTileBuildQueue.Push(tileKey);
+    }
+
+    // AABB do obstáculo (pos = centro; altura 0 usa a altura do agente).
+    void GetDynObstacleBounds(const ExternNavmeshContext& ctx, const DynObstacleState& st, float* bmin, float* bmax)
+    {
+        const float halfH = 0.5f * (st.height > 0.0f ? st.height : ctx.genSettings.agentHeight);
+        const float hx = st.shapeType == DYNOBS_BOX_AABB ? st.halfX : st.radius;
+        const float hz = st.shapeType == DYNOBS_BOX_AABB ? st.halfZ : st.radius;
+        bmin[0] = st.pos.x - hx; bmin[1] = st.pos.y - halfH; bmin[2] = st.pos.z - hz;
+        bmax[0] = st.pos.x + hx; bmax[1] = st.pos.y + halfH; bmax[2] = st.pos.z + hz;
+    }
+
+    void UncarveDynamicObstacle(ExternNavmeshContext& ctx, DynObstacleState& st)
+    {
+        if (st.carveRef != 0)
+            ctx.navData.RemoveObstacle(st.carveRef);
+        st.carveRef = 0;
+        st.carvePending = false;
+    }
+
+    void CarveDynamicObstacle(ExternNavmeshContext& ctx, DynObstacleState& st)
+    {
+        UncarveDynamicObstacle(ctx, st);
+        if (!ctx.navData.HasObstacleTileCache())
+            return;
+
+        float bmin[3];
+        float bmax[3];
+        GetDynObstacleBounds(ctx, st, bmin, bmax);
+        bool ok = false;
+        if (st.shapeType == DYNOBS_BOX_AABB)
+        {
+            ok = ctx.navData.AddBoxObstacle(bmin, bmax, &st.carveRef);
+        }
+        else
+        {
+            const float base[3] = { st.pos.x, bmin[1], st.pos.z };
+            ok = ctx.navData.AddCylinderObstacle(base, std::max(0.05f, st.radius), bmax[1] - bmin[1], &st.carveRef);
+        }
+        st.carvePending = !ok;
+    }
+
+    // Tile cache criado sob demanda: o grid pode ter sido recriado desde que o modo foi ligado.
+    bool EnsureObstacleCarving(ExternNavmeshContext& ctx)
+    {
+        if (!ctx.worldObstacleCarving)
+            return false;
+        if (ctx.navData.HasObstacleTileCache())
+            return true;
+        if (!ctx.navData.InitObstacleTileCache(ctx.worldCarveMaxObstacles, ctx.worldCarveMaxLayers))
+            return false;
+        for (auto& entry : ctx.dynObstacles)
+        {
+            entry.second.carveRef = 0;
+            CarveDynamicObstacle(ctx, entry.second);
+        }
+        return true;
+    }
+
+    // Camadas novas ganham refs novos; obstáculos que tocam o tile precisam ser reaplicados.
+    void RecarveObstaclesInTile(ExternNavmeshContext& ctx, int tx, int ty)
+    {
+        dtNavMesh* nav = ctx.navData.GetNavMesh();
+        if (!nav || ctx.dynObstacles.empty())
+            return;
+        const dtNavMeshParams* params = nav->getParams();
+        const float tminX = params->orig[0] + tx * params->tileWidth;
+        const float tminZ = params->orig[2] + ty * params->tileHeight;
+        const float tmaxX = tminX + params->tileWidth;
+        const float tmaxZ = tminZ + params->tileHeight;
+        for (auto& entry : ctx.dynObstacles)
+        {
+            float bmin[3];
+            float bmax[3];
+            GetDynObstacleBounds(ctx, entry.second, bmin, bmax);
+            if (bmax[0] < tminX || bmin[0] > tmaxX || bmax[2] < tminZ || bmin[2] > tmaxZ)
+                continue;
+            CarveDynamicObstacle(ctx, entry.second);
+        }
+    }
+
+    // Descarrega o tile (todos os layers + camadas comprimidas no modo carving).
+    bool RemoveWorldTileAt(ExternNavmeshContext& ctx, dtNavMesh* nav, int tx, int ty)
+    {
+        ctx.navData.DropCompactTile(tx, ty);
+        if (ctx.navData.HasObstacleTileCache())
+            return ctx.navData.RemoveTileLayersAt(tx, ty);
+
+        const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
+        if (ref == 0)
+            return false;
+        unsigned char* tileData = nullptr;
+        int tileDataSize = 0;
+        const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
+        if (dtStatusFailed(status))
+        {
+            GTANAV_TRACE(GTANAV_TRACE_ERROR, "StreamTiles", "Falha ao remover tile", nullptr,
+                         {"tx", tx}, {"ty", ty}, {"status", status});
+            return false;
+        }
+        if (tileData)
+            dtFree(tileData);
+        return true;
+    }
+
+    // Bytes de dados do tile (todos os layers) residentes na navmesh.
+    uint64_t GetWorldTileBytes(const dtNavMesh* nav, uint64_t key)
+    {
+        const int tx = static_cast<int>(key >> 32);
+        const int ty = static_cast<int>(key & 0xffffffffu);
+        const dtMeshTile* tiles[32];
+        const int count = nav->getTilesAt(tx, ty, tiles, 32);
+        uint64_t bytes = 0;
+        for (int i = 0; i < count; ++i)
+            bytes += static_cast<uint64_t>(tiles[i]->dataSize);
+        return bytes;
+    }
+
+    uint64_t ComputeResidentTileBytes(const ExternNavmeshContext& ctx, const dtNavMesh* nav)
+    {
+        uint64_t bytes = 0;
+        for (uint64_t key : ctx.residentTiles)
+            bytes += GetWorldTileBytes(nav, key);
+        return bytes;
+    }
+
+    bool IsResidentSetOverBudget(const ExternNavmeshContext& ctx, uint64_t residentBytes)
+    {
+        if (ctx.residentTiles.size() > static_cast<size_t>(ctx.maxResidentTiles))
+            return true;
+        return ctx.maxResidentBytes > 0 && residentBytes > ctx.maxResidentBytes;
+    }
+
+    // Slots do dtNavMesh por tile do mundo: com carving cada layer é um dtMeshTile.
+    int WorldTileSlotsPerTile(const ExternNavmeshContext& ctx)
+    {
+        return ctx.worldObstacleCarving ? std::max(1, ctx.worldCarveMaxLayers) : 1;
+    }
+
+    // Slots livres no dtNavMesh. Com dtPolyRef 64 bits ele é dimensionado pelos residentes
+    // e um addTile sem slot falha com DT_OUT_OF_MEMORY.
+    int CountFreeTileSlots(const dtNavMesh* nav)
+    {
+        int used = 0;
+        for (int i = 0; i < nav->getMaxTiles(); ++i)
+        {
+            if (nav->getTile(i)->header)
+                ++used;
+        }
+        return nav->getMaxTiles() - used;
+    }
+
+    // Com a sessão aberta o dtNavMesh já tem tamanho fixo: o limite de residentes (x layers)
+    // precisa caber nele. Com dtPolyRef 32 bits ele cobre o grid inteiro.
+    bool FitsResidentCapacity(const ExternNavmeshContext& ctx, int maxResidentTiles, int slotsPerTile)
+    {
+#ifdef DT_POLYREF64
+        const dtNavMesh* nav = ctx.navData.GetNavMesh();
+        if (!nav || !ctx.worldTileStreamingEnabled || !ctx.navData.HasTiledCache())
+            return true;
+        return static_cast<int64_t>(maxResidentTiles) * slotsPerTile <= nav->getMaxTiles();
+#else
+        (void)ctx;
+        (void)maxResidentTiles;
+        (void)slotsPerTile;
+        return true;
+#endif
+    }
+
+    // Tile saindo do conjunto residente: com compactTiles vira cópia compacta em vez de sumir.
+    bool EvictWorldTileAt(ExternNavmeshContext& ctx, dtNavMesh* nav, int tx, int ty)
+    {
+        if (ctx.navData.UsesCompactTiles() && ctx.navData.CompactTileAt(tx, ty))
+            return true;
+        return RemoveWorldTileAt(ctx, nav, tx, ty);
+    }
+
+    // A camada compacta divide o orçamento com os residentes: só usa a contagem e os bytes
+    // que eles deixam livres, então ligar compactTiles não passa do limite de memória.
+    void TrimCompactTiles(ExternNavmeshContext& ctx, uint64_t residentBytes)
+    {
+        const size_t maxTiles = static_cast<size_t>(std::max(1, ctx.maxResidentTiles));
+        const size_t maxCompact = maxTiles > ctx.residentTiles.size() ? maxTiles - ctx.residentTiles.size() : 0;
+        while (ctx.navData.GetCompactTileCount() > maxCompact ||
+               (ctx.maxResidentBytes > 0 &&
+                residentBytes + ctx.navData.GetCompactTileBytes() > ctx.maxResidentBytes))
+        {
+            if (!ctx.navData.DropOldestCompactTile())
+                break;
+        }
     }
 
     void MarkTilesDirty(ExternNavmeshContext& ctx, const std::unordered_set<uint64_t>& tiles)
@@ -1671,6 +2584,7 @@ namespace
         {
             ctx.dirtyWorldTiles.insert(key);
             ctx.dirtyWorldOffmeshTiles.insert(key);
+            ctx.navData.DropCompactTile(static_cast<int>(key >> 32), static_cast<int>(key & 0xffffffffu));
             EnqueueTileBuild(ctx, key);
         }
     }
@@ -1717,36 +2631,6 @@ namespace
         return true;
     }
 
-    void RemoveGeometryFromWorldIndex(ExternNavmeshContext& ctx, const std::string& geomId)
-    {
-        auto itTiles = ctx.geomToTiles.find(geomId);
-        if (itTiles != ctx.geomToTiles.end())
-        {
-            for (uint64_t tileKey : itTiles->second)
-            {
-                auto itVec = ctx.tileToGeometryIds.find(tileKey);
-                if (itVec == ctx.tileToGeometryIds.end())
-                    continue;
-
-                auto& ids = itVec->second;
-                ids.erase(std::remove(ids.begin(), ids.end(), geomId), ids.end());
-                if (ids.empty())
-                    ctx.tileToGeometryIds.erase(itVec);
-            }
-            ctx.geomToTiles.erase(itTiles);
-        }
-
-        for (auto itVec = ctx.tileToGeometryIds.begin(); itVec != ctx.tileToGeometryIds.end();)
-        {
-            auto& ids = itVec->second;
-            ids.erase(std::remove(ids.begin(), ids.end(), geomId), ids.end());
-            if (ids.empty())
-                itVec = ctx.tileToGeometryIds.erase(itVec);
-            else
-                ++itVec;
-        }
-    }
-
     bool IsWorldGeometryRecordUpToDate(const ExternNavmeshContext::WorldGeomRecord& record)
     {
         if (record.path.empty() || !std::filesystem::exists(record.path))
@@ -1895,6 +2779,8 @@ namespace
             const int minCz = static_cast<int>(std::floor((tileMin.z - rec.spatialCache.originZ) / rec.spatialCache.cellSize));
             const int maxCz = static_cast<int>(std::floor((tileMax.z - rec.spatialCache.originZ) / rec.spatialCache.cellSize));
             std::unordered_set<uint32_t> usedTriIndices;
+            // Estatísticas só para o trace; a faixa Y aceita custa por triângulo, então fica desligado por padrão.
+            const bool traceDetail = GTANAV_TRACE_ENABLED(GTANAV_TRACE_DEBUG);
             uint64_t debugCellsVisited = 0;
             uint64_t debugChunksVisited = 0;
             uint64_t debugTrisTested = 0;
@@ -1928,6 +2814,8 @@ namespace
                             if (outIndices.size() > prevCount)
                             {
                                 ++debugTrisAccepted;
+                                if (!traceDetail)
+                                    continue;
                                 const unsigned int i0 = rec.source.indices[triIdx * 3 + 0];
                                 const unsigned int i1 = rec.source.indices[triIdx * 3 + 1];
                                 const unsigned int i2 = rec.source.indices[triIdx * 3 + 2];
@@ -1943,15 +2831,15 @@ namespace
                     }
                 }
             }
-            printf("[WorldTile][AppendGeometryForTile] geom=%s cells=%llu chunks=%llu tested=%llu accepted=%llu acceptedY=[%.3f, %.3f] tileY=[%.3f, %.3f]\n",
-                   rec.id.c_str(),
-                   static_cast<unsigned long long>(debugCellsVisited),
-                   static_cast<unsigned long long>(debugChunksVisited),
-                   static_cast<unsigned long long>(debugTrisTested),
-                   static_cast<unsigned long long>(debugTrisAccepted),
-                   (debugTrisAccepted > 0 ? acceptedMinY : 0.0f),
-                   (debugTrisAccepted > 0 ? acceptedMaxY : 0.0f),
-                   tileMin.y, tileMax.y);
+            GTANAV_TRACE(GTANAV_TRACE_DEBUG, "WorldTile", "AppendGeometryForTile", rec.id.c_str(),
+                         {"cells", debugCellsVisited},
+                         {"chunks", debugChunksVisited},
+                         {"tested", debugTrisTested},
+                         {"accepted", debugTrisAccepted},
+                         {"acceptedMinY", debugTrisAccepted > 0 ? acceptedMinY : 0.0f},
+                         {"acceptedMaxY", debugTrisAccepted > 0 ? acceptedMaxY : 0.0f},
+                         {"tileMinY", tileMin.y},
+                         {"tileMaxY", tileMax.y});
             return (outIndices.size() - beforeIndices) / 3;
         }
 
@@ -1968,6 +2856,8 @@ namespace
                                 std::vector<unsigned int>& outIndices,
                                 bool* outAbortedByTriLimit = nullptr)
     {
+        GtaNavProfileScope gatherScope(GTANAV_PROF_GATHER);
+        GtaNavTraceScope traceScope(GTANAV_TRACE_INFO, "WorldTile", "BuildWorldTileGeometry");
         if (outAbortedByTriLimit)
             *outAbortedByTriLimit = false;
         outVerts.clear();
@@ -1996,6 +2886,10 @@ namespace
         const glm::vec3 tileMax(params->orig[0] + (tx + 1) * params->tileWidth + border,
                                 ctx.bboxMax.y + border,
                                 params->orig[2] + (ty + 1) * params->tileHeight + border);
+        traceScope.arg("tx", tx);
+        traceScope.arg("ty", ty);
+        // Distribuição Y e ranking por geometria só existem para o trace (nível DEBUG).
+        const bool traceDetail = GTANAV_TRACE_ENABLED(GTANAV_TRACE_DEBUG);
         uint64_t totalRawTris = 0;
         uint64_t totalFilteredTris = 0;
         uint64_t filteredBelow0 = 0;
@@ -2005,9 +2899,9 @@ namespace
         std::vector<std::pair<std::string, size_t>> perGeomAdded;
         static constexpr uint64_t MAX_INPUT_TRIS_PER_TILE = 20000000ull;
 
-        for (const std::string& geomId : itGeoms->second)
+        for (uint32_t handle : itGeoms->second)
         {
-            auto it = ctx.worldGeometry.find(geomId);
+            auto it = ctx.worldGeometry.find(handle);
             if (it == ctx.worldGeometry.end())
                 continue;
             auto& rec = it->second;
@@ -2043,6 +2937,7 @@ namespace
                     continue;
                 rec.fileMTime = mtime;
                 rec.fileSize = fsize;
+                ctx.manifestDirtyGeoms.insert(rec.handle);
             }
 
             totalRawTris += rec.source.indices.size() / 3;
@@ -2059,7 +2954,7 @@ namespace
             {
                 totalFilteredTris += added;
                 const size_t startIdx = outIndices.size() - (added * 3);
-                for (size_t i = startIdx; i + 2 < outIndices.size(); i += 3)
+                for (size_t i = startIdx; traceDetail && i + 2 < outIndices.size(); i += 3)
                 {
                     const glm::vec3& a = outVerts[outIndices[i + 0]];
                     const glm::vec3& b = outVerts[outIndices[i + 1]];
@@ -2070,28 +2965,29 @@ namespace
                     else if (triCenterY < 150.0f) ++filteredY50_150;
                     else ++filteredY150Plus;
                 }
-                perGeomAdded.emplace_back(rec.id, added);
+                if (traceDetail)
+                    perGeomAdded.emplace_back(rec.id, added);
                 const uint64_t sourceTris = rec.source.indices.size() / 3;
                 if (added > sourceTris)
                 {
-                    printf("[WorldTile][erro] addedTris > sourceTris tile %d,%d id=%s added=%zu source=%llu\n",
-                           tx, ty, rec.id.c_str(), added, static_cast<unsigned long long>(sourceTris));
+                    GTANAV_TRACE(GTANAV_TRACE_ERROR, "WorldTile", "addedTris > sourceTris", rec.id.c_str(),
+                                 {"tx", tx}, {"ty", ty}, {"added", added}, {"source", sourceTris});
                 }
                 if (sourceTris > 1000000ull)
                 {
-                    printf("[WorldTile] sourceTris alto id=%s path=%s source=%llu\n",
-                           rec.id.c_str(), rec.path.c_str(), static_cast<unsigned long long>(sourceTris));
+                    GTANAV_TRACE(GTANAV_TRACE_WARN, "WorldTile", "sourceTris alto", rec.path.c_str(),
+                                 {"source", sourceTris});
                 }
                 if (added > 1000000)
-                    printf("[WorldTile] Geometry triCount muito alto no tile %d,%d: id=%s path=%s tris=%zu\n",
-                           tx, ty, rec.id.c_str(), rec.path.c_str(), added);
+                    GTANAV_TRACE(GTANAV_TRACE_WARN, "WorldTile", "Geometry triCount muito alto", rec.path.c_str(),
+                                 {"tx", tx}, {"ty", ty}, {"tris", added});
                 if (totalFilteredTris > MAX_INPUT_TRIS_PER_TILE)
                 {
-                    printf("[WorldTile][erro] tile %d,%d excedeu limite de tris (%llu > %llu). "
-                           "Marcando como failed; reduza tileSize ou simplifique geometria.\n",
-                           tx, ty,
-                           static_cast<unsigned long long>(totalFilteredTris),
-                           static_cast<unsigned long long>(MAX_INPUT_TRIS_PER_TILE));
+                    GTANAV_TRACE(GTANAV_TRACE_ERROR, "WorldTile", "tile excedeu limite de tris",
+                                 "Marcando como failed; reduza tileSize ou simplifique geometria.",
+                                 {"tx", tx}, {"ty", ty},
+                                 {"tris", totalFilteredTris},
+                                 {"limit", MAX_INPUT_TRIS_PER_TILE});
                     if (outAbortedByTriLimit)
                         *outAbortedByTriLimit = true;
                     outVerts.clear();
@@ -2101,31 +2997,157 @@ namespace
             }
         }
 
-        std::sort(perGeomAdded.begin(), perGeomAdded.end(), [](const auto& a, const auto& b)
+        if (traceDetail)
         {
-            return a.second > b.second;
-        });
-        const size_t topN = std::min<size_t>(10, perGeomAdded.size());
-        for (size_t i = 0; i < topN; ++i)
-        {
-            printf("[WorldTile] Tile %d,%d topGeom[%zu]=%s tris=%zu\n",
-                   tx, ty, i, perGeomAdded[i].first.c_str(), perGeomAdded[i].second);
-        }
-        printf("[WorldTile] Tile %d,%d tris raw=%llu filtered=%llu geoms=%zu\n",
-               tx, ty,
-               static_cast<unsigned long long>(totalRawTris),
-               static_cast<unsigned long long>(totalFilteredTris),
-               itGeoms->second.size());
-        printf("[WorldTile] Tile %d,%d filteredYDist below0=%llu y0_50=%llu y50_150=%llu y150plus=%llu\n",
-               tx, ty,
-               static_cast<unsigned long long>(filteredBelow0),
-               static_cast<unsigned long long>(filteredY0_50),
-               static_cast<unsigned long long>(filteredY50_150),
-               static_cast<unsigned long long>(filteredY150Plus));
+            const size_t topN = std::min<size_t>(10, perGeomAdded.size());
+            std::partial_sort(perGeomAdded.begin(), perGeomAdded.begin() + topN, perGeomAdded.end(),
+                              [](const auto& a, const auto& b) { return a.second > b.second; });
+            for (size_t i = 0; i < topN; ++i)
+            {
+                GTANAV_TRACE(GTANAV_TRACE_DEBUG, "WorldTile", "topGeom", perGeomAdded[i].first.c_str(),
+                             {"tx", tx}, {"ty", ty}, {"rank", i}, {"tris", perGeomAdded[i].second});
+            }
+            GTANAV_TRACE(GTANAV_TRACE_DEBUG, "WorldTile", "filteredYDist", nullptr,
+                         {"tx", tx}, {"ty", ty},
+                         {"below0", filteredBelow0},
+                         {"y0_50", filteredY0_50},
+                         {"y50_150", filteredY50_150},
+                         {"y150plus", filteredY150Plus});
+        }
+        traceScope.arg("rawTris", totalRawTris);
+        traceScope.arg("filteredTris", totalFilteredTris);
+        traceScope.arg("geoms", itGeoms->second.size());
 
         return !outVerts.empty() && !outIndices.empty();
     }
 
+    // Tiles que o segmento pode influenciar, contando a borda que o Recast lê em volta do tile.
+    void CollectSegmentTiles(const ExternNavmeshContext& ctx,
+                             const dtNavMesh* nav,
+                             const GeometryInstance& inst,
+                             std::vector<uint64_t>& outTiles)
+    {
+        outTiles.clear();
+        if (inst.segmentIndices.empty())
+            return;
+
+        const float cs = std::max(ctx.genSettings.cellSize, 1e-4f);
+        const float border = (std::ceil(ctx.genSettings.agentRadius / cs) + 3.0f) * cs;
+        const glm::vec3 bmin = inst.segmentBMin - glm::vec3(border, 0.0f, border);
+        const glm::vec3 bmax = inst.segmentBMax + glm::vec3(border, 0.0f, border);
+        int minTx = 0, minTy = 0, maxTx = 0, maxTy = 0;
+        nav->calcTileLoc(&bmin.x, &minTx, &minTy);
+        nav->calcTileLoc(&bmax.x, &maxTx, &maxTy);
+        for (int ty = minTy; ty <= maxTy; ++ty)
+        {
+            for (int tx = minTx; tx <= maxTx; ++tx)
+                outTiles.push_back(MakeTileKey(tx, ty));
+        }
+    }
+
+    void UnindexGeometrySegment(ExternNavmeshContext& ctx, GeometryInstance& inst, uint32_t slot)
+    {
+        for (uint64_t key : inst.segmentTiles)
+        {
+            auto it = ctx.geometryTileIndex.find(key);
+            if (it == ctx.geometryTileIndex.end())
+                continue;
+            auto& slots = it->second;
+            slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+            if (slots.empty())
+                ctx.geometryTileIndex.erase(it);
+        }
+        inst.segmentTiles.clear();
+    }
+
+    // Retransforma só os segmentos sujos e acerta o índice deles. O índice inteiro é refeito
+    // quando a malha foi recriada (outra origem/tamanho de tile) ou geometries perdeu itens.
+    void RefreshGeometrySegments(ExternNavmeshContext& ctx, const dtNavMesh* nav)
+    {
+        SyncGeometrySegmentsBBox(ctx);
+        const bool rebuildIndex = !ctx.geometryTileIndexValid || ctx.geometryTileIndexEpoch != ctx.navMeshEpoch;
+        if (rebuildIndex)
+            ctx.geometryTileIndex.clear();
+
+        for (size_t i = 0; i < ctx.geometries.size(); ++i)
+        {
+            GeometryInstance& inst = ctx.geometries[i];
+            const uint32_t slot = static_cast<uint32_t>(i);
+            if (!inst.segmentDirty && !rebuildIndex)
+                continue;
+
+            if (rebuildIndex)
+                inst.segmentTiles.clear();
+            else
+                UnindexGeometrySegment(ctx, inst, slot);
+
+            if (inst.segmentDirty)
+            {
+                BuildGeometrySegment(ctx, inst);
+                ctx.combinedGeometryStale = true;
+            }
+
+            CollectSegmentTiles(ctx, nav, inst, inst.segmentTiles);
+            for (uint64_t key : inst.segmentTiles)
+                ctx.geometryTileIndex[key].push_back(slot);
+        }
+
+        ctx.geometryTileIndexValid = true;
+        ctx.geometryTileIndexEpoch = ctx.navMeshEpoch;
+    }
+
+    // Triângulos dos segmentos registrados no tile que encostam nele (com borda).
+    void GatherTileSegments(const ExternNavmeshContext& ctx,
+                            const dtNavMesh* nav,
+                            int tx,
+                            int ty,
+                            std::vector<glm::vec3>& outVerts,
+                            std::vector<unsigned int>& outIndices)
+    {
+        outVerts.clear();
+        outIndices.clear();
+        auto itTile = ctx.geometryTileIndex.find(MakeTileKey(tx, ty));
+        if (itTile == ctx.geometryTileIndex.end())
+            return;
+
+        const dtNavMeshParams* params = nav->getParams();
+        const float cs = std::max(ctx.genSettings.cellSize, 1e-4f);
+        const float border = (std::ceil(ctx.genSettings.agentRadius / cs) + 3.0f) * cs;
+        const float minX = params->orig[0] + tx * params->tileWidth - border;
+        const float minZ = params->orig[2] + ty * params->tileHeight - border;
+        const float maxX = params->orig[0] + (tx + 1) * params->tileWidth + border;
+        const float maxZ = params->orig[2] + (ty + 1) * params->tileHeight + border;
+
+        const unsigned int unmapped = std::numeric_limits<unsigned int>::max();
+        std::vector<unsigned int> remap;
+        for (uint32_t slot : itTile->second)
+        {
+            const GeometryInstance& inst = ctx.geometries[slot];
+            remap.assign(inst.segmentVerts.size(), unmapped);
+            for (size_t i = 0; i + 2 < inst.segmentIndices.size(); i += 3)
+            {
+                const glm::vec3& v0 = inst.segmentVerts[inst.segmentIndices[i + 0]];
+                const glm::vec3& v1 = inst.segmentVerts[inst.segmentIndices[i + 1]];
+                const glm::vec3& v2 = inst.segmentVerts[inst.segmentIndices[i + 2]];
+                const glm::vec3 triMin = glm::min(glm::min(v0, v1), v2);
+                const glm::vec3 triMax = glm::max(glm::max(v0, v1), v2);
+                if (triMin.x > maxX || triMax.x < minX || triMin.z > maxZ || triMax.z < minZ)
+                    continue;
+
+                for (int k = 0; k < 3; ++k)
+                {
+                    const unsigned int local = inst.segmentIndices[i + k];
+                    if (remap[local] == unmapped)
+                    {
+                        remap[local] = static_cast<unsigned int>(outVerts.size());
+                        outVerts.push_back(inst.segmentVerts[local]);
+                    }
+                    outIndices.push_back(remap[local]);
+                }
+            }
+        }
+    }
+
     bool RebuildDirtyTiles(ExternNavmeshContext& ctx)
     {
         if (ctx.worldTileStreamingEnabled)
@@ -2138,48 +3160,61 @@ namespace
         if (ctx.rebuildAll || !ctx.navData.IsLoaded() || !ctx.navData.HasTiledCache())
             return false;
 
-        std::vector<glm::vec3> verts;
-        std::vector<unsigned int> indices;
-        if (!CombineGeometry(ctx, verts, indices))
+        const dtNavMesh* nav = ctx.navData.GetNavMesh();
+        if (!nav)
             return false;
 
-        if (!ctx.navData.UpdateCachedGeometry(verts, indices))
-            return false;
+        // Só as instâncias que mudaram são retransformadas; a malha combinada do NavMeshData
+        // fica atrasada até alguém precisar dela (RefreshCombinedGeometryCache).
+        RefreshGeometrySegments(ctx, nav);
 
         std::set<uint64_t> dirtyTiles;
-        const auto tileKey = [](int tx, int ty) -> uint64_t
-        {
-            return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
-        };
-
         for (const auto& bounds : ctx.dirtyBounds)
         {
             std::vector<std::pair<int, int>> tiles;
             if (!ctx.navData.CollectTilesInBounds(bounds.first, bounds.second, true, tiles))
                 continue;
             for (const auto& t : tiles)
-                dirtyTiles.insert(tileKey(t.first, t.second));
+                dirtyTiles.insert(MakeTileKey(t.first, t.second));
         }
 
-        if (dirtyTiles.empty())
-        {
-            ctx.dirtyBounds.clear();
-            return true;
-        }
-
-        std::vector<std::pair<int, int>> toRebuild;
-        toRebuild.reserve(dirtyTiles.size());
+        std::vector<glm::vec3> verts;
+        std::vector<unsigned int> indices;
         for (uint64_t key : dirtyTiles)
         {
-            int tx = static_cast<int>(key >> 32);
-            int ty = static_cast<int>(key & 0xffffffffu);
-            toRebuild.emplace_back(tx, ty);
+            const int tx = static_cast<int>(key >> 32);
+            const int ty = static_cast<int>(key & 0xffffffffu);
+            GatherTileSegments(ctx, nav, tx, ty, verts, indices);
+
+            // Hash 0: o tile DB não reaproveita este tile sem rebuild.
+            bool built = false;
+            bool empty = false;
+            if (!ctx.navData.RebuildSingleTileFromGeometry(tx, ty, verts, indices, ctx.genSettings, nullptr, 0, &built, &empty))
+            {
+                printf("[ExternC] RebuildDirtyTiles: falhou ao reconstruir tile %d,%d.\n", tx, ty);
+                return false;
+            }
         }
 
-        bool ok = ctx.navData.RebuildSpecificTiles(toRebuild, ctx.genSettings, true, nullptr);
-        if (ok)
-            ctx.dirtyBounds.clear();
-        return ok;
+        ctx.dirtyBounds.clear();
+        return true;
+    }
+
+    bool RefreshCombinedGeometryCache(ExternNavmeshContext& ctx)
+    {
+        if (!ctx.combinedGeometryStale || ctx.worldTileStreamingEnabled)
+            return true;
+        if (!ctx.navData.IsLoaded() || !ctx.navData.HasTiledCache())
+            return true;
+
+        std::vector<glm::vec3> verts;
+        std::vector<unsigned int> indices;
+        if (!CombineGeometry(ctx, verts, indices))
+            return false;
+        if (!ctx.navData.UpdateCachedGeometry(verts, indices))
+            return false;
+        ctx.combinedGeometryStale = false;
+        return true;
     }
 
     bool UpdateNavmeshState(ExternNavmeshContext& ctx, bool forceFullBuild)
@@ -2211,6 +3246,7 @@ namespace
                 ctx.navData.SetOffmeshLinks(ctx.offmeshLinks);
                 if (!ctx.navData.InitTiledGrid(ctx.genSettings, forcedMin, forcedMax))
                     return false;
+                ctx.navMeshEpoch++;
             }
 
             if (forceFullBuild || ctx.rebuildAll)
@@ -2356,6 +3392,7 @@ namespace
 
 GTANAVVIEWER_API void* InitNavMesh()
 {
+    GtaNavTileAlloc_Install();
     auto* ctx = new ExternNavmeshContext();
     return ctx;
 }
@@ -2426,12 +3463,86 @@ GTANAVVIEWER_API void SetNavMeshSessionId(void* navMesh, const char* sessionId)
     ctx->dbMTime = {};
 }
 
-GTANAVVIEWER_API void SetMaxResidentTiles(void* navMesh, int maxTiles)
+GTANAVVIEWER_API bool SetMaxResidentTiles(void* navMesh, int maxTiles)
+{
+    if (!navMesh)
+        return false;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    const int value = std::max(1, maxTiles);
+    if (!FitsResidentCapacity(*ctx, value, WorldTileSlotsPerTile(*ctx)))
+    {
+        printf("[WorldTile] SetMaxResidentTiles: %d tiles x %d layers excede a capacidade da sessao (%d); use o valor em BeginWorldTileSession.\n",
+               value, WorldTileSlotsPerTile(*ctx), ctx->navData.GetNavMesh()->getMaxTiles());
+        return false;
+    }
+    ctx->maxResidentTiles = value;
+    return true;
+}
+
+GTANAVVIEWER_API void SetMaxResidentBytes(void* navMesh, std::uint64_t maxBytes)
 {
     if (!navMesh)
         return;
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
-    ctx->maxResidentTiles = std::max(1, maxTiles);
+    ctx->maxResidentBytes = maxBytes;
+}
+
+GTANAVVIEWER_API std::uint64_t GetResidentTileBytes(void* navMesh)
+{
+    if (!navMesh)
+        return 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    const dtNavMesh* nav = ctx->navData.GetNavMesh();
+    return nav ? ComputeResidentTileBytes(*ctx, nav) : 0;
+}
+
+GTANAVVIEWER_API int GetCompactTileStats(void* navMesh, std::uint64_t* outBytes)
+{
+    if (outBytes)
+        *outBytes = 0;
+    if (!navMesh)
+        return 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    if (outBytes)
+        *outBytes = ctx->navData.GetCompactTileBytes();
+    return static_cast<int>(ctx->navData.GetCompactTileCount());
+}
+
+GTANAVVIEWER_API bool GetNavTileAllocStats(NavTileAllocStatsFFI* outStats)
+{
+    if (!outStats)
+        return false;
+
+    static_assert(GTANAV_TILE_ALLOC_MAX_CLASSES <= 48, "NavTileAllocStatsFFI::class* pequeno demais");
+
+    GtaNavTileAllocStats stats{};
+    GtaNavTileAlloc_GetStats(stats);
+
+    *outStats = NavTileAllocStatsFFI{};
+    outStats->bytesInUse = stats.bytesInUse;
+    outStats->bytesReserved = stats.bytesReserved;
+    outStats->peakBytesInUse = stats.peakBytesInUse;
+    outStats->largeBytes = stats.largeBytes;
+    outStats->largeCount = stats.largeCount;
+    outStats->classCount = stats.classCount;
+    for (int i = 0; i < stats.classCount; ++i)
+    {
+        outStats->classBlockSize[i] = stats.classes[i].blockSize;
+        outStats->classPages[i] = stats.classes[i].pageCount;
+        outStats->classBlocksInUse[i] = stats.classes[i].blocksInUse;
+        outStats->classBlocksFree[i] = stats.classes[i].blocksFree;
+    }
+    return GtaNavTileAlloc_IsInstalled();
+}
+
+GTANAVVIEWER_API void TrimNavTileAlloc()
+{
+    GtaNavTileAlloc_Trim();
+}
+
+GTANAVVIEWER_API int GetNavMeshPolyRefBits()
+{
+    return static_cast<int>(sizeof(dtPolyRef) * 8);
 }
 
 GTANAVVIEWER_API bool SaveNavMeshRuntimeCache(void* navMesh, const char* cacheFilePath)
@@ -2481,12 +3592,15 @@ GTANAVVIEWER_API bool AddGeometry(void* navMesh,
     {
         *existing = std::move(inst);
         target = existing;
+        ctx->geometryTileIndexValid = false;
     }
     else
     {
         ctx->geometries.push_back(std::move(inst));
         target = &ctx->geometries.back();
     }
+    // geometries mudou: o cache combinado do NavMeshData tem que ser refeito.
+    ctx->combinedGeometryStale = true;
 
     RegisterDirtyBounds(*ctx, *target);
     ctx->rebuildAll = ctx->rebuildAll || ctx->genSettings.mode != NavmeshBuildMode::Tiled;
@@ -2505,22 +3619,22 @@ GTANAVVIEWER_API bool UpdateGeometry(void* navMesh,
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
     if (ctx->worldTileStreamingEnabled)
     {
-        auto it = ctx->worldGeometry.find(customID);
-        if (it == ctx->worldGeometry.end())
+        auto* geom = FindWorldGeometry(*ctx, customID);
+        if (!geom)
             return false;
 
-        auto& rec = it->second;
+        auto& rec = *geom;
         std::unordered_set<uint64_t> oldTiles;
-        auto prevIt = ctx->geomToTiles.find(customID);
-        if (prevIt != ctx->geomToTiles.end())
-            oldTiles = prevIt->second;
+        const auto& prevTiles = GetWorldGeometryTiles(*ctx, rec.handle);
+        if (!prevTiles.empty())
+            oldTiles.insert(prevTiles.begin(), prevTiles.end());
         else
             oldTiles.insert(rec.touchedTileKeys.begin(), rec.touchedTileKeys.end());
 
         if (!oldTiles.empty())
             MarkTilesDirty(*ctx, oldTiles);
 
-        RemoveGeometryFromWorldIndex(*ctx, customID);
+        RemoveGeometryFromWorldIndex(*ctx, rec.handle);
 
         if (pos)
             rec.position = glm::vec3(pos->x, pos->y, pos->z);
@@ -2537,8 +3651,8 @@ GTANAVVIEWER_API bool UpdateGeometry(void* navMesh,
         rec.spatialCache.chunks.clear();
         rec.spatialCache.cellToChunks.clear();
 
-        if (ctx->pendingWorldGeometrySet.insert(customID).second)
-            ctx->pendingWorldGeometryQueue.push_back(customID);
+        ctx->loadedWorldGeometry.erase(rec.handle);
+        QueueWorldGeometryHandle(*ctx, rec.handle);
         const bool isDynamic = (rec.flags & WORLD_GEOM_DYNAMIC) != 0;
         if (!isDynamic && ctx->worldAutoSaveManifest)
             SaveWorldTileManifestInternal(*ctx);
@@ -2556,6 +3670,7 @@ GTANAVVIEWER_API bool UpdateGeometry(void* navMesh,
         inst->position = glm::vec3(pos->x, pos->y, pos->z);
     if (rot)
         inst->rotation = glm::vec3(rot->x, rot->y, rot->z);
+    inst->segmentDirty = true;
 
     UpdateWorldBounds(*inst);
     RegisterDirtyBounds(*ctx, *inst);
@@ -2577,30 +3692,26 @@ GTANAVVIEWER_API bool RemoveGeometry(void* navMesh, const char* customID)
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
     if (ctx->worldTileStreamingEnabled)
     {
-        const std::string id(customID);
+        const uint32_t handle = ctx->geomIds.Find(customID);
+        if (handle == kInvalidGeomHandle)
+            return true;
         bool isDynamic = false;
-        auto itGeom = ctx->worldGeometry.find(id);
+        auto itGeom = ctx->worldGeometry.find(handle);
         if (itGeom != ctx->worldGeometry.end())
             isDynamic = (itGeom->second.flags & WORLD_GEOM_DYNAMIC) != 0;
 
         std::unordered_set<uint64_t> oldTiles;
-        auto itTiles = ctx->geomToTiles.find(id);
-        if (itTiles != ctx->geomToTiles.end())
-            oldTiles = itTiles->second;
-        else
-        {
-            auto itGeom = ctx->worldGeometry.find(id);
-            if (itGeom != ctx->worldGeometry.end())
-                oldTiles.insert(itGeom->second.touchedTileKeys.begin(), itGeom->second.touchedTileKeys.end());
-        }
+        const auto& geomTiles = GetWorldGeometryTiles(*ctx, handle);
+        if (!geomTiles.empty())
+            oldTiles.insert(geomTiles.begin(), geomTiles.end());
+        else if (itGeom != ctx->worldGeometry.end())
+            oldTiles.insert(itGeom->second.touchedTileKeys.begin(), itGeom->second.touchedTileKeys.end());
         if (!oldTiles.empty())
             MarkTilesDirty(*ctx, oldTiles);
-        RemoveGeometryFromWorldIndex(*ctx, id);
-        ctx->worldGeometry.erase(id);
-        ctx->pendingWorldGeometrySet.erase(id);
-        ctx->pendingWorldGeometryQueue.erase(
-            std::remove(ctx->pendingWorldGeometryQueue.begin(), ctx->pendingWorldGeometryQueue.end(), id),
-            ctx->pendingWorldGeometryQueue.end());
+        RemoveGeometryFromWorldIndex(*ctx, handle);
+        ctx->worldGeometry.erase(handle);
+        ctx->loadedWorldGeometry.erase(handle);
+        UnqueueWorldGeometryHandle(*ctx, handle, true);
         if (!isDynamic && ctx->worldAutoSaveManifest)
             SaveWorldTileManifestInternal(*ctx);
         return true;
@@ -2612,6 +3723,9 @@ GTANAVVIEWER_API bool RemoveGeometry(void* navMesh, const char* customID)
         {
             RegisterDirtyBounds(*ctx, *it);
             ctx->geometries.erase(it);
+            ctx->geometryTileIndexValid = false;
+            // Remoção não deixa segmento sujo; sem isso o cache combinado ficaria com o prop.
+            ctx->combinedGeometryStale = true;
             ctx->rebuildAll = ctx->rebuildAll || ctx->genSettings.mode != NavmeshBuildMode::Tiled;
             return true;
         }
@@ -2627,16 +3741,15 @@ GTANAVVIEWER_API void RemoveAllGeometries(void* navMesh)
     if (ctx->worldTileStreamingEnabled)
     {
         std::unordered_set<uint64_t> allTiles;
-        for (const auto& kv : ctx->geomToTiles)
-            allTiles.insert(kv.second.begin(), kv.second.end());
+        for (const auto& geomTiles : ctx->geomToTiles)
+            allTiles.insert(geomTiles.begin(), geomTiles.end());
         MarkTilesDirty(*ctx, allTiles);
-        ctx->worldGeometry.clear();
-        ctx->pendingWorldGeometryQueue.clear();
-        ctx->pendingWorldGeometrySet.clear();
-        ctx->tileToGeometryIds.clear();
-        ctx->geomToTiles.clear();
+        ClearWorldGeometryIndex(*ctx);
     }
     ctx->geometries.clear();
+    ctx->geometryTileIndex.clear();
+    ctx->geometryTileIndexValid = false;
+    ctx->combinedGeometryStale = true;
     ctx->rebuildAll = true;
     if (ctx->worldTileStreamingEnabled && ctx->worldAutoSaveManifest)
         SaveWorldTileManifestInternal(*ctx);
@@ -2822,13 +3935,9 @@ GTANAVVIEWER_API bool ExportWorldGeometriesObj(void* navMesh,
             }
             else
             {
-                auto itTiles = ctx->geomToTiles.find(rec.id);
-                if (itTiles != ctx->geomToTiles.end())
+                for (uint64_t tileKey : GetWorldGeometryTiles(*ctx, rec.handle))
                 {
-                    for (uint64_t tileKey : itTiles->second)
-                    {
-                        if (ctx->residentTiles.find(tileKey) != ctx->residentTiles.end()) { resident = true; break; }
-                    }
+                    if (ctx->residentTiles.find(tileKey) != ctx->residentTiles.end()) { resident = true; break; }
                 }
             }
             if (!resident) { ++filtered; continue; }
@@ -2915,18 +4024,14 @@ GTANAVVIEWER_API bool InitTiledGrid(void* navMesh, Vector3 bmin, Vector3 bmax)
     float forcedMax[3] = { ctx->bboxMax.x, ctx->bboxMax.y, ctx->bboxMax.z };
     if (!ctx->navData.InitTiledGrid(ctx->genSettings, forcedMin, forcedMax))
         return false;
+    ctx->navMeshEpoch++;
 
     ctx->residentTiles.clear();
     ctx->residentStamp.clear();
     ctx->stampCounter = 0;
-    ctx->worldGeometry.clear();
-    ctx->pendingWorldGeometryQueue.clear();
-    ctx->pendingWorldGeometrySet.clear();
-    ctx->tileToGeometryIds.clear();
-    ctx->geomToTiles.clear();
+    ClearWorldGeometryIndex(*ctx);
     ctx->dirtyWorldTiles.clear();
-    ctx->pendingTileBuildQueue.clear();
-    ctx->pendingTileBuildSet.clear();
+    ctx->pendingTileBuildQueue.Clear();
     ctx->emptyWorldTiles.clear();
     ctx->emptyWorldTileHashes.clear();
     ctx->failedWorldTiles.clear();
@@ -2984,8 +4089,8 @@ GTANAVVIEWER_API int StreamTilesAround(void* navMesh, Vector3 center, float radi
         const bool alreadyLoaded = nav->getTileRefAt(tx, ty, 0) != 0;
         if (!alreadyLoaded)
         {
-            bool loaded = false;
-            if (hasCacheFile && indexReady)
+            bool loaded = ctx->navData.ExpandCompactTileAt(tx, ty);
+            if (!loaded && hasCacheFile && indexReady)
             {
                 if (!LoadTileFromDb(cachePath.string().c_str(), nav, tx, ty, loaded, &ctx->dbIndexCache))
                 {
@@ -2996,7 +4101,7 @@ GTANAVVIEWER_API int StreamTilesAround(void* navMesh, Vector3 center, float radi
             {
                 std::vector<std::pair<int, int>> rebuildTiles;
                 rebuildTiles.emplace_back(tx, ty);
-                if (!ctx->geometries.empty())
+                if (!ctx->geometries.empty() && RefreshCombinedGeometryCache(*ctx))
                 {
                     if (ctx->navData.RebuildSpecificTiles(rebuildTiles, ctx->genSettings, false, nullptr))
                     {
@@ -3016,9 +4121,10 @@ GTANAVVIEWER_API int StreamTilesAround(void* navMesh, Vector3 center, float radi
         }
     }
 
-    if (ctx->residentTiles.size() > static_cast<size_t>(ctx->maxResidentTiles))
+    uint64_t residentBytes = ComputeResidentTileBytes(*ctx, nav);
+    if (IsResidentSetOverBudget(*ctx, residentBytes))
     {
-        while (ctx->residentTiles.size() > static_cast<size_t>(ctx->maxResidentTiles))
+        while (IsResidentSetOverBudget(*ctx, residentBytes))
         {
             uint64_t lruKey = 0;
             uint32_t lruStamp = std::numeric_limits<uint32_t>::max();
@@ -3043,20 +4149,14 @@ GTANAVVIEWER_API int StreamTilesAround(void* navMesh, Vector3 center, float radi
 
             const int tx = static_cast<int>(lruKey >> 32);
             const int ty = static_cast<int>(lruKey & 0xffffffffu);
-            const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
-            if (ref != 0)
-            {
-                unsigned char* tileData = nullptr;
-                int tileDataSize = 0;
-                const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
-                if (dtStatusSucceed(status) && tileData)
-                    dtFree(tileData);
-            }
+            residentBytes -= std::min(residentBytes, GetWorldTileBytes(nav, lruKey));
+            EvictWorldTileAt(*ctx, nav, tx, ty);
 
             ctx->residentTiles.erase(lruKey);
             ctx->residentStamp.erase(lruKey);
         }
     }
+    TrimCompactTiles(*ctx, residentBytes);
 
     EnsureNavQuery(*ctx);
     return loadedCount;
@@ -3071,6 +4171,8 @@ GTANAVVIEWER_API void ClearAllLoadedTiles(void* navMesh)
     if (!nav)
         return;
 
+    ctx->navData.ClearTileLayers();
+    ctx->navData.ClearCompactTiles();
     const int maxTiles = nav->getMaxTiles();
     for (int i = 0; i < maxTiles; ++i)
     {
@@ -3090,6 +4192,7 @@ GTANAVVIEWER_API void ClearAllLoadedTiles(void* navMesh)
     ctx->residentTiles.clear();
     ctx->residentStamp.clear();
     ctx->agentResidentTiles.clear();
+    ctx->pendingTileBuildQueue.ClearAgents();
     ctx->stampCounter = 0;
     EnsureNavQuery(*ctx);
 }
@@ -3138,6 +4241,7 @@ GTANAVVIEWER_API bool BakeTilesInBounds(void* navMesh, Vector3 bmin, Vector3 bma
         ctx->navData.SetOffmeshLinks(ctx->offmeshLinks);
         if (!ctx->navData.InitTiledGrid(ctx->genSettings, forcedMin, forcedMax))
             return false;
+        ctx->navMeshEpoch++;
 
         if (!EnsureNavQuery(*ctx))
             return false;
@@ -3145,6 +4249,7 @@ GTANAVVIEWER_API bool BakeTilesInBounds(void* navMesh, Vector3 bmin, Vector3 bma
 
     if (!ctx->navData.UpdateCachedGeometry(verts, indices))
         return false;
+    ctx->combinedGeometryStale = false;
 
     const glm::vec3 min(bmin.x, bmin.y, bmin.z);
     const glm::vec3 max(bmax.x, bmax.y, bmax.z);
@@ -3155,7 +4260,7 @@ GTANAVVIEWER_API bool BakeTilesInBounds(void* navMesh, Vector3 bmin, Vector3 bma
     {
         std::filesystem::path cachePath = GetSessionCachePath(*ctx);
         const auto& hashes = ctx->navData.GetCachedTileHashes();
-        TileDbWriteOrUpdateTiles(cachePath.string().c_str(), ctx->navData.GetNavMesh(), hashes);
+        TileDbWriteOrUpdateTiles(cachePath.string().c_str(), ctx->navData.GetNavMesh(), hashes, ctx->tileCacheCodec);
         ctx->dbIndexCache.clear();
         ctx->dbIndexLoaded = false;
     }
@@ -3203,16 +4308,12 @@ GTANAVVIEWER_API bool BeginWorldTileSession(void* navMesh,
     ctx->rebuildAll = false;
     ctx->dirtyBounds.clear();
     ctx->dirtyWorldTiles.clear();
-    ctx->pendingTileBuildQueue.clear();
-    ctx->pendingTileBuildSet.clear();
-    ctx->pendingWorldGeometryQueue.clear();
-    ctx->pendingWorldGeometrySet.clear();
-    ctx->tileToGeometryIds.clear();
-    ctx->geomToTiles.clear();
-    ctx->worldGeometry.clear();
+    ctx->pendingTileBuildQueue.Clear();
+    ClearWorldGeometryIndex(*ctx);
     ctx->residentTiles.clear();
     ctx->residentStamp.clear();
     ctx->agentResidentTiles.clear();
+    ctx->pendingTileBuildQueue.ClearAgents();
     ctx->stampCounter = 0;
     ctx->dbIndexCache.clear();
     ctx->dbIndexLoaded = false;
@@ -3221,8 +4322,15 @@ GTANAVVIEWER_API bool BeginWorldTileSession(void* navMesh,
     ctx->navData.SetOffmeshLinks(ctx->offmeshLinks);
     float forcedMin[3] = { ctx->bboxMin.x, ctx->bboxMin.y, ctx->bboxMin.z };
     float forcedMax[3] = { ctx->bboxMax.x, ctx->bboxMax.y, ctx->bboxMax.z };
-    if (!ctx->navData.InitTiledGrid(ctx->genSettings, forcedMin, forcedMax))
+    // dtPolyRef 64 bits: navmesh dimensionada pelos residentes, não pelo grid do mundo.
+    // O stream descarrega antes de carregar, então o conjunto necessário cabe em
+    // maxResidentTiles x layers; a folga 2x cobre os tiles gerados por BuildQueuedWorldTiles
+    // fora desse conjunto antes do próximo stream.
+    const int slotsPerTile = WorldTileSlotsPerTile(*ctx);
+    const int residentCapacity = std::min(ctx->maxResidentTiles, std::numeric_limits<int>::max() / (2 * slotsPerTile)) * slotsPerTile * 2;
+    if (!ctx->navData.InitTiledGrid(ctx->genSettings, forcedMin, forcedMax, residentCapacity))
         return false;
+    ctx->navMeshEpoch++;
 
     TileGridStats stats{};
     NavMeshData::EstimateTileGrid(ctx->genSettings, forcedMin, forcedMax, stats);
@@ -3272,19 +4380,20 @@ GTANAVVIEWER_API int QueueWorldGeometryEx(void* navMesh,
         : (std::string(pathToGeometry) + "#" + std::to_string(ctx->worldGeometry.size() + ctx->pendingWorldGeometryQueue.size()));
 
     bool oldWasPersistentManifestGeom = false;
-    auto it = ctx->worldGeometry.find(id);
+    const uint32_t handle = ctx->geomIds.Intern(id);
+    auto it = ctx->worldGeometry.find(handle);
     if (it != ctx->worldGeometry.end())
     {
         std::unordered_set<uint64_t> oldTiles;
-        auto prevIt = ctx->geomToTiles.find(id);
-        if (prevIt != ctx->geomToTiles.end())
-            oldTiles = prevIt->second;
+        const auto& prevTiles = GetWorldGeometryTiles(*ctx, handle);
+        if (!prevTiles.empty())
+            oldTiles.insert(prevTiles.begin(), prevTiles.end());
         else
         {
             oldTiles.insert(it->second.touchedTileKeys.begin(), it->second.touchedTileKeys.end());
         }
 
-        RemoveGeometryFromWorldIndex(*ctx, id);
+        RemoveGeometryFromWorldIndex(*ctx, handle);
         MarkTilesDirty(*ctx, oldTiles);
 
         oldWasPersistentManifestGeom =
@@ -3299,6 +4408,7 @@ GTANAVVIEWER_API int QueueWorldGeometryEx(void* navMesh,
 
     ExternNavmeshContext::WorldGeomRecord rec{};
     rec.id = id;
+    rec.handle = handle;
     rec.path = pathToGeometry;
     rec.position = glm::vec3(pos.x, pos.y, pos.z);
     rec.rotation = glm::vec3(rot.x, rot.y, rot.z);
@@ -3308,9 +4418,9 @@ GTANAVVIEWER_API int QueueWorldGeometryEx(void* navMesh,
         rec.flags &= ~WORLD_GEOM_PERSISTENT;
     const bool isDynamic = (rec.flags & WORLD_GEOM_DYNAMIC) != 0;
     rec.groupId = (groupId && groupId[0] != '\0') ? std::string(groupId) : "default";
-    ctx->worldGeometry[id] = std::move(rec);
-    if (ctx->pendingWorldGeometrySet.insert(id).second)
-        ctx->pendingWorldGeometryQueue.push_back(id);
+    ctx->worldGeometry[handle] = std::move(rec);
+    ctx->loadedWorldGeometry.erase(handle);
+    QueueWorldGeometryHandle(*ctx, handle);
     if ((oldWasPersistentManifestGeom || !isDynamic) && ctx->worldAutoSaveManifest)
         SaveWorldTileManifestInternal(*ctx);
 
@@ -3326,28 +4436,32 @@ GTANAVVIEWER_API bool RemoveWorldGeometryGroup(void* navMesh, const char* groupI
         return false;
 
     const std::string targetGroup(groupId);
-    std::vector<std::string> ids;
+    std::vector<uint32_t> handles;
     std::unordered_set<uint64_t> affectedTiles;
     for (const auto& kv : ctx->worldGeometry)
     {
         if (kv.second.groupId == targetGroup)
         {
-            ids.push_back(kv.first);
-            auto itTiles = ctx->geomToTiles.find(kv.first);
-            if (itTiles != ctx->geomToTiles.end())
-                affectedTiles.insert(itTiles->second.begin(), itTiles->second.end());
+            handles.push_back(kv.first);
+            const auto& geomTiles = GetWorldGeometryTiles(*ctx, kv.first);
+            affectedTiles.insert(geomTiles.begin(), geomTiles.end());
         }
     }
-    if (ids.empty())
+    if (handles.empty())
         return false;
 
-    for (const auto& id : ids)
+    for (uint32_t handle : handles)
+    {
+        RemoveGeometryFromWorldIndex(*ctx, handle);
+        ctx->worldGeometry.erase(handle);
+        ctx->loadedWorldGeometry.erase(handle);
+        UnqueueWorldGeometryHandle(*ctx, handle, false);
+    }
+    if (!ctx->pendingWorldGeometryQueue.empty())
     {
-        RemoveGeometryFromWorldIndex(*ctx, id);
-        ctx->worldGeometry.erase(id);
-        ctx->pendingWorldGeometrySet.erase(id);
         ctx->pendingWorldGeometryQueue.erase(
-            std::remove(ctx->pendingWorldGeometryQueue.begin(), ctx->pendingWorldGeometryQueue.end(), id),
+            std::remove_if(ctx->pendingWorldGeometryQueue.begin(), ctx->pendingWorldGeometryQueue.end(),
+                           [&](uint32_t handle) { return ctx->worldGeometry.find(handle) == ctx->worldGeometry.end(); }),
             ctx->pendingWorldGeometryQueue.end());
     }
 
@@ -3360,6 +4474,82 @@ GTANAVVIEWER_API bool RemoveWorldGeometryGroup(void* navMesh, const char* groupI
     return true;
 }
 
+struct WorldGeomLoadJob
+{
+    uint32_t handle = 0;
+    std::string path;
+    glm::vec3 position{0.0f};
+    glm::vec3 rotation{0.0f};
+    bool preferBin = false;
+};
+
+// Roda nas threads do pool: só lê disco e o job, nunca o contexto.
+static void LoadWorldGeometryJob(const WorldGeomLoadJob& job, ExternNavmeshContext::WorldGeomLoad& out)
+{
+    try
+    {
+        out.source = LoadGeometry(job.path.c_str(), job.preferBin);
+    }
+    catch (...)
+    {
+        // Exceção numa thread derruba o processo; vira falha de carga no commit.
+        out.source = LoadedGeometry{};
+    }
+    if (!out.source.Valid())
+        return;
+    ComputeWorldBounds(out.source, job.position, job.rotation, out.worldBMin, out.worldBMax);
+    out.fileMTime = GetFileMTimeHash(job.path);
+    out.fileSize = GetFileSizeBytes(job.path);
+    out.geomHash = ComputeWorldGeometryHash(job.path, job.position, job.rotation, out.worldBMin, out.worldBMax);
+}
+
+static bool CommitLoadedWorldGeometry(ExternNavmeshContext& ctx,
+                                      uint32_t handle,
+                                      ExternNavmeshContext::WorldGeomLoad& load)
+{
+    auto it = ctx.worldGeometry.find(handle);
+    if (it == ctx.worldGeometry.end())
+        return false;
+
+    RemoveGeometryFromWorldIndex(ctx, handle);
+
+    auto& rec = it->second;
+    rec.source = std::move(load.source);
+    rec.loaded = rec.source.Valid();
+    if (!rec.loaded)
+    {
+        printf("[ExternC] ProcessQueuedWorldGeometry: falha ao carregar %s (%s)\n", rec.id.c_str(), rec.path.c_str());
+        return false;
+    }
+
+    rec.worldBMin = load.worldBMin;
+    rec.worldBMax = load.worldBMax;
+    rec.fileMTime = load.fileMTime;
+    rec.fileSize = load.fileSize;
+    rec.geomHash = load.geomHash;
+    rec.indexed = false;
+    rec.touchedTileKeys.clear();
+
+    std::vector<std::pair<int, int>> tiles;
+    if (!ctx.navData.CollectTilesInBounds(rec.worldBMin, rec.worldBMax, false, tiles))
+        return false;
+
+    for (const auto& t : tiles)
+    {
+        const uint64_t tileKey = MakeTileKey(t.first, t.second);
+        AddGeometryToWorldTile(ctx, handle, tileKey);
+        rec.touchedTileKeys.push_back(tileKey);
+        ctx.dirtyWorldTiles.insert(tileKey);
+        ctx.dirtyWorldOffmeshTiles.insert(tileKey);
+        ctx.emptyWorldTiles.erase(tileKey);
+        ctx.emptyWorldTileHashes.erase(tileKey);
+        ctx.failedWorldTiles.erase(tileKey);
+        EnqueueTileBuild(ctx, tileKey);
+    }
+    rec.indexed = true;
+    return true;
+}
+
 GTANAVVIEWER_API int ProcessQueuedWorldGeometry(void* navMesh, int maxItems, int maxMilliseconds)
 {
     if (!navMesh)
@@ -3370,9 +4560,81 @@ GTANAVVIEWER_API int ProcessQueuedWorldGeometry(void* navMesh, int maxItems, int
 
     const int maxCount = maxItems <= 0 ? std::numeric_limits<int>::max() : maxItems;
     const auto start = std::chrono::steady_clock::now();
+
+    // Fatia da fila para esta chamada. maxItems/maxMilliseconds limitam o commit;
+    // o pool carrega à frente e o que sobrar fica em loadedWorldGeometry.
+    std::vector<WorldGeomLoadJob> jobs;
+    jobs.reserve(std::min<size_t>(ctx->pendingWorldGeometryQueue.size(), static_cast<size_t>(maxCount)));
+    while (!ctx->pendingWorldGeometryQueue.empty() && static_cast<int>(jobs.size()) < maxCount)
+    {
+        const uint32_t handle = ctx->pendingWorldGeometryQueue.front();
+        ctx->pendingWorldGeometryQueue.pop_front();
+        auto it = ctx->worldGeometry.find(handle);
+        if (it == ctx->worldGeometry.end())
+        {
+            UnqueueWorldGeometryHandle(*ctx, handle, false);
+            ctx->loadedWorldGeometry.erase(handle);
+            continue;
+        }
+        WorldGeomLoadJob job;
+        job.handle = handle;
+        job.path = it->second.path;
+        job.position = it->second.position;
+        job.rotation = it->second.rotation;
+        job.preferBin = it->second.preferBin;
+        jobs.push_back(std::move(job));
+    }
+
+    const size_t jobCount = jobs.size();
+    std::vector<ExternNavmeshContext::WorldGeomLoad> loads(jobCount);
+    std::vector<char> ready(jobCount, 0);
+    std::vector<size_t> toLoad;
+    toLoad.reserve(jobCount);
+    for (size_t i = 0; i < jobCount; ++i)
+    {
+        auto itLoaded = ctx->loadedWorldGeometry.find(jobs[i].handle);
+        if (itLoaded != ctx->loadedWorldGeometry.end())
+        {
+            loads[i] = std::move(itLoaded->second);
+            ctx->loadedWorldGeometry.erase(itLoaded);
+            ready[i] = 1;
+        }
+        else
+        {
+            toLoad.push_back(i);
+        }
+    }
+
+    std::mutex loadMutex;
+    std::condition_variable loadCv;
+    std::atomic<size_t> nextLoad{0};
+    std::atomic<bool> stopLoading{false};
+    auto loader = [&]()
+    {
+        for (size_t n = nextLoad.fetch_add(1); n < toLoad.size() && !stopLoading.load(); n = nextLoad.fetch_add(1))
+        {
+            const size_t i = toLoad[n];
+            LoadWorldGeometryJob(jobs[i], loads[i]);
+            {
+                std::lock_guard<std::mutex> lock(loadMutex);
+                ready[i] = 1;
+            }
+            loadCv.notify_all();
+        }
+    };
+
+    const int hw = static_cast<int>(std::thread::hardware_concurrency());
+    const size_t threadCount = std::min(static_cast<size_t>(std::max(1, hw)), toLoad.size());
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t t = 0; t < threadCount; ++t)
+        threads.emplace_back(loader);
+
+    // Commit em ordem da fila: a ordem de tileToGeometryIds continua a mesma do carregamento serial.
     int processed = 0;
     int indexed = 0;
-    while (!ctx->pendingWorldGeometryQueue.empty() && processed < maxCount)
+    size_t committed = 0;
+    for (; committed < jobCount; ++committed)
     {
         if (maxMilliseconds > 0)
         {
@@ -3381,65 +4643,31 @@ GTANAVVIEWER_API int ProcessQueuedWorldGeometry(void* navMesh, int maxItems, int
                 break;
         }
 
-        const std::string geomId = ctx->pendingWorldGeometryQueue.front();
-        ctx->pendingWorldGeometryQueue.erase(ctx->pendingWorldGeometryQueue.begin());
-        ctx->pendingWorldGeometrySet.erase(geomId);
-
-        auto it = ctx->worldGeometry.find(geomId);
-        if (it == ctx->worldGeometry.end())
-            continue;
-
-        RemoveGeometryFromWorldIndex(*ctx, geomId);
-
-        auto& rec = it->second;
-        rec.source = LoadGeometry(rec.path.c_str(), rec.preferBin);
-        rec.loaded = rec.source.Valid();
-        if (!rec.loaded)
         {
-            printf("[ExternC] ProcessQueuedWorldGeometry: falha ao carregar %s (%s)\n", geomId.c_str(), rec.path.c_str());
-            ++processed;
-            continue;
+            std::unique_lock<std::mutex> lock(loadMutex);
+            loadCv.wait(lock, [&]() { return ready[committed] != 0; });
         }
 
-        GeometryInstance temp{};
-        temp.position = rec.position;
-        temp.rotation = rec.rotation;
-        temp.source = rec.source;
-        UpdateWorldBounds(temp);
-        rec.worldBMin = temp.worldBMin;
-        rec.worldBMax = temp.worldBMax;
-        rec.fileMTime = GetFileMTimeHash(rec.path);
-        rec.fileSize = GetFileSizeBytes(rec.path);
-        rec.geomHash = ComputeWorldGeometryHash(rec.path, rec.position, rec.rotation, rec.worldBMin, rec.worldBMax);
-        rec.indexed = false;
-        rec.touchedTileKeys.clear();
-
-        std::vector<std::pair<int, int>> tiles;
-        if (ctx->navData.CollectTilesInBounds(rec.worldBMin, rec.worldBMax, false, tiles))
-        {
-            auto& geomTiles = ctx->geomToTiles[geomId];
-            for (const auto& t : tiles)
-            {
-                const uint64_t tileKey = MakeTileKey(t.first, t.second);
-                auto& vec = ctx->tileToGeometryIds[tileKey];
-                if (std::find(vec.begin(), vec.end(), geomId) == vec.end())
-                    vec.push_back(geomId);
-                geomTiles.insert(tileKey);
-                rec.touchedTileKeys.push_back(tileKey);
-                ctx->dirtyWorldTiles.insert(tileKey);
-                ctx->dirtyWorldOffmeshTiles.insert(tileKey);
-                ctx->emptyWorldTiles.erase(tileKey);
-                ctx->emptyWorldTileHashes.erase(tileKey);
-                ctx->failedWorldTiles.erase(tileKey);
-                EnqueueTileBuild(*ctx, tileKey);
-            }
-            rec.indexed = true;
+        const uint32_t handle = jobs[committed].handle;
+        UnqueueWorldGeometryHandle(*ctx, handle, false);
+        if (CommitLoadedWorldGeometry(*ctx, handle, loads[committed]))
             ++indexed;
-        }
-
         ++processed;
     }
 
+    stopLoading.store(true);
+    for (std::thread& t : threads)
+        t.join();
+
+    // Devolve a sobra para a frente da fila, guardando o que já foi carregado.
+    for (size_t i = jobCount; i > committed; --i)
+    {
+        const uint32_t handle = jobs[i - 1].handle;
+        if (ready[i - 1])
+            ctx->loadedWorldGeometry[handle] = std::move(loads[i - 1]);
+        ctx->pendingWorldGeometryQueue.push_front(handle);
+    }
+
     printf("[ExternC] ProcessQueuedWorldGeometry: processed=%d pending=%zu indexed=%d dirtyTiles=%zu\n",
            processed, ctx->pendingWorldGeometryQueue.size(), indexed, ctx->dirtyWorldTiles.size());
     if (processed > 0 && ctx->worldAutoSaveManifest)
@@ -3463,15 +4691,7 @@ static void UnloadProcessedNonResidentTiles(ExternNavmeshContext& ctx,
         const int tx = static_cast<int>(key >> 32);
         const int ty = static_cast<int>(key & 0xffffffffu);
 
-        const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
-        if (ref == 0)
-            continue;
-
-        unsigned char* tileData = nullptr;
-        int tileDataSize = 0;
-        const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
-        if (dtStatusSucceed(status) && tileData)
-            dtFree(tileData);
+        RemoveWorldTileAt(ctx, nav, tx, ty);
     }
 }
 
@@ -3496,6 +4716,30 @@ GTANAVVIEWER_API void SetWorldTileCacheGridDBEnabled(void* navMesh, bool enabled
     printf("[WorldTile][%s] tile cache backend selected\n", enabled ? "GridDB" : "SingleDB");
 }
 
+GTANAVVIEWER_API bool SetWorldTileCacheCodec(void* navMesh, int codec)
+{
+    if (!navMesh)
+        return false;
+    if (codec != static_cast<int>(TILE_DB_CODEC_RAW) && codec != static_cast<int>(TILE_DB_CODEC_LZ))
+    {
+        printf("[WorldTile] codec de cache desconhecido: %d\n", codec);
+        return false;
+    }
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    ctx->tileCacheCodec = static_cast<uint32_t>(codec);
+    return true;
+}
+
+GTANAVVIEWER_API void SetWorldTileBuildThreads(void* navMesh, int threads)
+{
+    if (!navMesh)
+        return;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    if (threads <= 0)
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    ctx->worldBuildThreads = std::max(1, threads);
+}
+
 GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxMilliseconds, bool saveToCache)
 {
     if (!navMesh)
@@ -3510,13 +4754,34 @@ GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxM
 
     const int maxCount = maxTiles <= 0 ? std::numeric_limits<int>::max() : maxTiles;
     const auto start = std::chrono::steady_clock::now();
+    // Carving: tiles saem das camadas do tile cache (não vão para o TileDB, que
+    // guardaria os obstáculos junto).
+    const bool carving = EnsureObstacleCarving(*ctx);
     int built = 0;
     int emptied = 0;
     int failed = 0;
     std::unordered_set<uint64_t> processedTileKeys;
     std::unordered_set<uint64_t> tilesToSave;
 
-    while (!ctx->pendingTileBuildQueue.empty() && built < maxCount)
+    // Com worldBuildThreads > 1 os tiles saem da fila em lotes e o Recast de cada lote roda
+    // em paralelo; geometria, troca no navMesh e offmesh continuam nesta thread, na ordem da fila.
+    const int buildThreads = carving ? 1 : std::max(1, ctx->worldBuildThreads);
+    struct WorldTileJob
+    {
+        uint64_t tileKey = 0;
+        int tx = 0;
+        int ty = 0;
+        uint64_t worldHash = 0;
+        std::vector<glm::vec3> verts;
+        std::vector<unsigned int> indices;
+        NavPrebuiltTile prebuilt;
+        bool prebuiltOk = false;
+    };
+    std::vector<WorldTileJob> jobs;
+    const int slotsPerTile = WorldTileSlotsPerTile(*ctx);
+    bool outOfSlots = false;
+
+    while (!ctx->pendingTileBuildQueue.Empty() && built < maxCount && !outOfSlots)
     {
         if (maxMilliseconds > 0)
         {
@@ -3525,21 +4790,48 @@ GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxM
                 break;
         }
 
-        const uint64_t tileKey = ctx->pendingTileBuildQueue.front();
-        ctx->pendingTileBuildQueue.pop_front();
-        ctx->pendingTileBuildSet.erase(tileKey);
-        ctx->dirtyWorldTiles.erase(tileKey);
-        processedTileKeys.insert(tileKey);
-
-        const int tx = static_cast<int>(tileKey >> 32);
-        const int ty = static_cast<int>(tileKey & 0xffffffffu);
-        std::vector<glm::vec3> verts;
-        std::vector<unsigned int> indices;
-        bool abortedByTriLimit = false;
-        const bool hasGeom = BuildWorldTileGeometry(*ctx, tx, ty, verts, indices, &abortedByTriLimit);
-        const uint64_t worldHash = ComputeWorldTileHash(*ctx, tx, ty);
-        if (!hasGeom)
+        const int batchSize = std::min(buildThreads > 1 ? buildThreads * 2 : 1, maxCount - built);
+        jobs.clear();
+        int freeSlots = CountFreeTileSlots(nav);
+        while (static_cast<int>(jobs.size()) < batchSize && !ctx->pendingTileBuildQueue.Empty() && built + static_cast<int>(jobs.size()) < maxCount)
         {
+            uint64_t tileKey = 0;
+            ctx->pendingTileBuildQueue.Pop(tileKey);
+            // Tile novo sem slot no navMesh: o addTile daria DT_OUT_OF_MEMORY e o tile iria
+            // para failedWorldTiles. Volta para a fila até o stream liberar slots.
+            const bool hasTile = nav->getTileRefAt(static_cast<int>(tileKey >> 32), static_cast<int>(tileKey & 0xffffffffu), 0) != 0;
+            if (!hasTile && freeSlots < slotsPerTile)
+            {
+                ctx->pendingTileBuildQueue.Push(tileKey);
+                GTANAV_TRACE(GTANAV_TRACE_WARN, "WorldTile", "Sem slot no navMesh", nullptr,
+                             {"tx", static_cast<int>(tileKey >> 32)},
+                             {"ty", static_cast<int>(tileKey & 0xffffffffu)},
+                             {"maxTiles", nav->getMaxTiles()},
+                             {"pending", ctx->pendingTileBuildQueue.Size()});
+                outOfSlots = true;
+                break;
+            }
+            ctx->dirtyWorldTiles.erase(tileKey);
+            processedTileKeys.insert(tileKey);
+
+            WorldTileJob job;
+            job.tileKey = tileKey;
+            job.tx = static_cast<int>(tileKey >> 32);
+            job.ty = static_cast<int>(tileKey & 0xffffffffu);
+            bool abortedByTriLimit = false;
+            const bool hasGeom = BuildWorldTileGeometry(*ctx, job.tx, job.ty, job.verts, job.indices, &abortedByTriLimit);
+            job.worldHash = ComputeWorldTileHash(*ctx, job.tx, job.ty);
+            if (hasGeom)
+            {
+                if (!hasTile)
+                    freeSlots -= slotsPerTile;
+                jobs.push_back(std::move(job));
+                continue;
+            }
+
+            GtaNavTraceScope traceScope(GTANAV_TRACE_INFO, "WorldTile", "BuildTile");
+            traceScope.arg("tx", job.tx);
+            traceScope.arg("ty", job.ty);
             if (abortedByTriLimit)
             {
                 ++failed;
@@ -3547,90 +4839,147 @@ GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxM
                 ctx->failedWorldTiles.insert(tileKey);
                 continue;
             }
-            const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
-            if (ref != 0)
-            {
-                unsigned char* tileData = nullptr;
-                int tileDataSize = 0;
-                const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
-                if (dtStatusSucceed(status) && tileData)
-                    dtFree(tileData);
-            }
+            RemoveWorldTileAt(*ctx, nav, job.tx, job.ty);
             ++emptied;
             ++built;
             tilesToSave.insert(tileKey);
             ctx->emptyWorldTiles.insert(tileKey);
-            ctx->emptyWorldTileHashes[tileKey] = worldHash;
+            ctx->emptyWorldTileHashes[tileKey] = job.worldHash;
             ctx->failedWorldTiles.erase(tileKey);
-            printf("[WorldTile] Build tile %d,%d geomCount=0 triCount=0 empty=1 hash=%llu\n",
-                   tx, ty, static_cast<unsigned long long>(worldHash));
-            continue;
+            traceScope.arg("geomCount", 0);
+            traceScope.arg("triCount", 0);
+            traceScope.arg("empty", 1);
         }
 
-        bool builtTile = false;
-        bool emptyTile = false;
-        if (!ctx->navData.RebuildSingleTileFromGeometry(tx, ty, verts, indices, ctx->genSettings, nullptr, worldHash, &builtTile, &emptyTile))
-        {
-            ++failed;
-            ctx->failedWorldTiles.insert(tileKey);
-        }
-        else if (!emptyTile)
+        if (buildThreads > 1 && jobs.size() > 1)
         {
-            std::vector<OffmeshLink> tileLinks;
-            if (ctx->worldAutoGenerateOffmeshLinks && (ctx->dirtyWorldOffmeshTiles.count(tileKey) > 0))
+            std::atomic<size_t> nextJob{0};
+            auto worker = [&]()
             {
-                GenerateWorldOffmeshLinksForTile(*ctx, tx, ty, ctx->autoOffmeshParamsV2, tileLinks);
-                if (!tileLinks.empty())
-                    ctx->worldOffmeshLinksByTile[tileKey] = tileLinks;
-                else
-                    ctx->worldOffmeshLinksByTile.erase(tileKey);
-                ctx->dirtyWorldOffmeshTiles.erase(tileKey);
+                for (size_t j = nextJob.fetch_add(1); j < jobs.size(); j = nextJob.fetch_add(1))
+                {
+                    WorldTileJob& job = jobs[j];
+                    job.prebuiltOk = ctx->navData.BuildTileDataFromGeometry(job.tx, job.ty, job.verts, job.indices, nullptr, job.prebuilt);
+                }
+            };
+            const size_t threadCount = std::min(static_cast<size_t>(buildThreads), jobs.size());
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+            for (size_t t = 1; t < threadCount; ++t)
+                threads.emplace_back(worker);
+            worker();
+            for (auto& th : threads)
+                th.join();
+        }
+        const bool prebuiltBatch = buildThreads > 1 && jobs.size() > 1;
+
+        for (WorldTileJob& job : jobs)
+        {
+            const uint64_t tileKey = job.tileKey;
+            const int tx = job.tx;
+            const int ty = job.ty;
+            const uint64_t worldHash = job.worldHash;
+            const std::vector<glm::vec3>& verts = job.verts;
+            const std::vector<unsigned int>& indices = job.indices;
+            GtaNavTraceScope traceScope(GTANAV_TRACE_INFO, "WorldTile", "BuildTile");
+            traceScope.arg("tx", tx);
+            traceScope.arg("ty", ty);
+            if (traceScope.active())
+            {
+                char hashText[32];
+                snprintf(hashText, sizeof(hashText), "hash=%llu", static_cast<unsigned long long>(worldHash));
+                traceScope.text(hashText);
             }
 
-            if (!tileLinks.empty())
+            const auto rebuildTile = [&](const std::vector<OffmeshLink>* links, bool* outBuilt, bool* outEmpty)
             {
-                bool builtWithLinks = false;
-                bool emptyWithLinks = false;
-                if (!ctx->navData.RebuildSingleTileFromGeometry(tx, ty, verts, indices, ctx->genSettings, &tileLinks, worldHash, &builtWithLinks, &emptyWithLinks))
+                if (!carving)
+                    return ctx->navData.RebuildSingleTileFromGeometry(tx, ty, verts, indices, ctx->genSettings, links, worldHash, outBuilt, outEmpty);
+                if (!links)
                 {
-                    ++failed;
-                    ctx->failedWorldTiles.insert(tileKey);
+                    const auto itLinks = ctx->worldOffmeshLinksByTile.find(tileKey);
+                    if (itLinks != ctx->worldOffmeshLinksByTile.end())
+                        links = &itLinks->second;
                 }
-                else
+                return ctx->navData.RebuildTileLayersFromGeometry(tx, ty, verts, indices, links, worldHash, outBuilt, outEmpty);
+            };
+
+            bool builtTile = false;
+            bool emptyTile = false;
+            const bool tileOk = prebuiltBatch
+                ? job.prebuiltOk && ctx->navData.ApplyBuiltTile(job.prebuilt, worldHash, &builtTile, &emptyTile)
+                : rebuildTile(nullptr, &builtTile, &emptyTile);
+            if (job.prebuilt.data)
+            {
+                dtFree(job.prebuilt.data);
+                job.prebuilt.data = nullptr;
+            }
+            if (!tileOk)
+            {
+                ++failed;
+                ctx->failedWorldTiles.insert(tileKey);
+            }
+            else if (!emptyTile)
+            {
+                std::vector<OffmeshLink> tileLinks;
+                if (ctx->worldAutoGenerateOffmeshLinks && (ctx->dirtyWorldOffmeshTiles.count(tileKey) > 0))
                 {
-                    builtTile = builtWithLinks;
-                    emptyTile = emptyWithLinks;
+                    GenerateWorldOffmeshLinksForTile(*ctx, tx, ty, ctx->autoOffmeshParamsV2, tileLinks);
+                    if (!tileLinks.empty())
+                        ctx->worldOffmeshLinksByTile[tileKey] = tileLinks;
+                    else
+                        ctx->worldOffmeshLinksByTile.erase(tileKey);
+                    ctx->dirtyWorldOffmeshTiles.erase(tileKey);
+                }
+
+                if (!tileLinks.empty())
+                {
+                    bool builtWithLinks = false;
+                    bool emptyWithLinks = false;
+                    if (!rebuildTile(&tileLinks, &builtWithLinks, &emptyWithLinks))
+                    {
+                        ++failed;
+                        ctx->failedWorldTiles.insert(tileKey);
+                    }
+                    else
+                    {
+                        builtTile = builtWithLinks;
+                        emptyTile = emptyWithLinks;
+                    }
                 }
             }
-        }
 
-        if (emptyTile)
-        {
-            tilesToSave.insert(tileKey);
-            ctx->emptyWorldTiles.insert(tileKey);
-            ctx->worldOffmeshLinksByTile.erase(tileKey);
-            ctx->emptyWorldTileHashes[tileKey] = worldHash;
-            ctx->failedWorldTiles.erase(tileKey);
-        }
-        else if (builtTile)
-        {
-            tilesToSave.insert(tileKey);
-            ctx->emptyWorldTiles.erase(tileKey);
-            ctx->emptyWorldTileHashes.erase(tileKey);
-            ctx->failedWorldTiles.erase(tileKey);
-        }
+            if (emptyTile)
+            {
+                tilesToSave.insert(tileKey);
+                ctx->emptyWorldTiles.insert(tileKey);
+                ctx->worldOffmeshLinksByTile.erase(tileKey);
+                ctx->emptyWorldTileHashes[tileKey] = worldHash;
+                ctx->failedWorldTiles.erase(tileKey);
+            }
+            else if (builtTile)
+            {
+                tilesToSave.insert(tileKey);
+                ctx->emptyWorldTiles.erase(tileKey);
+                ctx->emptyWorldTileHashes.erase(tileKey);
+                ctx->failedWorldTiles.erase(tileKey);
+            }
+            if (carving && (builtTile || emptyTile))
+                RecarveObstaclesInTile(*ctx, tx, ty);
 
-        ++built;
-        printf("[WorldTile] Build tile %d,%d geomCount=%zu triCount=%zu built=%d failed=%d hash=%llu\n",
-               tx, ty,
-               ctx->tileToGeometryIds[tileKey].size(),
-               indices.size() / 3,
-               builtTile ? 1 : 0,
-               (!builtTile && !emptyTile) ? 1 : 0,
-               static_cast<unsigned long long>(worldHash));
+            ++built;
+            if (traceScope.active())
+            {
+                const auto itGeoms = ctx->tileToGeometryIds.find(tileKey);
+                traceScope.arg("geomCount", itGeoms != ctx->tileToGeometryIds.end() ? itGeoms->second.size() : 0);
+                traceScope.arg("triCount", indices.size() / 3);
+                traceScope.arg("built", builtTile ? 1 : 0);
+                traceScope.arg("failed", (!builtTile && !emptyTile) ? 1 : 0);
+            }
+        }
     }
 
-    if (saveToCache && !tilesToSave.empty() && built > 0)
+    if (saveToCache && !carving && !tilesToSave.empty() && built > 0)
     {
         std::filesystem::path cachePath = GetSessionCachePath(*ctx);
         const auto& hashes = ctx->navData.GetCachedTileHashes();
@@ -3638,26 +4987,28 @@ GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxM
         if (ctx->useTileCacheGridDB)
         {
             const auto gridRoot = GetSessionGridCacheRoot(*ctx);
-            printf("[WorldTile][GridDB] TileDb grid write: %s tiles=%zu\n",
-                gridRoot.string().c_str(), tilesToSave.size());
+            GTANAV_TRACE(GTANAV_TRACE_INFO, "WorldTile", "GridDB write", gridRoot.string().c_str(),
+                         {"tiles", tilesToSave.size()});
 
             TileGridDbWriteOrUpdateTiles(
                 gridRoot.string().c_str(),
                 ctx->navData.GetNavMesh(),
                 hashes,
-                &tilesToSave
+                &tilesToSave,
+                ctx->tileCacheCodec
             );
         }
         else
         {
-            printf("[WorldTile][SingleDB] TileDb merge write: %s tiles=%zu\n",
-                cachePath.string().c_str(), tilesToSave.size());
+            GTANAV_TRACE(GTANAV_TRACE_INFO, "WorldTile", "SingleDB merge write", cachePath.string().c_str(),
+                         {"tiles", tilesToSave.size()});
 
             TileDbMergeWriteOrUpdateTiles(
                 cachePath.string().c_str(),
                 ctx->navData.GetNavMesh(),
                 hashes,
-                &tilesToSave
+                &tilesToSave,
+                ctx->tileCacheCodec
             );
         }
 
@@ -3666,20 +5017,20 @@ GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxM
 
         if (ctx->worldUnloadBuiltTilesAfterSave)
             UnloadProcessedNonResidentTiles(*ctx, tilesToSave);
-
-        if (ctx->useTileCacheGridDB)
-            printf("[WorldTile][GridDB] BuildQueuedWorldTiles: cache salvo em %s\n", GetSessionGridCacheRoot(*ctx).string().c_str());
-        else
-            printf("[WorldTile][SingleDB] BuildQueuedWorldTiles: cache salvo em %s\n", cachePath.string().c_str());
     }
 
     EnsureNavQuery(*ctx);
 
-    printf("[WorldTile] BuildQueuedWorldTiles: processed=%zu tilesToSave=%zu failed=%d saveToCache=%d\n",
-        processedTileKeys.size(), tilesToSave.size(), failed, saveToCache ? 1 : 0);
-
-    printf("[ExternC] BuildQueuedWorldTiles: built=%d empty=%d failed=%d saved=%d cache=%s\n",
-        built, emptied, failed, saveToCache ? 1 : 0, GetSessionCachePath(*ctx).string().c_str());
+    GTANAV_TRACE(GTANAV_TRACE_INFO, "WorldTile", "BuildQueuedWorldTiles",
+                 ctx->useTileCacheGridDB ? "GridDB" : "SingleDB",
+                 {"processed", processedTileKeys.size()},
+                 {"built", built},
+                 {"empty", emptied},
+                 {"failed", failed},
+                 {"tilesToSave", tilesToSave.size()},
+                 {"saveToCache", saveToCache ? 1 : 0},
+                 {"pending", ctx->pendingTileBuildQueue.Size()},
+                 {"carving", carving ? 1 : 0});
 
     if (built > 0 && ctx->worldAutoSaveManifest)
         SaveWorldTileManifestInternal(*ctx);
@@ -3790,13 +5141,26 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
     int updatedResident = 0;
     int enqueuedBuild = 0;
 
+    // Raio em tiles para a prioridade da fila de build (distância até o tile do agent).
+    const dtNavMeshParams* navParams = nav->getParams();
+    const float tileExtent = std::max(0.001f, std::min(navParams->tileWidth, navParams->tileHeight));
+    const int focusRadiusTiles = static_cast<int>(std::ceil(std::max(0.0f, radius) / tileExtent));
+
+    std::vector<std::pair<int, int>> tiles;
     for (int i = 0; i < agentCount; ++i)
     {
         std::unordered_set<uint64_t> neededForAgent;
         const glm::vec3 center(positions[i].x, positions[i].y, positions[i].z);
+        if (agentIds)
+        {
+            const float centerPos[3] = { center.x, center.y, center.z };
+            int agentTx = 0;
+            int agentTy = 0;
+            nav->calcTileLoc(centerPos, &agentTx, &agentTy);
+            ctx->pendingTileBuildQueue.SetAgentFocus(agentIds[i], agentTx, agentTy, focusRadiusTiles);
+        }
         const glm::vec3 bmin(center.x - radius, cachedBMin[1], center.z - radius);
         const glm::vec3 bmax(center.x + radius, cachedBMax[1], center.z + radius);
-        std::vector<std::pair<int, int>> tiles;
         if (!ctx->navData.CollectTilesInBounds(bmin, bmax, false, tiles))
             continue;
         for (const auto& t : tiles)
@@ -3820,12 +5184,47 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
         neededGlobal = needed;
     }
 
+    // 1) descarrega tudo que nenhum agent precisa mais, antes das cargas: os slots liberados
+    //    são os que os tiles novos usam (com dtPolyRef 64 bits a navmesh tem o tamanho dos residentes).
+    int unloaded = 0;
+    std::vector<uint64_t> toUnload;
+    for (uint64_t key : ctx->residentTiles)
+    {
+        if (neededGlobal.find(key) == neededGlobal.end())
+            toUnload.push_back(key);
+    }
+
+    for (uint64_t key : toUnload)
+    {
+        const int tx = static_cast<int>(key >> 32);
+        const int ty = static_cast<int>(key & 0xffffffffu);
+
+        if (EvictWorldTileAt(*ctx, nav, tx, ty))
+            unloaded++; // conta sempre que removeu com sucesso
+
+        ctx->residentTiles.erase(key);
+        ctx->residentStamp.erase(key);
+    }
+
+    // 2) carrega o que falta. Os tiles do DB entram sem links; TileDbEndBatchAdd liga as bordas de uma vez.
+    const int slotsPerTile = WorldTileSlotsPerTile(*ctx);
+    int freeSlots = CountFreeTileSlots(nav);
+    int deferred = 0;
+    nav->beginBatchAdd();
     for (uint64_t key : neededGlobal)
     {
         const int tx = static_cast<int>(key >> 32);
         const int ty = static_cast<int>(key & 0xffffffffu);
         const bool alreadyLoaded = nav->getTileRefAt(tx, ty, 0) != 0;
-        if (!alreadyLoaded)
+        // Sem slot o addTile falharia com DT_OUT_OF_MEMORY: o tile fica para o próximo stream
+        // (continua em neededGlobal) em vez de sumir.
+        if (!alreadyLoaded && freeSlots < slotsPerTile)
+        {
+            ++deferred;
+            continue;
+        }
+        // A cópia compacta em memória volta antes de olhar hash/DB.
+        if (!alreadyLoaded && !ctx->navData.ExpandCompactTileAt(tx, ty, true))
         {
             bool loaded = false;
             bool shouldBuild = false;
@@ -3844,7 +5243,7 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
             if (knownEmpty || knownFailed)
                 continue;
 
-            if (hasCacheFile && indexReady)
+            if (hasCacheFile && indexReady && !ctx->navData.HasObstacleTileCache())
             {
                 auto itDb = ctx->dbIndexCache.find(key);
                 if (itDb != ctx->dbIndexCache.end())
@@ -3853,9 +5252,9 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
                         shouldBuild = true;
                     else
                         if (ctx->useTileCacheGridDB)
-                            TileGridDbLoadTile(gridRoot.string().c_str(), nav, tx, ty, loaded);
+                            TileGridDbLoadTile(gridRoot.string().c_str(), nav, tx, ty, loaded, true);
                         else
-                            LoadTileFromDb(cachePath.string().c_str(), nav, tx, ty, loaded, &ctx->dbIndexCache);
+                            LoadTileFromDb(cachePath.string().c_str(), nav, tx, ty, loaded, &ctx->dbIndexCache, true);
                 }
                 else
                 {
@@ -3878,50 +5277,29 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
 
         if (nav->getTileRefAt(tx, ty, 0) != 0)
         {
+            if (!alreadyLoaded)
+            {
+                const dtMeshTile* layers[32];
+                freeSlots -= std::max(1, nav->getTilesAt(tx, ty, layers, 32));
+            }
             ctx->residentTiles.insert(key);
             ctx->residentStamp[key] = ++ctx->stampCounter;
             ++updatedResident;
         }
     }
-
-    // 1) descarrega tudo que nenhum agent precisa mais
-    int unloaded = 0;
-    std::vector<uint64_t> toUnload;
-    for (uint64_t key : ctx->residentTiles)
-    {
-        if (neededGlobal.find(key) == neededGlobal.end())
-            toUnload.push_back(key);
-    }
-
-    for (uint64_t key : toUnload)
+    TileDbEndBatchAdd(nav);
+    if (deferred > 0)
     {
-        const int tx = static_cast<int>(key >> 32);
-        const int ty = static_cast<int>(key & 0xffffffffu);
-
-        const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
-        if (ref != 0)
-        {
-            unsigned char* tileData = nullptr;
-            int tileDataSize = 0;
-            const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
-
-            if (dtStatusSucceed(status))
-            {
-                unloaded++; // conta sempre que removeu com sucesso
-                if (tileData)
-                    dtFree(tileData);
-            } else
-            {
-                printf("[StreamTiles] Falha ao remover tile (%d,%d) status=0x%x\n", tx, ty, status);
-            }
-        }
-
-        ctx->residentTiles.erase(key);
-        ctx->residentStamp.erase(key);
+        GTANAV_TRACE(GTANAV_TRACE_WARN, "StreamTiles", "Sem slot no navMesh", nullptr,
+                     {"deferred", deferred},
+                     {"neededGlobal", neededGlobal.size()},
+                     {"maxTiles", nav->getMaxTiles()},
+                     {"slotsPerTile", slotsPerTile});
     }
 
-    // 2) depois, LRU só como limite de segurança
-    while (ctx->residentTiles.size() > static_cast<size_t>(ctx->maxResidentTiles))
+    // 3) depois, LRU só como limite de segurança (contagem e/ou bytes)
+    uint64_t residentBytes = ComputeResidentTileBytes(*ctx, nav);
+    while (IsResidentSetOverBudget(*ctx, residentBytes))
     {
         uint64_t lruKey = 0;
         uint32_t lruStamp = std::numeric_limits<uint32_t>::max();
@@ -3943,22 +5321,24 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
             break;
         const int tx = static_cast<int>(lruKey >> 32);
         const int ty = static_cast<int>(lruKey & 0xffffffffu);
-        const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
-        if (ref != 0)
-        {
-            unsigned char* tileData = nullptr;
-            int tileDataSize = 0;
-            const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
-            if (dtStatusSucceed(status) && tileData)
-                dtFree(tileData);
-        }
+        residentBytes -= std::min(residentBytes, GetWorldTileBytes(nav, lruKey));
+        EvictWorldTileAt(*ctx, nav, tx, ty);
         ctx->residentTiles.erase(lruKey);
         ctx->residentStamp.erase(lruKey);
     }
+    TrimCompactTiles(*ctx, residentBytes);
 
     EnsureNavQuery(*ctx);
-    printf("[ExternC] StreamTilesForAgents: agents=%d neededCurrent=%zu neededGlobal=%zu loadedFromDb=%d enqueuedBuild=%d alreadyResident=%d unloaded=%d residentTiles=%zu\n",
-       agentCount, needed.size(), neededGlobal.size(), loadedFromDb, enqueuedBuild, updatedResident, unloaded, ctx->residentTiles.size());
+    GTANAV_TRACE(GTANAV_TRACE_INFO, "StreamTiles", "StreamTilesForAgents", nullptr,
+                 {"agents", agentCount},
+                 {"neededCurrent", needed.size()},
+                 {"neededGlobal", neededGlobal.size()},
+                 {"loadedFromDb", loadedFromDb},
+                 {"enqueuedBuild", enqueuedBuild},
+                 {"alreadyResident", updatedResident},
+                 {"unloaded", unloaded},
+                 {"deferred", deferred},
+                 {"residentTiles", ctx->residentTiles.size()});
     return static_cast<int>(needed.size());
 }
 
@@ -3972,6 +5352,7 @@ GTANAVVIEWER_API void RemoveStreamingAgent(void* navMesh, std::uint32_t agentId)
         return;
 
     ctx->agentResidentTiles.erase(agentId);
+    ctx->pendingTileBuildQueue.RemoveAgent(agentId);
     std::unordered_set<uint64_t> neededGlobal;
     for (const auto& entry : ctx->agentResidentTiles)
         neededGlobal.insert(entry.second.begin(), entry.second.end());
@@ -3988,18 +5369,11 @@ GTANAVVIEWER_API void RemoveStreamingAgent(void* navMesh, std::uint32_t agentId)
     {
         const int tx = static_cast<int>(key >> 32);
         const int ty = static_cast<int>(key & 0xffffffffu);
-        const dtTileRef ref = nav->getTileRefAt(tx, ty, 0);
-        if (ref != 0)
-        {
-            unsigned char* tileData = nullptr;
-            int tileDataSize = 0;
-            const dtStatus status = nav->removeTile(ref, &tileData, &tileDataSize);
-            if (dtStatusSucceed(status) && tileData)
-                dtFree(tileData);
-        }
+        EvictWorldTileAt(*ctx, nav, tx, ty);
         ctx->residentTiles.erase(key);
         ctx->residentStamp.erase(key);
     }
+    TrimCompactTiles(*ctx, ComputeResidentTileBytes(*ctx, nav));
 
     EnsureNavQuery(*ctx);
 }
@@ -4010,9 +5384,41 @@ GTANAVVIEWER_API void ClearStreamingAgents(void* navMesh)
         return;
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
     ctx->agentResidentTiles.clear();
+    ctx->pendingTileBuildQueue.ClearAgents();
     ClearAllLoadedTiles(navMesh);
 }
 
+GTANAVVIEWER_API int GetPendingWorldTilesForAgent(void* navMesh,
+                                                  std::uint32_t agentId,
+                                                  int* outTileX,
+                                                  int* outTileY,
+                                                  int maxTiles)
+{
+    if (!navMesh)
+        return 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    std::vector<uint64_t> pending;
+    const int count = ctx->pendingTileBuildQueue.CollectPendingForAgent(agentId, pending);
+    const int written = std::min(count, std::max(0, maxTiles));
+    for (int i = 0; i < written; ++i)
+    {
+        if (outTileX)
+            outTileX[i] = static_cast<int>(pending[i] >> 32);
+        if (outTileY)
+            outTileY[i] = static_cast<int>(pending[i] & 0xffffffffu);
+    }
+    return count;
+}
+
+GTANAVVIEWER_API void SetWorldTileBuildAging(void* navMesh, int agingPops, int agedPopInterval)
+{
+    if (!navMesh)
+        return;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    ctx->pendingTileBuildQueue.SetAging(static_cast<uint32_t>(std::max(0, agingPops)),
+                                        static_cast<uint32_t>(std::max(1, agedPopInterval)));
+}
+
 GTANAVVIEWER_API int GetWorldTileStreamingStats(void* navMesh,
                                                 int* outQueuedGeometries,
                                                 int* outIndexedGeometries,
@@ -4030,7 +5436,7 @@ GTANAVVIEWER_API int GetWorldTileStreamingStats(void* navMesh,
     if (outDirtyTiles)
         *outDirtyTiles = static_cast<int>(ctx->dirtyWorldTiles.size());
     if (outPendingBuildTiles)
-        *outPendingBuildTiles = static_cast<int>(ctx->pendingTileBuildQueue.size());
+        *outPendingBuildTiles = static_cast<int>(ctx->pendingTileBuildQueue.Size());
     if (outResidentTiles)
         *outResidentTiles = static_cast<int>(ctx->residentTiles.size());
     return 1;
@@ -4063,6 +5469,14 @@ GTANAVVIEWER_API int GetWorldTileStreamingStatsEx(void* navMesh,
     return 1;
 }
 
+GTANAVVIEWER_API int GetWorldTileFailedCount(void* navMesh)
+{
+    if (!navMesh)
+        return 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    return static_cast<int>(ctx->failedWorldTiles.size());
+}
+
 GTANAVVIEWER_API bool SaveWorldTileManifest(void* navMesh)
 {
     if (!navMesh)
@@ -4084,7 +5498,23 @@ GTANAVVIEWER_API bool HasWorldTileManifest(void* navMesh)
     if (!navMesh)
         return false;
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
-    return std::filesystem::exists(GetWorldManifestPath(*ctx));
+    return std::filesystem::exists(GetWorldManifestPath(*ctx)) ||
+           std::filesystem::exists(GetWorldManifestJsonPath(*ctx));
+}
+
+GTANAVVIEWER_API bool ExportWorldTileManifestJson(void* navMesh, const char* path)
+{
+    if (!navMesh)
+        return false;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    if (!ctx->worldTileStreamingEnabled)
+        return false;
+    const std::filesystem::path outPath = (path && path[0] != '\0')
+        ? std::filesystem::path(path)
+        : GetWorldManifestJsonPath(*ctx);
+    if (outPath.has_parent_path())
+        std::filesystem::create_directories(outPath.parent_path());
+    return ExportWorldTileManifestJsonInternal(*ctx, outPath);
 }
 
 GTANAVVIEWER_API bool SetWorldTileAutoSaveManifest(void* navMesh, bool enabled)
@@ -4096,6 +5526,340 @@ GTANAVVIEWER_API bool SetWorldTileAutoSaveManifest(void* navMesh, bool enabled)
     return true;
 }
 
+static constexpr size_t kNavTileLogMaxEntries = 4096;
+
+static ExternNavmeshContext::NavTileSlot MakeNavTileSlot(const dtNavMesh* nav, const dtMeshTile* tile)
+{
+    ExternNavmeshContext::NavTileSlot slot;
+    slot.present = true;
+    slot.tx = tile->header->x;
+    slot.ty = tile->header->y;
+    slot.layer = tile->header->layer;
+    slot.salt = tile->salt;
+    slot.polyRefBase = static_cast<uint64_t>(nav->getPolyRefBase(tile));
+    return slot;
+}
+
+static void RecordNavTileChange(ExternNavmeshContext& ctx, int tileIndex, int kind, const ExternNavmeshContext::NavTileSlot& slot)
+{
+    ExternNavmeshContext::NavTileLogEntry entry;
+    entry.generation = ++ctx.navGeneration;
+    entry.tileIndex = tileIndex;
+    entry.kind = kind;
+    entry.slot = slot;
+    ctx.navTileLog.push_back(entry);
+
+    // Quem ficou para trás do log descartado recebe resync completo.
+    while (ctx.navTileLog.size() > kNavTileLogMaxEntries)
+    {
+        ctx.navGenerationFloor = ctx.navTileLog.front().generation;
+        ctx.navTileLog.pop_front();
+    }
+}
+
+// Compara os slots de tile com o último snapshot. Só varre quando o dtNavMesh acusou
+// add/remove de tile (getTileGeneration), então consultas sem mudança saem em O(1).
+static void RefreshNavTileLog(ExternNavmeshContext& ctx)
+{
+    const dtNavMesh* nav = ctx.navData.GetNavMesh();
+    if (!nav)
+    {
+        if (ctx.navObservedMesh)
+        {
+            ctx.navTileSlots.clear();
+            ctx.navTileLog.clear();
+            ctx.navGenerationFloor = ++ctx.navGeneration;
+            ctx.navObservedMesh = nullptr;
+        }
+        return;
+    }
+
+    const int maxTiles = nav->getMaxTiles();
+    if (nav != ctx.navObservedMesh ||
+        ctx.navObservedEpoch != ctx.navMeshEpoch ||
+        static_cast<int>(ctx.navTileSlots.size()) != maxTiles)
+    {
+        // Malha recriada: as refs antigas não valem mais, todo consumidor refaz do zero.
+        ctx.navTileLog.clear();
+        ctx.navGenerationFloor = ++ctx.navGeneration;
+        ctx.navTileSlots.assign(static_cast<size_t>(maxTiles), ExternNavmeshContext::NavTileSlot{});
+        for (int i = 0; i < maxTiles; ++i)
+        {
+            const dtMeshTile* tile = nav->getTile(i);
+            if (tile && tile->header)
+                ctx.navTileSlots[i] = MakeNavTileSlot(nav, tile);
+        }
+        ctx.navObservedMesh = nav;
+        ctx.navObservedEpoch = ctx.navMeshEpoch;
+        ctx.navObservedTileGeneration = nav->getTileGeneration();
+        return;
+    }
+
+    if (nav->getTileGeneration() == ctx.navObservedTileGeneration)
+        return;
+    ctx.navObservedTileGeneration = nav->getTileGeneration();
+
+    // Remoções primeiro: um tile refeito pode voltar em outro slot, e quem aplica o log
+    // em ordem não pode ver o "added" antes do "removed" da mesma (tx, ty, layer).
+    for (int i = 0; i < maxTiles; ++i)
+    {
+        ExternNavmeshContext::NavTileSlot& slot = ctx.navTileSlots[i];
+        if (!slot.present)
+            continue;
+        const dtMeshTile* tile = nav->getTile(i);
+        const bool present = tile && tile->header;
+        // removeTile incrementa o salt, então salt diferente no mesmo slot é tile novo.
+        if (present && slot.salt == tile->salt)
+            continue;
+        const bool sameKey = present && slot.tx == tile->header->x && slot.ty == tile->header->y &&
+                             slot.layer == tile->header->layer;
+        if (sameKey)
+            continue;
+        RecordNavTileChange(ctx, i, NAV_TILE_CHANGE_REMOVED, slot);
+        slot = ExternNavmeshContext::NavTileSlot{};
+    }
+
+    for (int i = 0; i < maxTiles; ++i)
+    {
+        const dtMeshTile* tile = nav->getTile(i);
+        if (!tile || !tile->header)
+            continue;
+        ExternNavmeshContext::NavTileSlot& slot = ctx.navTileSlots[i];
+        if (slot.present && slot.salt == tile->salt)
+            continue;
+        const bool rebuilt = slot.present;
+        slot = MakeNavTileSlot(nav, tile);
+        RecordNavTileChange(ctx, i, rebuilt ? NAV_TILE_CHANGE_REBUILT : NAV_TILE_CHANGE_ADDED, slot);
+    }
+}
+
+// Índices dos tiles presentes que mudaram depois de since (mais os vizinhos, cujos links
+// de borda mudam junto). outFullResync: since é antigo demais, devolve a malha inteira.
+static void CollectNavTilesChangedSince(ExternNavmeshContext& ctx,
+                                        uint64_t since,
+                                        bool includeNeighbours,
+                                        std::vector<int>& outTileIndices,
+                                        bool& outFullResync)
+{
+    RefreshNavTileLog(ctx);
+    outTileIndices.clear();
+    outFullResync = since < ctx.navGenerationFloor || since > ctx.navGeneration;
+
+    const dtNavMesh* nav = ctx.navData.GetNavMesh();
+    if (!nav)
+        return;
+
+    const int slotCount = static_cast<int>(ctx.navTileSlots.size());
+    if (outFullResync)
+    {
+        for (int i = 0; i < slotCount; ++i)
+        {
+            if (ctx.navTileSlots[i].present)
+                outTileIndices.push_back(i);
+        }
+        return;
+    }
+
+    std::vector<char> marked(static_cast<size_t>(slotCount), 0);
+    auto mark = [&](int tileIndex)
+    {
+        if (tileIndex < 0 || tileIndex >= slotCount || marked[tileIndex] || !ctx.navTileSlots[tileIndex].present)
+            return;
+        marked[tileIndex] = 1;
+        outTileIndices.push_back(tileIndex);
+    };
+
+    for (auto it = ctx.navTileLog.rbegin(); it != ctx.navTileLog.rend() && it->generation > since; ++it)
+    {
+        mark(it->tileIndex);
+        if (!includeNeighbours)
+            continue;
+
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                const dtMeshTile* neighbours[32];
+                const int count = nav->getTilesAt(it->slot.tx + dx, it->slot.ty + dy, neighbours, 32);
+                for (int n = 0; n < count; ++n)
+                    mark(static_cast<int>(nav->decodePolyIdTile(nav->getTileRef(neighbours[n]))));
+            }
+        }
+    }
+    std::sort(outTileIndices.begin(), outTileIndices.end());
+}
+
+static std::vector<int> CollectAllNavTiles(const dtNavMesh* nav)
+{
+    std::vector<int> tileIndices;
+    const int maxTiles = nav->getMaxTiles();
+    for (int tileIndex = 0; tileIndex < maxTiles; ++tileIndex)
+    {
+        const dtMeshTile* tile = nav->getTile(tileIndex);
+        if (tile && tile->header)
+            tileIndices.push_back(tileIndex);
+    }
+    return tileIndices;
+}
+
+// Tiles da malha cuja área XZ (e faixa de altura) encosta nos bounds.
+static void CollectNavTilesInBounds(const dtNavMesh* nav, const glm::vec3& bmin, const glm::vec3& bmax, std::vector<int>& outTileIndices)
+{
+    outTileIndices.clear();
+    int minTx = 0, minTy = 0, maxTx = 0, maxTy = 0;
+    nav->calcTileLoc(&bmin.x, &minTx, &minTy);
+    nav->calcTileLoc(&bmax.x, &maxTx, &maxTy);
+    if (minTx > maxTx || minTy > maxTy)
+        return;
+
+    // Bounds maiores que a malha: mais barato varrer os tiles carregados.
+    const int64_t area = (static_cast<int64_t>(maxTx) - minTx + 1) * (static_cast<int64_t>(maxTy) - minTy + 1);
+    if (area > nav->getMaxTiles())
+    {
+        for (int tileIndex : CollectAllNavTiles(nav))
+        {
+            const dtMeshHeader* header = nav->getTile(tileIndex)->header;
+            if (header->x < minTx || header->x > maxTx || header->y < minTy || header->y > maxTy ||
+                header->bmax[1] < bmin.y || header->bmin[1] > bmax.y)
+                continue;
+            outTileIndices.push_back(tileIndex);
+        }
+        return;
+    }
+
+    for (int ty = minTy; ty <= maxTy; ++ty)
+    {
+        for (int tx = minTx; tx <= maxTx; ++tx)
+        {
+            const dtMeshTile* tiles[32];
+            const int count = nav->getTilesAt(tx, ty, tiles, 32);
+            for (int n = 0; n < count; ++n)
+            {
+                const dtMeshHeader* header = tiles[n]->header;
+                if (header->bmax[1] < bmin.y || header->bmin[1] > bmax.y)
+                    continue;
+                outTileIndices.push_back(static_cast<int>(nav->decodePolyIdTile(nav->getTileRef(tiles[n]))));
+            }
+        }
+    }
+    std::sort(outTileIndices.begin(), outTileIndices.end());
+}
+
+// Escreve os polys ground de um tile. false quando algum buffer encheu (o poly que não coube fica de fora).
+static bool AppendTilePolygons(const dtNavMesh* nav,
+                               const dtMeshTile* tile,
+                               NavMeshPolygonInfo* polygons,
+                               int maxPolygons,
+                               Vector3* vertices,
+                               int maxVertices,
+                               NavMeshEdgeInfo* edges,
+                               int maxEdges,
+                               int& writtenPolygons,
+                               int& writtenVertices,
+                               int& writtenEdges,
+                               std::uint64_t& generatedId)
+{
+    for (int polyIndex = 0; polyIndex < tile->header->polyCount; ++polyIndex)
+    {
+        const dtPoly* poly = &tile->polys[polyIndex];
+        if (poly->getType() != DT_POLYTYPE_GROUND)
+            continue;
+
+        if (writtenPolygons >= maxPolygons)
+            return false;
+
+        const dtPolyRef pref = nav->getPolyRefBase(tile) | static_cast<unsigned int>(polyIndex);
+        std::uint64_t polyId = pref != 0 ? static_cast<std::uint64_t>(pref) : generatedId++;
+
+        const glm::vec3 center = ComputePolyCentroid(tile, poly);
+        const glm::vec3 normal = ComputePolyNormal(tile, poly);
+
+        NavMeshPolygonInfo info{};
+        info.polygonId = polyId;
+        info.center = ToVector3(center);
+        info.normal = ToVector3(normal);
+        info.vertexStart = writtenVertices;
+        info.vertexCount = poly->vertCount;
+        info.edgeStart = writtenEdges;
+        info.edgeCount = poly->vertCount;
+
+        if (writtenVertices + poly->vertCount > maxVertices || writtenEdges + poly->vertCount > maxEdges)
+            return false;
+
+        for (int v = 0; v < poly->vertCount; ++v)
+        {
+            const int vi = poly->verts[v];
+            const float* p = &tile->verts[vi * 3];
+            vertices[writtenVertices + v] = Vector3{p[0], p[1], p[2]};
+        }
+
+        for (int edge = 0; edge < poly->vertCount; ++edge)
+        {
+            const int vaIndex = edge;
+            const int vbIndex = (edge + 1) % poly->vertCount;
+            const int va = poly->verts[vaIndex];
+            const int vb = poly->verts[vbIndex];
+            const float* a = &tile->verts[va * 3];
+            const float* b = &tile->verts[vb * 3];
+            const glm::vec3 pa(a[0], a[1], a[2]);
+            const glm::vec3 pb(b[0], b[1], b[2]);
+            NavMeshEdgeInfo e{};
+            e.vertexA = ToVector3(pa);
+            e.vertexB = ToVector3(pb);
+            const glm::vec3 mid = (pa + pb) * 0.5f;
+            e.center = ToVector3(mid);
+            const glm::vec3 outward = ComputeEdgeOutwardNormal(pa, pb, center, normal);
+            e.normal = ToVector3(outward);
+            e.polygonId = polyId;
+            edges[writtenEdges + edge] = e;
+        }
+
+        writtenVertices += poly->vertCount;
+        writtenEdges += poly->vertCount;
+        polygons[writtenPolygons++] = info;
+    }
+    return true;
+}
+
+static int WriteNavTilePolygons(const dtNavMesh* nav,
+                                const std::vector<int>& tileIndices,
+                                NavMeshPolygonInfo* polygons,
+                                int maxPolygons,
+                                Vector3* vertices,
+                                int maxVertices,
+                                NavMeshEdgeInfo* edges,
+                                int maxEdges,
+                                int* outVertexCount,
+                                int* outEdgeCount,
+                                bool* outComplete)
+{
+    int writtenPolygons = 0;
+    int writtenVertices = 0;
+    int writtenEdges = 0;
+    std::uint64_t generatedId = 1;
+    bool complete = true;
+    for (int tileIndex : tileIndices)
+    {
+        const dtMeshTile* tile = nav->getTile(tileIndex);
+        if (!tile || !tile->header)
+            continue;
+        if (!AppendTilePolygons(nav, tile, polygons, maxPolygons, vertices, maxVertices, edges, maxEdges,
+                                writtenPolygons, writtenVertices, writtenEdges, generatedId))
+        {
+            complete = false;
+            break;
+        }
+    }
+
+    if (outVertexCount)
+        *outVertexCount = writtenVertices;
+    if (outEdgeCount)
+        *outEdgeCount = writtenEdges;
+    if (outComplete)
+        *outComplete = complete;
+    return writtenPolygons;
+}
+
 GTANAVVIEWER_API int GetNavMeshPolygons(void* navMesh,
                                         NavMeshPolygonInfo* polygons,
                                         int maxPolygons,
@@ -4118,81 +5882,149 @@ GTANAVVIEWER_API int GetNavMeshPolygons(void* navMesh,
     if (!nav)
         return 0;
 
-    int writtenPolygons = 0;
-    int writtenVertices = 0;
-    int writtenEdges = 0;
-    std::uint64_t generatedId = 1;
+    return WriteNavTilePolygons(nav, CollectAllNavTiles(nav), polygons, maxPolygons, vertices, maxVertices,
+                                edges, maxEdges, outVertexCount, outEdgeCount, nullptr);
+}
 
-    const int maxTiles = nav->getMaxTiles();
-    for (int tileIndex = 0; tileIndex < maxTiles && writtenPolygons < maxPolygons; ++tileIndex)
+GTANAVVIEWER_API std::uint64_t GetNavMeshGeneration(void* navMesh)
+{
+    if (!navMesh)
+        return 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    RefreshNavTileLog(*ctx);
+    return ctx->navGeneration;
+}
+
+GTANAVVIEWER_API int GetNavMeshTileChanges(void* navMesh,
+                                           std::uint64_t sinceGeneration,
+                                           NavMeshTileChangeInfo* outChanges,
+                                           int maxChanges,
+                                           std::uint64_t* outGeneration,
+                                           bool* outFullResync)
+{
+    if (outGeneration)
+        *outGeneration = sinceGeneration;
+    if (outFullResync)
+        *outFullResync = false;
+    if (!navMesh || !outChanges || maxChanges <= 0)
+        return 0;
+
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    RefreshNavTileLog(*ctx);
+    if (sinceGeneration < ctx->navGenerationFloor || sinceGeneration > ctx->navGeneration)
     {
-        const dtMeshTile* tile = nav->getTile(tileIndex);
-        if (!tile || !tile->header)
-            continue;
+        if (outFullResync)
+            *outFullResync = true;
+        if (outGeneration)
+            *outGeneration = ctx->navGeneration;
+        return 0;
+    }
 
-        for (int polyIndex = 0; polyIndex < tile->header->polyCount && writtenPolygons < maxPolygons; ++polyIndex)
+    // Log em ordem de geração: acha o primeiro registro depois de since.
+    auto it = std::upper_bound(ctx->navTileLog.begin(), ctx->navTileLog.end(), sinceGeneration,
+        [](std::uint64_t generation, const ExternNavmeshContext::NavTileLogEntry& entry)
         {
-            const dtPoly* poly = &tile->polys[polyIndex];
-            if (poly->getType() != DT_POLYTYPE_GROUND)
-                continue;
+            return generation < entry.generation;
+        });
 
-            const dtPolyRef pref = nav->getPolyRefBase(tile) | static_cast<unsigned int>(polyIndex);
-            std::uint64_t polyId = pref != 0 ? static_cast<std::uint64_t>(pref) : generatedId++;
+    int written = 0;
+    std::uint64_t lastGeneration = sinceGeneration;
+    for (; it != ctx->navTileLog.end() && written < maxChanges; ++it)
+    {
+        NavMeshTileChangeInfo info{};
+        info.generation = it->generation;
+        info.polyRefBase = it->slot.polyRefBase;
+        info.tx = it->slot.tx;
+        info.ty = it->slot.ty;
+        info.layer = it->slot.layer;
+        info.salt = it->slot.salt;
+        info.kind = it->kind;
+        outChanges[written++] = info;
+        lastGeneration = it->generation;
+    }
+
+    // Buffer cheio: a geração devolvida é a do último registro entregue, e a próxima chamada continua dali.
+    if (outGeneration)
+        *outGeneration = it == ctx->navTileLog.end() ? ctx->navGeneration : lastGeneration;
+    return written;
+}
 
-            const glm::vec3 center = ComputePolyCentroid(tile, poly);
-            const glm::vec3 normal = ComputePolyNormal(tile, poly);
+GTANAVVIEWER_API int GetNavMeshPolygonsDelta(void* navMesh,
+                                             std::uint64_t sinceGeneration,
+                                             NavMeshPolygonInfo* polygons,
+                                             int maxPolygons,
+                                             Vector3* vertices,
+                                             int maxVertices,
+                                             NavMeshEdgeInfo* edges,
+                                             int maxEdges,
+                                             int* outVertexCount,
+                                             int* outEdgeCount,
+                                             std::uint64_t* outGeneration,
+                                             bool* outFullResync)
+{
+    if (outVertexCount)
+        *outVertexCount = 0;
+    if (outEdgeCount)
+        *outEdgeCount = 0;
+    if (outGeneration)
+        *outGeneration = sinceGeneration;
+    if (outFullResync)
+        *outFullResync = false;
+    if (!navMesh || !polygons || maxPolygons <= 0 || !vertices || maxVertices <= 0 || !edges || maxEdges <= 0)
+        return 0;
 
-            NavMeshPolygonInfo info{};
-            info.polygonId = polyId;
-            info.center = ToVector3(center);
-            info.normal = ToVector3(normal);
-            info.vertexStart = writtenVertices;
-            info.vertexCount = poly->vertCount;
-            info.edgeStart = writtenEdges;
-            info.edgeCount = poly->vertCount;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    std::vector<int> tileIndices;
+    bool fullResync = false;
+    CollectNavTilesChangedSince(*ctx, sinceGeneration, false, tileIndices, fullResync);
+    if (outFullResync)
+        *outFullResync = fullResync;
 
-            if (writtenVertices + poly->vertCount > maxVertices || writtenEdges + poly->vertCount > maxEdges)
-                return writtenPolygons;
+    dtNavMesh* nav = ctx->navData.GetNavMesh();
+    if (!nav)
+    {
+        if (outGeneration)
+            *outGeneration = ctx->navGeneration;
+        return 0;
+    }
 
-            for (int v = 0; v < poly->vertCount; ++v)
-            {
-                const int vi = poly->verts[v];
-                const float* p = &tile->verts[vi * 3];
-                vertices[writtenVertices + v] = Vector3{p[0], p[1], p[2]};
-            }
+    bool complete = false;
+    const int written = WriteNavTilePolygons(nav, tileIndices, polygons, maxPolygons, vertices, maxVertices,
+                                             edges, maxEdges, outVertexCount, outEdgeCount, &complete);
+    // Só avança a geração quando tudo coube; senão o chamador repete com buffers maiores.
+    if (complete && outGeneration)
+        *outGeneration = ctx->navGeneration;
+    return written;
+}
 
-            for (int edge = 0; edge < poly->vertCount; ++edge)
-            {
-                const int vaIndex = edge;
-                const int vbIndex = (edge + 1) % poly->vertCount;
-                const int va = poly->verts[vaIndex];
-                const int vb = poly->verts[vbIndex];
-                const float* a = &tile->verts[va * 3];
-                const float* b = &tile->verts[vb * 3];
-                const glm::vec3 pa(a[0], a[1], a[2]);
-                const glm::vec3 pb(b[0], b[1], b[2]);
-                NavMeshEdgeInfo e{};
-                e.vertexA = ToVector3(pa);
-                e.vertexB = ToVector3(pb);
-                const glm::vec3 mid = (pa + pb) * 0.5f;
-                e.center = ToVector3(mid);
-                const glm::vec3 outward = ComputeEdgeOutwardNormal(pa, pb, center, normal);
-                e.normal = ToVector3(outward);
-                e.polygonId = polyId;
-                edges[writtenEdges + edge] = e;
-            }
+GTANAVVIEWER_API int GetNavMeshPolygonsInBounds(void* navMesh,
+                                                Vector3 bmin,
+                                                Vector3 bmax,
+                                                NavMeshPolygonInfo* polygons,
+                                                int maxPolygons,
+                                                Vector3* vertices,
+                                                int maxVertices,
+                                                NavMeshEdgeInfo* edges,
+                                                int maxEdges,
+                                                int* outVertexCount,
+                                                int* outEdgeCount)
+{
+    if (outVertexCount)
+        *outVertexCount = 0;
+    if (outEdgeCount)
+        *outEdgeCount = 0;
+    if (!navMesh || !polygons || maxPolygons <= 0 || !vertices || maxVertices <= 0 || !edges || maxEdges <= 0)
+        return 0;
 
-            writtenVertices += poly->vertCount;
-            writtenEdges += poly->vertCount;
-            polygons[writtenPolygons++] = info;
-        }
-    }
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    dtNavMesh* nav = ctx->navData.GetNavMesh();
+    if (!nav)
+        return 0;
 
-    if (outVertexCount)
-        *outVertexCount = writtenVertices;
-    if (outEdgeCount)
-        *outEdgeCount = writtenEdges;
-    return writtenPolygons;
+    std::vector<int> tileIndices;
+    CollectNavTilesInBounds(nav, glm::vec3(bmin.x, bmin.y, bmin.z), glm::vec3(bmax.x, bmax.y, bmax.z), tileIndices);
+    return WriteNavTilePolygons(nav, tileIndices, polygons, maxPolygons, vertices, maxVertices,
+                                edges, maxEdges, outVertexCount, outEdgeCount, nullptr);
 }
 
 static bool HasGroundNeighbourOnEdge(const dtMeshTile* tile,
@@ -4241,6 +6073,86 @@ static bool HasGroundNeighbourOnEdge(const dtMeshTile* tile,
     return false;
 }
 
+// Escreve as bordas (edges sem vizinho ground) de um tile. false quando o buffer encheu.
+static bool AppendTileBorderEdges(const dtNavMesh* nav,
+                                  const dtMeshTile* tile,
+                                  NavMeshEdgeInfo* edges,
+                                  int maxEdges,
+                                  int& written)
+{
+    for (int polyIndex = 0; polyIndex < tile->header->polyCount; ++polyIndex)
+    {
+        const dtPoly* poly = &tile->polys[polyIndex];
+        if (poly->getType() != DT_POLYTYPE_GROUND)
+            continue;
+
+        const dtPolyRef pref = nav->getPolyRefBase(tile) | static_cast<unsigned int>(polyIndex);
+        const glm::vec3 center = ComputePolyCentroid(tile, poly);
+        const glm::vec3 normal = ComputePolyNormal(tile, poly);
+
+        for (int edge = 0; edge < poly->vertCount; ++edge)
+        {
+            // ✅ Novo critério: "borda" == NÃO tem vizinho ground neste edge
+            if (HasGroundNeighbourOnEdge(tile, poly, edge, nav))
+                continue;
+
+            if (written >= maxEdges)
+                return false;
+
+            const int vaIndex = edge;
+            const int vbIndex = (edge + 1) % poly->vertCount;
+            const int va = poly->verts[vaIndex];
+            const int vb = poly->verts[vbIndex];
+
+            const float* a = &tile->verts[va * 3];
+            const float* b = &tile->verts[vb * 3];
+            const glm::vec3 pa(a[0], a[1], a[2]);
+            const glm::vec3 pb(b[0], b[1], b[2]);
+
+            NavMeshEdgeInfo e{};
+            e.vertexA = ToVector3(pa);
+            e.vertexB = ToVector3(pb);
+
+            const glm::vec3 mid = (pa + pb) * 0.5f;
+            e.center = ToVector3(mid);
+
+            e.normal = ToVector3(ComputeEdgeOutwardNormal(pa, pb, center, normal));
+            e.polygonId = pref != 0 ? static_cast<std::uint64_t>(pref) : 0;
+
+            edges[written++] = e;
+        }
+    }
+    return true;
+}
+
+static int WriteNavTileBorderEdges(const dtNavMesh* nav,
+                                   const std::vector<int>& tileIndices,
+                                   NavMeshEdgeInfo* edges,
+                                   int maxEdges,
+                                   int* outEdgeCount,
+                                   bool* outComplete)
+{
+    int written = 0;
+    bool complete = true;
+    for (int tileIndex : tileIndices)
+    {
+        const dtMeshTile* tile = nav->getTile(tileIndex);
+        if (!tile || !tile->header)
+            continue;
+        if (!AppendTileBorderEdges(nav, tile, edges, maxEdges, written))
+        {
+            complete = false;
+            break;
+        }
+    }
+
+    if (outEdgeCount)
+        *outEdgeCount = written;
+    if (outComplete)
+        *outComplete = complete;
+    return written;
+}
+
 GTANAVVIEWER_API int GetNavMeshBorderEdges(void* navMesh,
                                            NavMeshEdgeInfo* edges,
                                            int maxEdges,
@@ -4257,60 +6169,69 @@ GTANAVVIEWER_API int GetNavMeshBorderEdges(void* navMesh,
     if (!nav)
         return 0;
 
-    int written = 0;
-    const int maxTiles = nav->getMaxTiles();
-
-    for (int tileIndex = 0; tileIndex < maxTiles && written < maxEdges; ++tileIndex)
-    {
-        const dtMeshTile* tile = nav->getTile(tileIndex);
-        if (!tile || !tile->header)
-            continue;
-
-        for (int polyIndex = 0; polyIndex < tile->header->polyCount && written < maxEdges; ++polyIndex)
-        {
-            const dtPoly* poly = &tile->polys[polyIndex];
-            if (poly->getType() != DT_POLYTYPE_GROUND)
-                continue;
-
-            const dtPolyRef pref = nav->getPolyRefBase(tile) | static_cast<unsigned int>(polyIndex);
-            const glm::vec3 center = ComputePolyCentroid(tile, poly);
-            const glm::vec3 normal = ComputePolyNormal(tile, poly);
-
-            for (int edge = 0; edge < poly->vertCount && written < maxEdges; ++edge)
-            {
-                // ✅ Novo critério: "borda" == NÃO tem vizinho ground neste edge
-                if (HasGroundNeighbourOnEdge(tile, poly, edge, nav))
-                    continue;
-
-                const int vaIndex = edge;
-                const int vbIndex = (edge + 1) % poly->vertCount;
-                const int va = poly->verts[vaIndex];
-                const int vb = poly->verts[vbIndex];
-
-                const float* a = &tile->verts[va * 3];
-                const float* b = &tile->verts[vb * 3];
-                const glm::vec3 pa(a[0], a[1], a[2]);
-                const glm::vec3 pb(b[0], b[1], b[2]);
-
-                NavMeshEdgeInfo e{};
-                e.vertexA = ToVector3(pa);
-                e.vertexB = ToVector3(pb);
+    return WriteNavTileBorderEdges(nav, CollectAllNavTiles(nav), edges, maxEdges, outEdgeCount, nullptr);
+}
 
-                const glm::vec3 mid = (pa + pb) * 0.5f;
-                e.center = ToVector3(mid);
+GTANAVVIEWER_API int GetNavMeshBorderEdgesDelta(void* navMesh,
+                                                std::uint64_t sinceGeneration,
+                                                NavMeshEdgeInfo* edges,
+                                                int maxEdges,
+                                                int* outEdgeCount,
+                                                std::uint64_t* outGeneration,
+                                                bool* outFullResync)
+{
+    if (outEdgeCount)
+        *outEdgeCount = 0;
+    if (outGeneration)
+        *outGeneration = sinceGeneration;
+    if (outFullResync)
+        *outFullResync = false;
+    if (!navMesh || !edges || maxEdges <= 0)
+        return 0;
 
-                e.normal = ToVector3(ComputeEdgeOutwardNormal(pa, pb, center, normal));
-                e.polygonId = pref != 0 ? static_cast<std::uint64_t>(pref) : 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    std::vector<int> tileIndices;
+    bool fullResync = false;
+    // Tile novo ou removido muda as bordas dos vizinhos também.
+    CollectNavTilesChangedSince(*ctx, sinceGeneration, true, tileIndices, fullResync);
+    if (outFullResync)
+        *outFullResync = fullResync;
 
-                edges[written++] = e;
-            }
-        }
+    dtNavMesh* nav = ctx->navData.GetNavMesh();
+    if (!nav)
+    {
+        if (outGeneration)
+            *outGeneration = ctx->navGeneration;
+        return 0;
     }
 
+    bool complete = false;
+    const int written = WriteNavTileBorderEdges(nav, tileIndices, edges, maxEdges, outEdgeCount, &complete);
+    if (complete && outGeneration)
+        *outGeneration = ctx->navGeneration;
+    return written;
+}
+
+GTANAVVIEWER_API int GetNavMeshBorderEdgesInBounds(void* navMesh,
+                                                   Vector3 bmin,
+                                                   Vector3 bmax,
+                                                   NavMeshEdgeInfo* edges,
+                                                   int maxEdges,
+                                                   int* outEdgeCount)
+{
     if (outEdgeCount)
-        *outEdgeCount = written;
+        *outEdgeCount = 0;
+    if (!navMesh || !edges || maxEdges <= 0)
+        return 0;
 
-    return written;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    dtNavMesh* nav = ctx->navData.GetNavMesh();
+    if (!nav)
+        return 0;
+
+    std::vector<int> tileIndices;
+    CollectNavTilesInBounds(nav, glm::vec3(bmin.x, bmin.y, bmin.z), glm::vec3(bmax.x, bmax.y, bmax.z), tileIndices);
+    return WriteNavTileBorderEdges(nav, tileIndices, edges, maxEdges, outEdgeCount, nullptr);
 }
 
 static float HeadingDegXZ(const glm::vec3& from, const glm::vec3& to)
@@ -4338,13 +6259,7 @@ static int RunPathfindInternal(ExternNavmeshContext& ctx,
     const float startPos[3] = { start.x, start.y, start.z };
     const float endPos[3]   = { end.x, end.y, end.z };
 
-    dtQueryFilter filter{};
-    filter.setIncludeFlags(static_cast<unsigned short>(flags));
-    filter.setExcludeFlags(0);
-
-    filter.setAreaCost(AREA_JUMP, 4.0f);
-    filter.setAreaCost(AREA_DROP, 1.5f);
-    filter.setAreaCost(AREA_OFFMESH, 2.0f);
+    const dtQueryFilter filter = MakeAgentPathFilter(flags);
 
     dtPolyRef startRef = 0, endRef = 0;
     float startNearest[3]{};
@@ -4602,12 +6517,7 @@ static int RunPathfindInternal(ExternNavmeshContext& ctx,
         const float startPos[3] = { start.x, start.y, start.z };
         const float endPos[3] = { end.x, end.y, end.z };
 
-        dtQueryFilter filter{};
-        filter.setIncludeFlags(static_cast<unsigned short>(flags));
-        filter.setExcludeFlags(0);
-        filter.setAreaCost(AREA_JUMP, 4.0f);
-        filter.setAreaCost(AREA_DROP, 1.5f);
-        filter.setAreaCost(AREA_OFFMESH, 2.0f);
+        const dtQueryFilter filter = MakeAgentPathFilter(flags);
 
         dtPolyRef startRef = 0, endRef = 0;
         float startNearest[3]{};
@@ -5134,6 +7044,7 @@ GTANAVVIEWER_API int AddOffmeshLinksToNavMeshIsland(void* navMesh,
         return 0;
 
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    RefreshCombinedGeometryCache(*ctx);
     std::vector<OffmeshLink> generated;
     if (!ctx->navData.AddOffmeshLinksToNavMeshIsland(*params, generated))
         return 0;
@@ -5277,6 +7188,7 @@ GTANAVVIEWER_API bool GenerateAutomaticOffmeshLinks(void* navMesh)
     params.sweepUp = std::max(0.1f, params.agentHeight * 0.5f);
     
     printf("[ExternC] Gerando offmesh links, genFlags: %d\n", params.genFlags);
+    RefreshCombinedGeometryCache(*ctx);
     std::vector<OffmeshLink> generated;
     if (!ctx->navData.GenerateAutomaticOffmeshLinksV2(params, generated))
         return false;
@@ -5338,6 +7250,7 @@ GTANAVVIEWER_API int UpsertDynamicObstacles(void* navMesh, const DynObstacleDesc
 
         const bool exists = ctx->dynObstacles.find(d.obstacleId) != ctx->dynObstacles.end();
         DynObstacleState& st = ctx->dynObstacles[d.obstacleId];
+        const DynObstacleState prev = st;
         st.id = d.obstacleId;
         st.teamMask = d.teamMask;
         st.avoidMask = d.avoidMask;
@@ -5349,6 +7262,16 @@ GTANAVVIEWER_API int UpsertDynamicObstacles(void* navMesh, const DynObstacleDesc
         st.height = std::max(0.0f, d.height);
         if (!exists)
             ctx->dynObstacleIds.push_back(d.obstacleId);
+
+        // Carving só é refeito quando a forma/posição mudou (cada troca custa remontar tiles).
+        if (ctx->navData.HasObstacleTileCache())
+        {
+            const bool changed = !exists || st.carvePending || prev.carveRef == 0 ||
+                prev.shapeType != st.shapeType || prev.pos != st.pos || prev.radius != st.radius ||
+                prev.halfX != st.halfX || prev.halfZ != st.halfZ || prev.height != st.height;
+            if (changed)
+                CarveDynamicObstacle(*ctx, st);
+        }
         ++upserted;
     }
     return upserted;
@@ -5363,8 +7286,12 @@ GTANAVVIEWER_API int RemoveDynamicObstacles(void* navMesh, const std::uint32_t*
     int removed = 0;
     for (int i = 0; i < count; ++i)
     {
-        if (ctx->dynObstacles.erase(obstacleIds[i]) > 0)
-            ++removed;
+        const auto it = ctx->dynObstacles.find(obstacleIds[i]);
+        if (it == ctx->dynObstacles.end())
+            continue;
+        UncarveDynamicObstacle(*ctx, it->second);
+        ctx->dynObstacles.erase(it);
+        ++removed;
     }
 
     if (removed > 0)
@@ -5384,10 +7311,98 @@ GTANAVVIEWER_API void ClearDynamicObstacles(void* navMesh)
     if (!navMesh)
         return;
     auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    for (auto& entry : ctx->dynObstacles)
+        UncarveDynamicObstacle(*ctx, entry.second);
     ctx->dynObstacles.clear();
     ctx->dynObstacleIds.clear();
 }
 
+GTANAVVIEWER_API bool SetWorldObstacleCarvingEnabled(void* navMesh, bool enabled, int maxObstacles, int maxLayersPerTile)
+{
+    if (!navMesh)
+        return false;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    if (!enabled)
+    {
+        const bool wasActive = ctx->navData.HasObstacleTileCache();
+        ctx->worldObstacleCarving = false;
+        for (auto& entry : ctx->dynObstacles)
+        {
+            entry.second.carveRef = 0;
+            entry.second.carvePending = false;
+        }
+        ctx->navData.DestroyObstacleTileCache();
+        // Tiles carregados ainda têm os obstáculos carvados; volta para o build sólido.
+        if (wasActive)
+        {
+            for (uint64_t key : ctx->residentTiles)
+                EnqueueTileBuild(*ctx, key);
+        }
+        return true;
+    }
+
+    if (ctx->genSettings.mode != NavmeshBuildMode::Tiled)
+    {
+        printf("[ExternC] SetWorldObstacleCarvingEnabled: requer modo tiled.\n");
+        return false;
+    }
+
+    const int layers = maxLayersPerTile > 0 ? maxLayersPerTile : 4;
+    if (!FitsResidentCapacity(*ctx, ctx->maxResidentTiles, layers))
+    {
+        printf("[WorldTile] SetWorldObstacleCarvingEnabled: %d tiles x %d layers excede a capacidade da sessao (%d); ligue o carving antes de BeginWorldTileSession.\n",
+               ctx->maxResidentTiles, layers, ctx->navData.GetNavMesh()->getMaxTiles());
+        return false;
+    }
+
+    ctx->worldObstacleCarving = true;
+    ctx->worldCarveMaxObstacles = maxObstacles > 0 ? maxObstacles : 1024;
+    ctx->worldCarveMaxLayers = layers;
+    ctx->navData.DestroyObstacleTileCache();
+    if (!ctx->navData.HasTiledCache())
+        return true; // cria no próximo BuildQueuedWorldTiles, depois do grid existir
+    if (!EnsureObstacleCarving(*ctx))
+        return false;
+
+    // Tiles já carregados não têm camadas; remonta para poderem ser carvados.
+    for (uint64_t key : ctx->residentTiles)
+        EnqueueTileBuild(*ctx, key);
+    return true;
+}
+
+GTANAVVIEWER_API int UpdateWorldObstacleCarving(void* navMesh, float budgetMs, bool* outUpToDate)
+{
+    if (outUpToDate)
+        *outUpToDate = true;
+    if (!navMesh)
+        return 0;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    if (!ctx->navData.HasObstacleTileCache())
+        return 0;
+
+    GtaNavTraceScope traceScope(GTANAV_TRACE_DEBUG, "Carving", "UpdateWorldObstacleCarving");
+    int retried = 0;
+    for (auto& entry : ctx->dynObstacles)
+    {
+        if (!entry.second.carvePending)
+            continue;
+        CarveDynamicObstacle(*ctx, entry.second);
+        ++retried;
+    }
+
+    int steps = 0;
+    const bool upToDate = ctx->navData.UpdateObstacles(budgetMs, &steps);
+    if (outUpToDate)
+        *outUpToDate = upToDate;
+    if (steps > 0)
+        EnsureNavQuery(*ctx);
+
+    traceScope.arg("steps", steps);
+    traceScope.arg("retried", retried);
+    traceScope.arg("upToDate", upToDate ? 1 : 0);
+    return steps;
+}
+
 GTANAVVIEWER_API int FindPathAvoidingDynamicObstacles(
     void* navMesh,
     Vector3 start,
@@ -5848,6 +7863,143 @@ GTANAVVIEWER_API int ComputeAgentPath(void* navMesh,
                               SIM_PATH_SOFT_REPATH);
 }
 
+GTANAVVIEWER_API std::uint32_t BuildFlowField(void* navMesh, Vector3 target, float radius, int flags)
+{
+    if (!navMesh)
+        return 0;
+
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    ExternNavmeshContext::FlowFieldEntry entry;
+    entry.field.reset(dtAllocFlowField());
+    if (!entry.field)
+        return 0;
+    entry.target = glm::vec3(target.x, target.y, target.z);
+    entry.radius = (std::isfinite(radius) && radius > 0.0f) ? radius : FLT_MAX;
+    entry.flags = flags;
+    if (!RefreshFlowField(*ctx, entry))
+    {
+        printf("[Sim] BuildFlowField: alvo (%.2f, %.2f, %.2f) fora do navmesh residente.\n", target.x, target.y, target.z);
+        return 0;
+    }
+
+    std::uint32_t id = ctx->nextFlowFieldId++;
+    if (id == 0)
+        id = ctx->nextFlowFieldId++;
+    ctx->flowFields[id] = std::move(entry);
+    return id;
+}
+
+GTANAVVIEWER_API bool SampleFlowField(void* navMesh,
+                                      std::uint32_t fieldId,
+                                      Vector3 pos,
+                                      Vector3* outSteerPos,
+                                      float* outCostToGo)
+{
+    if (!navMesh)
+        return false;
+
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    auto it = ctx->flowFields.find(fieldId);
+    if (it == ctx->flowFields.end() || !RefreshFlowField(*ctx, it->second))
+        return false;
+
+    const dtFlowField& field = *it->second.field;
+    const float p[3] = { pos.x, pos.y, pos.z };
+    dtPolyRef ref = 0;
+    float nearest[3]{};
+    if (dtStatusFailed(ctx->navQuery->findNearestPoly(p, ctx->cachedExtents, field.getFilter(), &ref, nearest)) || ref == 0)
+        return false;
+
+    float steer[3]{};
+    float costToGo = 0.0f;
+    if (!field.getNextHop(ref, nullptr, steer, &costToGo))
+        return false;
+
+    if (outSteerPos)
+        *outSteerPos = Vector3{ steer[0], steer[1], steer[2] };
+    if (outCostToGo)
+        *outCostToGo = costToGo;
+    return true;
+}
+
+GTANAVVIEWER_API int ComputeAgentPathFromFlowField(void* navMesh,
+                                                   std::uint32_t agentId,
+                                                   std::uint32_t fieldId,
+                                                   int maxCorners)
+{
+    if (!navMesh || maxCorners <= 0)
+        return 0;
+
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    auto agentIt = ctx->simAgents.find(agentId);
+    auto fieldIt = ctx->flowFields.find(fieldId);
+    if (agentIt == ctx->simAgents.end() || fieldIt == ctx->flowFields.end())
+        return 0;
+    if (!RefreshFlowField(*ctx, fieldIt->second))
+        return 0;
+
+    SimAgentState& agent = agentIt->second;
+    const dtFlowField& field = *fieldIt->second.field;
+    const float p[3] = { agent.pos.x, agent.pos.y, agent.pos.z };
+
+    // Sem busca: a cadeia de próximos polígonos do campo já é o corredor.
+    dtPolyRef startRef = agent.currentRef;
+    float startNearest[3]{};
+    if (startRef == 0 || !field.getNextHop(startRef, nullptr, nullptr, nullptr) ||
+        dtStatusFailed(ctx->navQuery->closestPointOnPoly(startRef, p, startNearest, nullptr)))
+    {
+        startRef = 0;
+        if (dtStatusFailed(ctx->navQuery->findNearestPoly(p, ctx->cachedExtents, field.getFilter(), &startRef, startNearest)) || startRef == 0)
+            return 0;
+    }
+
+    dtPolyRef polys[256]{};
+    int polyCount = 0;
+    const dtStatus pathStatus = field.getPath(startRef, polys, &polyCount, 256);
+    if (dtStatusFailed(pathStatus) || polyCount == 0)
+        return 0;
+
+    float endPos[3];
+    if (dtStatusDetail(pathStatus, DT_PARTIAL_RESULT))
+        field.getNextHop(polys[polyCount - 1], nullptr, endPos, nullptr);
+    else
+        dtVcopy(endPos, field.getGoalPos());
+
+    std::vector<float> corners(static_cast<size_t>(maxCorners) * 3);
+    std::vector<unsigned char> cornerFlags(static_cast<size_t>(maxCorners));
+    std::vector<dtPolyRef> straightRefs(static_cast<size_t>(maxCorners));
+    int straightCount = 0;
+    const dtStatus straightStatus = ctx->navQuery->findStraightPath(startNearest, endPos, polys, polyCount, corners.data(), cornerFlags.data(), straightRefs.data(), &straightCount, maxCorners, 0);
+    if (dtStatusFailed(straightStatus) || straightCount <= 0)
+        return 0;
+
+    corners.resize(static_cast<size_t>(straightCount) * 3);
+    cornerFlags.resize(static_cast<size_t>(straightCount));
+    agent.cornersXYZ = std::move(corners);
+    agent.cornerFlags = std::move(cornerFlags);
+    agent.cornerCount = straightCount;
+    agent.cornerIndex = 0;
+    agent.pathPolys.assign(polys, polys + polyCount);
+    agent.currentRef = startRef;
+    return agent.cornerCount;
+}
+
+GTANAVVIEWER_API void DestroyFlowField(void* navMesh, std::uint32_t fieldId)
+{
+    if (!navMesh)
+        return;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    ctx->flowFields.erase(fieldId);
+}
+
+GTANAVVIEWER_API void ClearFlowFields(void* navMesh)
+{
+    if (!navMesh)
+        return;
+    auto* ctx = static_cast<ExternNavmeshContext*>(navMesh);
+    ctx->flowFields.clear();
+}
+
 GTANAVVIEWER_API void EnableHeightSampling(void* navMesh, bool enabled)
 {
     if (!navMesh)
@@ -6321,3 +8473,97 @@ GTANAVVIEWER_API int SimulateAgentsFramesBatch(void* navMesh,
                                   outEvents,
                                   maxEvents);
 }
+
+GTANAVVIEWER_API bool GetNavBuildProfile(NavBuildProfileFFI* outProfile)
+{
+    if (!outProfile)
+        return false;
+
+    static_assert(RC_MAX_TIMERS <= 32, "NavBuildProfileFFI::stageMs pequeno demais para RC_MAX_TIMERS");
+    static_assert(GTANAV_PROF_MAX_COUNTERS <= 8, "NavBuildProfileFFI::counterMs pequeno demais");
+
+    GtaNavBuildProfile profile{};
+    GtaNavProfile_GetSnapshot(profile);
+
+    *outProfile = NavBuildProfileFFI{};
+    for (int i = 0; i < RC_MAX_TIMERS; ++i)
+    {
+        outProfile->stageMs[i] = profile.timerNs[i] / 1.0e6;
+        outProfile->stageCalls[i] = static_cast<std::uint32_t>(profile.timerCalls[i]);
+    }
+    for (int i = 0; i < GTANAV_PROF_MAX_COUNTERS; ++i)
+    {
+        outProfile->counterMs[i] = profile.counterNs[i] / 1.0e6;
+        outProfile->counterCalls[i] = static_cast<std::uint32_t>(profile.counterCalls[i]);
+        outProfile->counterBytes[i] = static_cast<std::uint64_t>(profile.counterBytes[i]);
+    }
+    outProfile->totalMs = profile.timerNs[RC_TIMER_TOTAL] / 1.0e6;
+    outProfile->stageCount = RC_MAX_TIMERS;
+    outProfile->counterCount = GTANAV_PROF_MAX_COUNTERS;
+    return true;
+}
+
+GTANAVVIEWER_API int GetNavBuildProfileJson(char* outBuffer, int bufferSize)
+{
+    GtaNavBuildProfile profile{};
+    GtaNavProfile_GetSnapshot(profile);
+    const std::string json = GtaNavProfile_ToJson(profile);
+
+    // Retorna o tamanho necessário (sem o '\0'); só copia se couber.
+    const int required = static_cast<int>(json.size());
+    if (outBuffer && bufferSize > required)
+    {
+        memcpy(outBuffer, json.data(), json.size());
+        outBuffer[required] = '\0';
+    }
+    return required;
+}
+
+GTANAVVIEWER_API bool SaveNavBuildProfileJson(const char* outputPath)
+{
+    if (!outputPath || !outputPath[0])
+        return false;
+
+    GtaNavBuildProfile profile{};
+    GtaNavProfile_GetSnapshot(profile);
+
+    const std::filesystem::path path(outputPath);
+    if (path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+    out << GtaNavProfile_ToJson(profile);
+    return out.good();
+}
+
+GTANAVVIEWER_API void ResetNavBuildProfile()
+{
+    GtaNavProfile_Reset();
+}
+
+GTANAVVIEWER_API void SetNavBuildProfileEnabled(bool enabled)
+{
+    GtaNavProfile_SetEnabled(enabled);
+}
+
+GTANAVVIEWER_API void SetNavTraceLevel(int level, int echoLevel)
+{
+    GtaNavTrace_SetLevel(level);
+    GtaNavTrace_SetEchoLevel(echoLevel);
+}
+
+GTANAVVIEWER_API void ClearNavTrace()
+{
+    GtaNavTrace_Clear();
+}
+
+GTANAVVIEWER_API int GetNavTraceEventCount()
+{
+    return GtaNavTrace_GetEventCount();
+}
+
+GTANAVVIEWER_API bool SaveNavTraceChromeJson(const char* outputPath)
+{
+    return GtaNavTrace_SaveChromeJson(outputPath);
+}
@@ -39,6 +39,26 @@ struct NavMeshPolygonInfo
     int edgeCount = 0;
 };
 
+enum NavTileChangeKind : int
+{
+    NAV_TILE_CHANGE_ADDED = 0,
+    NAV_TILE_CHANGE_REMOVED = 1,
+    NAV_TILE_CHANGE_REBUILT = 2
+};
+
+// Uma entrada do log de tiles. Consumidores indexam por (tx, ty, layer); polyRefBase
+// é a parte de tile dos polygonId (no REMOVED, a do tile que saiu).
+struct NavMeshTileChangeInfo
+{
+    std::uint64_t generation = 0;
+    std::uint64_t polyRefBase = 0;
+    int tx = 0;
+    int ty = 0;
+    int layer = 0;
+    std::uint32_t salt = 0;
+    int kind = NAV_TILE_CHANGE_ADDED;
+};
+
 struct NavMeshGeometryInfo
 {
     char customID[128]{};
@@ -203,12 +223,47 @@ struct SimEventFFI
     float duration = 0.0f;
 };
 
+// Perfil de build por estágio (ver GtaNavProfile.h).
+// stage* é indexado por rcTimerLabel; counter* segue GtaNavProfileCounter
+// (gather, detourCreate, addTile, cacheRead, cacheWrite).
+struct NavBuildProfileFFI
+{
+    double stageMs[32]{};
+    std::uint32_t stageCalls[32]{};
+    double counterMs[8]{};
+    std::uint32_t counterCalls[8]{};
+    std::uint64_t counterBytes[8]{};
+    double totalMs = 0.0;
+    std::int32_t stageCount = 0;
+    std::int32_t counterCount = 0;
+};
+
+// Estatísticas do alocador de tiles (ver GtaNavTileAlloc.h). class* por classe de tamanho.
+struct NavTileAllocStatsFFI
+{
+    std::uint32_t classBlockSize[48]{};
+    std::uint32_t classPages[48]{};
+    std::uint32_t classBlocksInUse[48]{};
+    std::uint32_t classBlocksFree[48]{};
+    std::uint64_t bytesInUse = 0;
+    std::uint64_t bytesReserved = 0;
+    std::uint64_t peakBytesInUse = 0;
+    std::uint64_t largeBytes = 0;
+    std::uint32_t largeCount = 0;
+    std::int32_t classCount = 0;
+};
+
 static_assert(sizeof(SimAgentDescFFI) == 64, "Unexpected SimAgentDescFFI ABI size");
 static_assert(sizeof(SimParamsFFI) == 104, "Unexpected SimParamsFFI ABI size");
 static_assert(sizeof(DynObstacleDescFFI) == 44, "Unexpected DynObstacleDescFFI ABI size");
 static_assert(sizeof(PathAvoidParamsFFI) == 32, "Unexpected PathAvoidParamsFFI ABI size");
+static_assert(sizeof(NavBuildProfileFFI) == 560, "Unexpected NavBuildProfileFFI ABI size");
+static_assert(sizeof(NavTileAllocStatsFFI) == 808, "Unexpected NavTileAllocStatsFFI ABI size");
 
-#ifdef _WIN32
+#if defined(GTANAVVIEWER_STATIC)
+  // Linkado direto no executável (GtaNavBake), sem DLL.
+  #define GTANAVVIEWER_API extern "C"
+#elif defined(_WIN32)
   #ifdef GTANAVVIEWER_BUILD_DLL
     #define GTANAVVIEWER_API extern "C" __declspec(dllexport)
   #else
@@ -225,7 +280,19 @@ GTANAVVIEWER_API void  SetNavMeshGenSettings(void* navMesh, const NavmeshGenerat
 GTANAVVIEWER_API void  SetAutoOffMeshGenerationParams(void* navMesh, const AutoOffmeshGenerationParamsV2* params);
 GTANAVVIEWER_API void  SetNavMeshCacheRoot(void* navMesh, const char* cacheRoot);
 GTANAVVIEWER_API void  SetNavMeshSessionId(void* navMesh, const char* sessionId);
-GTANAVVIEWER_API void  SetMaxResidentTiles(void* navMesh, int maxTiles);
+// Com dtPolyRef 64 bits e sessão aberta, false se maxTiles (x layers do carving) não couber
+// no dtNavMesh criado em BeginWorldTileSession; o limite anterior continua.
+GTANAVVIEWER_API bool  SetMaxResidentTiles(void* navMesh, int maxTiles);
+// Orçamento de memória dos tiles residentes (soma de dtMeshTile::dataSize); 0 = sem limite.
+// O LRU descarrega enquanto passar da contagem ou dos bytes.
+GTANAVVIEWER_API void  SetMaxResidentBytes(void* navMesh, std::uint64_t maxBytes);
+GTANAVVIEWER_API std::uint64_t GetResidentTileBytes(void* navMesh);
+// Tiles frios guardados compactos (NavmeshGenerationSettings::compactTiles). Usam só a
+// sobra do orçamento dos residentes: residentes + compactos <= maxResidentTiles (e bytes).
+GTANAVVIEWER_API int   GetCompactTileStats(void* navMesh, std::uint64_t* outBytes);
+// Largura do dtPolyRef do build (32 ou 64). Com 64 bits, BeginWorldTileSession dimensiona
+// a navmesh pelos tiles residentes; aumentar maxResidentTiles depois exige nova sessão.
+GTANAVVIEWER_API int   GetNavMeshPolyRefBits();
 GTANAVVIEWER_API bool  SaveNavMeshRuntimeCache(void* navMesh, const char* cacheFilePath);
 GTANAVVIEWER_API bool  LoadNavMeshRuntimeCache(void* navMesh, const char* cacheFilePath);
 
@@ -286,9 +353,16 @@ GTANAVVIEWER_API int QueueWorldGeometryEx(void* navMesh,
                                           bool preferBIN,
                                           std::uint32_t flags,
                                           const char* groupId);
+// Carrega as geometrias da fila em paralelo; maxItems/maxMilliseconds limitam o commit no índice de tiles.
 GTANAVVIEWER_API int ProcessQueuedWorldGeometry(void* navMesh, int maxItems, int maxMilliseconds);
 GTANAVVIEWER_API void SetWorldUnloadBuiltTilesAfterSave(void* navMesh, bool enabled);
 GTANAVVIEWER_API void SetWorldTileCacheGridDBEnabled(void* navMesh, bool enabled);
+// Codec dos tiles gravados no cache: 0 = sem compressão, 1 = LZ (padrão).
+// Só afeta gravações novas; a leitura aceita os dois.
+GTANAVVIEWER_API bool SetWorldTileCacheCodec(void* navMesh, int codec);
+// Threads do Recast em BuildQueuedWorldTiles (0 = núcleos da máquina). Com mais de uma, os
+// tiles da fila são gerados em lotes e trocados no navMesh na ordem da fila. Padrão 1.
+GTANAVVIEWER_API void SetWorldTileBuildThreads(void* navMesh, int threads);
 GTANAVVIEWER_API int BuildQueuedWorldTiles(void* navMesh, int maxTiles, int maxMilliseconds, bool saveToCache);
 GTANAVVIEWER_API bool SetWorldAutoOffmeshEnabled(void* navMesh, bool enabled);
 GTANAVVIEWER_API int GenerateWorldOffmeshLinksForQueuedTiles(void* navMesh, int maxTiles, int maxMilliseconds);
@@ -302,6 +376,16 @@ GTANAVVIEWER_API int StreamTilesForAgents(void* navMesh,
                                           bool allowBuildIfMissing);
 GTANAVVIEWER_API void RemoveStreamingAgent(void* navMesh, std::uint32_t agentId);
 GTANAVVIEWER_API void ClearStreamingAgents(void* navMesh);
+// Tiles do agent ainda na fila de build, do mais perto para o mais longe.
+// Retorna o total; grava no máximo maxTiles em outTileX/outTileY.
+GTANAVVIEWER_API int GetPendingWorldTilesForAgent(void* navMesh,
+                                                  std::uint32_t agentId,
+                                                  int* outTileX,
+                                                  int* outTileY,
+                                                  int maxTiles);
+// A fila de build prioriza os tiles perto dos agents; um tile que esperou agingPops
+// builds passa na frente uma vez a cada agedPopInterval (padrão 256 / 4).
+GTANAVVIEWER_API void SetWorldTileBuildAging(void* navMesh, int agingPops, int agedPopInterval);
 GTANAVVIEWER_API int GetWorldTileStreamingStats(void* navMesh,
                                                 int* outQueuedGeometries,
                                                 int* outIndexedGeometries,
@@ -316,9 +400,13 @@ GTANAVVIEWER_API int GetWorldTileStreamingStatsEx(void* navMesh,
                                                   int* outResidentTiles,
                                                   int* outManifestLoaded,
                                                   int* outTileDbIndexLoaded);
+// Tiles cujo build falhou (limite de triângulos ou erro do Recast) e que ficam sem navmesh.
+GTANAVVIEWER_API int GetWorldTileFailedCount(void* navMesh);
 GTANAVVIEWER_API bool SaveWorldTileManifest(void* navMesh);
 GTANAVVIEWER_API bool LoadWorldTileManifest(void* navMesh);
 GTANAVVIEWER_API bool HasWorldTileManifest(void* navMesh);
+// Dump legível do manifesto (path nulo = <session>.worldmanifest.json). Só para debug; o load usa o binário.
+GTANAVVIEWER_API bool ExportWorldTileManifestJson(void* navMesh, const char* path);
 GTANAVVIEWER_API bool SetWorldTileAutoSaveManifest(void* navMesh, bool enabled);
 
 // Pathfind
@@ -365,6 +453,56 @@ GTANAVVIEWER_API int GetNavMeshBorderEdges(void* navMesh,
                                            int maxEdges,
                                            int* outEdgeCount);
 
+// Deltas: a geração sobe a cada tile adicionado/removido/refeito. Passe a geração da última
+// chamada em sinceGeneration; outFullResync = true quando ela ficou velha demais (ou a malha
+// foi recriada) e a resposta traz a malha inteira. outGeneration só avança quando tudo coube.
+// Os deltas de polígonos trazem os tiles adicionados/refeitos; as remoções vêm de GetNavMeshTileChanges.
+GTANAVVIEWER_API std::uint64_t GetNavMeshGeneration(void* navMesh);
+GTANAVVIEWER_API int GetNavMeshTileChanges(void* navMesh,
+                                           std::uint64_t sinceGeneration,
+                                           NavMeshTileChangeInfo* outChanges,
+                                           int maxChanges,
+                                           std::uint64_t* outGeneration,
+                                           bool* outFullResync);
+GTANAVVIEWER_API int GetNavMeshPolygonsDelta(void* navMesh,
+                                             std::uint64_t sinceGeneration,
+                                             NavMeshPolygonInfo* polygons,
+                                             int maxPolygons,
+                                             Vector3* vertices,
+                                             int maxVertices,
+                                             NavMeshEdgeInfo* edges,
+                                             int maxEdges,
+                                             int* outVertexCount,
+                                             int* outEdgeCount,
+                                             std::uint64_t* outGeneration,
+                                             bool* outFullResync);
+// Bordas dos tiles alterados e dos vizinhos deles (links entre tiles mudam junto).
+GTANAVVIEWER_API int GetNavMeshBorderEdgesDelta(void* navMesh,
+                                                std::uint64_t sinceGeneration,
+                                                NavMeshEdgeInfo* edges,
+                                                int maxEdges,
+                                                int* outEdgeCount,
+                                                std::uint64_t* outGeneration,
+                                                bool* outFullResync);
+// Só os tiles que encostam nos bounds (granularidade de tile).
+GTANAVVIEWER_API int GetNavMeshPolygonsInBounds(void* navMesh,
+                                                Vector3 bmin,
+                                                Vector3 bmax,
+                                                NavMeshPolygonInfo* polygons,
+                                                int maxPolygons,
+                                                Vector3* vertices,
+                                                int maxVertices,
+                                                NavMeshEdgeInfo* edges,
+                                                int maxEdges,
+                                                int* outVertexCount,
+                                                int* outEdgeCount);
+GTANAVVIEWER_API int GetNavMeshBorderEdgesInBounds(void* navMesh,
+                                                   Vector3 bmin,
+                                                   Vector3 bmax,
+                                                   NavMeshEdgeInfo* edges,
+                                                   int maxEdges,
+                                                   int* outEdgeCount);
+
 // Offmesh links
 GTANAVVIEWER_API bool AddOffMeshLink(void* navMesh,
                                      Vector3 start,
@@ -396,6 +534,12 @@ GTANAVVIEWER_API void ClearSimAgents(void* navMesh);
 GTANAVVIEWER_API int UpsertDynamicObstacles(void* navMesh, const DynObstacleDescFFI* obs, int count);
 GTANAVVIEWER_API int RemoveDynamicObstacles(void* navMesh, const std::uint32_t* obstacleIds, int count);
 GTANAVVIEWER_API void ClearDynamicObstacles(void* navMesh);
+// Carving (DetourTileCache): obstáculos de UpsertDynamicObstacles são recortados
+// no navmesh; UpdateWorldObstacleCarving aplica por frame dentro do budget (ms).
+// Tiles carvados não vão para o TileDB; andares extras ocupam slots de tile. Com dtPolyRef
+// 64 bits ligue antes de BeginWorldTileSession: a navmesh reserva maxResidentTiles x layers.
+GTANAVVIEWER_API bool SetWorldObstacleCarvingEnabled(void* navMesh, bool enabled, int maxObstacles, int maxLayersPerTile);
+GTANAVVIEWER_API int UpdateWorldObstacleCarving(void* navMesh, float budgetMs, bool* outUpToDate);
 GTANAVVIEWER_API int ComputeAgentPath(void* navMesh,
                                       std::uint32_t agentId,
                                       Vector3 start,
@@ -413,6 +557,20 @@ GTANAVVIEWER_API int ComputeAgentPathEx(void* navMesh,
                                         float minEdgeDist,
                                         int options,
                                         std::uint32_t pathModeFlags);
+// Flow field: uma busca a partir do alvo serve todos os agentes com o mesmo destino.
+// O campo acompanha tiles que entram/saem do streaming; radius <= 0 = sem limite.
+GTANAVVIEWER_API std::uint32_t BuildFlowField(void* navMesh, Vector3 target, float radius, int flags);
+GTANAVVIEWER_API bool SampleFlowField(void* navMesh,
+                                      std::uint32_t fieldId,
+                                      Vector3 pos,
+                                      Vector3* outSteerPos,
+                                      float* outCostToGo);
+GTANAVVIEWER_API int ComputeAgentPathFromFlowField(void* navMesh,
+                                                   std::uint32_t agentId,
+                                                   std::uint32_t fieldId,
+                                                   int maxCorners);
+GTANAVVIEWER_API void DestroyFlowField(void* navMesh, std::uint32_t fieldId);
+GTANAVVIEWER_API void ClearFlowFields(void* navMesh);
 GTANAVVIEWER_API void EnableHeightSampling(void* navMesh, bool enabled);
 GTANAVVIEWER_API bool BuildHeightSamplerForCurrentGeometry(void* navMesh, int samplesPerTile, bool storeTwoLayers);
 GTANAVVIEWER_API int SimulateAgentFrames(void* navMesh,
@@ -444,3 +602,21 @@ GTANAVVIEWER_API int SimulateAgentsFramesBatch(void* navMesh,
 // Bounding box de build
 GTANAVVIEWER_API void SetNavMeshBoundingBox(void* navMesh, Vector3 bmin, Vector3 bmax);
 GTANAVVIEWER_API void RemoveNavMeshBoundingBox(void* navMesh);
+
+// Profiling de build
+GTANAVVIEWER_API bool GetNavBuildProfile(NavBuildProfileFFI* outProfile);
+GTANAVVIEWER_API int  GetNavBuildProfileJson(char* outBuffer, int bufferSize);
+GTANAVVIEWER_API bool SaveNavBuildProfileJson(const char* outputPath);
+GTANAVVIEWER_API void ResetNavBuildProfile();
+GTANAVVIEWER_API void SetNavBuildProfileEnabled(bool enabled);
+
+// Alocador de tiles (slabs por classe de tamanho, instalado em InitNavMesh)
+GTANAVVIEWER_API bool GetNavTileAllocStats(NavTileAllocStatsFFI* outStats);
+GTANAVVIEWER_API void TrimNavTileAlloc();
+
+// Trace estruturado (ring buffer -> chrome://tracing)
+// level/echoLevel: 0=off 1=erro 2=aviso 3=info 4=debug
+GTANAVVIEWER_API void SetNavTraceLevel(int level, int echoLevel);
+GTANAVVIEWER_API void ClearNavTrace();
+GTANAVVIEWER_API int  GetNavTraceEventCount();
+GTANAVVIEWER_API bool SaveNavTraceChromeJson(const char* outputPath);
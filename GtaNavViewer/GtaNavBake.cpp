@@ -0,0 +1,344 @@
+// GtaNavBake.cpp
+// Bake em lote dos tiles do mundo, sem janela/SDL. Lê um manifesto JSON com as geometrias,
+// roda o pipeline de tiles do mundo (ExternC) e grava no cache (TileDB ou GridDB).
+//
+// Manifesto:
+// {
+//   "bmin": [x, y, z], "bmax": [x, y, z],          (opcional se passado na linha de comando)
+//   "geometries": [
+//     { "path": "props/a.obj", "pos": [x, y, z], "rot": [x, y, z],
+//       "id": "a_01", "preferBIN": false, "flags": 1, "group": "default" }
+//   ]
+// }
+// Caminhos relativos são resolvidos a partir da pasta do manifesto.
+#include "ExternC.h"
+#include "GtaNavProfile.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct BakeOptions
+    {
+        std::string manifestPath;
+        std::string cacheRoot = "navcache";
+        std::string sessionId = "bake";
+        std::string profilePath;
+        int threads = 0;
+        int batchTiles = 256;
+        int codec = 1;
+        bool gridDb = false;
+        bool hasBounds = false;
+        Vector3 bmin{};
+        Vector3 bmax{};
+        NavmeshGenerationSettings settings{};
+    };
+
+    using BakeClock = std::chrono::steady_clock;
+
+    double ElapsedMs(BakeClock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(BakeClock::now() - start).count();
+    }
+
+    void PrintUsage()
+    {
+        printf("Uso: GtaNavBake <manifest.json> [opcoes]\n"
+               "  --cache <dir>            raiz do cache (padrao navcache)\n"
+               "  --session <id>           id da sessao (padrao bake)\n"
+               "  --threads <n>            threads do Recast (0 = nucleos, padrao)\n"
+               "  --batch <n>              tiles por chamada de BuildQueuedWorldTiles (padrao 256)\n"
+               "  --griddb                 grava em GridDB em vez do TileDB unico\n"
+               "  --codec <raw|lz>         codec dos tiles (padrao lz)\n"
+               "  --bounds x y z x y z     bounds do mundo (senao bmin/bmax do manifesto)\n"
+               "  --cell <cs> <ch>         cellSize / cellHeight\n"
+               "  --tile-size <n>          tileSize em celulas\n"
+               "  --agent <h> <r> <climb>  altura, raio e degrau do agent\n"
+               "  --profile <arquivo>      salva o perfil de build em JSON\n");
+    }
+
+    bool ReadVec3(const nlohmann::json& j, Vector3& out)
+    {
+        if (!j.is_array() || j.size() < 3)
+            return false;
+        out.x = j[0].get<float>();
+        out.y = j[1].get<float>();
+        out.z = j[2].get<float>();
+        return true;
+    }
+
+    bool ParseArgs(int argc, char** argv, BakeOptions& opt)
+    {
+        opt.settings.mode = NavmeshBuildMode::Tiled;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const auto need = [&](int count)
+            {
+                if (i + count >= argc)
+                {
+                    printf("[GtaNavBake] %s: faltam argumentos.\n", arg.c_str());
+                    return false;
+                }
+                return true;
+            };
+
+            if (arg == "--cache")
+            {
+                if (!need(1)) return false;
+                opt.cacheRoot = argv[++i];
+            }
+            else if (arg == "--session")
+            {
+                if (!need(1)) return false;
+                opt.sessionId = argv[++i];
+            }
+            else if (arg == "--threads")
+            {
+                if (!need(1)) return false;
+                opt.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--batch")
+            {
+                if (!need(1)) return false;
+                opt.batchTiles = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--griddb")
+            {
+                opt.gridDb = true;
+            }
+            else if (arg == "--codec")
+            {
+                if (!need(1)) return false;
+                const std::string codec = argv[++i];
+                if (codec == "raw")
+                    opt.codec = 0;
+                else if (codec == "lz")
+                    opt.codec = 1;
+                else
+                {
+                    printf("[GtaNavBake] codec desconhecido: %s\n", codec.c_str());
+                    return false;
+                }
+            }
+            else if (arg == "--bounds")
+            {
+                if (!need(6)) return false;
+                opt.bmin = { std::strtof(argv[i + 1], nullptr), std::strtof(argv[i + 2], nullptr), std::strtof(argv[i + 3], nullptr) };
+                opt.bmax = { std::strtof(argv[i + 4], nullptr), std::strtof(argv[i + 5], nullptr), std::strtof(argv[i + 6], nullptr) };
+                opt.hasBounds = true;
+                i += 6;
+            }
+            else if (arg == "--cell")
+            {
+                if (!need(2)) return false;
+                opt.settings.cellSize = std::strtof(argv[++i], nullptr);
+                opt.settings.cellHeight = std::strtof(argv[++i], nullptr);
+            }
+            else if (arg == "--tile-size")
+            {
+                if (!need(1)) return false;
+                opt.settings.tileSize = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--agent")
+            {
+                if (!need(3)) return false;
+                opt.settings.agentHeight = std::strtof(argv[++i], nullptr);
+                opt.settings.agentRadius = std::strtof(argv[++i], nullptr);
+                opt.settings.agentMaxClimb = std::strtof(argv[++i], nullptr);
+            }
+            else if (arg == "--profile")
+            {
+                if (!need(1)) return false;
+                opt.profilePath = argv[++i];
+            }
+            else if (arg == "-h" || arg == "--help")
+            {
+                return false;
+            }
+            else if (!arg.empty() && arg[0] != '-' && opt.manifestPath.empty())
+            {
+                opt.manifestPath = arg;
+            }
+            else
+            {
+                printf("[GtaNavBake] argumento desconhecido: %s\n", arg.c_str());
+                return false;
+            }
+        }
+        return !opt.manifestPath.empty();
+    }
+
+    void PrintProfile()
+    {
+        NavBuildProfileFFI profile{};
+        if (!GetNavBuildProfile(&profile))
+            return;
+
+        printf("[GtaNavBake] perfil: recast total=%.1fms\n", profile.totalMs);
+        for (int i = 0; i < profile.counterCount && i < GTANAV_PROF_MAX_COUNTERS; ++i)
+        {
+            if (profile.counterCalls[i] == 0)
+                continue;
+            printf("[GtaNavBake]   %-14s %10.1fms  calls=%u  bytes=%llu\n",
+                   GtaNavProfile_CounterName(static_cast<GtaNavProfileCounter>(i)),
+                   profile.counterMs[i], profile.counterCalls[i],
+                   static_cast<unsigned long long>(profile.counterBytes[i]));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BakeOptions opt;
+    if (!ParseArgs(argc, argv, opt))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    nlohmann::json manifest;
+    {
+        std::ifstream in(opt.manifestPath);
+        if (!in.is_open())
+        {
+            printf("[GtaNavBake] falha ao abrir manifesto: %s\n", opt.manifestPath.c_str());
+            return 1;
+        }
+        try
+        {
+            in >> manifest;
+        }
+        catch (const std::exception& e)
+        {
+            printf("[GtaNavBake] manifesto invalido: %s\n", e.what());
+            return 1;
+        }
+    }
+
+    if (!opt.hasBounds)
+        opt.hasBounds = ReadVec3(manifest.value("bmin", nlohmann::json()), opt.bmin) &&
+                        ReadVec3(manifest.value("bmax", nlohmann::json()), opt.bmax);
+    if (!opt.hasBounds)
+    {
+        printf("[GtaNavBake] bounds do mundo ausentes (use --bounds ou bmin/bmax no manifesto).\n");
+        return 1;
+    }
+
+    const std::filesystem::path manifestDir = std::filesystem::path(opt.manifestPath).parent_path();
+    const int threads = opt.threads > 0 ? opt.threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    void* nav = InitNavMesh();
+    if (!nav)
+        return 1;
+
+    SetNavMeshGenSettings(nav, &opt.settings);
+    SetWorldTileCacheGridDBEnabled(nav, opt.gridDb);
+    SetWorldTileCacheCodec(nav, opt.codec);
+    SetWorldTileBuildThreads(nav, threads);
+    // Os tiles já gravados saem do navMesh; a capacidade só precisa cobrir um lote.
+    SetWorldUnloadBuiltTilesAfterSave(nav, true);
+    if (!EnableWorldTileStreaming(nav, true) ||
+        !BeginWorldTileSession(nav, opt.bmin, opt.bmax, opt.cacheRoot.c_str(), opt.sessionId.c_str(), opt.batchTiles))
+    {
+        printf("[GtaNavBake] falha ao iniciar a sessao de tiles.\n");
+        DestroyNavMeshResources(nav);
+        return 1;
+    }
+    ResetNavBuildProfile();
+
+    const auto totalStart = BakeClock::now();
+
+    // 1) Fila de geometrias
+    auto stageStart = BakeClock::now();
+    int queued = 0;
+    int rejected = 0;
+    for (const auto& g : manifest.value("geometries", nlohmann::json::array()))
+    {
+        std::filesystem::path path = g.value("path", std::string());
+        if (path.empty())
+        {
+            ++rejected;
+            continue;
+        }
+        if (path.is_relative())
+            path = manifestDir / path;
+
+        Vector3 pos{};
+        Vector3 rot{};
+        ReadVec3(g.value("pos", nlohmann::json()), pos);
+        ReadVec3(g.value("rot", nlohmann::json()), rot);
+        const std::string id = g.value("id", path.filename().string() + "_" + std::to_string(queued + rejected));
+        const std::string group = g.value("group", std::string("default"));
+        const std::uint32_t flags = g.value("flags", static_cast<std::uint32_t>(WORLD_GEOM_PERSISTENT));
+        if (QueueWorldGeometryEx(nav, path.string().c_str(), pos, rot, id.c_str(), g.value("preferBIN", false), flags, group.c_str()) >= 0)
+            ++queued;
+        else
+            ++rejected;
+    }
+    const double queueMs = ElapsedMs(stageStart);
+
+    // 2) Carga das geometrias e índice de tiles
+    stageStart = BakeClock::now();
+    const int processed = ProcessQueuedWorldGeometry(nav, 0, 0);
+    const double loadMs = ElapsedMs(stageStart);
+
+    int pendingTiles = 0;
+    GetWorldTileStreamingStats(nav, nullptr, nullptr, nullptr, &pendingTiles, nullptr);
+    printf("[GtaNavBake] geometrias: %d na fila, %d rejeitadas, %d indexadas; %d tiles pendentes; %d threads\n",
+           queued, rejected, processed, pendingTiles, threads);
+
+    // 3) Build + gravação, um lote por vez
+    stageStart = BakeClock::now();
+    // O laço segue a fila, não o retorno do lote: só para quando não sobra tile pendente
+    // ou quando um lote não tirou nada da fila.
+    int builtTiles = 0;
+    int remaining = pendingTiles;
+    while (remaining > 0)
+    {
+        const int built = BuildQueuedWorldTiles(nav, opt.batchTiles, 0, true);
+        builtTiles += std::max(0, built);
+        const int before = remaining;
+        GetWorldTileStreamingStats(nav, nullptr, nullptr, nullptr, &remaining, nullptr);
+        printf("[GtaNavBake] %d tiles (%d restantes) %.1fs\n", builtTiles, remaining, ElapsedMs(stageStart) / 1000.0);
+        if (remaining >= before && built <= 0)
+        {
+            printf("[GtaNavBake] fila de tiles parada com %d pendentes.\n", remaining);
+            break;
+        }
+    }
+    const int failedTiles = GetWorldTileFailedCount(nav);
+    const double buildMs = ElapsedMs(stageStart);
+
+    // 4) Manifesto
+    stageStart = BakeClock::now();
+    const bool manifestOk = SaveWorldTileManifest(nav);
+    const double manifestMs = ElapsedMs(stageStart);
+    const double totalMs = ElapsedMs(totalStart);
+
+    printf("[GtaNavBake] etapas: fila=%.1fms carga=%.1fms build=%.1fms manifesto=%.1fms total=%.1fms\n",
+           queueMs, loadMs, buildMs, manifestMs, totalMs);
+    printf("[GtaNavBake] %d tiles em %.2fs = %.1f tiles/s\n",
+           builtTiles, buildMs / 1000.0, buildMs > 0.0 ? builtTiles * 1000.0 / buildMs : 0.0);
+    PrintProfile();
+    if (!opt.profilePath.empty() && !SaveNavBuildProfileJson(opt.profilePath.c_str()))
+        printf("[GtaNavBake] falha ao salvar perfil em %s\n", opt.profilePath.c_str());
+
+    if (failedTiles > 0 || remaining > 0)
+        printf("[GtaNavBake] incompleto: %d tiles falharam, %d pendentes.\n", failedTiles, remaining);
+
+    DestroyNavMeshResources(nav);
+    if (!manifestOk)
+        return 2;
+    return (failedTiles > 0 || remaining > 0) ? 3 : 0;
+}
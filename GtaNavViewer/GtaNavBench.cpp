@@ -0,0 +1,827 @@
+// GtaNavBench.cpp
+// Benchmark do pipeline de mundo com uma cidade sintética reproduzível (mesma seed = mesmos
+// arquivos). Mede bake de tiles, latência de streaming, FindPath / FindPathAvoidingDynamicObstacles,
+// SimulateAgentsFramesBatch e picos de memória; o resultado sai em JSON para comparar versões.
+//
+// A cidade: terreno em heightmap com a malha de ruas, lotes elevados, prédios e props
+// instanciados a partir de poucos protótipos (como no jogo) e prédios com andares
+// empilhados ligados por rampas.
+#include "ExternC.h"
+#include "GtaNavProfile.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    struct CityParams
+    {
+        int blocksX = 8;
+        int blocksZ = 8;
+        float blockSize = 80.0f;
+        float roadWidth = 12.0f;
+        float terrainStep = 4.0f;
+        int buildingsPerBlock = 4;
+        int propsPerBlock = 24;
+        int interiorEvery = 4;      // 1 a cada N lotes tem prédio com andares
+        int interiorFloors = 4;
+        int detail = 1;             // subdivisão NxN das faces dos protótipos (props densos)
+        unsigned int seed = 1337;
+    };
+
+    struct BenchOptions
+    {
+        CityParams city;
+        std::string workDir = "gtanavbench";
+        std::string outPath;
+        int threads = 0;
+        int pathQueries = 2000;
+        int obstacles = 64;
+        int agents = 256;
+        int simFrames = 60;
+        float streamRadius = 120.0f;
+        NavmeshGenerationSettings settings{};
+    };
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    struct ObjMesh
+    {
+        std::vector<Vec3> verts;
+        std::vector<int> tris;
+        int detail = 1;
+
+        int AddVert(const Vec3& v)
+        {
+            verts.push_back(v);
+            return static_cast<int>(verts.size()) - 1;
+        }
+
+        // Ordena o triângulo para a normal apontar para dir.
+        void AddTri(int a, int b, int c, const Vec3& dir)
+        {
+            const Vec3& va = verts[a];
+            const Vec3& vb = verts[b];
+            const Vec3& vc = verts[c];
+            const Vec3 e0{ vb.x - va.x, vb.y - va.y, vb.z - va.z };
+            const Vec3 e1{ vc.x - va.x, vc.y - va.y, vc.z - va.z };
+            const Vec3 n{ e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x };
+            if (n.x * dir.x + n.y * dir.y + n.z * dir.z < 0.0f)
+                std::swap(b, c);
+            tris.push_back(a);
+            tris.push_back(b);
+            tris.push_back(c);
+        }
+
+        // a-b-c-d em volta; com detail > 1 vira uma grade detail x detail.
+        void AddQuad(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d, const Vec3& dir)
+        {
+            const int n = std::max(1, detail);
+            const int base = static_cast<int>(verts.size());
+            for (int j = 0; j <= n; ++j)
+            {
+                const float v = static_cast<float>(j) / n;
+                for (int i = 0; i <= n; ++i)
+                {
+                    const float u = static_cast<float>(i) / n;
+                    const float wa = (1.0f - u) * (1.0f - v);
+                    const float wb = u * (1.0f - v);
+                    const float wc = u * v;
+                    const float wd = (1.0f - u) * v;
+                    AddVert({ a.x * wa + b.x * wb + c.x * wc + d.x * wd,
+                              a.y * wa + b.y * wb + c.y * wc + d.y * wd,
+                              a.z * wa + b.z * wb + c.z * wc + d.z * wd });
+                }
+            }
+            for (int j = 0; j < n; ++j)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    const int v00 = base + j * (n + 1) + i;
+                    const int v10 = v00 + 1;
+                    const int v11 = v10 + n + 1;
+                    const int v01 = v00 + n + 1;
+                    AddTri(v00, v10, v11, dir);
+                    AddTri(v00, v11, v01, dir);
+                }
+            }
+        }
+
+        // Caixa fechada com a base em y0.
+        void AddBox(float cx, float y0, float cz, float hx, float height, float hz)
+        {
+            const float x0 = cx - hx, x1 = cx + hx;
+            const float z0 = cz - hz, z1 = cz + hz;
+            const float y1 = y0 + height;
+            AddQuad({ x0, y1, z0 }, { x1, y1, z0 }, { x1, y1, z1 }, { x0, y1, z1 }, { 0, 1, 0 });
+            AddQuad({ x0, y0, z0 }, { x1, y0, z0 }, { x1, y0, z1 }, { x0, y0, z1 }, { 0, -1, 0 });
+            AddQuad({ x0, y0, z0 }, { x1, y0, z0 }, { x1, y1, z0 }, { x0, y1, z0 }, { 0, 0, -1 });
+            AddQuad({ x0, y0, z1 }, { x1, y0, z1 }, { x1, y1, z1 }, { x0, y1, z1 }, { 0, 0, 1 });
+            AddQuad({ x0, y0, z0 }, { x0, y0, z1 }, { x0, y1, z1 }, { x0, y1, z0 }, { -1, 0, 0 });
+            AddQuad({ x1, y0, z0 }, { x1, y0, z1 }, { x1, y1, z1 }, { x1, y1, z0 }, { 1, 0, 0 });
+        }
+
+        bool Save(const std::filesystem::path& path) const
+        {
+            std::ofstream out(path);
+            if (!out.is_open())
+                return false;
+            for (const Vec3& v : verts)
+                out << "v " << v.x << " " << v.y << " " << v.z << "\n";
+            for (size_t i = 0; i + 2 < tris.size(); i += 3)
+                out << "f " << tris[i] + 1 << " " << tris[i + 1] + 1 << " " << tris[i + 2] + 1 << "\n";
+            return out.good();
+        }
+    };
+
+    struct CityInstance
+    {
+        std::string path;
+        Vec3 pos;
+        float yawDeg;
+        std::string id;
+    };
+
+    struct City
+    {
+        Vec3 bmin{};
+        Vec3 bmax{};
+        std::vector<CityInstance> instances;
+        std::vector<Vec3> roadPoints;     // cruzamentos, para pathfind/agents
+        int triangles = 0;
+    };
+
+    float TerrainHeight(float x, float z)
+    {
+        return 2.0f * std::sin(x * 0.011f) + 1.5f * std::cos(z * 0.013f) + 0.5f * std::sin((x + z) * 0.031f);
+    }
+
+    float CityPitch(const CityParams& p)
+    {
+        return p.blockSize + p.roadWidth;
+    }
+
+    // Dentro de um lote (fora das ruas)? Lotes ficam 0.2m acima do terreno.
+    bool InsidePlot(const CityParams& p, float x, float z)
+    {
+        const float pitch = CityPitch(p);
+        const float lx = std::fmod(x, pitch);
+        const float lz = std::fmod(z, pitch);
+        return lx > p.roadWidth && lz > p.roadWidth &&
+               x < pitch * p.blocksX && z < pitch * p.blocksZ;
+    }
+
+    // Um chunk de terreno por lote (lote + metade das ruas em volta), em coordenadas do mundo.
+    ObjMesh BuildTerrainChunk(const CityParams& p, int bx, int bz)
+    {
+        const float pitch = CityPitch(p);
+        const float x0 = bx * pitch;
+        const float z0 = bz * pitch;
+        const float x1 = (bx + 1 == p.blocksX) ? x0 + pitch + p.roadWidth : x0 + pitch;
+        const float z1 = (bz + 1 == p.blocksZ) ? z0 + pitch + p.roadWidth : z0 + pitch;
+        const int nx = std::max(1, static_cast<int>(std::ceil((x1 - x0) / p.terrainStep)));
+        const int nz = std::max(1, static_cast<int>(std::ceil((z1 - z0) / p.terrainStep)));
+
+        ObjMesh mesh;
+        for (int iz = 0; iz <= nz; ++iz)
+        {
+            for (int ix = 0; ix <= nx; ++ix)
+            {
+                const float x = std::min(x1, x0 + ix * p.terrainStep);
+                const float z = std::min(z1, z0 + iz * p.terrainStep);
+                // Borda do lote levemente para dentro: o degrau fica na calçada, não na rua.
+                const float y = TerrainHeight(x, z) + (InsidePlot(p, x - 0.01f, z - 0.01f) ? 0.2f : 0.0f);
+                mesh.AddVert({ x, y, z });
+            }
+        }
+        for (int iz = 0; iz < nz; ++iz)
+        {
+            for (int ix = 0; ix < nx; ++ix)
+            {
+                const int a = iz * (nx + 1) + ix;
+                const int b = a + 1;
+                const int c = a + nx + 2;
+                const int d = a + nx + 1;
+                mesh.AddTri(a, b, c, { 0, 1, 0 });
+                mesh.AddTri(a, c, d, { 0, 1, 0 });
+            }
+        }
+        return mesh;
+    }
+
+    // Lajes de 4m empilhadas, rampa entre cada andar alternando o lado.
+    ObjMesh BuildInteriorStack(int floors, int detail)
+    {
+        const float half = 10.0f;
+        const float floorHeight = 4.0f;
+        const float rampWidth = 3.0f;
+        const float rampRun = 9.0f;
+        ObjMesh mesh;
+        mesh.detail = detail;
+        for (int f = 0; f < floors; ++f)
+        {
+            const float y = f * floorHeight;
+            if (f == 0)
+                mesh.AddBox(0.0f, y, 0.0f, half, 0.3f, half);
+            else
+            {
+                // Laje com o vão da rampa que chega neste andar.
+                const float side = (f % 2) ? 1.0f : -1.0f;
+                const float rx0 = side > 0 ? half - rampWidth : -half;
+                const float rx1 = rx0 + rampWidth;
+                const float zTop = -half + 0.5f + rampRun;
+                const float restX0 = side > 0 ? -half : rx1;
+                const float restX1 = side > 0 ? rx0 : half;
+                mesh.AddBox((restX0 + restX1) * 0.5f, y, 0.0f, (restX1 - restX0) * 0.5f, 0.3f, half);
+                mesh.AddBox((rx0 + rx1) * 0.5f, y, (zTop + half) * 0.5f, rampWidth * 0.5f, 0.3f, (half - zTop) * 0.5f);
+            }
+            if (f + 1 < floors)
+            {
+                const float side = ((f + 1) % 2) ? 1.0f : -1.0f;
+                const float rx0 = side > 0 ? half - rampWidth : -half;
+                const float rx1 = side > 0 ? half : -half + rampWidth;
+                const float yBottom = y + 0.3f;
+                const float yTop = y + floorHeight + 0.3f;
+                const float zBottom = -half + 0.5f;
+                const float zTop = zBottom + rampRun;
+                mesh.AddQuad({ rx0, yBottom, zBottom }, { rx1, yBottom, zBottom }, { rx1, yTop, zTop }, { rx0, yTop, zTop }, { 0, 1, 0 });
+            }
+        }
+        return mesh;
+    }
+
+    bool GenerateCity(const CityParams& p, const std::filesystem::path& dir, City& city)
+    {
+        std::filesystem::create_directories(dir);
+        std::mt19937 rng(p.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        int triangles = 0;
+        const auto save = [&](const ObjMesh& mesh, const std::filesystem::path& path)
+        {
+            triangles += static_cast<int>(mesh.tris.size() / 3);
+            return mesh.Save(path);
+        };
+
+        // Protótipos instanciados: prédios, props e o prédio com andares.
+        const float buildingSizes[4][3] = { { 8, 12, 8 }, { 12, 24, 10 }, { 16, 40, 16 }, { 10, 8, 20 } };
+        const float propSizes[4][3] = { { 1.0f, 0.5f, 0.3f }, { 0.2f, 0.9f, 0.2f }, { 1.0f, 1.5f, 0.6f }, { 0.6f, 2.8f, 0.6f } };
+        std::vector<ObjMesh> buildingProtos(4);
+        std::vector<ObjMesh> propProtos(4);
+        for (int i = 0; i < 4; ++i)
+        {
+            buildingProtos[i].detail = p.detail;
+            propProtos[i].detail = p.detail;
+            buildingProtos[i].AddBox(0.0f, 0.0f, 0.0f, buildingSizes[i][0] * 0.5f, buildingSizes[i][1], buildingSizes[i][2] * 0.5f);
+            propProtos[i].AddBox(0.0f, 0.0f, 0.0f, propSizes[i][0], propSizes[i][1], propSizes[i][2]);
+            if (!buildingProtos[i].Save(dir / ("building_" + std::to_string(i) + ".obj")) ||
+                !propProtos[i].Save(dir / ("prop_" + std::to_string(i) + ".obj")))
+                return false;
+        }
+        const ObjMesh interior = BuildInteriorStack(std::max(2, p.interiorFloors), p.detail);
+        if (!interior.Save(dir / "interior.obj"))
+            return false;
+
+        const float pitch = CityPitch(p);
+        city = City{};
+        city.bmin = { -8.0f, -20.0f, -8.0f };
+        city.bmax = { pitch * p.blocksX + p.roadWidth + 8.0f, 80.0f, pitch * p.blocksZ + p.roadWidth + 8.0f };
+
+        for (int bz = 0; bz < p.blocksZ; ++bz)
+        {
+            for (int bx = 0; bx < p.blocksX; ++bx)
+            {
+                const std::string chunkName = "terrain_" + std::to_string(bx) + "_" + std::to_string(bz) + ".obj";
+                if (!save(BuildTerrainChunk(p, bx, bz), dir / chunkName))
+                    return false;
+                city.instances.push_back({ chunkName, { 0, 0, 0 }, 0.0f, chunkName });
+
+                const float plotX0 = bx * pitch + p.roadWidth;
+                const float plotZ0 = bz * pitch + p.roadWidth;
+                city.roadPoints.push_back({ bx * pitch + p.roadWidth * 0.5f, 0.0f, bz * pitch + p.roadWidth * 0.5f });
+
+                // Prédios em grade 2x2 dentro do lote; um lote a cada interiorEvery vira prédio com andares.
+                const bool hasInterior = p.interiorEvery > 0 && ((bx + bz * p.blocksX) % p.interiorEvery) == 0;
+                const int cells = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(p.buildingsPerBlock)))));
+                const float cell = p.blockSize / cells;
+                for (int b = 0; b < p.buildingsPerBlock; ++b)
+                {
+                    const float cx = plotX0 + (b % cells + 0.5f) * cell;
+                    const float cz = plotZ0 + (b / cells + 0.5f) * cell;
+                    const float y = TerrainHeight(cx, cz) + 0.2f;
+                    const std::string id = "b_" + std::to_string(bx) + "_" + std::to_string(bz) + "_" + std::to_string(b);
+                    if (hasInterior && b == 0)
+                    {
+                        city.instances.push_back({ "interior.obj", { cx, y, cz }, 0.0f, id });
+                        triangles += static_cast<int>(interior.tris.size() / 3);
+                        continue;
+                    }
+                    const int proto = static_cast<int>(unit(rng) * 4.0f) & 3;
+                    const float yaw = 90.0f * (static_cast<int>(unit(rng) * 4.0f) & 3);
+                    city.instances.push_back({ "building_" + std::to_string(proto) + ".obj", { cx, y, cz }, yaw, id });
+                    triangles += static_cast<int>(buildingProtos[proto].tris.size() / 3);
+                }
+
+                // Props ao longo da calçada (primeiros 3m do lote).
+                for (int i = 0; i < p.propsPerBlock; ++i)
+                {
+                    const float t = unit(rng) * p.blockSize;
+                    const float inset = 0.5f + unit(rng) * 2.5f;
+                    float px = plotX0 + t;
+                    float pz = plotZ0 + inset;
+                    switch (i & 3)
+                    {
+                    case 1: px = plotX0 + inset; pz = plotZ0 + t; break;
+                    case 2: pz = plotZ0 + p.blockSize - inset; break;
+                    case 3: px = plotX0 + p.blockSize - inset; pz = plotZ0 + t; break;
+                    default: break;
+                    }
+                    const int proto = static_cast<int>(unit(rng) * 4.0f) & 3;
+                    const float yaw = unit(rng) * 360.0f;
+                    const std::string id = "p_" + std::to_string(bx) + "_" + std::to_string(bz) + "_" + std::to_string(i);
+                    city.instances.push_back({ "prop_" + std::to_string(proto) + ".obj", { px, TerrainHeight(px, pz) + 0.2f, pz }, yaw, id });
+                    triangles += static_cast<int>(propProtos[proto].tris.size() / 3);
+                }
+            }
+        }
+        for (Vec3& rp : city.roadPoints)
+            rp.y = TerrainHeight(rp.x, rp.z);
+        city.triangles = triangles;
+        return true;
+    }
+
+    using BenchClock = std::chrono::steady_clock;
+
+    double ElapsedMs(BenchClock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+    }
+
+    nlohmann::json LatencyJson(std::vector<double> samplesUs)
+    {
+        nlohmann::json j;
+        j["count"] = samplesUs.size();
+        if (samplesUs.empty())
+            return j;
+        std::sort(samplesUs.begin(), samplesUs.end());
+        const auto rank = [&](double q)
+        {
+            const size_t idx = static_cast<size_t>(std::ceil(q * samplesUs.size())) - 1;
+            return samplesUs[std::min(idx, samplesUs.size() - 1)];
+        };
+        double sum = 0.0;
+        for (double s : samplesUs)
+            sum += s;
+        j["meanUs"] = sum / samplesUs.size();
+        j["p50Us"] = rank(0.50);
+        j["p90Us"] = rank(0.90);
+        j["p99Us"] = rank(0.99);
+        j["maxUs"] = samplesUs.back();
+        return j;
+    }
+
+    // Pico de memória residente do processo (working set no Windows); null no JSON se a plataforma não tiver.
+    nlohmann::json PeakRssBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+#elif defined(__APPLE__)
+        struct rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            return static_cast<uint64_t>(usage.ru_maxrss);
+#elif defined(__unix__)
+        struct rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+#endif
+        return nullptr;
+    }
+
+    void PrintUsage()
+    {
+        printf("Uso: GtaNavBench [opcoes]\n"
+               "  --blocks <x> <z>         lotes da cidade (padrao 8 8)\n"
+               "  --seed <n>               seed do gerador (padrao 1337)\n"
+               "  --props <n>              props por lote (padrao 24)\n"
+               "  --floors <n>             andares dos predios com interior (padrao 4)\n"
+               "  --detail <n>             subdivide as faces dos props/predios em n x n (padrao 1)\n"
+               "  --threads <n>            threads do bake (0 = nucleos, padrao)\n"
+               "  --paths <n>              consultas de pathfind (padrao 2000)\n"
+               "  --obstacles <n>          obstaculos dinamicos (padrao 64)\n"
+               "  --agents <n> <frames>    agentes e frames simulados (padrao 256 60)\n"
+               "  --stream-radius <m>      raio do streaming (padrao 120)\n"
+               "  --work <dir>             pasta da cidade gerada e do cache (padrao gtanavbench)\n"
+               "  --out <arquivo>          grava o resultado em JSON (sempre impresso no stdout)\n");
+    }
+
+    bool ParseArgs(int argc, char** argv, BenchOptions& opt)
+    {
+        opt.settings.mode = NavmeshBuildMode::Tiled;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const auto need = [&](int count)
+            {
+                if (i + count >= argc)
+                {
+                    printf("[GtaNavBench] %s: faltam argumentos.\n", arg.c_str());
+                    return false;
+                }
+                return true;
+            };
+
+            if (arg == "--blocks")
+            {
+                if (!need(2)) return false;
+                opt.city.blocksX = std::max(1, std::atoi(argv[++i]));
+                opt.city.blocksZ = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--seed")
+            {
+                if (!need(1)) return false;
+                opt.city.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (arg == "--props")
+            {
+                if (!need(1)) return false;
+                opt.city.propsPerBlock = std::max(0, std::atoi(argv[++i]));
+            }
+            else if (arg == "--floors")
+            {
+                if (!need(1)) return false;
+                opt.city.interiorFloors = std::max(2, std::atoi(argv[++i]));
+            }
+            else if (arg == "--detail")
+            {
+                if (!need(1)) return false;
+                opt.city.detail = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--threads")
+            {
+                if (!need(1)) return false;
+                opt.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--paths")
+            {
+                if (!need(1)) return false;
+                opt.pathQueries = std::max(0, std::atoi(argv[++i]));
+            }
+            else if (arg == "--obstacles")
+            {
+                if (!need(1)) return false;
+                opt.obstacles = std::max(0, std::atoi(argv[++i]));
+            }
+            else if (arg == "--agents")
+            {
+                if (!need(2)) return false;
+                opt.agents = std::max(0, std::atoi(argv[++i]));
+                opt.simFrames = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--stream-radius")
+            {
+                if (!need(1)) return false;
+                opt.streamRadius = std::max(1.0f, std::strtof(argv[++i], nullptr));
+            }
+            else if (arg == "--work")
+            {
+                if (!need(1)) return false;
+                opt.workDir = argv[++i];
+            }
+            else if (arg == "--out")
+            {
+                if (!need(1)) return false;
+                opt.outPath = argv[++i];
+            }
+            else
+            {
+                if (arg != "-h" && arg != "--help")
+                    printf("[GtaNavBench] argumento desconhecido: %s\n", arg.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Vector3 ToVector3(const Vec3& v)
+    {
+        return Vector3{ v.x, v.y, v.z };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions opt;
+    if (!ParseArgs(argc, argv, opt))
+    {
+        PrintUsage();
+        return 1;
+    }
+    const int threads = opt.threads > 0 ? opt.threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    nlohmann::json result;
+    result["schema"] = 1;
+    result["config"] = {
+        { "blocks", { opt.city.blocksX, opt.city.blocksZ } },
+        { "blockSize", opt.city.blockSize },
+        { "roadWidth", opt.city.roadWidth },
+        { "propsPerBlock", opt.city.propsPerBlock },
+        { "interiorFloors", opt.city.interiorFloors },
+        { "detail", opt.city.detail },
+        { "seed", opt.city.seed },
+        { "threads", threads },
+        { "cellSize", opt.settings.cellSize },
+        { "tileSize", opt.settings.tileSize },
+        { "polyRefBits", GetNavMeshPolyRefBits() }
+    };
+
+    // 1) Cidade
+    const std::filesystem::path workDir = opt.workDir;
+    const std::filesystem::path cityDir = workDir / "city";
+    auto stageStart = BenchClock::now();
+    City city;
+    if (!GenerateCity(opt.city, cityDir, city))
+    {
+        printf("[GtaNavBench] falha ao gerar a cidade em %s\n", cityDir.string().c_str());
+        return 1;
+    }
+    result["city"] = {
+        { "instances", city.instances.size() },
+        { "triangles", city.triangles },
+        { "bmin", { city.bmin.x, city.bmin.y, city.bmin.z } },
+        { "bmax", { city.bmax.x, city.bmax.y, city.bmax.z } },
+        { "generateMs", ElapsedMs(stageStart) }
+    };
+
+    // 2) Bake
+    const std::filesystem::path cacheDir = workDir / "cache";
+    std::filesystem::remove_all(cacheDir);
+    void* nav = InitNavMesh();
+    if (!nav)
+        return 1;
+    SetNavMeshGenSettings(nav, &opt.settings);
+    SetWorldTileBuildThreads(nav, threads);
+    SetWorldUnloadBuiltTilesAfterSave(nav, true);
+    const float tileWorld = opt.settings.tileSize * opt.settings.cellSize;
+    const int worldTiles = static_cast<int>(std::ceil((city.bmax.x - city.bmin.x) / tileWorld) * std::ceil((city.bmax.z - city.bmin.z) / tileWorld));
+    if (!EnableWorldTileStreaming(nav, true) ||
+        !BeginWorldTileSession(nav, ToVector3(city.bmin), ToVector3(city.bmax), cacheDir.string().c_str(), "bench", worldTiles))
+    {
+        printf("[GtaNavBench] falha ao iniciar a sessao de tiles.\n");
+        DestroyNavMeshResources(nav);
+        return 1;
+    }
+    ResetNavBuildProfile();
+
+    stageStart = BenchClock::now();
+    for (const CityInstance& inst : city.instances)
+        QueueWorldGeometry(nav, (cityDir / inst.path).string().c_str(), ToVector3(inst.pos), Vector3{ 0.0f, 0.0f, inst.yawDeg }, inst.id.c_str(), false);
+    const int indexed = ProcessQueuedWorldGeometry(nav, 0, 0);
+    const double loadMs = ElapsedMs(stageStart);
+
+    int pendingTiles = 0;
+    GetWorldTileStreamingStats(nav, nullptr, nullptr, nullptr, &pendingTiles, nullptr);
+    stageStart = BenchClock::now();
+    int bakedTiles = 0;
+    for (int built = BuildQueuedWorldTiles(nav, 512, 0, true); built > 0; built = BuildQueuedWorldTiles(nav, 512, 0, true))
+        bakedTiles += built;
+    const double bakeMs = ElapsedMs(stageStart);
+    NavBuildProfileFFI profile{};
+    GetNavBuildProfile(&profile);
+    result["bake"] = {
+        { "geometryIndexed", indexed },
+        { "geometryLoadMs", loadMs },
+        { "tilesQueued", pendingTiles },
+        { "tilesBuilt", bakedTiles },
+        { "bakeMs", bakeMs },
+        { "tilesPerSecond", bakeMs > 0.0 ? bakedTiles * 1000.0 / bakeMs : 0.0 },
+        { "recastMs", profile.totalMs },
+        { "rasterizeMs", profile.stageMs[RC_TIMER_RASTERIZE_TRIANGLES] },
+        { "cacheWriteMs", profile.counterMs[GTANAV_PROF_CACHE_WRITE] }
+    };
+    printf("[GtaNavBench] bake: %d tiles em %.1fms (%d threads)\n", bakedTiles, bakeMs, threads);
+
+    // 3) Streaming: um agent percorre a diagonal da cidade a meio tile por passo, tudo do cache.
+    ClearAllLoadedTiles(nav);
+    std::vector<double> streamUs;
+    int streamRequested = 0;
+    {
+        const Vec3 from = city.roadPoints.front();
+        const Vec3 to = city.roadPoints.back();
+        const float dx = to.x - from.x;
+        const float dz = to.z - from.z;
+        const int steps = std::max(1, static_cast<int>(std::sqrt(dx * dx + dz * dz) / (tileWorld * 0.5f)));
+        for (int s = 0; s <= steps; ++s)
+        {
+            const float t = static_cast<float>(s) / steps;
+            const Vector3 center{ from.x + dx * t, from.y, from.z + dz * t };
+            const auto callStart = BenchClock::now();
+            streamRequested += StreamTilesAround(nav, center, opt.streamRadius, false);
+            streamUs.push_back(ElapsedMs(callStart) * 1000.0);
+        }
+    }
+    nlohmann::json streaming = LatencyJson(streamUs);
+    streaming["radius"] = opt.streamRadius;
+    // StreamTilesAround devolve os tiles da área (carregados ou já residentes).
+    streaming["tilesRequested"] = streamRequested;
+    int residentTiles = 0;
+    GetWorldTileStreamingStats(nav, nullptr, nullptr, nullptr, nullptr, &residentTiles);
+    streaming["residentTiles"] = residentTiles;
+    streaming["residentBytes"] = GetResidentTileBytes(nav);
+    result["streaming"] = streaming;
+
+    // Cidade inteira residente para as consultas.
+    const Vector3 cityCenter{ (city.bmin.x + city.bmax.x) * 0.5f, 0.0f, (city.bmin.z + city.bmax.z) * 0.5f };
+    StreamTilesAround(nav, cityCenter, std::max(city.bmax.x - city.bmin.x, city.bmax.z - city.bmin.z), false);
+
+    // 4) Pathfind entre cruzamentos
+    std::mt19937 rng(opt.city.seed ^ 0x9e3779b9u);
+    std::uniform_int_distribution<size_t> pick(0, city.roadPoints.size() - 1);
+    constexpr int kMaxPoints = 256;
+    std::vector<float> pathBuf(kMaxPoints * 3);
+    std::vector<NodeInfo> nodeBuf(kMaxPoints);
+    std::vector<std::pair<Vec3, Vec3>> queries;
+    queries.reserve(static_cast<size_t>(opt.pathQueries));
+    for (int i = 0; i < opt.pathQueries; ++i)
+        queries.emplace_back(city.roadPoints[pick(rng)], city.roadPoints[pick(rng)]);
+
+    std::vector<double> pathUs;
+    int pathFound = 0;
+    double pathLength = 0.0;
+    for (const auto& q : queries)
+    {
+        const auto callStart = BenchClock::now();
+        const int n = FindPath(nav, ToVector3(q.first), ToVector3(q.second), 0xffff, kMaxPoints, pathBuf.data(), 0);
+        pathUs.push_back(ElapsedMs(callStart) * 1000.0);
+        pathFound += n > 0 ? 1 : 0;
+        for (int k = 1; k < n; ++k)
+        {
+            const float* p0 = &pathBuf[(k - 1) * 3];
+            const float* p1 = &pathBuf[k * 3];
+            pathLength += std::sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) + (p1[1] - p0[1]) * (p1[1] - p0[1]) + (p1[2] - p0[2]) * (p1[2] - p0[2]));
+        }
+    }
+    nlohmann::json findPath = LatencyJson(pathUs);
+    findPath["found"] = pathFound;
+    // Soma dos comprimentos: compara o resultado walkable entre versões/opções.
+    findPath["totalLength"] = pathLength;
+    result["findPath"] = findPath;
+
+    // 5) Pathfind desviando de obstáculos dinâmicos espalhados pelas ruas
+    std::vector<DynObstacleDescFFI> obstacles(static_cast<size_t>(opt.obstacles));
+    std::uniform_real_distribution<float> jitter(-4.0f, 4.0f);
+    for (int i = 0; i < opt.obstacles; ++i)
+    {
+        const Vec3& rp = city.roadPoints[pick(rng)];
+        DynObstacleDescFFI& ob = obstacles[static_cast<size_t>(i)];
+        ob.obstacleId = static_cast<std::uint32_t>(i + 1);
+        ob.avoidMask = 0xffffffffu;
+        ob.teamMask = 0xffffffffu;
+        ob.shapeType = (i & 1) ? DYNOBS_BOX_AABB : DYNOBS_CYLINDER;
+        ob.pos[0] = rp.x + jitter(rng);
+        ob.pos[1] = rp.y;
+        ob.pos[2] = rp.z + jitter(rng);
+        ob.radius = 1.5f;
+        ob.halfX = 2.2f;
+        ob.halfZ = 1.0f;
+        ob.height = 1.8f;
+    }
+    if (!obstacles.empty())
+        UpsertDynamicObstacles(nav, obstacles.data(), static_cast<int>(obstacles.size()));
+    const PathAvoidParamsFFI avoidParams{};
+    std::vector<double> avoidUs;
+    int avoidFound = 0;
+    for (const auto& q : queries)
+    {
+        const auto callStart = BenchClock::now();
+        const int n = FindPathAvoidingDynamicObstacles(nav, ToVector3(q.first), ToVector3(q.second), 0xffff, kMaxPoints, -1.0f, 0,
+                                                       &avoidParams, 0xffffffffu, 0, pathBuf.data(), nodeBuf.data());
+        avoidUs.push_back(ElapsedMs(callStart) * 1000.0);
+        avoidFound += n > 0 ? 1 : 0;
+    }
+    nlohmann::json avoidPath = LatencyJson(avoidUs);
+    avoidPath["found"] = avoidFound;
+    avoidPath["obstacles"] = opt.obstacles;
+    result["findPathAvoidingDynamicObstacles"] = avoidPath;
+
+    // 6) Simulação em lote
+    nlohmann::json sim;
+    if (opt.agents > 0)
+    {
+        std::vector<SimAgentDescFFI> agents(static_cast<size_t>(opt.agents));
+        std::vector<std::uint32_t> agentIds(static_cast<size_t>(opt.agents));
+        int withPath = 0;
+        for (int i = 0; i < opt.agents; ++i)
+        {
+            const Vec3& rp = city.roadPoints[pick(rng)];
+            SimAgentDescFFI& a = agents[static_cast<size_t>(i)];
+            a.agentId = static_cast<std::uint32_t>(1000 + i);
+            a.flags = AGENT_ENABLED | ((i % 8) == 0 ? AGENT_VEHICLE : 0u);
+            a.pos[0] = rp.x + jitter(rng);
+            a.pos[1] = rp.y;
+            a.pos[2] = rp.z + jitter(rng);
+            a.radius = 0.4f;
+            a.halfX = 1.0f;
+            a.halfZ = 2.2f;
+            a.height = 1.8f;
+            agentIds[static_cast<size_t>(i)] = a.agentId;
+        }
+        UpsertSimAgents(nav, agents.data(), opt.agents);
+        for (const SimAgentDescFFI& a : agents)
+        {
+            const Vec3& target = city.roadPoints[pick(rng)];
+            if (ComputeAgentPath(nav, a.agentId, Vector3{ a.pos[0], a.pos[1], a.pos[2] }, ToVector3(target), 0xffff, 64, -1.0f, 0) > 0)
+                ++withPath;
+        }
+
+        SimParamsFFI params{};
+        params.agentSpeed = 4.0f;
+        params.agentAccel = 8.0f;
+        params.agentTurnSpeedDeg = 270.0f;
+        params.lookAheadDist = 2.0f;
+        params.reachRadius = 0.6f;
+        params.avoidWeight = 1.0f;
+        params.avoidRange = 3.0f;
+        params.wallAvoidWeight = 0.5f;
+        params.wallAvoidDist = 1.0f;
+        params.gravity = 9.8f;
+        params.maxFallSpeed = 30.0f;
+        params.maxSpeedForward = 12.0f;
+        params.maxSpeedReverse = 4.0f;
+        params.brakeDecel = 10.0f;
+
+        const size_t frameSlots = static_cast<size_t>(opt.agents) * static_cast<size_t>(opt.simFrames);
+        std::vector<float> outPos(frameSlots * 3);
+        std::vector<float> outHeading(frameSlots);
+        std::vector<float> outVel(frameSlots * 3);
+        std::vector<std::uint8_t> outFlags(frameSlots);
+        std::vector<float> outEuler(frameSlots * 3);
+        std::vector<SimEventFFI> outEvents(1024);
+        const auto simStart = BenchClock::now();
+        const int simulated = SimulateAgentsFramesBatch(nav, agentIds.data(), opt.agents, 1.0f / 30.0f, opt.simFrames, &params,
+                                                        outPos.data(), outHeading.data(), outVel.data(), outFlags.data(),
+                                                        outEuler.data(), outEvents.data(), static_cast<int>(outEvents.size()));
+        const double simMs = ElapsedMs(simStart);
+        sim = {
+            { "agents", opt.agents },
+            { "agentsWithPath", withPath },
+            { "frames", opt.simFrames },
+            { "result", simulated },
+            { "batchMs", simMs },
+            { "msPerFrame", simMs / opt.simFrames },
+            // agent-frames simulados por ms
+            { "agentsPerMs", simMs > 0.0 ? static_cast<double>(frameSlots) / simMs : 0.0 }
+        };
+    }
+    result["simulateAgentsFramesBatch"] = sim;
+
+    // 7) Memória
+    NavTileAllocStatsFFI alloc{};
+    GetNavTileAllocStats(&alloc);
+    result["memory"] = {
+        { "peakRssBytes", PeakRssBytes() },
+        { "tileAllocPeakBytes", alloc.peakBytesInUse },
+        { "tileAllocInUseBytes", alloc.bytesInUse },
+        { "tileAllocReservedBytes", alloc.bytesReserved },
+        { "residentTileBytes", GetResidentTileBytes(nav) }
+    };
+
+    DestroyNavMeshResources(nav);
+
+    const std::string text = result.dump(2);
+    printf("%s\n", text.c_str());
+    if (!opt.outPath.empty())
+    {
+        std::ofstream out(opt.outPath);
+        out << text << "\n";
+        if (!out.good())
+        {
+            printf("[GtaNavBench] falha ao gravar %s\n", opt.outPath.c_str());
+            return 2;
+        }
+    }
+    return 0;
+}
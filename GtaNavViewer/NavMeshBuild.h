@@ -45,3 +45,28 @@ bool BuildSingleTile(const NavmeshBuildInput& input,
                      dtNavMesh* nav,
                      bool& outBuilt,
                      bool& outEmpty);
+
+// Metade "pura" do BuildSingleTile: não toca o dtNavMesh, então tiles diferentes podem
+// rodar em threads diferentes (cada uma com o seu rcContext em input.ctx).
+// outData (dtAlloc) fica nulo quando o tile não tem triângulos (outNoGeometry) ou não gerou polys (outEmpty).
+bool BuildSingleTileData(const NavmeshBuildInput& input,
+                         const NavmeshGenerationSettings& settings,
+                         int tileX,
+                         int tileY,
+                         int maxPolys,
+                         unsigned char*& outData,
+                         int& outDataSize,
+                         bool& outNoGeometry,
+                         bool& outEmpty);
+
+// Outra metade: troca o tile no navMesh (assume a posse de data). Sem geometria remove o tile;
+// Empty mantém o anterior.
+bool ApplySingleTileData(dtNavMesh* nav,
+                         int tileX,
+                         int tileY,
+                         unsigned char* data,
+                         int dataSize,
+                         bool noGeometry,
+                         bool empty,
+                         bool& outBuilt,
+                         bool& outEmpty);
@@ -8,6 +8,9 @@
 #include <DetourCommon.h>
 
 #include "NavMeshBuild.h"
+#include "NavMesh_TileCacheDB.h"
+#include "GtaNavProfile.h"
+#include "GtaNavRefBits.h"
 
 #include <algorithm>
 #include <cstdarg>
@@ -25,7 +28,7 @@
 
 namespace
 {
-    struct LoggingRcContext : public rcContext
+    struct LoggingRcContext : public GtaNavProfilingContext
     {
         void doLog(const rcLogCategory category, const char* msg, const int len) override
         {
@@ -568,6 +571,8 @@ namespace
 
 NavMeshData::~NavMeshData()
 {
+    DestroyObstacleTileCache();
+    ClearCompactTiles();
     if (m_nav)
     {
         dtFreeNavMesh(m_nav);
@@ -1468,6 +1473,8 @@ NavMeshData& NavMeshData::operator=(NavMeshData&& other) noexcept
 {
     if (this != &other)
     {
+        DestroyObstacleTileCache();
+        ClearCompactTiles();
         if (m_nav)
         {
             dtFreeNavMesh(m_nav);
@@ -1475,6 +1482,8 @@ NavMeshData& NavMeshData::operator=(NavMeshData&& other) noexcept
 
         m_nav = other.m_nav;
         other.m_nav = nullptr;
+        m_obstacleCache = other.m_obstacleCache;
+        other.m_obstacleCache = nullptr;
 
         m_cachedVerts = std::move(other.m_cachedVerts);
         m_cachedTris = std::move(other.m_cachedTris);
@@ -1490,6 +1499,9 @@ NavMeshData& NavMeshData::operator=(NavMeshData&& other) noexcept
         m_cachedTileHashes = std::move(other.m_cachedTileHashes);
         m_offmeshLinks = std::move(other.m_offmeshLinks);
         m_fixedGridBounds = other.m_fixedGridBounds;
+        m_compactTiles = std::move(other.m_compactTiles);
+        m_compactTileBytes = other.m_compactTileBytes;
+        m_compactStampCounter = other.m_compactStampCounter;
 
         std::memset(other.m_cachedBMin, 0, sizeof(other.m_cachedBMin));
         std::memset(other.m_cachedBMax, 0, sizeof(other.m_cachedBMax));
@@ -1500,6 +1512,8 @@ NavMeshData& NavMeshData::operator=(NavMeshData&& other) noexcept
         other.m_hasTiledCache = false;
         other.m_cachedTileHashes.clear();
         other.m_fixedGridBounds = false;
+        other.m_compactTiles.clear();
+        other.m_compactTileBytes = 0;
     }
     return *this;
 }
@@ -1527,6 +1541,7 @@ bool NavMeshData::Load(const char* path)
     dtNavMeshParams params;
     fread(&params, sizeof(params), 1, f);
 
+    ClearCompactTiles();
     m_nav = dtAllocNavMesh();
     if (!m_nav)
     {
@@ -1553,6 +1568,14 @@ bool NavMeshData::Load(const char* path)
         unsigned char* data = (unsigned char*)dtAlloc(dataSize, DT_ALLOC_PERM);
         fread(data, dataSize, 1, f);
 
+        if (!TileDbIsTileLayoutValid(data, dataSize))
+        {
+            printf("[NavMeshData] Tile %d com layout incompativel (dtPolyRef %d bits neste build)\n",
+                   i, (int)(sizeof(dtPolyRef) * 8));
+            dtFree(data);
+            continue;
+        }
+
         if (dtStatusFailed(m_nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, NULL)))
         {
             dtFree(data);
@@ -1615,6 +1638,7 @@ bool NavMeshData::BuildTileAt(const glm::vec3& worldPos,
 
     bool built = false;
     bool empty = false;
+    DropCompactTile(tx, ty);
     if (!BuildSingleTile(buildInput, m_cachedSettings, tx, ty, m_nav, built, empty))
         return false;
 
@@ -1662,6 +1686,7 @@ bool NavMeshData::RemoveTileAt(const glm::vec3& worldPos,
         return false;
     }
 
+    DropCompactTile(tx, ty);
     const dtTileRef tileRef = m_nav->getTileRefAt(tx, ty, 0);
     if (tileRef == 0)
     {
@@ -1810,6 +1835,7 @@ bool NavMeshData::RebuildSpecificTiles(const std::vector<std::pair<int, int>>& t
 
         bool built = false;
         bool empty = false;
+        DropCompactTile(tx, ty);
         if (!BuildSingleTile(buildInput, m_cachedSettings, tx, ty, m_nav, built, empty))
         {
             printf("[NavMeshData] RebuildSpecificTiles: falhou ao reconstruir tile %d,%d.\n", tx, ty);
@@ -1858,6 +1884,28 @@ bool NavMeshData::RebuildSingleTileFromGeometry(int tx,
         printf("[NavMeshData] RebuildSingleTileFromGeometry: configuracao atual difere da cacheada.\n");
     }
 
+    NavPrebuiltTile tile;
+    if (!BuildTileDataFromGeometry(tx, ty, verts, indices, tileOffmeshOverride, tile))
+        return false;
+    return ApplyBuiltTile(tile, tileHash, outBuilt, outEmpty);
+}
+
+bool NavMeshData::BuildTileDataFromGeometry(int tx,
+                                            int ty,
+                                            const std::vector<glm::vec3>& verts,
+                                            const std::vector<unsigned int>& indices,
+                                            const std::vector<OffmeshLink>* tileOffmeshOverride,
+                                            NavPrebuiltTile& outTile) const
+{
+    outTile = NavPrebuiltTile{};
+    outTile.tx = tx;
+    outTile.ty = ty;
+
+    if (!m_nav || !m_hasTiledCache)
+        return false;
+    if (tx < 0 || ty < 0 || tx >= m_cachedTileWidthCount || ty >= m_cachedTileHeightCount)
+        return false;
+
     std::vector<float> localVerts;
     std::vector<int> localTris;
     localVerts.reserve(verts.size() * 3);
@@ -1880,13 +1928,31 @@ bool NavMeshData::RebuildSingleTileFromGeometry(int tx,
     input.baseCfg = m_cachedBaseCfg;
     input.offmeshLinks = tileOffmeshOverride ? tileOffmeshOverride : &m_offmeshLinks;
 
+    return BuildSingleTileData(input, m_cachedSettings, tx, ty, static_cast<int>(m_nav->getParams()->maxPolys),
+                               outTile.data, outTile.dataSize, outTile.noGeometry, outTile.empty);
+}
+
+bool NavMeshData::ApplyBuiltTile(NavPrebuiltTile& tile, uint64_t tileHash, bool* outBuilt, bool* outEmpty)
+{
+    if (outBuilt) *outBuilt = false;
+    if (outEmpty) *outEmpty = false;
+
+    unsigned char* data = tile.data;
+    tile.data = nullptr;
+    if (!m_nav)
+    {
+        if (data)
+            dtFree(data);
+        return false;
+    }
+
     bool built = false;
     bool empty = false;
-    const bool ok = BuildSingleTile(input, m_cachedSettings, tx, ty, m_nav, built, empty);
-    if (!ok)
+    DropCompactTile(tile.tx, tile.ty);
+    if (!ApplySingleTileData(m_nav, tile.tx, tile.ty, data, tile.dataSize, tile.noGeometry, tile.empty, built, empty))
         return false;
 
-    const uint64_t tileKey = (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
+    const uint64_t tileKey = (static_cast<uint64_t>(static_cast<uint32_t>(tile.tx)) << 32) | static_cast<uint32_t>(tile.ty);
     m_cachedTileHashes[tileKey] = tileHash;
     if (outBuilt) *outBuilt = built;
     if (outEmpty) *outEmpty = empty;
@@ -1903,7 +1969,8 @@ bool NavMeshData::EstimateTileGrid(const NavmeshGenerationSettings& settings,
 
 bool NavMeshData::InitTiledGrid(const NavmeshGenerationSettings& settings,
                                 const float* forcedBMin,
-                                const float* forcedBMax)
+                                const float* forcedBMax,
+                                int residentTileCapacity)
 {
     if (settings.mode != NavmeshBuildMode::Tiled)
     {
@@ -1917,6 +1984,9 @@ bool NavMeshData::InitTiledGrid(const NavmeshGenerationSettings& settings,
         return false;
     }
 
+    // camadas/obstáculos pertencem ao grid antigo
+    DestroyObstacleTileCache();
+    ClearCompactTiles();
     if (m_nav)
     {
         dtFreeNavMesh(m_nav);
@@ -1931,6 +2001,12 @@ bool NavMeshData::InitTiledGrid(const NavmeshGenerationSettings& settings,
     }
 
     const int maxAllowedTiles = 32768;
+#ifdef DT_POLYREF64
+    // Com capacidade residente o grid do mundo não tem limite além dos bits de tile.
+    const bool sizedByResidentSet = residentTileCapacity > 0;
+#else
+    (void)residentTileCapacity;
+    const bool sizedByResidentSet = false;
     const int maxAllowedWorldTiles = 500000;
     if (stats.tileCountTotal > maxAllowedWorldTiles)
     {
@@ -1944,8 +2020,9 @@ bool NavMeshData::InitTiledGrid(const NavmeshGenerationSettings& settings,
                stats.tileCountTotal, maxAllowedWorldTiles, stats.tileWorld, minTileWorld, suggestedTileSize, settings.cellSize);
         return false;
     }
+#endif
 
-    if (settings.maxTilesOverride <= 0 && stats.tileCountTotal > maxAllowedTiles)
+    if (settings.maxTilesOverride <= 0 && !sizedByResidentSet && stats.tileCountTotal > maxAllowedTiles)
     {
         const float area = std::max(0.0f, stats.boundsWidth * stats.boundsHeight);
         const float minTileWorld = area > 0.0f
@@ -1987,21 +2064,23 @@ bool NavMeshData::InitTiledGrid(const NavmeshGenerationSettings& settings,
     navParams.maxTiles = settings.maxTilesOverride > 0
         ? settings.maxTilesOverride
         : computedMaxTiles;
+    // Tile achado pelo hash de (x,y) no m_posLookup: basta caber o conjunto residente.
+    if (settings.maxTilesOverride <= 0 && sizedByResidentSet)
+        navParams.maxTiles = std::min(computedMaxTiles, residentTileCapacity);
 
     const unsigned int desiredMaxPolys = static_cast<unsigned int>(std::max(16, settings.desiredMaxPolysPerTile));
-    const unsigned int tileBits = static_cast<unsigned int>(dtIlog2(dtNextPow2(static_cast<unsigned int>(navParams.maxTiles))));
-    const unsigned int desiredPolyBits = static_cast<unsigned int>(dtIlog2(dtNextPow2(desiredMaxPolys)));
-    const unsigned int maxPolyBitsAllowed = tileBits >= 22 ? 0u : (22u - tileBits);
-    if (maxPolyBitsAllowed == 0)
+    GtaNavRefLayout refLayout;
+    if (!GtaNav_ComputeRefLayout(navParams.maxTiles, desiredMaxPolys, refLayout))
     {
-        printf("[NavMeshData] InitTiledGrid: maxTiles=%u consome todos os bits de ref (tileBits=%u). Ajuste tileSize maior ou reduza os bounds.\n",
-               static_cast<unsigned int>(navParams.maxTiles), tileBits);
+        printf("[NavMeshData] InitTiledGrid: maxTiles=%u consome todos os bits de ref (tileBits=%u, dtPolyRef %d bits). Ajuste tileSize maior ou reduza os bounds.\n",
+               static_cast<unsigned int>(navParams.maxTiles), refLayout.tileBits, static_cast<int>(sizeof(dtPolyRef) * 8));
         dtFreeNavMesh(nav);
         return false;
     }
 
-    const unsigned int chosenPolyBits = std::min(desiredPolyBits, maxPolyBitsAllowed);
-    navParams.maxPolys = 1u << chosenPolyBits;
+    const unsigned int tileBits = refLayout.tileBits;
+    const unsigned int chosenPolyBits = refLayout.polyBits;
+    navParams.maxPolys = refLayout.maxPolys;
 
     printf("[NavMeshData] InitTiledGrid: worldTiles=%d residentCapacity=%d tileWidthCount=%d tileHeightCount=%d tileWorld=%.3f tileBits=%u polyBits=%u maxPolys=%d desiredMaxPolys=%u tileSize=%d\n",
            computedMaxTiles,
@@ -2223,6 +2302,9 @@ bool NavMeshData::BuildFromMesh(const std::vector<glm::vec3>& vertsIn,
         return false;
     }
 
+    // camadas/obstáculos pertencem ao grid antigo
+    DestroyObstacleTileCache();
+    ClearCompactTiles();
     if (m_nav)
     {
         dtFreeNavMesh(m_nav);
@@ -33,6 +33,19 @@ struct NavmeshGenerationSettings
     int tileSize = 48;
     int maxTilesOverride = 0; // 0 = auto
     int desiredMaxPolysPerTile = 4096; // minimo recomendado para ilhas densas
+    int compactTiles = 0; // 1 = tiles descarregados ficam em memória no formato compacto (dtCompactNavMeshData)
+};
+
+// Tile gerado fora do navMesh (NavMeshData::BuildTileDataFromGeometry). data é dtAlloc e
+// passa para o navMesh em ApplyBuiltTile.
+struct NavPrebuiltTile
+{
+    int tx = 0;
+    int ty = 0;
+    unsigned char* data = nullptr;
+    int dataSize = 0;
+    bool noGeometry = false;
+    bool empty = false;
 };
 
 struct TileGridStats
@@ -180,9 +193,12 @@ public:
                        const char* cachePath = nullptr,
                        const float* forcedBMin = nullptr,
                        const float* forcedBMax = nullptr);
+    // residentTileCapacity: com dtPolyRef 64 bits e sem maxTilesOverride, o dtNavMesh
+    // é dimensionado para os tiles residentes em vez do grid inteiro (0 = grid inteiro).
     bool InitTiledGrid(const NavmeshGenerationSettings& settings,
                        const float* forcedBMin,
-                       const float* forcedBMax);
+                       const float* forcedBMax,
+                       int residentTileCapacity = 0);
 
     bool BuildTileAt(const glm::vec3& worldPos,
                      const NavmeshGenerationSettings& settings,
@@ -214,6 +230,16 @@ public:
                                        bool* outBuilt,
                                        bool* outEmpty);
 
+    // RebuildSingleTileFromGeometry em duas fases, para builds em paralelo: BuildTileDataFromGeometry
+    // não mexe no navMesh e pode rodar em várias threads; ApplyBuiltTile troca o tile e grava o hash.
+    bool BuildTileDataFromGeometry(int tx,
+                                   int ty,
+                                   const std::vector<glm::vec3>& verts,
+                                   const std::vector<unsigned int>& indices,
+                                   const std::vector<OffmeshLink>* tileOffmeshOverride,
+                                   NavPrebuiltTile& outTile) const;
+    bool ApplyBuiltTile(NavPrebuiltTile& tile, uint64_t tileHash, bool* outBuilt, bool* outEmpty);
+
     bool HasTiledCache() const { return m_hasTiledCache; }
     bool GetCachedBounds(float* outBMin, float* outBMax) const;
     const std::unordered_map<uint64_t, uint64_t>& GetCachedTileHashes() const { return m_cachedTileHashes; }
@@ -235,6 +261,46 @@ public:
 
     dtNavMesh* GetNavMesh() const { return m_nav; }
 
+    // Obstáculos "carvados" via DetourTileCache (modo opcional do grid tiled).
+    // Cada tile guarda camadas de heightfield comprimidas; obstáculos marcam as
+    // camadas e só os tiles tocados são remontados (sem rodar o Recast de novo).
+    // Os tiles do navMesh passam a usar tileLayer > 0 quando há andares.
+    bool InitObstacleTileCache(int maxObstacles, int maxLayersPerTile);
+    void DestroyObstacleTileCache();
+    bool HasObstacleTileCache() const { return m_obstacleCache != nullptr; }
+    bool RebuildTileLayersFromGeometry(int tx,
+                                       int ty,
+                                       const std::vector<glm::vec3>& verts,
+                                       const std::vector<unsigned int>& indices,
+                                       const std::vector<OffmeshLink>* tileOffmesh,
+                                       uint64_t tileHash,
+                                       bool* outBuilt,
+                                       bool* outEmpty);
+    // Remove camadas comprimidas e todos os layers do navMesh em (tx,ty).
+    bool RemoveTileLayersAt(int tx, int ty);
+    void ClearTileLayers();
+    // Refs são dtObstacleRef (0 = inválido). pos/bmin/bmax em coordenadas Recast.
+    bool AddCylinderObstacle(const float* basePos, float radius, float height, unsigned int* outRef);
+    bool AddBoxObstacle(const float* bmin, const float* bmax, unsigned int* outRef);
+    bool RemoveObstacle(unsigned int ref);
+    // Processa pedidos pendentes e remonta tiles tocados até estourar budgetMs
+    // (<= 0: até zerar). Retorna true quando não sobrou trabalho.
+    bool UpdateObstacles(float budgetMs, int* outSteps);
+
+    // Camada "fria" do streaming: com settings.compactTiles, o tile descarregado
+    // fica em memória compacto (vértices 16 bits, sem links) e volta expandido no
+    // primeiro uso, sem ir ao DB. Só layer 0 e fora do modo carving.
+    bool UsesCompactTiles() const;
+    bool CompactTileAt(int tx, int ty);
+    bool ExpandCompactTileAt(int tx, int ty, bool deferLinks = false);
+    bool HasCompactTile(int tx, int ty) const;
+    void DropCompactTile(int tx, int ty);
+    // Descarta o tile compactado há mais tempo; false se não há nenhum.
+    bool DropOldestCompactTile();
+    void ClearCompactTiles();
+    size_t GetCompactTileCount() const { return m_compactTiles.size(); }
+    uint64_t GetCompactTileBytes() const { return m_compactTileBytes; }
+
     void AddOffmeshLink(const glm::vec3& start,
                         const glm::vec3& end,
                         float radius,
@@ -280,4 +346,15 @@ private:
     std::unordered_map<uint64_t, uint64_t> m_cachedTileHashes;
     std::vector<OffmeshLink> m_offmeshLinks;
     bool m_fixedGridBounds = false;
+    struct ObstacleTileCache* m_obstacleCache = nullptr;
+
+    struct CompactTile
+    {
+        unsigned char* data = nullptr; // dtAlloc, formato dtCompactNavMeshData
+        int size = 0;
+        uint32_t stamp = 0;
+    };
+    std::unordered_map<uint64_t, CompactTile> m_compactTiles;
+    uint64_t m_compactTileBytes = 0;
+    uint32_t m_compactStampCounter = 0;
 };
@@ -0,0 +1,140 @@
+#include "NavMeshData.h"
+
+#include <DetourNavMesh.h>
+#include <DetourNavMeshBuilder.h>
+#include <DetourAlloc.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+    uint64_t MakeCompactTileKey(int tx, int ty)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
+    }
+}
+
+bool NavMeshData::UsesCompactTiles() const
+{
+    // No modo carving os tiles são remontados das camadas, não vale guardar cópia.
+    return m_nav && m_cachedSettings.compactTiles != 0 && !m_obstacleCache;
+}
+
+bool NavMeshData::CompactTileAt(int tx, int ty)
+{
+    if (!UsesCompactTiles())
+        return false;
+
+    const dtMeshTile* tile = m_nav->getTileAt(tx, ty, 0);
+    if (!tile || !tile->header)
+        return false;
+
+    // Compacta antes de remover: se falhar, o tile só é descarregado normalmente.
+    unsigned char* compactData = nullptr;
+    int compactSize = 0;
+    const bool compacted = dtCompactNavMeshData(tile->data, tile->dataSize, &compactData, &compactSize);
+
+    unsigned char* tileData = nullptr;
+    int tileDataSize = 0;
+    const dtStatus status = m_nav->removeTile(m_nav->getTileRef(tile), &tileData, &tileDataSize);
+    if (dtStatusFailed(status))
+    {
+        printf("[NavMeshData] CompactTileAt: falhou ao remover tile %d,%d.\n", tx, ty);
+        if (compactData)
+            dtFree(compactData);
+        return false;
+    }
+    if (tileData)
+        dtFree(tileData);
+
+    if (!compacted)
+    {
+        printf("[NavMeshData] CompactTileAt: tile %d,%d nao pode ser compactado, descarregado.\n", tx, ty);
+        return false;
+    }
+
+    DropCompactTile(tx, ty);
+    CompactTile& entry = m_compactTiles[MakeCompactTileKey(tx, ty)];
+    entry.data = compactData;
+    entry.size = compactSize;
+    entry.stamp = ++m_compactStampCounter;
+    m_compactTileBytes += static_cast<uint64_t>(compactSize);
+    return true;
+}
+
+bool NavMeshData::ExpandCompactTileAt(int tx, int ty, bool deferLinks)
+{
+    if (!m_nav)
+        return false;
+    auto it = m_compactTiles.find(MakeCompactTileKey(tx, ty));
+    if (it == m_compactTiles.end())
+        return false;
+
+    unsigned char* tileData = nullptr;
+    int tileDataSize = 0;
+    if (!dtExpandNavMeshData(it->second.data, it->second.size, &tileData, &tileDataSize))
+    {
+        printf("[NavMeshData] ExpandCompactTileAt: dados compactos invalidos no tile %d,%d.\n", tx, ty);
+        DropCompactTile(tx, ty);
+        return false;
+    }
+
+    const int flags = DT_TILE_FREE_DATA | (deferLinks ? DT_TILE_DEFER_LINKS : 0);
+    const dtStatus status = m_nav->addTile(tileData, tileDataSize, flags, 0, nullptr);
+    if (dtStatusFailed(status))
+    {
+        // Tile já carregado por outro caminho ou navmesh cheia: mantém a cópia compacta.
+        dtFree(tileData);
+        return false;
+    }
+
+    DropCompactTile(tx, ty);
+    return true;
+}
+
+bool NavMeshData::HasCompactTile(int tx, int ty) const
+{
+    return m_compactTiles.find(MakeCompactTileKey(tx, ty)) != m_compactTiles.end();
+}
+
+void NavMeshData::DropCompactTile(int tx, int ty)
+{
+    auto it = m_compactTiles.find(MakeCompactTileKey(tx, ty));
+    if (it == m_compactTiles.end())
+        return;
+    m_compactTileBytes -= static_cast<uint64_t>(it->second.size);
+    dtFree(it->second.data);
+    m_compactTiles.erase(it);
+}
+
+bool NavMeshData::DropOldestCompactTile()
+{
+    auto oldest = m_compactTiles.end();
+    uint32_t oldestStamp = std::numeric_limits<uint32_t>::max();
+    for (auto it = m_compactTiles.begin(); it != m_compactTiles.end(); ++it)
+    {
+        if (oldest == m_compactTiles.end() || it->second.stamp < oldestStamp)
+        {
+            oldest = it;
+            oldestStamp = it->second.stamp;
+        }
+    }
+    if (oldest == m_compactTiles.end())
+        return false;
+
+    m_compactTileBytes -= static_cast<uint64_t>(oldest->second.size);
+    dtFree(oldest->second.data);
+    m_compactTiles.erase(oldest);
+    return true;
+}
+
+void NavMeshData::ClearCompactTiles()
+{
+    for (auto& entry : m_compactTiles)
+        dtFree(entry.second.data);
+    m_compactTiles.clear();
+    m_compactTileBytes = 0;
+    m_compactStampCounter = 0;
+}
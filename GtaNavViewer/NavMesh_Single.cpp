@@ -1,4 +1,5 @@
 #include "NavMeshBuild.h"
+#include "GtaNavProfile.h"
 
 #include <DetourNavMeshBuilder.h>
 #include <algorithm>
@@ -21,6 +22,8 @@ namespace
         if (localTris == 0)
             return false;
 
+        rcScopedTimer totalTimer(&input.ctx, RC_TIMER_TOTAL);
+
         rcHeightfield* solid = rcAllocHeightfield();
         if (!solid)
         {
@@ -237,7 +240,11 @@ namespace
             params.offMeshConCount = static_cast<int>(offmeshDirs.size());
         }
 
-        bool ok = dtCreateNavMeshData(&params, &navData, &navDataSize);
+        bool ok = false;
+        {
+            GtaNavProfileScope createScope(GTANAV_PROF_DETOUR_CREATE);
+            ok = dtCreateNavMeshData(&params, &navData, &navDataSize);
+        }
         if (!ok)
         {
             printf("[NavMeshData] dtCreateNavMeshData falhou. polys=%d verts=%d detailVerts=%d detailTris=%d bounds=(%.2f, %.2f, %.2f)-(%.2f, %.2f, %.2f)\n",
@@ -312,7 +319,11 @@ bool BuildSingleNavMesh(const NavmeshBuildInput& input,
         return false;   
     }
 
-    dtStatus status = nav->addTile(navMeshData, navMeshDataSize, DT_TILE_FREE_DATA, 0, nullptr);
+    dtStatus status;
+    {
+        GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, navMeshDataSize);
+        status = nav->addTile(navMeshData, navMeshDataSize, DT_TILE_FREE_DATA, 0, nullptr);
+    }
     if (dtStatusFailed(status))
     {
         printf("[NavMeshData] addTile falhou. status=0x%x size=%d\n", status, navMeshDataSize);
@@ -0,0 +1,220 @@
+#include "NavMesh_TileBuildScheduler.h"
+#include "NavMesh_TileCacheDB.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    int TileKeyX(uint64_t tileKey)
+    {
+        return static_cast<int>(tileKey >> 32);
+    }
+
+    int TileKeyY(uint64_t tileKey)
+    {
+        return static_cast<int>(tileKey & 0xffffffffu);
+    }
+}
+
+bool WorldTileBuildScheduler::Push(uint64_t tileKey)
+{
+    auto inserted = m_nodes.emplace(tileKey, Node{});
+    if (!inserted.second)
+        return false;
+
+    Node& node = inserted.first->second;
+    node.priority = ComputePriority(tileKey);
+    node.seq = m_nextSeq++;
+    node.enqueuePop = m_popCount;
+    m_byPriority.insert({ { node.priority, node.seq }, tileKey });
+    m_bySeq.insert({ node.seq, tileKey });
+    return true;
+}
+
+bool WorldTileBuildScheduler::Pop(uint64_t& outTileKey)
+{
+    if (m_nodes.empty())
+        return false;
+
+    uint64_t tileKey = m_byPriority.begin()->second;
+    const uint64_t oldestKey = m_bySeq.begin()->second;
+    if (oldestKey != tileKey)
+    {
+        const Node& oldest = m_nodes.at(oldestKey);
+        if (m_popCount - oldest.enqueuePop >= m_agingPops && m_popsSinceAged + 1 >= m_agedPopInterval)
+            tileKey = oldestKey;
+    }
+
+    if (tileKey == oldestKey)
+        m_popsSinceAged = 0;
+    else
+        ++m_popsSinceAged;
+    ++m_popCount;
+
+    EraseNode(m_nodes.find(tileKey));
+    outTileKey = tileKey;
+    return true;
+}
+
+bool WorldTileBuildScheduler::Erase(uint64_t tileKey)
+{
+    auto it = m_nodes.find(tileKey);
+    if (it == m_nodes.end())
+        return false;
+    EraseNode(it);
+    return true;
+}
+
+void WorldTileBuildScheduler::Clear()
+{
+    m_nodes.clear();
+    m_byPriority.clear();
+    m_bySeq.clear();
+    m_popsSinceAged = 0;
+}
+
+std::vector<uint64_t> WorldTileBuildScheduler::Ordered() const
+{
+    std::vector<uint64_t> keys;
+    keys.reserve(m_byPriority.size());
+    for (const PriorityKey& entry : m_byPriority)
+        keys.push_back(entry.second);
+    return keys;
+}
+
+void WorldTileBuildScheduler::SetAgentFocus(uint32_t agentId, int tx, int ty, int radiusTiles)
+{
+    const AgentFocus focus{ tx, ty, std::max(0, radiusTiles) };
+    auto it = m_agents.find(agentId);
+    if (it != m_agents.end())
+    {
+        const AgentFocus old = it->second;
+        if (old.tx == focus.tx && old.ty == focus.ty && old.radius == focus.radius)
+            return;
+        it->second = focus;
+        ReprioritizeArea(old);
+    }
+    else
+    {
+        m_agents.emplace(agentId, focus);
+    }
+    ReprioritizeArea(focus);
+}
+
+void WorldTileBuildScheduler::RemoveAgent(uint32_t agentId)
+{
+    auto it = m_agents.find(agentId);
+    if (it == m_agents.end())
+        return;
+    const AgentFocus old = it->second;
+    m_agents.erase(it);
+    ReprioritizeArea(old);
+}
+
+void WorldTileBuildScheduler::ClearAgents()
+{
+    if (m_agents.empty())
+        return;
+    m_agents.clear();
+    m_byPriority.clear();
+    for (auto& kv : m_nodes)
+    {
+        kv.second.priority = FAR_PRIORITY;
+        m_byPriority.insert({ { kv.second.priority, kv.second.seq }, kv.first });
+    }
+}
+
+int WorldTileBuildScheduler::CollectPendingForAgent(uint32_t agentId, std::vector<uint64_t>& outTileKeys) const
+{
+    outTileKeys.clear();
+    auto itAgent = m_agents.find(agentId);
+    if (itAgent == m_agents.end())
+        return 0;
+
+    const AgentFocus& focus = itAgent->second;
+    for (int ring = 0; ring <= focus.radius; ++ring)
+    {
+        for (int y = focus.ty - ring; y <= focus.ty + ring; ++y)
+        {
+            for (int x = focus.tx - ring; x <= focus.tx + ring; ++x)
+            {
+                if (std::max(std::abs(x - focus.tx), std::abs(y - focus.ty)) != ring)
+                    continue;
+                const uint64_t tileKey = MakeTileKey(x, y);
+                if (Contains(tileKey))
+                    outTileKeys.push_back(tileKey);
+            }
+        }
+    }
+    return static_cast<int>(outTileKeys.size());
+}
+
+void WorldTileBuildScheduler::SetAging(uint32_t agingPops, uint32_t agedPopInterval)
+{
+    m_agingPops = agingPops;
+    m_agedPopInterval = std::max<uint32_t>(1, agedPopInterval);
+}
+
+uint32_t WorldTileBuildScheduler::ComputePriority(uint64_t tileKey) const
+{
+    const int tx = TileKeyX(tileKey);
+    const int ty = TileKeyY(tileKey);
+    uint32_t best = FAR_PRIORITY;
+    for (const auto& kv : m_agents)
+    {
+        const AgentFocus& focus = kv.second;
+        const int dist = std::max(std::abs(tx - focus.tx), std::abs(ty - focus.ty));
+        if (dist <= focus.radius)
+            best = std::min(best, static_cast<uint32_t>(dist));
+    }
+    return best;
+}
+
+void WorldTileBuildScheduler::Reprioritize(uint64_t tileKey)
+{
+    auto it = m_nodes.find(tileKey);
+    if (it == m_nodes.end())
+        return;
+    Node& node = it->second;
+    const uint32_t priority = ComputePriority(tileKey);
+    if (priority == node.priority)
+        return;
+    m_byPriority.erase({ { node.priority, node.seq }, tileKey });
+    node.priority = priority;
+    m_byPriority.insert({ { node.priority, node.seq }, tileKey });
+}
+
+void WorldTileBuildScheduler::ReprioritizeArea(const AgentFocus& focus)
+{
+    // Área maior que a fila: mais barato varrer a fila.
+    const uint64_t side = static_cast<uint64_t>(focus.radius) * 2 + 1;
+    if (side * side > m_nodes.size())
+    {
+        std::vector<uint64_t> inArea;
+        for (const auto& kv : m_nodes)
+        {
+            const int dx = std::abs(TileKeyX(kv.first) - focus.tx);
+            const int dy = std::abs(TileKeyY(kv.first) - focus.ty);
+            if (std::max(dx, dy) <= focus.radius)
+                inArea.push_back(kv.first);
+        }
+        for (uint64_t tileKey : inArea)
+            Reprioritize(tileKey);
+        return;
+    }
+
+    for (int y = focus.ty - focus.radius; y <= focus.ty + focus.radius; ++y)
+    {
+        for (int x = focus.tx - focus.radius; x <= focus.tx + focus.radius; ++x)
+            Reprioritize(MakeTileKey(x, y));
+    }
+}
+
+void WorldTileBuildScheduler::EraseNode(std::unordered_map<uint64_t, Node>::iterator it)
+{
+    const Node& node = it->second;
+    m_byPriority.erase({ { node.priority, node.seq }, it->first });
+    m_bySeq.erase({ node.seq, it->first });
+    m_nodes.erase(it);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Fila de build dos tiles do mundo, ordenada pela distância (em tiles, Chebyshev)
+// até o agent de streaming mais próximo. Tiles fora da área de todos os agents
+// ficam numa classe "longe" em ordem FIFO, e por isso mover um agent só reordena
+// os tiles da área antiga e da nova (O(log n) cada).
+//
+// Aging: quando o tile mais antigo já esperou agingPops pops, uma a cada
+// agedPopInterval retiradas vai para ele; perto do agent continua com a maior
+// parte do orçamento e longe nunca fica parado.
+class WorldTileBuildScheduler
+{
+public:
+    static constexpr uint32_t FAR_PRIORITY = 0xffffffffu;
+
+    bool Push(uint64_t tileKey);
+    bool Pop(uint64_t& outTileKey);
+    bool Erase(uint64_t tileKey);
+    bool Contains(uint64_t tileKey) const { return m_nodes.find(tileKey) != m_nodes.end(); }
+    size_t Size() const { return m_nodes.size(); }
+    bool Empty() const { return m_nodes.empty(); }
+    void Clear();
+
+    // Em ordem de prioridade (o que Pop devolveria sem aging).
+    std::vector<uint64_t> Ordered() const;
+
+    // Centro do agent em coordenadas de tile; radiusTiles é a área que ele segura residente.
+    void SetAgentFocus(uint32_t agentId, int tx, int ty, int radiusTiles);
+    void RemoveAgent(uint32_t agentId);
+    void ClearAgents();
+    bool HasAgent(uint32_t agentId) const { return m_agents.find(agentId) != m_agents.end(); }
+    // Tiles ainda na fila dentro da área do agent, do mais perto para o mais longe.
+    int CollectPendingForAgent(uint32_t agentId, std::vector<uint64_t>& outTileKeys) const;
+
+    void SetAging(uint32_t agingPops, uint32_t agedPopInterval);
+
+private:
+    struct AgentFocus
+    {
+        int tx = 0;
+        int ty = 0;
+        int radius = 0;
+    };
+    struct Node
+    {
+        uint32_t priority = FAR_PRIORITY;
+        uint64_t seq = 0;
+        uint64_t enqueuePop = 0;
+    };
+    using PriorityKey = std::pair<std::pair<uint32_t, uint64_t>, uint64_t>; // ((prioridade, seq), tile)
+
+    uint32_t ComputePriority(uint64_t tileKey) const;
+    void Reprioritize(uint64_t tileKey);
+    void ReprioritizeArea(const AgentFocus& focus);
+    void EraseNode(std::unordered_map<uint64_t, Node>::iterator it);
+
+    std::unordered_map<uint64_t, Node> m_nodes;
+    std::set<PriorityKey> m_byPriority;
+    std::set<std::pair<uint64_t, uint64_t>> m_bySeq;   // (seq, tile): o mais antigo primeiro
+    std::unordered_map<uint32_t, AgentFocus> m_agents;
+    uint64_t m_nextSeq = 0;
+    uint64_t m_popCount = 0;
+    uint32_t m_popsSinceAged = 0;
+    uint32_t m_agingPops = 256;
+    uint32_t m_agedPopInterval = 4;
+};
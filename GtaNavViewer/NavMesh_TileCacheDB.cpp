@@ -1,15 +1,24 @@
 #include "NavMesh_TileCacheDB.h"
+#include "GtaNavProfile.h"
 
 #include <DetourNavMesh.h>
+#include <DetourTileCacheCompressor.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <limits>
+#include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
 namespace
 {
     bool FileSeek64(FILE* fp, uint64_t offset, int origin)
@@ -43,13 +52,68 @@ namespace
         return true;
     }
 
+    // Índice da v2 (sem codec): todos os tiles RAW.
+    struct TileDbIndexEntryV2
+    {
+        int tx = 0;
+        int ty = 0;
+        uint32_t dataSize = 0;
+        uint64_t dataOffset = 0;
+        uint64_t geomHash = 0;
+    };
+
+    size_t IndexEntrySize(uint32_t version)
+    {
+        return version >= 3 ? sizeof(TileDbIndexEntry) : sizeof(TileDbIndexEntryV2);
+    }
+
+    bool ReadIndexEntry(FILE* fp, uint32_t version, TileDbIndexEntry& outEntry)
+    {
+        if (version >= 3)
+            return fread(&outEntry, sizeof(TileDbIndexEntry), 1, fp) == 1;
+
+        TileDbIndexEntryV2 legacy{};
+        if (fread(&legacy, sizeof(TileDbIndexEntryV2), 1, fp) != 1)
+            return false;
+        outEntry = {};
+        outEntry.tx = legacy.tx;
+        outEntry.ty = legacy.ty;
+        outEntry.dataSize = legacy.dataSize;
+        outEntry.dataOffset = legacy.dataOffset;
+        outEntry.geomHash = legacy.geomHash;
+        outEntry.codec = TILE_DB_CODEC_RAW;
+        outEntry.rawSize = legacy.dataSize;
+        return true;
+    }
+
+    bool IsEntryCodecValid(const TileDbIndexEntry& entry)
+    {
+        if (entry.rawSize == 0 || entry.rawSize > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+            return false;
+        if (entry.codec == TILE_DB_CODEC_RAW)
+            return entry.rawSize == entry.dataSize;
+        return entry.codec == TILE_DB_CODEC_LZ;
+    }
+
+    // Bytes como estão no arquivo (sem descomprimir).
+    bool ReadStoredBytes(FILE* fp, uint64_t fileSize, const TileDbIndexEntry& entry, std::vector<unsigned char>& outStored)
+    {
+        outStored.clear();
+        if (entry.dataSize == 0 || entry.dataOffset + static_cast<uint64_t>(entry.dataSize) > fileSize)
+            return false;
+        if (!FileSeek64(fp, entry.dataOffset, SEEK_SET))
+            return false;
+        outStored.resize(entry.dataSize);
+        return fread(outStored.data(), entry.dataSize, 1, fp) == 1;
+    }
+
     bool ReadHeader(FILE* fp, TileDbHeader& outHeader)
     {
         if (!fp)
             return false;
         if (fread(&outHeader, sizeof(TileDbHeader), 1, fp) != 1)
             return false;
-        if (outHeader.magic != TILE_DB_MAGIC || outHeader.version != TILE_DB_VERSION)
+        if (outHeader.magic != TILE_DB_MAGIC || (outHeader.version != TILE_DB_VERSION && outHeader.version != 2))
         {
             printf("[NavMeshData] Tile DB incompatível (magic/version).\n");
             return false;
@@ -71,14 +135,140 @@ namespace
             return false;
 
         // Permit current navmesh to allocate equal-or-greater capacity.
+        // With 64-bit refs maxTiles is only the resident capacity, tile refs do not depend on it.
+#ifndef DT_POLYREF64
         if (current.maxTiles < expected.maxTiles)
             return false;
+#endif
         if (current.maxPolys < expected.maxPolys)
             return false;
 
         return true;
     }
 
+    // Abaixo disso o custo de subir threads passa do ganho.
+    constexpr int kBatchLinkMinJobsPerThread = 4;
+
+    void TileDbParallelFor(void* /*userData*/, int jobCount, dtParallelJobFn job, void* jobData)
+    {
+        const int hw = static_cast<int>(std::thread::hardware_concurrency());
+        const int threadCount = std::min(std::max(1, hw), std::max(1, jobCount / kBatchLinkMinJobsPerThread));
+        if (threadCount <= 1)
+        {
+            for (int i = 0; i < jobCount; ++i)
+                job(jobData, i);
+            return;
+        }
+
+        std::atomic<int> next{0};
+        auto worker = [&]() {
+            for (int i = next.fetch_add(1); i < jobCount; i = next.fetch_add(1))
+                job(jobData, i);
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (int t = 1; t < threadCount; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (std::thread& t : threads)
+            t.join();
+    }
+}
+
+bool TileDbEncodeBlob(uint32_t codec,
+                      const unsigned char* data,
+                      int dataSize,
+                      std::vector<unsigned char>& outStored,
+                      uint32_t& outCodec)
+{
+    outStored.clear();
+    outCodec = TILE_DB_CODEC_RAW;
+    if (!data || dataSize <= 0)
+        return false;
+
+    if (codec == TILE_DB_CODEC_LZ)
+    {
+        outStored.resize(static_cast<size_t>(dtLZCompressBound(dataSize)));
+        const int n = dtLZCompress(data, dataSize, outStored.data(), static_cast<int>(outStored.size()));
+        if (n > 0 && n < dataSize)
+        {
+            outStored.resize(static_cast<size_t>(n));
+            outCodec = TILE_DB_CODEC_LZ;
+            return true;
+        }
+    }
+
+    outStored.assign(data, data + dataSize);
+    return true;
+}
+
+bool TileDbIsTileLayoutValid(const unsigned char* data, int dataSize)
+{
+    if (!data || dataSize < static_cast<int>(sizeof(dtMeshHeader)))
+        return false;
+
+    dtMeshHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != DT_NAVMESH_MAGIC || header.version != DT_NAVMESH_VERSION)
+        return false;
+
+    // Mesma conta do dtCreateNavMeshData / dtNavMesh::addTile (em 64 bits, sem overflow).
+    auto align4 = [](uint64_t x) { return (x + 3) & ~static_cast<uint64_t>(3); };
+    auto count = [](int n) { return static_cast<uint64_t>(std::max(0, n)); };
+    const uint64_t expected =
+        align4(sizeof(dtMeshHeader)) +
+        align4(sizeof(float) * 3 * count(header.vertCount)) +
+        align4(sizeof(dtPoly) * count(header.polyCount)) +
+        align4(sizeof(dtLink) * count(header.maxLinkCount)) +
+        align4(sizeof(dtPolyDetail) * count(header.detailMeshCount)) +
+        align4(sizeof(float) * 3 * count(header.detailVertCount)) +
+        align4(4 * count(header.detailTriCount)) +
+        align4(sizeof(dtBVNode) * count(header.bvNodeCount)) +
+        align4(sizeof(dtOffMeshConnection) * count(header.offMeshConCount));
+    return expected == static_cast<uint64_t>(dataSize);
+}
+
+bool TileDbDecodeBlob(uint32_t codec,
+                      const unsigned char* stored,
+                      uint32_t storedSize,
+                      uint32_t rawSize,
+                      unsigned char*& outData,
+                      int& outSize)
+{
+    outData = nullptr;
+    outSize = 0;
+    if (!stored || storedSize == 0 || rawSize == 0 || rawSize > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+        return false;
+    if (codec != TILE_DB_CODEC_RAW && codec != TILE_DB_CODEC_LZ)
+        return false;
+    if (codec == TILE_DB_CODEC_RAW && storedSize != rawSize)
+        return false;
+
+    unsigned char* data = static_cast<unsigned char*>(dtAlloc(rawSize, DT_ALLOC_PERM));
+    if (!data)
+        return false;
+
+    if (codec == TILE_DB_CODEC_RAW)
+    {
+        memcpy(data, stored, rawSize);
+    }
+    else if (dtLZDecompress(stored, static_cast<int>(storedSize), data, static_cast<int>(rawSize)) != static_cast<int>(rawSize))
+    {
+        dtFree(data);
+        return false;
+    }
+
+    if (!TileDbIsTileLayoutValid(data, static_cast<int>(rawSize)))
+    {
+        printf("[TileDB] tile com layout incompativel (dtPolyRef %d bits neste build), descartado.\n",
+               static_cast<int>(sizeof(dtPolyRef) * 8));
+        dtFree(data);
+        return false;
+    }
+
+    outData = data;
+    outSize = static_cast<int>(rawSize);
+    return true;
 }
 
 bool TileDbLoadIndex(const char* dbPath,
@@ -134,7 +324,7 @@ bool TileDbLoadIndex(const char* dbPath,
         fclose(fp);
         return false;
     }
-    const uint64_t indexBytes = static_cast<uint64_t>(header.tileCount) * sizeof(TileDbIndexEntry);
+    const uint64_t indexBytes = static_cast<uint64_t>(header.tileCount) * IndexEntrySize(header.version);
     if (header.indexOffset + indexBytes > fileSize)
     {
         fclose(fp);
@@ -151,7 +341,7 @@ bool TileDbLoadIndex(const char* dbPath,
     for (uint32_t i = 0; i < header.tileCount; ++i)
     {
         TileDbIndexEntry entry{};
-        if (fread(&entry, sizeof(TileDbIndexEntry), 1, fp) != 1)
+        if (!ReadIndexEntry(fp, header.version, entry))
         {
             fclose(fp);
             outIndex.clear();
@@ -159,7 +349,7 @@ bool TileDbLoadIndex(const char* dbPath,
         }
         if (entry.dataSize == 0 || entry.dataOffset < sizeof(TileDbHeader) || entry.dataOffset > fileSize ||
             entry.dataOffset + static_cast<uint64_t>(entry.dataSize) > fileSize ||
-            std::abs(entry.tx) > 1000000 || std::abs(entry.ty) > 1000000)
+            std::abs(entry.tx) > 1000000 || std::abs(entry.ty) > 1000000 || !IsEntryCodecValid(entry))
         {
             fclose(fp);
             outIndex.clear();
@@ -185,6 +375,7 @@ bool TileDbReadTile(const char* dbPath,
     if (!dbPath)
         return false;
 
+    GtaNavProfileScope readScope(GTANAV_PROF_CACHE_READ);
     FILE* fp = fopen(dbPath, "rb");
     if (!fp)
         return false;
@@ -211,39 +402,62 @@ bool TileDbReadTile(const char* dbPath,
         return false;
     }
 
-    unsigned char* data = static_cast<unsigned char*>(dtAlloc(entry.dataSize, DT_ALLOC_PERM));
-    if (!data)
+    // RAW vai direto para o buffer do tile; LZ passa por um buffer temporário.
+    unsigned char* data = nullptr;
+    std::vector<unsigned char> stored;
+    bool ok = false;
+    if (entry.codec == TILE_DB_CODEC_RAW)
     {
-        fclose(fp);
-        return false;
+        data = static_cast<unsigned char*>(dtAlloc(entry.dataSize, DT_ALLOC_PERM));
+        ok = data && fread(data, entry.dataSize, 1, fp) == 1;
+    }
+    else
+    {
+        stored.resize(entry.dataSize);
+        ok = fread(stored.data(), entry.dataSize, 1, fp) == 1;
     }
+    fclose(fp);
 
-    if (fread(data, entry.dataSize, 1, fp) != 1)
+    if (!ok)
     {
-        dtFree(data);
-        fclose(fp);
+        if (data)
+            dtFree(data);
         return false;
     }
+    readScope.addBytes(entry.dataSize);
 
-    fclose(fp);
-    outData = data;
-    outSize = static_cast<int>(entry.dataSize);
+    if (data)
+    {
+        outData = data;
+        outSize = static_cast<int>(entry.dataSize);
+        return true;
+    }
+
+    if (!TileDbDecodeBlob(entry.codec, stored.data(), entry.dataSize, entry.rawSize, outData, outSize))
+    {
+        printf("[TileDB][ERROR] decode fail path=%s tile=(%d,%d) codec=%u size=%u raw=%u\n", dbPath,
+               entry.tx, entry.ty, entry.codec, entry.dataSize, entry.rawSize);
+        return false;
+    }
     return true;
 }
 
 bool TileDbWriteOrUpdateTiles(const char* dbPath,
                               dtNavMesh* nav,
-                              const std::unordered_map<uint64_t, uint64_t>& tileHashes)
+                              const std::unordered_map<uint64_t, uint64_t>& tileHashes,
+                              uint32_t codec)
 {
     if (!dbPath || !nav)
         return false;
 
+    GtaNavProfileScope writeScope(GTANAV_PROF_CACHE_WRITE);
+
     std::filesystem::path path(dbPath);
     if (path.has_parent_path())
         std::filesystem::create_directories(path.parent_path());
 
     std::vector<TileDbIndexEntry> indexEntries;
-    std::vector<const unsigned char*> tileData;
+    std::vector<std::vector<unsigned char>> tileData;
     indexEntries.reserve(nav->getMaxTiles());
     tileData.reserve(nav->getMaxTiles());
 
@@ -256,13 +470,17 @@ bool TileDbWriteOrUpdateTiles(const char* dbPath,
         TileDbIndexEntry entry{};
         entry.tx = tile->header->x;
         entry.ty = tile->header->y;
-        entry.dataSize = static_cast<uint32_t>(tile->dataSize);
+        std::vector<unsigned char> stored;
+        if (!TileDbEncodeBlob(codec, tile->data, tile->dataSize, stored, entry.codec))
+            continue;
+        entry.dataSize = static_cast<uint32_t>(stored.size());
+        entry.rawSize = static_cast<uint32_t>(tile->dataSize);
         const uint64_t key = MakeTileKey(entry.tx, entry.ty);
         const auto itHash = tileHashes.find(key);
         entry.geomHash = itHash != tileHashes.end() ? itHash->second : 0;
 
         indexEntries.push_back(entry);
-        tileData.push_back(tile->data);
+        tileData.push_back(std::move(stored));
     }
 
     TileDbHeader header{};
@@ -288,7 +506,9 @@ bool TileDbWriteOrUpdateTiles(const char* dbPath,
             break;
         }
         indexEntries[i].dataOffset = static_cast<uint64_t>(offset);
-        ok = fwrite(tileData[i], indexEntries[i].dataSize, 1, fp) == 1;
+        ok = fwrite(tileData[i].data(), indexEntries[i].dataSize, 1, fp) == 1;
+        if (ok)
+            writeScope.addBytes(indexEntries[i].dataSize);
     }
 
     if (ok)
@@ -348,11 +568,14 @@ bool TileDbWriteOrUpdateTiles(const char* dbPath,
 bool TileDbMergeWriteOrUpdateTiles(const char* dbPath,
                                    dtNavMesh* nav,
                                    const std::unordered_map<uint64_t, uint64_t>& tileHashes,
-                                   const std::unordered_set<uint64_t>* onlyTileKeysToUpdate)
+                                   const std::unordered_set<uint64_t>* onlyTileKeysToUpdate,
+                                   uint32_t codec)
 {
     if (!dbPath || !nav)
         return false;
 
+    GtaNavProfileScope writeScope(GTANAV_PROF_CACHE_WRITE);
+
     struct StoredTile
     {
         TileDbIndexEntry entry{};
@@ -370,6 +593,7 @@ bool TileDbMergeWriteOrUpdateTiles(const char* dbPath,
     std::size_t removedTiles = 0;
 
     // 1) Preserve old DB tiles (when compatible) unless explicitly updated.
+    //    Stored bytes are copied as-is, keeping each tile's codec.
     uint64_t oldFileSizeBytes = 0;
     if (std::filesystem::exists(path))
     {
@@ -378,28 +602,30 @@ bool TileDbMergeWriteOrUpdateTiles(const char* dbPath,
         if (TileDbLoadIndex(dbPath, nav, oldIndex))
         {
             oldIndexSize = oldIndex.size();
+            FILE* oldFp = fopen(dbPath, "rb");
+            if (!oldFp)
+            {
+                printf("[TileDB][FATAL] failed to reopen existing DB for merge\n");
+                return false;
+            }
             for (const auto& kv : oldIndex)
             {
                 const uint64_t key = kv.first;
                 if (onlyTileKeysToUpdate && onlyTileKeysToUpdate->find(key) != onlyTileKeysToUpdate->end())
                     continue;
 
-                unsigned char* raw = nullptr;
-                int rawSize = 0;
-                if (!TileDbReadTile(dbPath, kv.second, raw, rawSize))
+                StoredTile st{};
+                st.entry = kv.second;
+                if (!ReadStoredBytes(oldFp, oldFileSizeBytes, kv.second, st.data))
                 {
+                    fclose(oldFp);
                     printf("[TileDB][FATAL] failed to preserve old tile (%d,%d)\n", kv.second.tx, kv.second.ty);
                     return false;
                 }
-
-                StoredTile st{};
-                st.entry = kv.second;
-                st.data.assign(raw, raw + rawSize);
-                dtFree(raw);
-                st.entry.dataSize = static_cast<uint32_t>(st.data.size());
                 mergedTiles[key] = std::move(st);
                 ++preservedOldTiles;
             }
+            fclose(oldFp);
         }
         else
         {
@@ -422,10 +648,12 @@ bool TileDbMergeWriteOrUpdateTiles(const char* dbPath,
         StoredTile st{};
         st.entry.tx = tile->header->x;
         st.entry.ty = tile->header->y;
-        st.entry.dataSize = static_cast<uint32_t>(tile->dataSize);
+        if (!TileDbEncodeBlob(codec, tile->data, tile->dataSize, st.data, st.entry.codec))
+            continue;
+        st.entry.dataSize = static_cast<uint32_t>(st.data.size());
+        st.entry.rawSize = static_cast<uint32_t>(tile->dataSize);
         auto itHash = tileHashes.find(key);
         st.entry.geomHash = itHash != tileHashes.end() ? itHash->second : 0;
-        st.data.assign(tile->data, tile->data + tile->dataSize);
         mergedTiles[key] = std::move(st);
         ++updatedTiles;
     }
@@ -479,6 +707,8 @@ bool TileDbMergeWriteOrUpdateTiles(const char* dbPath,
         }
         t.entry.dataOffset = static_cast<uint64_t>(offset);
         ok = fwrite(t.data.data(), t.entry.dataSize, 1, fp) == 1;
+        if (ok)
+            writeScope.addBytes(t.entry.dataSize);
     }
 
     if (ok)
@@ -543,7 +773,8 @@ bool LoadTileFromDb(const char* dbPath,
                     int tx,
                     int ty,
                     bool& outLoaded,
-                    const std::unordered_map<uint64_t, TileDbIndexEntry>* indexOverride)
+                    const std::unordered_map<uint64_t, TileDbIndexEntry>* indexOverride,
+                    bool deferLinks)
 {
     outLoaded = false;
     if (!dbPath || !nav)
@@ -568,12 +799,13 @@ bool LoadTileFromDb(const char* dbPath,
     if (!TileDbReadTile(dbPath, it->second, data, dataSize))
         return false;
 
-    if (nav->getTileRefAt(tx, ty, 0) != 0)
+    // Troca direta: se o tile do DB for rejeitado, o tile atual continua.
+    dtStatus status;
     {
-        dtTileRef oldRef = nav->getTileRefAt(tx, ty, 0);
-        nav->removeTile(oldRef, nullptr, nullptr);
+        GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, dataSize);
+        const int flags = DT_TILE_FREE_DATA | (deferLinks ? DT_TILE_DEFER_LINKS : 0);
+        status = nav->replaceTile(data, dataSize, flags, nullptr);
     }
-    dtStatus status = nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, nullptr);
     if (dtStatusFailed(status))
     {
         dtFree(data);
@@ -607,6 +839,8 @@ bool LoadTilesInBoundsFromDb(const char* dbPath,
     const int maxTx = static_cast<int>(floorf((bmax[0] - params->orig[0]) / tileWidth));
     const int maxTy = static_cast<int>(floorf((bmax[2] - params->orig[2]) / params->tileHeight));
 
+    // Insere todos os tiles primeiro e liga as bordas no fim (uma vez por borda).
+    nav->beginBatchAdd();
     for (const auto& pair : index)
     {
         const TileDbIndexEntry& entry = pair.second;
@@ -623,7 +857,11 @@ bool LoadTilesInBoundsFromDb(const char* dbPath,
         if (!TileDbReadTile(dbPath, entry, data, dataSize))
             continue;
 
-        dtStatus status = nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, nullptr);
+        dtStatus status;
+        {
+            GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, dataSize);
+            status = nav->addTile(data, dataSize, DT_TILE_FREE_DATA | DT_TILE_DEFER_LINKS, 0, nullptr);
+        }
         if (dtStatusFailed(status))
         {
             dtFree(data);
@@ -632,10 +870,19 @@ bool LoadTilesInBoundsFromDb(const char* dbPath,
         }
         ++outLoadedCount;
     }
+    TileDbEndBatchAdd(nav);
 
     return true;
 }
 
+dtStatus TileDbEndBatchAdd(dtNavMesh* nav)
+{
+    if (!nav)
+        return DT_FAILURE | DT_INVALID_PARAM;
+    GtaNavProfileScope linkScope(GTANAV_PROF_ADD_TILE);
+    return nav->endBatchAdd(TileDbParallelFor, nullptr);
+}
+
 bool TileDbGetStats(const char* dbPath, dtNavMesh* nav, TileDbStats& outStats)
 {
     outStats = {};
@@ -670,19 +917,84 @@ bool TileDbGetStats(const char* dbPath, dtNavMesh* nav, TileDbStats& outStats)
         outStats.maxTx = std::max(outStats.maxTx, e.tx);
         outStats.minTy = std::min(outStats.minTy, e.ty);
         outStats.maxTy = std::max(outStats.maxTy, e.ty);
+        outStats.storedBytes += e.dataSize;
+        outStats.rawBytes += e.rawSize;
+        if (e.codec != TILE_DB_CODEC_RAW)
+            ++outStats.compressedTiles;
     }
-    printf("[TileDB][Stats] fileMB=%.2f tileCount=%u tx=[%d,%d] ty=[%d,%d] invalid=%u dup=%u navCompatible=%d\n",
+    printf("[TileDB][Stats] fileMB=%.2f tileCount=%u tx=[%d,%d] ty=[%d,%d] invalid=%u dup=%u navCompatible=%d compressed=%u ratio=%.2f\n",
            static_cast<double>(outStats.fileSizeBytes) / (1024.0 * 1024.0),
            outStats.tileCount, outStats.minTx, outStats.maxTx, outStats.minTy, outStats.maxTy,
-           outStats.invalidEntries, outStats.duplicateKeys, outStats.navParamsCompatible ? 1 : 0);
+           outStats.invalidEntries, outStats.duplicateKeys, outStats.navParamsCompatible ? 1 : 0,
+           outStats.compressedTiles,
+           outStats.storedBytes > 0 ? static_cast<double>(outStats.rawBytes) / static_cast<double>(outStats.storedBytes) : 1.0);
     return true;
 }
 
 bool TileDbAppendOrReplaceTiles(const char* dbPath,
                                 dtNavMesh* nav,
                                 const std::unordered_map<uint64_t, uint64_t>& tileHashes,
-                                const std::unordered_set<uint64_t>* onlyTileKeysToUpdate)
+                                const std::unordered_set<uint64_t>* onlyTileKeysToUpdate,
+                                uint32_t codec)
 {
     printf("[TileDB][TODO] TileDbAppendOrReplaceTiles not implemented yet; falling back to merge rewrite.\n");
-    return TileDbMergeWriteOrUpdateTiles(dbPath, nav, tileHashes, onlyTileKeysToUpdate);
+    return TileDbMergeWriteOrUpdateTiles(dbPath, nav, tileHashes, onlyTileKeysToUpdate, codec);
+}
+
+bool TileDbCopyRegion(const char* srcPath, uint64_t srcOffset, const char* dstPath, uint64_t dstOffset, uint64_t size)
+{
+    FILE* src = fopen(srcPath, "rb");
+    if (!src)
+        return false;
+    FILE* dst = fopen(dstPath, "r+b");
+    if (!dst)
+        dst = fopen(dstPath, "w+b");
+    if (!dst)
+    {
+        fclose(src);
+        return false;
+    }
+
+    uint64_t copied = 0;
+#if defined(__linux__)
+    // Cópia dentro do kernel; cai no loop com buffer se o FS não suportar.
+    {
+        loff_t inOff = static_cast<loff_t>(srcOffset);
+        loff_t outOff = static_cast<loff_t>(dstOffset);
+        while (copied < size)
+        {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - copied, 1ull << 30));
+            const ssize_t n = copy_file_range(fileno(src), &inOff, fileno(dst), &outOff, chunk, 0);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                    continue;
+                break;
+            }
+            copied += static_cast<uint64_t>(n);
+        }
+    }
+#endif
+
+    bool ok = true;
+    if (copied < size)
+    {
+        std::vector<char> buffer(1 << 20);
+        ok = FileSeek64(src, srcOffset + copied, SEEK_SET) && FileSeek64(dst, dstOffset + copied, SEEK_SET);
+        while (ok && copied < size)
+        {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - copied, buffer.size()));
+            ok = fread(buffer.data(), 1, chunk, src) == chunk &&
+                 fwrite(buffer.data(), 1, chunk, dst) == chunk;
+            copied += chunk;
+        }
+    }
+
+    fclose(src);
+    if (fclose(dst) != 0)
+        ok = false;
+    if (!ok)
+        printf("[TileDB] TileDbCopyRegion: falha copiando %llu bytes de %s para %s\n",
+               static_cast<unsigned long long>(size), srcPath, dstPath);
+    return ok;
 }
@@ -3,11 +3,16 @@
 #include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <DetourNavMesh.h>
 
 static constexpr uint32_t TILE_DB_MAGIC = 'G' << 24 | 'T' << 16 | 'D' << 8 | 'B';
-static constexpr uint32_t TILE_DB_VERSION = 2;
+static constexpr uint32_t TILE_DB_VERSION = 3;
+
+// Codec por tile (v3). RAW = dados do dtNavMesh como estão; LZ = dtLZCompress.
+static constexpr uint32_t TILE_DB_CODEC_RAW = 0;
+static constexpr uint32_t TILE_DB_CODEC_LZ = 1;
 
 struct TileDbHeader
 {
@@ -22,9 +27,11 @@ struct TileDbIndexEntry
 {
     int tx = 0;
     int ty = 0;
-    uint32_t dataSize = 0;
+    uint32_t dataSize = 0;      // bytes gravados (comprimidos se codec != RAW)
     uint64_t dataOffset = 0;
     uint64_t geomHash = 0;
+    uint32_t codec = TILE_DB_CODEC_RAW;
+    uint32_t rawSize = 0;       // tamanho do tile descomprimido
 };
 
 inline uint64_t MakeTileKey(int tx, int ty)
@@ -32,6 +39,25 @@ inline uint64_t MakeTileKey(int tx, int ty)
     return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
 }
 
+// Comprime com o codec pedido; se não reduzir, grava RAW (outCodec diz o que foi usado).
+bool TileDbEncodeBlob(uint32_t codec,
+                      const unsigned char* data,
+                      int dataSize,
+                      std::vector<unsigned char>& outStored,
+                      uint32_t& outCodec);
+
+// Confere se o tamanho do tile bate com o layout deste build (dtLink muda com
+// DT_POLYREF64, então um tile gravado com refs de outra largura é rejeitado).
+bool TileDbIsTileLayoutValid(const unsigned char* data, int dataSize);
+
+// Devolve um buffer dtAlloc com o tile descomprimido (layout validado).
+bool TileDbDecodeBlob(uint32_t codec,
+                      const unsigned char* stored,
+                      uint32_t storedSize,
+                      uint32_t rawSize,
+                      unsigned char*& outData,
+                      int& outSize);
+
 bool TileDbLoadIndex(const char* dbPath,
                      dtNavMesh* nav,
                      std::unordered_map<uint64_t, TileDbIndexEntry>& outIndex);
@@ -43,18 +69,23 @@ bool TileDbReadTile(const char* dbPath,
 
 bool TileDbWriteOrUpdateTiles(const char* dbPath,
                               dtNavMesh* nav,
-                              const std::unordered_map<uint64_t, uint64_t>& tileHashes);
+                              const std::unordered_map<uint64_t, uint64_t>& tileHashes,
+                              uint32_t codec = TILE_DB_CODEC_LZ);
+// Tiles antigos preservados mantêm o codec com que foram gravados.
 bool TileDbMergeWriteOrUpdateTiles(const char* dbPath,
                                    dtNavMesh* nav,
                                    const std::unordered_map<uint64_t, uint64_t>& tileHashes,
-                                   const std::unordered_set<uint64_t>* onlyTileKeysToUpdate = nullptr);
+                                   const std::unordered_set<uint64_t>* onlyTileKeysToUpdate = nullptr,
+                                   uint32_t codec = TILE_DB_CODEC_LZ);
 
+// deferLinks: dentro de nav->beginBatchAdd(), os links com os vizinhos ficam para TileDbEndBatchAdd.
 bool LoadTileFromDb(const char* dbPath,
                     dtNavMesh* nav,
                     int tx,
                     int ty,
                     bool& outLoaded,
-                    const std::unordered_map<uint64_t, TileDbIndexEntry>* indexOverride = nullptr);
+                    const std::unordered_map<uint64_t, TileDbIndexEntry>* indexOverride = nullptr,
+                    bool deferLinks = false);
 
 bool LoadTilesInBoundsFromDb(const char* dbPath,
                              dtNavMesh* nav,
@@ -62,6 +93,10 @@ bool LoadTilesInBoundsFromDb(const char* dbPath,
                              const float* bmax,
                              int& outLoadedCount);
 
+// Carga em bloco: fecha o nav->beginBatchAdd() ligando cada borda compartilhada uma vez,
+// com os tiles repartidos entre threads.
+dtStatus TileDbEndBatchAdd(dtNavMesh* nav);
+
 struct TileDbStats
 {
     uint64_t fileSizeBytes = 0;
@@ -74,14 +109,22 @@ struct TileDbStats
     uint32_t invalidEntries = 0;
     uint32_t duplicateKeys = 0;
     bool navParamsCompatible = false;
+    uint32_t compressedTiles = 0;
+    uint64_t storedBytes = 0;   // soma de dataSize
+    uint64_t rawBytes = 0;      // soma de rawSize
 };
 
 bool TileDbGetStats(const char* dbPath,
                     dtNavMesh* nav,
                     TileDbStats& outStats);
 
+// Copia size bytes de srcPath[srcOffset] para dstPath[dstOffset] em blocos (copy_file_range
+// no Linux), sem carregar o arquivo inteiro. dstPath é criado se faltar e não é truncado.
+bool TileDbCopyRegion(const char* srcPath, uint64_t srcOffset, const char* dstPath, uint64_t dstOffset, uint64_t size);
+
 // TODO: Implement append/segmented tile DB writes to avoid full rewrite in long full builds.
 bool TileDbAppendOrReplaceTiles(const char* dbPath,
                                 dtNavMesh* nav,
                                 const std::unordered_map<uint64_t, uint64_t>& tileHashes,
-                                const std::unordered_set<uint64_t>* onlyTileKeysToUpdate = nullptr);
+                                const std::unordered_set<uint64_t>* onlyTileKeysToUpdate = nullptr,
+                                uint32_t codec = TILE_DB_CODEC_LZ);
@@ -1,4 +1,5 @@
 #include "NavMesh_TileCacheGridDB.h"
+#include "GtaNavProfile.h"
 
 #include "json.hpp"
 
@@ -9,6 +10,7 @@
 #include <filesystem>
 #include <fstream>
 #include <limits>
+#include <vector>
 
 namespace
 {
@@ -19,13 +21,67 @@ namespace
             if (std::fabs(expected.orig[i] - current.orig[i]) > eps) return false;
         if (std::fabs(expected.tileWidth - current.tileWidth) > eps) return false;
         if (std::fabs(expected.tileHeight - current.tileHeight) > eps) return false;
+#ifdef DT_POLYREF64
+        // maxTiles = capacidade residente; o ref 64 bits não depende dele.
+        return current.maxPolys >= expected.maxPolys;
+#else
         return current.maxTiles >= expected.maxTiles && current.maxPolys >= expected.maxPolys;
+#endif
     }
 
     std::filesystem::path TilePath(const std::filesystem::path& root, int tx, int ty)
     {
         return root / "tiles" / std::to_string(tx) / (std::to_string(ty) + ".tile");
     }
+
+    // Header da v1 (sem codec): dados RAW logo após o header.
+    struct TileGridDbFileHeaderV1
+    {
+        uint32_t magic = TILE_GRID_DB_MAGIC;
+        uint32_t version = 1;
+        int32_t tx = 0;
+        int32_t ty = 0;
+        uint64_t geomHash = 0;
+        uint32_t dataSize = 0;
+    };
+
+    // Lê v1 ou v2; outHeaderSize = offset dos dados no arquivo.
+    bool ReadTileHeader(FILE* fp, TileGridDbFileHeader& outHeader, uint32_t& outHeaderSize)
+    {
+        TileGridDbFileHeaderV1 v1{};
+        if (fread(&v1, sizeof(v1), 1, fp) != 1 || v1.magic != TILE_GRID_DB_MAGIC)
+            return false;
+
+        if (v1.version == 1)
+        {
+            outHeader = {};
+            outHeader.version = 1;
+            outHeader.tx = v1.tx;
+            outHeader.ty = v1.ty;
+            outHeader.geomHash = v1.geomHash;
+            outHeader.dataSize = v1.dataSize;
+            outHeader.codec = TILE_DB_CODEC_RAW;
+            outHeader.rawSize = v1.dataSize;
+            outHeaderSize = sizeof(TileGridDbFileHeaderV1);
+            return true;
+        }
+        if (v1.version != TILE_GRID_DB_VERSION)
+            return false;
+
+        if (fseek(fp, 0, SEEK_SET) != 0 || fread(&outHeader, sizeof(outHeader), 1, fp) != 1)
+            return false;
+        outHeaderSize = sizeof(TileGridDbFileHeader);
+        return true;
+    }
+
+    bool IsHeaderCodecValid(const TileGridDbFileHeader& h)
+    {
+        if (h.rawSize == 0 || h.rawSize > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+            return false;
+        if (h.codec == TILE_DB_CODEC_RAW)
+            return h.rawSize == h.dataSize;
+        return h.codec == TILE_DB_CODEC_LZ;
+    }
 }
 
 bool TileGridDbDeleteTile(const char* rootPath, int tx, int ty)
@@ -46,9 +102,11 @@ bool TileGridDbDeleteTile(const char* rootPath, int tx, int ty)
 bool TileGridDbWriteOrUpdateTiles(const char* rootPath,
                                   dtNavMesh* nav,
                                   const std::unordered_map<uint64_t, uint64_t>& tileHashes,
-                                  const std::unordered_set<uint64_t>* onlyTileKeysToUpdate)
+                                  const std::unordered_set<uint64_t>* onlyTileKeysToUpdate,
+                                  uint32_t codec)
 {
     if (!rootPath || !nav) return false;
+    GtaNavProfileScope writeScope(GTANAV_PROF_CACHE_WRITE);
     const std::filesystem::path root(rootPath);
     std::filesystem::create_directories(root / "tiles");
 
@@ -86,12 +144,18 @@ bool TileGridDbWriteOrUpdateTiles(const char* rootPath,
         }
 
         TileGridDbFileHeader h{};
-        h.tx = tx; h.ty = ty; h.dataSize = static_cast<uint32_t>(tile->dataSize);
+        h.tx = tx; h.ty = ty;
+        std::vector<unsigned char> stored;
+        TileDbEncodeBlob(codec, tile->data, tile->dataSize, stored, h.codec);
+        h.dataSize = static_cast<uint32_t>(stored.size());
+        h.rawSize = static_cast<uint32_t>(tile->dataSize);
         auto it = tileHashes.find(key);
         h.geomHash = it != tileHashes.end() ? it->second : 0;
 
-        bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 && fwrite(tile->data, tile->dataSize, 1, fp) == 1;
+        bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 && fwrite(stored.data(), stored.size(), 1, fp) == 1;
         fclose(fp);
+        if (ok)
+            writeScope.addBytes(stored.size());
         if (!ok)
         {
             std::error_code ec;
@@ -226,11 +290,12 @@ bool TileGridDbLoadIndex(const char* rootPath,
             FILE* fp = fopen(file.path().string().c_str(), "rb");
             if (!fp) continue;
             TileGridDbFileHeader h{};
-            bool ok = fread(&h, sizeof(h), 1, fp) == 1;
+            uint32_t headerSize = 0;
+            bool ok = ReadTileHeader(fp, h, headerSize);
             fclose(fp);
             const uintmax_t fileSize = std::filesystem::file_size(file.path());
-            const uintmax_t expectedSize = sizeof(TileGridDbFileHeader) + static_cast<uintmax_t>(h.dataSize);
-            const bool invalidHeader = !ok || h.magic != TILE_GRID_DB_MAGIC || h.version != TILE_GRID_DB_VERSION ||
+            const uintmax_t expectedSize = headerSize + static_cast<uintmax_t>(h.dataSize);
+            const bool invalidHeader = !ok || !IsHeaderCodecValid(h) ||
                 h.dataSize == 0 || h.dataSize > static_cast<uint32_t>(std::numeric_limits<int>::max()) || fileSize < expectedSize;
             if (invalidHeader)
             {
@@ -239,7 +304,8 @@ bool TileGridDbLoadIndex(const char* rootPath,
                 continue;
             }
             TileDbIndexEntry e{};
-            e.tx = h.tx; e.ty = h.ty; e.geomHash = h.geomHash; e.dataSize = h.dataSize; e.dataOffset = sizeof(TileGridDbFileHeader);
+            e.tx = h.tx; e.ty = h.ty; e.geomHash = h.geomHash; e.dataSize = h.dataSize; e.dataOffset = headerSize;
+            e.codec = h.codec; e.rawSize = h.rawSize;
             outIndex[MakeTileKey(e.tx, e.ty)] = e;
         }
     }
@@ -251,49 +317,67 @@ bool TileGridDbReadTile(const char* rootPath, int tx, int ty, uint64_t* outGeomH
 {
     outData = nullptr; outSize = 0; if (outGeomHash) *outGeomHash = 0;
     if (!rootPath) return false;
+    GtaNavProfileScope readScope(GTANAV_PROF_CACHE_READ);
     auto path = TilePath(rootPath, tx, ty);
     if (!std::filesystem::exists(path)) return false;
     FILE* fp = fopen(path.string().c_str(), "rb");
     if (!fp) return false;
     TileGridDbFileHeader h{};
-    if (fread(&h, sizeof(h), 1, fp) != 1 || h.magic != TILE_GRID_DB_MAGIC || h.version != TILE_GRID_DB_VERSION || h.tx != tx || h.ty != ty)
+    uint32_t headerSize = 0;
+    if (!ReadTileHeader(fp, h, headerSize) || h.tx != tx || h.ty != ty || !IsHeaderCodecValid(h))
     { fclose(fp); return false; }
     if (h.dataSize == 0 || h.dataSize > static_cast<uint32_t>(std::numeric_limits<int>::max())) { fclose(fp); return false; }
     const uintmax_t fileSize = std::filesystem::file_size(path);
-    const uintmax_t expectedSize = sizeof(TileGridDbFileHeader) + static_cast<uintmax_t>(h.dataSize);
+    const uintmax_t expectedSize = headerSize + static_cast<uintmax_t>(h.dataSize);
     if (fileSize < expectedSize)
     {
         printf("[WorldTile][GridDB][warn] truncated tile file %s\n", path.string().c_str());
         fclose(fp);
         return false;
     }
-    unsigned char* data = static_cast<unsigned char*>(dtAlloc(h.dataSize, DT_ALLOC_PERM));
-    if (!data) { fclose(fp); return false; }
-    if (fread(data, h.dataSize, 1, fp) != 1) { dtFree(data); fclose(fp); return false; }
-    fclose(fp);
+    if (h.codec == TILE_DB_CODEC_RAW)
+    {
+        unsigned char* data = static_cast<unsigned char*>(dtAlloc(h.dataSize, DT_ALLOC_PERM));
+        if (!data) { fclose(fp); return false; }
+        if (fread(data, h.dataSize, 1, fp) != 1) { dtFree(data); fclose(fp); return false; }
+        fclose(fp);
+        outData = data; outSize = static_cast<int>(h.dataSize);
+    }
+    else
+    {
+        std::vector<unsigned char> stored(h.dataSize);
+        const bool readOk = fread(stored.data(), h.dataSize, 1, fp) == 1;
+        fclose(fp);
+        if (!readOk) return false;
+        if (!TileDbDecodeBlob(h.codec, stored.data(), h.dataSize, h.rawSize, outData, outSize))
+        {
+            printf("[WorldTile][GridDB][erro] decode failed tx=%d ty=%d codec=%u\n", tx, ty, h.codec);
+            return false;
+        }
+    }
     if (outGeomHash) *outGeomHash = h.geomHash;
-    outData = data; outSize = static_cast<int>(h.dataSize);
+    readScope.addBytes(h.dataSize);
     return true;
 }
 
-bool TileGridDbLoadTile(const char* rootPath, dtNavMesh* nav, int tx, int ty, bool& outLoaded)
+bool TileGridDbLoadTile(const char* rootPath, dtNavMesh* nav, int tx, int ty, bool& outLoaded, bool deferLinks)
 {
     outLoaded = false;
     if (!rootPath || !nav) return false;
     unsigned char* data = nullptr; int size = 0; uint64_t hash = 0;
     if (!TileGridDbReadTile(rootPath, tx, ty, &hash, data, size)) return false;
-    const dtTileRef existing = nav->getTileRefAt(tx, ty, 0);
-    if (existing)
+    dtStatus st;
     {
+        GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, size);
         unsigned char* oldData = nullptr;
-        nav->removeTile(existing, &oldData, nullptr);
+        const int flags = DT_TILE_FREE_DATA | (deferLinks ? DT_TILE_DEFER_LINKS : 0);
+        st = nav->replaceTile(data, size, flags, nullptr, &oldData, nullptr);
         if (oldData) dtFree(oldData);
     }
-    const dtStatus st = nav->addTile(data, size, DT_TILE_FREE_DATA, 0, nullptr);
     if (dtStatusFailed(st))
     {
         dtFree(data);
-        printf("[WorldTile][GridDB][erro] addTile failed tx=%d ty=%d status=0x%08x\n", tx, ty, st);
+        printf("[WorldTile][GridDB][erro] replaceTile failed tx=%d ty=%d status=0x%08x\n", tx, ty, st);
         return false;
     }
     outLoaded = true;
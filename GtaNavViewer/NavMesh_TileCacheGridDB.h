@@ -9,7 +9,7 @@
 #include <DetourNavMesh.h>
 
 static constexpr uint32_t TILE_GRID_DB_MAGIC = 'G' << 24 | 'T' << 16 | 'G' << 8 | 'D';
-static constexpr uint32_t TILE_GRID_DB_VERSION = 1;
+static constexpr uint32_t TILE_GRID_DB_VERSION = 2;
 
 struct TileGridDbFileHeader
 {
@@ -18,13 +18,16 @@ struct TileGridDbFileHeader
     int32_t tx = 0;
     int32_t ty = 0;
     uint64_t geomHash = 0;
-    uint32_t dataSize = 0;
+    uint32_t dataSize = 0;      // bytes gravados após o header
+    uint32_t codec = TILE_DB_CODEC_RAW;   // v2
+    uint32_t rawSize = 0;                 // v2
 };
 
 bool TileGridDbWriteOrUpdateTiles(const char* rootPath,
                                   dtNavMesh* nav,
                                   const std::unordered_map<uint64_t, uint64_t>& tileHashes,
-                                  const std::unordered_set<uint64_t>* onlyTileKeysToUpdate);
+                                  const std::unordered_set<uint64_t>* onlyTileKeysToUpdate,
+                                  uint32_t codec = TILE_DB_CODEC_LZ);
 
 bool TileGridDbLoadIndex(const char* rootPath,
                          dtNavMesh* nav,
@@ -41,7 +44,8 @@ bool TileGridDbLoadTile(const char* rootPath,
                         dtNavMesh* nav,
                         int tx,
                         int ty,
-                        bool& outLoaded);
+                        bool& outLoaded,
+                        bool deferLinks = false);
 
 bool TileGridDbDeleteTile(const char* rootPath,
                           int tx,
@@ -0,0 +1,514 @@
+#include "NavMeshData.h"
+#include "GtaNavProfile.h"
+
+#include <Recast.h>
+#include <DetourNavMesh.h>
+#include <DetourNavMeshBuilder.h>
+#include <DetourCommon.h>
+#include <DetourTileCache.h>
+#include <DetourTileCacheBuilder.h>
+#include <DetourTileCacheCompressor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    uint64_t MakeLayerTileKey(int tx, int ty)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
+    }
+
+    // Flags/áreas iguais ao build sólido (flags = 1 em tudo que é andável) + offmesh do tile.
+    struct LayerMeshProcess : public dtTileCacheMeshProcess
+    {
+        std::unordered_map<uint64_t, std::vector<OffmeshLink>> linksByTile;
+
+        std::vector<float> offmeshVerts;
+        std::vector<float> offmeshRads;
+        std::vector<unsigned char> offmeshDirs;
+        std::vector<unsigned char> offmeshAreas;
+        std::vector<unsigned short> offmeshFlags;
+        std::vector<unsigned int> offmeshIds;
+
+        void process(dtNavMeshCreateParams* params, unsigned char* polyAreas, unsigned short* polyFlags) override
+        {
+            for (int i = 0; i < params->polyCount; ++i)
+            {
+                if (polyAreas[i] == DT_TILECACHE_WALKABLE_AREA)
+                    polyAreas[i] = AREA_GROUND;
+                polyFlags[i] = polyAreas[i] != AREA_NULL ? 1 : 0;
+            }
+            params->buildBvTree = true;
+
+            offmeshVerts.clear();
+            offmeshRads.clear();
+            offmeshDirs.clear();
+            offmeshAreas.clear();
+            offmeshFlags.clear();
+            offmeshIds.clear();
+
+            const auto it = linksByTile.find(MakeLayerTileKey(params->tileX, params->tileY));
+            if (it == linksByTile.end() || it->second.empty())
+                return;
+
+            unsigned int baseId = 1000;
+            for (const auto& link : it->second)
+            {
+                offmeshVerts.push_back(link.start.x);
+                offmeshVerts.push_back(link.start.y);
+                offmeshVerts.push_back(link.start.z);
+                offmeshVerts.push_back(link.end.x);
+                offmeshVerts.push_back(link.end.y);
+                offmeshVerts.push_back(link.end.z);
+                offmeshRads.push_back(link.radius);
+                offmeshDirs.push_back(link.bidirectional ? 1 : 0);
+                offmeshAreas.push_back(link.area);
+                offmeshFlags.push_back(link.flags);
+                offmeshIds.push_back(link.userId != 0 ? link.userId : baseId++);
+            }
+
+            // Links fora da faixa de altura do layer são descartados pelo Detour.
+            params->offMeshConVerts = offmeshVerts.data();
+            params->offMeshConRad = offmeshRads.data();
+            params->offMeshConDir = offmeshDirs.data();
+            params->offMeshConAreas = offmeshAreas.data();
+            params->offMeshConFlags = offmeshFlags.data();
+            params->offMeshConUserID = offmeshIds.data();
+            params->offMeshConCount = static_cast<int>(offmeshDirs.size());
+        }
+    };
+
+    struct CompressedLayer
+    {
+        unsigned char* data = nullptr;
+        int size = 0;
+    };
+
+    void FreeLayers(std::vector<CompressedLayer>& layers)
+    {
+        for (auto& layer : layers)
+            dtFree(layer.data);
+        layers.clear();
+    }
+
+    // Pipeline do Recast até rcBuildHeightfieldLayers; cada layer vira um blob comprimido.
+    bool RasterizeTileLayers(rcContext& ctx,
+                             const rcConfig& cfg,
+                             const std::vector<float>& verts,
+                             const std::vector<int>& tris,
+                             int tx,
+                             int ty,
+                             int maxLayers,
+                             dtTileCacheCompressor* comp,
+                             std::vector<CompressedLayer>& outLayers)
+    {
+        outLayers.clear();
+        const int nverts = static_cast<int>(verts.size() / 3);
+        const int ntris = static_cast<int>(tris.size() / 3);
+        if (ntris == 0)
+            return true;
+
+        rcHeightfield* solid = rcAllocHeightfield();
+        if (!solid || !rcCreateHeightfield(&ctx, *solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch))
+        {
+            printf("[NavMeshData] TileLayers %d,%d: rcCreateHeightfield falhou.\n", tx, ty);
+            rcFreeHeightField(solid);
+            return false;
+        }
+
+        std::vector<unsigned char> triAreas(static_cast<size_t>(ntris), 0);
+        rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts.data(), nverts, tris.data(), ntris, triAreas.data());
+        if (!rcRasterizeTriangles(&ctx, verts.data(), nverts, tris.data(), triAreas.data(), ntris, *solid, cfg.walkableClimb))
+        {
+            printf("[NavMeshData] TileLayers %d,%d: rcRasterizeTriangles falhou.\n", tx, ty);
+            rcFreeHeightField(solid);
+            return false;
+        }
+
+        rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *solid);
+        rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid);
+        rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *solid);
+
+        rcCompactHeightfield* chf = rcAllocCompactHeightfield();
+        if (!chf || !rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid, *chf))
+        {
+            printf("[NavMeshData] TileLayers %d,%d: rcBuildCompactHeightfield falhou.\n", tx, ty);
+            rcFreeCompactHeightfield(chf);
+            rcFreeHeightField(solid);
+            return false;
+        }
+        rcFreeHeightField(solid);
+
+        if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *chf))
+        {
+            printf("[NavMeshData] TileLayers %d,%d: rcErodeWalkableArea falhou.\n", tx, ty);
+            rcFreeCompactHeightfield(chf);
+            return false;
+        }
+
+        rcHeightfieldLayerSet* lset = rcAllocHeightfieldLayerSet();
+        if (!lset || !rcBuildHeightfieldLayers(&ctx, *chf, cfg.borderSize, cfg.walkableHeight, *lset))
+        {
+            printf("[NavMeshData] TileLayers %d,%d: rcBuildHeightfieldLayers falhou.\n", tx, ty);
+            rcFreeHeightfieldLayerSet(lset);
+            rcFreeCompactHeightfield(chf);
+            return false;
+        }
+        rcFreeCompactHeightfield(chf);
+
+        int nlayers = lset->nlayers;
+        if (nlayers > maxLayers)
+        {
+            printf("[NavMeshData] TileLayers %d,%d: %d layers, limite %d (excedentes descartados).\n",
+                   tx, ty, nlayers, maxLayers);
+            nlayers = maxLayers;
+        }
+
+        bool ok = true;
+        for (int i = 0; i < nlayers; ++i)
+        {
+            const rcHeightfieldLayer* layer = &lset->layers[i];
+
+            dtTileCacheLayerHeader header;
+            memset(&header, 0, sizeof(header));
+            header.magic = DT_TILECACHE_MAGIC;
+            header.version = DT_TILECACHE_VERSION;
+            header.tx = tx;
+            header.ty = ty;
+            header.tlayer = i;
+            dtVcopy(header.bmin, layer->bmin);
+            dtVcopy(header.bmax, layer->bmax);
+            header.width = static_cast<unsigned char>(layer->width);
+            header.height = static_cast<unsigned char>(layer->height);
+            header.minx = static_cast<unsigned char>(layer->minx);
+            header.maxx = static_cast<unsigned char>(layer->maxx);
+            header.miny = static_cast<unsigned char>(layer->miny);
+            header.maxy = static_cast<unsigned char>(layer->maxy);
+            header.hmin = static_cast<unsigned short>(layer->hmin);
+            header.hmax = static_cast<unsigned short>(layer->hmax);
+
+            CompressedLayer out;
+            const dtStatus status = dtBuildTileCacheLayer(comp, &header, layer->heights, layer->areas, layer->cons,
+                                                          &out.data, &out.size);
+            if (dtStatusFailed(status))
+            {
+                printf("[NavMeshData] TileLayers %d,%d: dtBuildTileCacheLayer falhou (layer %d) status=0x%x\n",
+                       tx, ty, i, status);
+                ok = false;
+                break;
+            }
+            outLayers.push_back(out);
+        }
+
+        rcFreeHeightfieldLayerSet(lset);
+        if (!ok)
+            FreeLayers(outLayers);
+        return ok;
+    }
+}
+
+struct ObstacleTileCache
+{
+    dtTileCache* tileCache = nullptr;
+    dtTileCacheAlloc alloc;
+    dtTileCacheLZCompressor comp;
+    LayerMeshProcess proc;
+    int maxLayersPerTile = 0;
+};
+
+bool NavMeshData::InitObstacleTileCache(int maxObstacles, int maxLayersPerTile)
+{
+    DestroyObstacleTileCache();
+
+    if (!m_nav || !m_hasTiledCache)
+    {
+        printf("[NavMeshData] InitObstacleTileCache: requer grid tiled inicializado.\n");
+        return false;
+    }
+
+    const int tileSize = std::max(1, m_cachedSettings.tileSize);
+    const int borderSize = m_cachedBaseCfg.walkableRadius + 3;
+    if (tileSize + borderSize * 2 > 255)
+    {
+        printf("[NavMeshData] InitObstacleTileCache: tileSize=%d + borda=%d excede 255 celulas por layer.\n",
+               tileSize, borderSize * 2);
+        return false;
+    }
+
+    const dtNavMeshParams* navParams = m_nav->getParams();
+
+    dtTileCacheParams tcparams;
+    memset(&tcparams, 0, sizeof(tcparams));
+    rcVcopy(tcparams.orig, navParams->orig);
+    tcparams.cs = m_cachedBaseCfg.cs;
+    tcparams.ch = m_cachedBaseCfg.ch;
+    tcparams.width = tileSize;
+    tcparams.height = tileSize;
+    tcparams.walkableHeight = m_cachedSettings.agentHeight;
+    tcparams.walkableRadius = m_cachedSettings.agentRadius;
+    tcparams.walkableClimb = m_cachedSettings.agentMaxClimb;
+    tcparams.maxSimplificationError = m_cachedSettings.maxSimplificationError;
+    // Camadas só existem para tiles residentes (saem junto no unload).
+    tcparams.maxTiles = navParams->maxTiles * std::max(1, maxLayersPerTile);
+    tcparams.maxObstacles = std::max(1, maxObstacles);
+
+    auto* cache = new ObstacleTileCache();
+    cache->maxLayersPerTile = std::max(1, maxLayersPerTile);
+    cache->tileCache = dtAllocTileCache();
+    if (!cache->tileCache)
+    {
+        printf("[NavMeshData] InitObstacleTileCache: dtAllocTileCache falhou.\n");
+        delete cache;
+        return false;
+    }
+
+    const dtStatus status = cache->tileCache->init(&tcparams, &cache->alloc, &cache->comp, &cache->proc);
+    if (dtStatusFailed(status))
+    {
+        printf("[NavMeshData] InitObstacleTileCache: init falhou status=0x%x maxTiles=%d maxObstacles=%d\n",
+               status, tcparams.maxTiles, tcparams.maxObstacles);
+        dtFreeTileCache(cache->tileCache);
+        delete cache;
+        return false;
+    }
+
+    printf("[NavMeshData] InitObstacleTileCache: maxTiles=%d maxObstacles=%d layersPorTile=%d\n",
+           tcparams.maxTiles, tcparams.maxObstacles, cache->maxLayersPerTile);
+    m_obstacleCache = cache;
+    return true;
+}
+
+void NavMeshData::DestroyObstacleTileCache()
+{
+    if (!m_obstacleCache)
+        return;
+    dtFreeTileCache(m_obstacleCache->tileCache);
+    delete m_obstacleCache;
+    m_obstacleCache = nullptr;
+}
+
+bool NavMeshData::RebuildTileLayersFromGeometry(int tx,
+                                                int ty,
+                                                const std::vector<glm::vec3>& verts,
+                                                const std::vector<unsigned int>& indices,
+                                                const std::vector<OffmeshLink>* tileOffmesh,
+                                                uint64_t tileHash,
+                                                bool* outBuilt,
+                                                bool* outEmpty)
+{
+    if (outBuilt) *outBuilt = false;
+    if (outEmpty) *outEmpty = false;
+
+    if (!m_nav || !m_hasTiledCache || !m_obstacleCache)
+        return false;
+    if (tx < 0 || ty < 0 || tx >= m_cachedTileWidthCount || ty >= m_cachedTileHeightCount)
+        return false;
+
+    dtTileCache* tc = m_obstacleCache->tileCache;
+
+    rcConfig cfg = m_cachedBaseCfg;
+    cfg.tileSize = std::max(1, m_cachedSettings.tileSize);
+    cfg.borderSize = cfg.walkableRadius + 3;
+    cfg.width = cfg.tileSize + cfg.borderSize * 2;
+    cfg.height = cfg.tileSize + cfg.borderSize * 2;
+
+    const float tileWorld = cfg.tileSize * cfg.cs;
+    cfg.bmin[0] = m_gridBMin[0] + tx * tileWorld - cfg.borderSize * cfg.cs;
+    cfg.bmin[1] = m_gridBMin[1];
+    cfg.bmin[2] = m_gridBMin[2] + ty * tileWorld - cfg.borderSize * cfg.cs;
+    cfg.bmax[0] = m_gridBMin[0] + (tx + 1) * tileWorld + cfg.borderSize * cfg.cs;
+    cfg.bmax[1] = m_gridBMax[1];
+    cfg.bmax[2] = m_gridBMin[2] + (ty + 1) * tileWorld + cfg.borderSize * cfg.cs;
+
+    std::vector<float> localVerts;
+    std::vector<int> localTris;
+    localVerts.reserve(verts.size() * 3);
+    for (const auto& v : verts)
+    {
+        localVerts.push_back(v.x);
+        localVerts.push_back(v.y);
+        localVerts.push_back(v.z);
+    }
+    localTris.reserve(indices.size());
+    for (unsigned int i : indices)
+        localTris.push_back(static_cast<int>(i));
+
+    // Camadas novas ficam prontas antes de mexer nas antigas; em falha o tile atual continua.
+    std::vector<CompressedLayer> layers;
+    {
+        GtaNavProfilingContext rcCtx;
+        if (!RasterizeTileLayers(rcCtx, cfg, localVerts, localTris, tx, ty,
+                                 m_obstacleCache->maxLayersPerTile, &m_obstacleCache->comp, layers))
+            return false;
+    }
+
+    dtCompressedTileRef oldRefs[64];
+    const int oldCount = tc->getTilesAt(tx, ty, oldRefs, 64);
+    for (int i = 0; i < oldCount; ++i)
+        tc->removeTile(oldRefs[i], nullptr, nullptr);
+
+    int added = 0;
+    for (auto& layer : layers)
+    {
+        const dtStatus status = tc->addTile(layer.data, layer.size, DT_COMPRESSEDTILE_FREE_DATA, nullptr);
+        if (dtStatusFailed(status))
+        {
+            printf("[NavMeshData] TileLayers %d,%d: addTile no tile cache falhou status=0x%x\n", tx, ty, status);
+            dtFree(layer.data);
+        }
+        else
+        {
+            ++added;
+        }
+        layer.data = nullptr;
+    }
+
+    const uint64_t tileKey = MakeLayerTileKey(tx, ty);
+    if (tileOffmesh && !tileOffmesh->empty())
+        m_obstacleCache->proc.linksByTile[tileKey] = *tileOffmesh;
+    else
+        m_obstacleCache->proc.linksByTile.erase(tileKey);
+
+    if (added > 0)
+    {
+        const dtStatus status = tc->buildNavMeshTilesAt(tx, ty, m_nav);
+        if (dtStatusFailed(status))
+            printf("[NavMeshData] TileLayers %d,%d: buildNavMeshTilesAt falhou status=0x%x\n", tx, ty, status);
+    }
+
+    // Layers do navMesh sem camada correspondente (andar sumiu) saem agora.
+    const dtMeshTile* navTiles[64];
+    const int navCount = m_nav->getTilesAt(tx, ty, navTiles, 64);
+    std::vector<dtTileRef> staleRefs;
+    for (int i = 0; i < navCount; ++i)
+    {
+        if (!tc->getTileAt(tx, ty, navTiles[i]->header->layer))
+            staleRefs.push_back(m_nav->getTileRef(navTiles[i]));
+    }
+    for (dtTileRef ref : staleRefs)
+        m_nav->removeTile(ref, nullptr, nullptr);
+
+    const bool built = m_nav->getTilesAt(tx, ty, navTiles, 64) > 0;
+    m_cachedTileHashes[tileKey] = tileHash;
+    if (outBuilt) *outBuilt = built;
+    if (outEmpty) *outEmpty = !built;
+    return true;
+}
+
+bool NavMeshData::RemoveTileLayersAt(int tx, int ty)
+{
+    if (!m_nav)
+        return false;
+
+    bool removed = false;
+    if (m_obstacleCache)
+    {
+        dtTileCache* tc = m_obstacleCache->tileCache;
+        dtCompressedTileRef refs[64];
+        const int count = tc->getTilesAt(tx, ty, refs, 64);
+        for (int i = 0; i < count; ++i)
+            tc->removeTile(refs[i], nullptr, nullptr);
+        m_obstacleCache->proc.linksByTile.erase(MakeLayerTileKey(tx, ty));
+    }
+
+    const dtMeshTile* navTiles[64];
+    const int navCount = m_nav->getTilesAt(tx, ty, navTiles, 64);
+    std::vector<dtTileRef> refs;
+    for (int i = 0; i < navCount; ++i)
+        refs.push_back(m_nav->getTileRef(navTiles[i]));
+    for (dtTileRef ref : refs)
+    {
+        unsigned char* data = nullptr;
+        if (dtStatusSucceed(m_nav->removeTile(ref, &data, nullptr)))
+        {
+            removed = true;
+            if (data)
+                dtFree(data);
+        }
+    }
+    return removed;
+}
+
+void NavMeshData::ClearTileLayers()
+{
+    if (!m_obstacleCache)
+        return;
+    dtTileCache* tc = m_obstacleCache->tileCache;
+    for (int i = 0; i < tc->getTileCount(); ++i)
+    {
+        const dtCompressedTile* tile = tc->getTile(i);
+        if (tile && tile->header)
+            tc->removeTile(tc->getTileRef(tile), nullptr, nullptr);
+    }
+    m_obstacleCache->proc.linksByTile.clear();
+}
+
+bool NavMeshData::AddCylinderObstacle(const float* basePos, float radius, float height, unsigned int* outRef)
+{
+    if (outRef) *outRef = 0;
+    if (!m_obstacleCache || !basePos)
+        return false;
+    dtObstacleRef ref = 0;
+    const dtStatus status = m_obstacleCache->tileCache->addObstacle(basePos, radius, height, &ref);
+    if (dtStatusFailed(status))
+        return false;
+    if (outRef) *outRef = ref;
+    return true;
+}
+
+bool NavMeshData::AddBoxObstacle(const float* bmin, const float* bmax, unsigned int* outRef)
+{
+    if (outRef) *outRef = 0;
+    if (!m_obstacleCache || !bmin || !bmax)
+        return false;
+    dtObstacleRef ref = 0;
+    const dtStatus status = m_obstacleCache->tileCache->addBoxObstacle(bmin, bmax, &ref);
+    if (dtStatusFailed(status))
+        return false;
+    if (outRef) *outRef = ref;
+    return true;
+}
+
+bool NavMeshData::RemoveObstacle(unsigned int ref)
+{
+    if (!m_obstacleCache || ref == 0)
+        return false;
+    return dtStatusSucceed(m_obstacleCache->tileCache->removeObstacle(ref));
+}
+
+bool NavMeshData::UpdateObstacles(float budgetMs, int* outSteps)
+{
+    if (outSteps) *outSteps = 0;
+    if (!m_obstacleCache || !m_nav)
+        return true;
+
+    // Cada update() processa os pedidos e remonta no máximo 1 tile.
+    const auto start = std::chrono::steady_clock::now();
+    bool upToDate = false;
+    int steps = 0;
+    while (!upToDate)
+    {
+        const dtStatus status = m_obstacleCache->tileCache->update(0.0f, m_nav, &upToDate);
+        ++steps;
+        if (dtStatusFailed(status))
+        {
+            printf("[NavMeshData] UpdateObstacles: update falhou status=0x%x\n", status);
+            break;
+        }
+        if (budgetMs > 0.0f)
+        {
+            const float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (elapsedMs >= budgetMs)
+                break;
+        }
+    }
+
+    if (outSteps) *outSteps = steps;
+    return upToDate;
+}
@@ -1,5 +1,7 @@
 #include "NavMeshBuild.h"
 #include "NavMesh_TileCacheDB.h"
+#include "GtaNavProfile.h"
+#include "GtaNavRefBits.h"
 
 #include <DetourMath.h>
 #include <DetourNavMeshBuilder.h>
@@ -194,6 +196,8 @@ namespace
         if (localTris == 0)
             return NavTileBuildResult::Empty;
 
+        rcScopedTimer totalTimer(&input.ctx, RC_TIMER_TOTAL);
+
         rcHeightfield* solid = rcAllocHeightfield();
         if (!solid)
         {
@@ -437,7 +441,11 @@ namespace
         }
 
         printf("[NavMeshData] params.offMeshConCount %d \n", params.offMeshConCount);
-        bool ok = dtCreateNavMeshData(&params, &navData, &navDataSize);
+        bool ok = false;
+        {
+            GtaNavProfileScope createScope(GTANAV_PROF_DETOUR_CREATE);
+            ok = dtCreateNavMeshData(&params, &navData, &navDataSize);
+        }
         if (!ok)
         {
             printf("[NavMeshData] dtCreateNavMeshData falhou. polys=%d verts=%d detailVerts=%d detailTris=%d bounds=(%.2f, %.2f, %.2f)-(%.2f, %.2f, %.2f)\n",
@@ -528,6 +536,7 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
         }
         for (int tx = 0; tx < tileWidthCount; ++tx)
         {
+            GtaNavProfileScope gatherScope(GTANAV_PROF_GATHER);
             rcConfig tileCfg = cfg;
             tileCfg.width = cfg.tileSize + cfg.borderSize * 2;
             tileCfg.height = cfg.tileSize + cfg.borderSize * 2;
@@ -635,19 +644,18 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
     navParams.maxTiles = tileCountTotal;
 
     const unsigned int desiredMaxPolys = 1 << 18;
-    const unsigned int tileBits = (unsigned int)dtIlog2(dtNextPow2((unsigned int)navParams.maxTiles));
-    const unsigned int desiredPolyBits = (unsigned int)dtIlog2(dtNextPow2(desiredMaxPolys));
-    const unsigned int maxPolyBitsAllowed = tileBits >= 22 ? 0u : (22u - tileBits);
-    if (maxPolyBitsAllowed == 0)
+    GtaNavRefLayout refLayout;
+    if (!GtaNav_ComputeRefLayout(navParams.maxTiles, desiredMaxPolys, refLayout))
     {
         printf("[NavMeshData] maxTiles=%u consome todos os bits de ref (tileBits=%u). Ajuste tileSize ou reduza area.\n",
-               (unsigned int)navParams.maxTiles, tileBits);
+               (unsigned int)navParams.maxTiles, refLayout.tileBits);
         dtFreeNavMesh(nav);
         return false;
     }
 
-    const unsigned int chosenPolyBits = std::min(desiredPolyBits, maxPolyBitsAllowed);
-    navParams.maxPolys = 1u << chosenPolyBits;
+    const unsigned int tileBits = refLayout.tileBits;
+    const unsigned int chosenPolyBits = refLayout.polyBits;
+    navParams.maxPolys = refLayout.maxPolys;
     if (navParams.maxPolys != desiredMaxPolys)
     {
         printf("[NavMeshData] Clamp maxPolys para %u (tileBits=%u polyBits=%u). Numero de tiles=%u\n",
@@ -679,6 +687,7 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
             const bool loadedIndex = TileDbLoadIndex(cacheFile, nav, index);
             if (loadedIndex)
             {
+                nav->beginBatchAdd();
                 for (const TileInput& inputTile : tilesToBuild)
                 {
                     const uint64_t tileKey = MakeTileKey(inputTile.tx, inputTile.ty);
@@ -704,7 +713,11 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
                         continue;
                     }
 
-                    dtStatus status = nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, nullptr);
+                    dtStatus status;
+                    {
+                        GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, dataSize);
+                        status = nav->addTile(data, dataSize, DT_TILE_FREE_DATA | DT_TILE_DEFER_LINKS, 0, nullptr);
+                    }
                     if (dtStatusSucceed(status))
                     {
                         tilesLoadedFromCache[tileKey] = true;
@@ -716,6 +729,7 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
                         printf("[NavMeshData] Falha ao adicionar tile do cache (%d,%d) status=0x%x\n", inputTile.tx, inputTile.ty, status);
                     }
                 }
+                TileDbEndBatchAdd(nav);
 
                 tilesBuilt += static_cast<int>(tilesLoadedFromCache.size());
                 if (!tilesLoadedFromCache.empty())
@@ -770,7 +784,11 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
                 return false;
             }
 
-            dtStatus status = nav->addTile(navMeshData, navMeshDataSize, DT_TILE_FREE_DATA, 0, nullptr);
+            dtStatus status;
+            {
+                GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, navMeshDataSize);
+                status = nav->addTile(navMeshData, navMeshDataSize, DT_TILE_FREE_DATA, 0, nullptr);
+            }
             if (dtStatusFailed(status))
             {
                 printf("[NavMeshData] addTile falhou (tile %d,%d). status=0x%x size=%d polys=%d verts=%d bounds=(%.2f, %.2f, %.2f)-(%.2f, %.2f, %.2f)\n",
@@ -807,23 +825,21 @@ bool BuildTiledNavMesh(const NavmeshBuildInput& input,
     return true;
 }
 
-bool BuildSingleTile(const NavmeshBuildInput& input,
-                     const NavmeshGenerationSettings& settings,
-                     int tileX,
-                     int tileY,
-                     dtNavMesh* nav,
-                     bool& outBuilt,
-                     bool& outEmpty)
+bool BuildSingleTileData(const NavmeshBuildInput& input,
+                         const NavmeshGenerationSettings& settings,
+                         int tileX,
+                         int tileY,
+                         int maxPolys,
+                         unsigned char*& outData,
+                         int& outDataSize,
+                         bool& outNoGeometry,
+                         bool& outEmpty)
 {
-    outBuilt = false;
+    outData = nullptr;
+    outDataSize = 0;
+    outNoGeometry = false;
     outEmpty = false;
 
-    if (!nav)
-    {
-        printf("[NavMeshData] BuildSingleTile: navMesh nulo.\n");
-        return false;
-    }
-
     rcConfig cfg = input.baseCfg;
     cfg.borderSize = cfg.walkableRadius + 3;
     cfg.tileSize = std::max(1, settings.tileSize);
@@ -863,50 +879,40 @@ bool BuildSingleTile(const NavmeshBuildInput& input,
     std::vector<int> tileTris;
     tileTris.reserve(input.tris.size());
     std::vector<OffmeshLink> tileOffmesh;
-    collectOffmeshForTile(input, tileCfg, tileX, tileY, tileOffmesh);
-
-    for (int i = 0; i < input.ntris; ++i)
     {
-        const float* v0 = &input.verts[input.tris[i*3+0] * 3];
-        const float* v1 = &input.verts[input.tris[i*3+1] * 3];
-        const float* v2 = &input.verts[input.tris[i*3+2] * 3];
-
-        float triMin[3] = {
-            std::min({v0[0], v1[0], v2[0]}),
-            std::min({v0[1], v1[1], v2[1]}),
-            std::min({v0[2], v1[2], v2[2]})
-        };
-        float triMax[3] = {
-            std::max({v0[0], v1[0], v2[0]}),
-            std::max({v0[1], v1[1], v2[1]}),
-            std::max({v0[2], v1[2], v2[2]})
-        };
+        GtaNavProfileScope gatherScope(GTANAV_PROF_GATHER);
+        collectOffmeshForTile(input, tileCfg, tileX, tileY, tileOffmesh);
 
-        if (overlapsBounds(triMin, triMax, tileCfg.bmin, tileCfg.bmax))
+        for (int i = 0; i < input.ntris; ++i)
         {
-            tileTris.push_back(input.tris[i*3+0]);
-            tileTris.push_back(input.tris[i*3+1]);
-            tileTris.push_back(input.tris[i*3+2]);
+            const float* v0 = &input.verts[input.tris[i*3+0] * 3];
+            const float* v1 = &input.verts[input.tris[i*3+1] * 3];
+            const float* v2 = &input.verts[input.tris[i*3+2] * 3];
+
+            float triMin[3] = {
+                std::min({v0[0], v1[0], v2[0]}),
+                std::min({v0[1], v1[1], v2[1]}),
+                std::min({v0[2], v1[2], v2[2]})
+            };
+            float triMax[3] = {
+                std::max({v0[0], v1[0], v2[0]}),
+                std::max({v0[1], v1[1], v2[1]}),
+                std::max({v0[2], v1[2], v2[2]})
+            };
+
+            if (overlapsBounds(triMin, triMax, tileCfg.bmin, tileCfg.bmax))
+            {
+                tileTris.push_back(input.tris[i*3+0]);
+                tileTris.push_back(input.tris[i*3+1]);
+                tileTris.push_back(input.tris[i*3+2]);
+            }
         }
     }
 
-    dtNavMeshParams params = *nav->getParams();
-    const unsigned int maxPolys = params.maxPolys;
-
-    const dtTileRef existing = nav->getTileRefAt(tileX, tileY, 0);
-
     if (tileTris.empty())
     {
-        dtStatus removeStatus = DT_SUCCESS;
-        if (existing)
-        {
-            removeStatus = nav->removeTile(existing, nullptr, nullptr);
-            DEBUG_LOG("[NavMeshData] removeTile existente (%d,%d) status=0x%x\n", tileX, tileY, removeStatus);
-        }
-        printf("[NavMeshData] BuildSingleTile: tile %d,%d nao possui geometria. Removido=%s\n",
-               tileX, tileY, dtStatusSucceed(removeStatus) ? "sim" : "nao");
-        outEmpty = true;
-        return dtStatusSucceed(removeStatus);
+        outNoGeometry = true;
+        return true;
     }
 
     dtNavMeshCreateParams createParams{};
@@ -916,7 +922,6 @@ bool BuildSingleTile(const NavmeshBuildInput& input,
     if (result == NavTileBuildResult::Empty)
     {
         outEmpty = true;
-        printf("[NavMeshData] BuildSingleTile: tile %d,%d resultou Empty; tile anterior mantido.\n", tileX, tileY);
         return true;
     }
     if (result == NavTileBuildResult::Error)
@@ -924,42 +929,113 @@ bool BuildSingleTile(const NavmeshBuildInput& input,
         return false;
     }
 
-    if (createParams.polyCount > (int)maxPolys)
+    if (createParams.polyCount > maxPolys)
     {
-        printf("[NavMeshData] BuildSingleTile: tile %d,%d tem %d polys > maxPolys(%u).\n",
+        printf("[NavMeshData] BuildSingleTile: tile %d,%d tem %d polys > maxPolys(%d).\n",
                tileX, tileY, createParams.polyCount, maxPolys);
         dtFree(navMeshData);
         return false;
     }
 
-    if (existing)
+    outData = navMeshData;
+    outDataSize = navMeshDataSize;
+    return true;
+}
+
+bool ApplySingleTileData(dtNavMesh* nav,
+                         int tileX,
+                         int tileY,
+                         unsigned char* data,
+                         int dataSize,
+                         bool noGeometry,
+                         bool empty,
+                         bool& outBuilt,
+                         bool& outEmpty)
+{
+    outBuilt = false;
+    outEmpty = false;
+
+    if (!nav)
+    {
+        printf("[NavMeshData] BuildSingleTile: navMesh nulo.\n");
+        if (data)
+            dtFree(data);
+        return false;
+    }
+
+    const dtTileRef existing = nav->getTileRefAt(tileX, tileY, 0);
+
+    if (noGeometry)
     {
-        const dtStatus removeStatus = nav->removeTile(existing, nullptr, nullptr);
-        DEBUG_LOG("[NavMeshData] removeTile existente (%d,%d) status=0x%x\n", tileX, tileY, removeStatus);
-        if (dtStatusFailed(removeStatus))
+        dtStatus removeStatus = DT_SUCCESS;
+        if (existing)
         {
-            printf("[NavMeshData] BuildSingleTile: falha ao remover tile antigo %d,%d status=0x%x\n",
-                   tileX, tileY, removeStatus);
-            dtFree(navMeshData);
-            return false;
+            removeStatus = nav->removeTile(existing, nullptr, nullptr);
+            DEBUG_LOG("[NavMeshData] removeTile existente (%d,%d) status=0x%x\n", tileX, tileY, removeStatus);
         }
+        printf("[NavMeshData] BuildSingleTile: tile %d,%d nao possui geometria. Removido=%s\n",
+               tileX, tileY, dtStatusSucceed(removeStatus) ? "sim" : "nao");
+        outEmpty = true;
+        return dtStatusSucceed(removeStatus);
+    }
+
+    if (empty || !data)
+    {
+        outEmpty = true;
+        printf("[NavMeshData] BuildSingleTile: tile %d,%d resultou Empty; tile anterior mantido.\n", tileX, tileY);
+        return true;
     }
 
-    dtStatus addStatus = nav->addTile(navMeshData, navMeshDataSize, DT_TILE_FREE_DATA, 0, nullptr);
+    const dtMeshHeader* header = reinterpret_cast<const dtMeshHeader*>(data);
+
+    // remove+add num passo só; se falhar, o tile antigo continua no navMesh
+    dtStatus addStatus;
+    {
+        GtaNavProfileScope addScope(GTANAV_PROF_ADD_TILE, dataSize);
+        addStatus = nav->replaceTile(data, dataSize, DT_TILE_FREE_DATA, nullptr);
+    }
+    DEBUG_LOG("[NavMeshData] replaceTile (%d,%d) existente=%d status=0x%x\n", tileX, tileY, existing ? 1 : 0, addStatus);
     if (dtStatusFailed(addStatus))
     {
-        printf("[NavMeshData] BuildSingleTile: addTile falhou (tile %d,%d) status=0x%x size=%d polys=%d bounds=(%.2f, %.2f, %.2f)-(%.2f, %.2f, %.2f)\n",
-               tileX, tileY, addStatus, navMeshDataSize, createParams.polyCount,
-               createParams.bmin[0], createParams.bmin[1], createParams.bmin[2],
-               createParams.bmax[0], createParams.bmax[1], createParams.bmax[2]);
-        dtFree(navMeshData);
+        printf("[NavMeshData] BuildSingleTile: replaceTile falhou (tile %d,%d) status=0x%x size=%d polys=%d bounds=(%.2f, %.2f, %.2f)-(%.2f, %.2f, %.2f)\n",
+               tileX, tileY, addStatus, dataSize, header->polyCount,
+               header->bmin[0], header->bmin[1], header->bmin[2],
+               header->bmax[0], header->bmax[1], header->bmax[2]);
+        dtFree(data);
         return false;
     }
 
+    // Depois do replaceTile os dados são do navMesh; o header continua válido.
     outBuilt = true;
     printf("[NavMeshData] BuildSingleTile OK (%d,%d). polys=%d verts=%d bounds=(%.2f, %.2f, %.2f)-(%.2f, %.2f, %.2f)\n",
-           tileX, tileY, createParams.polyCount, createParams.vertCount,
-           createParams.bmin[0], createParams.bmin[1], createParams.bmin[2],
-           createParams.bmax[0], createParams.bmax[1], createParams.bmax[2]);
+           tileX, tileY, header->polyCount, header->vertCount,
+           header->bmin[0], header->bmin[1], header->bmin[2],
+           header->bmax[0], header->bmax[1], header->bmax[2]);
     return true;
 }
+
+bool BuildSingleTile(const NavmeshBuildInput& input,
+                     const NavmeshGenerationSettings& settings,
+                     int tileX,
+                     int tileY,
+                     dtNavMesh* nav,
+                     bool& outBuilt,
+                     bool& outEmpty)
+{
+    outBuilt = false;
+    outEmpty = false;
+
+    if (!nav)
+    {
+        printf("[NavMeshData] BuildSingleTile: navMesh nulo.\n");
+        return false;
+    }
+
+    unsigned char* data = nullptr;
+    int dataSize = 0;
+    bool noGeometry = false;
+    bool empty = false;
+    if (!BuildSingleTileData(input, settings, tileX, tileY, nav->getParams()->maxPolys, data, dataSize, noGeometry, empty))
+        return false;
+    return ApplySingleTileData(nav, tileX, tileY, data, dataSize, noGeometry, empty, outBuilt, outEmpty);
+}
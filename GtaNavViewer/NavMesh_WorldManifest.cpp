@@ -0,0 +1,572 @@
+#include "NavMesh_WorldManifest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+    // Registro fixo do base; strings e tile keys ficam em blocos separados no fim do arquivo.
+    struct WorldManifestDiskGeom
+    {
+        uint32_t idOffset = 0;
+        uint32_t idSize = 0;
+        uint32_t pathOffset = 0;
+        uint32_t pathSize = 0;
+        uint32_t groupOffset = 0;
+        uint32_t groupSize = 0;
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[3] = { 0.0f, 0.0f, 0.0f };
+        float worldBMin[3] = { 0.0f, 0.0f, 0.0f };
+        float worldBMax[3] = { 0.0f, 0.0f, 0.0f };
+        uint32_t flags = 0;
+        uint32_t tileKeyFirst = 0;
+        uint32_t tileKeyCount = 0;
+        uint8_t preferBin = 0;
+        uint8_t indexed = 0;
+        uint8_t pending = 0;
+        uint8_t reserved = 0;
+        uint64_t geomHash = 0;
+        uint64_t fileMTime = 0;
+        uint64_t fileSize = 0;
+    };
+    static_assert(sizeof(WorldManifestDiskGeom) == 112, "layout do manifesto mudou");
+
+    struct WorldManifestDiskTile
+    {
+        uint64_t key = 0;
+        uint64_t emptyHash = 0;
+        uint8_t bits = 0;
+        uint8_t reserved[7] = {};
+    };
+    static_assert(sizeof(WorldManifestDiskTile) == 24, "layout do manifesto mudou");
+    static_assert(sizeof(WorldManifestFileHeader) == 64, "layout do manifesto mudou");
+
+    struct WorldJournalFileHeader
+    {
+        uint32_t magic = WORLD_JOURNAL_MAGIC;
+        uint32_t version = WORLD_JOURNAL_VERSION;
+    };
+
+    struct WorldJournalRecordHeader
+    {
+        uint32_t payloadSize = 0;
+        uint32_t checksum = 0;
+        uint64_t seq = 0;
+    };
+
+    uint32_t Fnv1a32(const unsigned char* data, size_t size)
+    {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= data[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    template <typename T>
+    void AppendPod(std::vector<unsigned char>& out, const T& value)
+    {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    void AppendString(std::vector<unsigned char>& out, const std::string& s)
+    {
+        AppendPod(out, static_cast<uint32_t>(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    struct ByteReader
+    {
+        const unsigned char* p = nullptr;
+        size_t left = 0;
+        bool ok = true;
+
+        template <typename T>
+        T Pod()
+        {
+            T value{};
+            if (left < sizeof(T))
+            {
+                ok = false;
+                return value;
+            }
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            left -= sizeof(T);
+            return value;
+        }
+
+        std::string String()
+        {
+            const uint32_t size = Pod<uint32_t>();
+            if (!ok || left < size)
+            {
+                ok = false;
+                return {};
+            }
+            std::string s(reinterpret_cast<const char*>(p), size);
+            p += size;
+            left -= size;
+            return s;
+        }
+    };
+
+    void AppendGeom(std::vector<unsigned char>& out, const WorldManifestGeom& g)
+    {
+        AppendString(out, g.id);
+        AppendString(out, g.path);
+        AppendString(out, g.groupId);
+        AppendPod(out, g.position);
+        AppendPod(out, g.rotation);
+        AppendPod(out, g.worldBMin);
+        AppendPod(out, g.worldBMax);
+        AppendPod(out, g.geomHash);
+        AppendPod(out, g.fileMTime);
+        AppendPod(out, g.fileSize);
+        AppendPod(out, g.flags);
+        const uint8_t bools = (g.preferBin ? 1 : 0) | (g.indexed ? 2 : 0) | (g.pending ? 4 : 0);
+        AppendPod(out, bools);
+        AppendPod(out, static_cast<uint32_t>(g.tileKeys.size()));
+        for (uint64_t key : g.tileKeys)
+            AppendPod(out, key);
+    }
+
+    bool ReadGeom(ByteReader& in, WorldManifestGeom& g)
+    {
+        g.id = in.String();
+        g.path = in.String();
+        g.groupId = in.String();
+        const auto readVec3 = [&](float* dst) {
+            for (int i = 0; i < 3; ++i)
+                dst[i] = in.Pod<float>();
+        };
+        readVec3(g.position);
+        readVec3(g.rotation);
+        readVec3(g.worldBMin);
+        readVec3(g.worldBMax);
+        g.geomHash = in.Pod<uint64_t>();
+        g.fileMTime = in.Pod<uint64_t>();
+        g.fileSize = in.Pod<uint64_t>();
+        g.flags = in.Pod<uint32_t>();
+        const uint8_t bools = in.Pod<uint8_t>();
+        g.preferBin = (bools & 1) != 0;
+        g.indexed = (bools & 2) != 0;
+        g.pending = (bools & 4) != 0;
+        const uint32_t tileKeyCount = in.Pod<uint32_t>();
+        if (!in.ok || in.left / sizeof(uint64_t) < tileKeyCount)
+            return false;
+        g.tileKeys.resize(tileKeyCount);
+        for (uint32_t i = 0; i < tileKeyCount; ++i)
+            g.tileKeys[i] = in.Pod<uint64_t>();
+        return in.ok;
+    }
+
+    bool ReadWholeFile(const std::filesystem::path& path, std::vector<unsigned char>& out)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in.is_open())
+            return false;
+        const std::streamoff size = in.tellg();
+        if (size < 0)
+            return false;
+        out.resize(static_cast<size_t>(size));
+        in.seekg(0);
+        if (size > 0 && !in.read(reinterpret_cast<char*>(out.data()), size))
+            return false;
+        return true;
+    }
+
+    bool WriteFileReplacing(const std::filesystem::path& path, const std::vector<unsigned char>& data)
+    {
+        std::filesystem::path tmpPath = path;
+        tmpPath += ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return false;
+            if (!data.empty())
+                out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!out.good())
+                return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            printf("[WorldManifest] falha ao renomear %s: %s\n", tmpPath.string().c_str(), ec.message().c_str());
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // Percorre os registros válidos; para no primeiro truncado ou corrompido.
+    template <typename Fn>
+    size_t ForEachJournalRecord(const std::vector<unsigned char>& bytes, Fn&& fn)
+    {
+        size_t at = sizeof(WorldJournalFileHeader);
+        while (bytes.size() - at >= sizeof(WorldJournalRecordHeader))
+        {
+            WorldJournalRecordHeader rh;
+            std::memcpy(&rh, bytes.data() + at, sizeof(rh));
+            const size_t payloadAt = at + sizeof(rh);
+            if (bytes.size() - payloadAt < rh.payloadSize)
+                break;
+            if (Fnv1a32(bytes.data() + payloadAt, rh.payloadSize) != rh.checksum)
+                break;
+            if (!fn(rh, bytes.data() + payloadAt, at))
+                break;
+            at = payloadAt + rh.payloadSize;
+        }
+        return at;
+    }
+
+    bool ReadJournal(const std::filesystem::path& path, std::vector<unsigned char>& bytes)
+    {
+        if (!ReadWholeFile(path, bytes))
+            return false;
+        if (bytes.size() < sizeof(WorldJournalFileHeader))
+            return false;
+        WorldJournalFileHeader fh;
+        std::memcpy(&fh, bytes.data(), sizeof(fh));
+        return fh.magic == WORLD_JOURNAL_MAGIC && fh.version == WORLD_JOURNAL_VERSION;
+    }
+}
+
+bool WorldManifestWrite(const std::filesystem::path& path, const WorldManifest& manifest)
+{
+    WorldManifestFileHeader header;
+    header.settingsHash = manifest.settingsHash;
+    header.lastSeq = manifest.lastSeq;
+    std::memcpy(header.bboxMin, manifest.bboxMin, sizeof(header.bboxMin));
+    std::memcpy(header.bboxMax, manifest.bboxMax, sizeof(header.bboxMax));
+    header.geomCount = static_cast<uint32_t>(manifest.geometries.size());
+    header.tileCount = static_cast<uint32_t>(manifest.tiles.size());
+
+    std::vector<WorldManifestDiskGeom> geoms(manifest.geometries.size());
+    std::vector<uint64_t> tileKeys;
+    std::string strings;
+    for (size_t i = 0; i < manifest.geometries.size(); ++i)
+    {
+        const WorldManifestGeom& g = manifest.geometries[i];
+        WorldManifestDiskGeom& d = geoms[i];
+        d.idOffset = static_cast<uint32_t>(strings.size());
+        d.idSize = static_cast<uint32_t>(g.id.size());
+        strings += g.id;
+        d.pathOffset = static_cast<uint32_t>(strings.size());
+        d.pathSize = static_cast<uint32_t>(g.path.size());
+        strings += g.path;
+        d.groupOffset = static_cast<uint32_t>(strings.size());
+        d.groupSize = static_cast<uint32_t>(g.groupId.size());
+        strings += g.groupId;
+        std::memcpy(d.position, g.position, sizeof(d.position));
+        std::memcpy(d.rotation, g.rotation, sizeof(d.rotation));
+        std::memcpy(d.worldBMin, g.worldBMin, sizeof(d.worldBMin));
+        std::memcpy(d.worldBMax, g.worldBMax, sizeof(d.worldBMax));
+        d.flags = g.flags;
+        d.tileKeyFirst = static_cast<uint32_t>(tileKeys.size());
+        d.tileKeyCount = static_cast<uint32_t>(g.tileKeys.size());
+        tileKeys.insert(tileKeys.end(), g.tileKeys.begin(), g.tileKeys.end());
+        d.preferBin = g.preferBin ? 1 : 0;
+        d.indexed = g.indexed ? 1 : 0;
+        d.pending = g.pending ? 1 : 0;
+        d.geomHash = g.geomHash;
+        d.fileMTime = g.fileMTime;
+        d.fileSize = g.fileSize;
+    }
+    if (strings.size() > std::numeric_limits<uint32_t>::max() || tileKeys.size() > std::numeric_limits<uint32_t>::max())
+        return false;
+    header.tileKeyCount = static_cast<uint32_t>(tileKeys.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    std::vector<WorldManifestDiskTile> tiles(manifest.tiles.size());
+    for (size_t i = 0; i < manifest.tiles.size(); ++i)
+    {
+        tiles[i].key = manifest.tiles[i].key;
+        tiles[i].emptyHash = manifest.tiles[i].emptyHash;
+        tiles[i].bits = manifest.tiles[i].bits;
+    }
+
+    std::vector<unsigned char> bytes;
+    bytes.reserve(sizeof(header) + geoms.size() * sizeof(WorldManifestDiskGeom) +
+                  tiles.size() * sizeof(WorldManifestDiskTile) + tileKeys.size() * sizeof(uint64_t) + strings.size());
+    const auto appendBlock = [&](const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    };
+    appendBlock(&header, sizeof(header));
+    appendBlock(geoms.data(), geoms.size() * sizeof(WorldManifestDiskGeom));
+    appendBlock(tiles.data(), tiles.size() * sizeof(WorldManifestDiskTile));
+    appendBlock(tileKeys.data(), tileKeys.size() * sizeof(uint64_t));
+    appendBlock(strings.data(), strings.size());
+    return WriteFileReplacing(path, bytes);
+}
+
+bool WorldManifestRead(const std::filesystem::path& path, WorldManifest& outManifest)
+{
+    std::vector<unsigned char> bytes;
+    if (!ReadWholeFile(path, bytes) || bytes.size() < sizeof(WorldManifestFileHeader))
+        return false;
+
+    WorldManifestFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != WORLD_MANIFEST_MAGIC || header.version != WORLD_MANIFEST_VERSION)
+    {
+        printf("[WorldManifest] %s: magic/versao invalidos.\n", path.string().c_str());
+        return false;
+    }
+
+    const uint64_t geomBytes = static_cast<uint64_t>(header.geomCount) * sizeof(WorldManifestDiskGeom);
+    const uint64_t tileBytes = static_cast<uint64_t>(header.tileCount) * sizeof(WorldManifestDiskTile);
+    const uint64_t keyBytes = static_cast<uint64_t>(header.tileKeyCount) * sizeof(uint64_t);
+    if (sizeof(header) + geomBytes + tileBytes + keyBytes + header.stringBytes != bytes.size())
+    {
+        printf("[WorldManifest] %s: tamanho inconsistente.\n", path.string().c_str());
+        return false;
+    }
+
+    const unsigned char* geomData = bytes.data() + sizeof(header);
+    const unsigned char* tileData = geomData + geomBytes;
+    const unsigned char* keyData = tileData + tileBytes;
+    const char* strings = reinterpret_cast<const char*>(keyData + keyBytes);
+    const auto validRange = [&](uint32_t offset, uint32_t size, uint32_t total) {
+        return offset <= total && size <= total - offset;
+    };
+
+    outManifest = {};
+    outManifest.settingsHash = header.settingsHash;
+    outManifest.lastSeq = header.lastSeq;
+    std::memcpy(outManifest.bboxMin, header.bboxMin, sizeof(header.bboxMin));
+    std::memcpy(outManifest.bboxMax, header.bboxMax, sizeof(header.bboxMax));
+
+    outManifest.geometries.resize(header.geomCount);
+    for (uint32_t i = 0; i < header.geomCount; ++i)
+    {
+        WorldManifestDiskGeom d;
+        std::memcpy(&d, geomData + static_cast<size_t>(i) * sizeof(d), sizeof(d));
+        if (!validRange(d.idOffset, d.idSize, header.stringBytes) ||
+            !validRange(d.pathOffset, d.pathSize, header.stringBytes) ||
+            !validRange(d.groupOffset, d.groupSize, header.stringBytes) ||
+            !validRange(d.tileKeyFirst, d.tileKeyCount, header.tileKeyCount))
+        {
+            printf("[WorldManifest] %s: registro %u invalido.\n", path.string().c_str(), i);
+            outManifest = {};
+            return false;
+        }
+
+        WorldManifestGeom& g = outManifest.geometries[i];
+        g.id.assign(strings + d.idOffset, d.idSize);
+        g.path.assign(strings + d.pathOffset, d.pathSize);
+        g.groupId.assign(strings + d.groupOffset, d.groupSize);
+        std::memcpy(g.position, d.position, sizeof(g.position));
+        std::memcpy(g.rotation, d.rotation, sizeof(g.rotation));
+        std::memcpy(g.worldBMin, d.worldBMin, sizeof(g.worldBMin));
+        std::memcpy(g.worldBMax, d.worldBMax, sizeof(g.worldBMax));
+        g.geomHash = d.geomHash;
+        g.fileMTime = d.fileMTime;
+        g.fileSize = d.fileSize;
+        g.flags = d.flags;
+        g.preferBin = d.preferBin != 0;
+        g.indexed = d.indexed != 0;
+        g.pending = d.pending != 0;
+        g.tileKeys.resize(d.tileKeyCount);
+        if (d.tileKeyCount > 0)
+            std::memcpy(g.tileKeys.data(), keyData + static_cast<size_t>(d.tileKeyFirst) * sizeof(uint64_t), d.tileKeyCount * sizeof(uint64_t));
+    }
+
+    outManifest.tiles.resize(header.tileCount);
+    for (uint32_t i = 0; i < header.tileCount; ++i)
+    {
+        WorldManifestDiskTile d;
+        std::memcpy(&d, tileData + static_cast<size_t>(i) * sizeof(d), sizeof(d));
+        outManifest.tiles[i].key = d.key;
+        outManifest.tiles[i].emptyHash = d.emptyHash;
+        outManifest.tiles[i].bits = d.bits;
+    }
+    return true;
+}
+
+bool WorldJournalReset(const std::filesystem::path& path)
+{
+    std::vector<unsigned char> bytes;
+    AppendPod(bytes, WorldJournalFileHeader{});
+    return WriteFileReplacing(path, bytes);
+}
+
+bool WorldJournalAppend(const std::filesystem::path& path, const WorldManifestDelta& delta, uint64_t* outJournalBytes)
+{
+    std::vector<unsigned char> payload;
+    AppendPod(payload, static_cast<uint32_t>(delta.upserts.size()));
+    for (const WorldManifestGeom& g : delta.upserts)
+        AppendGeom(payload, g);
+    AppendPod(payload, static_cast<uint32_t>(delta.removals.size()));
+    for (const std::string& id : delta.removals)
+        AppendString(payload, id);
+    AppendPod(payload, static_cast<uint32_t>(delta.tiles.size()));
+    for (const WorldManifestTile& t : delta.tiles)
+    {
+        AppendPod(payload, t.key);
+        AppendPod(payload, t.emptyHash);
+        AppendPod(payload, t.bits);
+    }
+    if (payload.size() > std::numeric_limits<uint32_t>::max())
+        return false;
+
+    std::error_code ec;
+    const bool exists = std::filesystem::exists(path, ec);
+    if (!exists && !WorldJournalReset(path))
+        return false;
+
+    WorldJournalRecordHeader rh;
+    rh.payloadSize = static_cast<uint32_t>(payload.size());
+    rh.checksum = Fnv1a32(payload.data(), payload.size());
+    rh.seq = delta.seq;
+
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    if (!out.is_open())
+        return false;
+    out.write(reinterpret_cast<const char*>(&rh), sizeof(rh));
+    out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    out.flush();
+    if (!out.good())
+        return false;
+    if (outJournalBytes)
+        *outJournalBytes = static_cast<uint64_t>(out.tellp());
+    return true;
+}
+
+bool WorldJournalReplay(const std::filesystem::path& path, WorldManifest& manifest, uint64_t* outJournalBytes)
+{
+    if (outJournalBytes)
+        *outJournalBytes = 0;
+    std::vector<unsigned char> bytes;
+    if (!ReadJournal(path, bytes))
+        return false;
+
+    std::unordered_map<std::string, size_t> geomIndex;
+    std::unordered_map<uint64_t, size_t> tileIndex;
+    geomIndex.reserve(manifest.geometries.size());
+    for (size_t i = 0; i < manifest.geometries.size(); ++i)
+        geomIndex.emplace(manifest.geometries[i].id, i);
+    tileIndex.reserve(manifest.tiles.size());
+    for (size_t i = 0; i < manifest.tiles.size(); ++i)
+        tileIndex.emplace(manifest.tiles[i].key, i);
+
+    std::vector<char> geomRemoved(manifest.geometries.size(), 0);
+    const uint64_t baseSeq = manifest.lastSeq;
+    size_t applied = 0;
+    bool corrupt = false;
+    const size_t end = ForEachJournalRecord(bytes, [&](const WorldJournalRecordHeader& rh, const unsigned char* payload, size_t) {
+        if (rh.seq <= baseSeq)
+            return true;
+
+        ByteReader in{ payload, rh.payloadSize, true };
+        const uint32_t upserts = in.Pod<uint32_t>();
+        for (uint32_t i = 0; i < upserts && in.ok; ++i)
+        {
+            WorldManifestGeom g;
+            if (!ReadGeom(in, g))
+                break;
+            auto it = geomIndex.find(g.id);
+            if (it != geomIndex.end())
+            {
+                manifest.geometries[it->second] = std::move(g);
+                geomRemoved[it->second] = 0;
+            }
+            else
+            {
+                geomIndex.emplace(g.id, manifest.geometries.size());
+                manifest.geometries.push_back(std::move(g));
+                geomRemoved.push_back(0);
+            }
+        }
+        const uint32_t removals = in.Pod<uint32_t>();
+        for (uint32_t i = 0; i < removals && in.ok; ++i)
+        {
+            const std::string id = in.String();
+            auto it = geomIndex.find(id);
+            if (in.ok && it != geomIndex.end())
+                geomRemoved[it->second] = 1;
+        }
+        const uint32_t tiles = in.Pod<uint32_t>();
+        for (uint32_t i = 0; i < tiles && in.ok; ++i)
+        {
+            WorldManifestTile t;
+            t.key = in.Pod<uint64_t>();
+            t.emptyHash = in.Pod<uint64_t>();
+            t.bits = in.Pod<uint8_t>();
+            if (!in.ok)
+                break;
+            auto it = tileIndex.find(t.key);
+            if (it != tileIndex.end())
+            {
+                manifest.tiles[it->second] = t;
+            }
+            else
+            {
+                tileIndex.emplace(t.key, manifest.tiles.size());
+                manifest.tiles.push_back(t);
+            }
+        }
+        if (!in.ok)
+        {
+            corrupt = true;
+            return false;
+        }
+        manifest.lastSeq = rh.seq;
+        ++applied;
+        return true;
+    });
+
+    if (corrupt)
+        printf("[WorldManifest] journal %s: registro invalido, replay parou no seq %llu.\n",
+               path.string().c_str(), static_cast<unsigned long long>(manifest.lastSeq));
+    else if (end != bytes.size())
+        printf("[WorldManifest] journal %s: %zu bytes truncados no fim ignorados.\n", path.string().c_str(), bytes.size() - end);
+
+    size_t keep = 0;
+    for (size_t i = 0; i < manifest.geometries.size(); ++i)
+    {
+        if (geomRemoved[i])
+            continue;
+        if (keep != i)
+            manifest.geometries[keep] = std::move(manifest.geometries[i]);
+        ++keep;
+    }
+    manifest.geometries.resize(keep);
+    manifest.tiles.erase(std::remove_if(manifest.tiles.begin(), manifest.tiles.end(),
+                                        [](const WorldManifestTile& t) { return t.bits == 0; }),
+                         manifest.tiles.end());
+
+    if (outJournalBytes)
+        *outJournalBytes = end;
+    return true;
+}
+
+bool WorldJournalDropThrough(const std::filesystem::path& path, uint64_t upToSeq, uint64_t* outJournalBytes)
+{
+    std::vector<unsigned char> bytes;
+    if (!ReadJournal(path, bytes))
+        return WorldJournalReset(path);
+
+    std::vector<unsigned char> kept;
+    AppendPod(kept, WorldJournalFileHeader{});
+    ForEachJournalRecord(bytes, [&](const WorldJournalRecordHeader& rh, const unsigned char* payload, size_t at) {
+        if (rh.seq > upToSeq)
+            kept.insert(kept.end(), bytes.begin() + at, bytes.begin() + (payload - bytes.data()) + rh.payloadSize);
+        return true;
+    });
+    if (!WriteFileReplacing(path, kept))
+        return false;
+    if (outJournalBytes)
+        *outJournalBytes = kept.size();
+    return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Manifesto binário do mundo: um bloco plano (header, registros de tamanho fixo,
+// tile keys e strings) mais um journal só de append com as mudanças desde o último base.
+static constexpr uint32_t WORLD_MANIFEST_MAGIC = 'G' << 24 | 'W' << 16 | 'M' << 8 | 'F';
+static constexpr uint32_t WORLD_MANIFEST_VERSION = 1;
+static constexpr uint32_t WORLD_JOURNAL_MAGIC = 'G' << 24 | 'W' << 16 | 'J' << 8 | 'L';
+static constexpr uint32_t WORLD_JOURNAL_VERSION = 1;
+
+enum WorldManifestTileBits : uint8_t
+{
+    WORLD_TILE_DIRTY = 1 << 0,
+    WORLD_TILE_PENDING_BUILD = 1 << 1,
+    WORLD_TILE_EMPTY = 1 << 2,
+    WORLD_TILE_FAILED = 1 << 3,
+    WORLD_TILE_EMPTY_HASH = 1 << 4,
+};
+
+struct WorldManifestFileHeader
+{
+    uint32_t magic = WORLD_MANIFEST_MAGIC;
+    uint32_t version = WORLD_MANIFEST_VERSION;
+    uint64_t settingsHash = 0;
+    uint64_t lastSeq = 0;       // último registro do journal já incluído no base
+    float bboxMin[3] = { 0.0f, 0.0f, 0.0f };
+    float bboxMax[3] = { 0.0f, 0.0f, 0.0f };
+    uint32_t geomCount = 0;
+    uint32_t tileCount = 0;
+    uint32_t tileKeyCount = 0;
+    uint32_t stringBytes = 0;
+};
+
+struct WorldManifestGeom
+{
+    std::string id;
+    std::string path;
+    std::string groupId;
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    float rotation[3] = { 0.0f, 0.0f, 0.0f };
+    float worldBMin[3] = { 0.0f, 0.0f, 0.0f };
+    float worldBMax[3] = { 0.0f, 0.0f, 0.0f };
+    uint64_t geomHash = 0;
+    uint64_t fileMTime = 0;
+    uint64_t fileSize = 0;
+    uint32_t flags = 0;
+    bool preferBin = false;
+    bool indexed = false;
+    bool pending = false;       // ainda na fila de ProcessQueuedWorldGeometry
+    std::vector<uint64_t> tileKeys;
+};
+
+struct WorldManifestTile
+{
+    uint64_t key = 0;
+    uint64_t emptyHash = 0;
+    uint8_t bits = 0;           // WorldManifestTileBits; 0 no journal tira o tile
+};
+
+struct WorldManifest
+{
+    uint64_t settingsHash = 0;
+    uint64_t lastSeq = 0;
+    float bboxMin[3] = { 0.0f, 0.0f, 0.0f };
+    float bboxMax[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<WorldManifestGeom> geometries;
+    std::vector<WorldManifestTile> tiles;
+};
+
+struct WorldManifestDelta
+{
+    uint64_t seq = 0;
+    std::vector<WorldManifestGeom> upserts;
+    std::vector<std::string> removals;
+    std::vector<WorldManifestTile> tiles;
+};
+
+// Grava em arquivo temporário e renomeia por cima; pode rodar fora da thread principal.
+bool WorldManifestWrite(const std::filesystem::path& path, const WorldManifest& manifest);
+bool WorldManifestRead(const std::filesystem::path& path, WorldManifest& outManifest);
+
+bool WorldJournalReset(const std::filesystem::path& path);
+bool WorldJournalAppend(const std::filesystem::path& path, const WorldManifestDelta& delta, uint64_t* outJournalBytes);
+// Aplica os registros com seq > manifest.lastSeq. Um registro truncado no fim encerra o replay.
+bool WorldJournalReplay(const std::filesystem::path& path, WorldManifest& manifest, uint64_t* outJournalBytes);
+// Remove do journal os registros que o base já incorporou (seq <= upToSeq).
+bool WorldJournalDropThrough(const std::filesystem::path& path, uint64_t upToSeq, uint64_t* outJournalBytes);
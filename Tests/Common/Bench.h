@@ -0,0 +1,48 @@
+#ifndef TESTS_BENCH_H
+#define TESTS_BENCH_H
+
+#include <stdio.h>
+
+#include "catch2/catch_all.hpp"
+
+// TODO: Implement benchmarking for platforms other than posix.
+#ifdef __unix__
+#include <unistd.h>
+#ifdef _POSIX_TIMERS
+#include <time.h>
+#include <stdint.h>
+
+#define BENCH_ENABLED 1
+
+static inline int64_t BenchNowNanos(clockid_t clock) {
+	struct timespec tp;
+	clock_gettime(clock, &tp);
+	return tp.tv_nsec + 1000000000LL * tp.tv_sec;
+}
+
+#define BM_CLOCK(name, iterations, clock) \
+	struct BM_ ## name { \
+		static void Run() { \
+			int64_t begin_time = BenchNowNanos(clock); \
+			for (int i = 0 ; i < iterations; i++) { \
+				Body(); \
+			} \
+			int64_t nanos = BenchNowNanos(clock) - begin_time; \
+			printf("BM_%-35s %ld iterations in %10ld nanos: %10.2f nanos/it\n", #name ":", (int64_t)iterations, nanos, double(nanos) / iterations); \
+		} \
+		static void Body(); \
+	}; \
+	TEST_CASE(#name) { \
+		BM_ ## name::Run(); \
+	} \
+	void BM_ ## name::Body()
+
+// Process CPU time.
+#define BM(name, iterations) BM_CLOCK(name, iterations, CLOCK_PROCESS_CPUTIME_ID)
+// Wall clock, for benchmarks whose work runs on several threads.
+#define BM_WALL(name, iterations) BM_CLOCK(name, iterations, CLOCK_MONOTONIC)
+
+#endif  // _POSIX_TIMERS
+#endif  // __unix__
+
+#endif  // TESTS_BENCH_H
@@ -0,0 +1,109 @@
+#include "TestParallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DetourCommon.h"
+
+void reverseParallelFor(void* userData, int jobCount, dtParallelJobFn job, void* jobData)
+{
+	++*(int*)userData;
+	for (int i = jobCount - 1; i >= 0; --i)
+		job(jobData, i);
+}
+
+namespace
+{
+class WorkerPool
+{
+public:
+	WorkerPool() : m_job(0), m_jobData(0), m_jobCount(0), m_nextJob(0), m_busy(0), m_generation(0), m_quit(false)
+	{
+		const int threadCount = dtMax(1, dtMin((int)std::thread::hardware_concurrency(), 8));
+		for (int t = 1; t < threadCount; ++t)
+			m_workers.push_back(std::thread(&WorkerPool::workerLoop, this));
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for (size_t t = 0; t < m_workers.size(); ++t)
+			m_workers[t].join();
+	}
+
+	void run(int jobCount, dtParallelJobFn job, void* jobData)
+	{
+		if (m_workers.empty() || jobCount <= 1)
+		{
+			for (int i = 0; i < jobCount; ++i)
+				job(jobData, i);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_job = job;
+			m_jobData = jobData;
+			m_jobCount = jobCount;
+			m_nextJob = 0;
+			m_busy = (int)m_workers.size();
+			++m_generation;
+		}
+		m_wake.notify_all();
+		runJobs();
+
+		std::unique_lock<std::mutex> lock(m_lock);
+		m_done.wait(lock, [this]() { return m_busy == 0; });
+	}
+
+private:
+	void runJobs()
+	{
+		for (int i = m_nextJob++; i < m_jobCount; i = m_nextJob++)
+			m_job(m_jobData, i);
+	}
+
+	void workerLoop()
+	{
+		unsigned int seen = 0;
+		std::unique_lock<std::mutex> lock(m_lock);
+		for (;;)
+		{
+			m_wake.wait(lock, [&]() { return m_quit || m_generation != seen; });
+			if (m_quit)
+				return;
+			seen = m_generation;
+			lock.unlock();
+			runJobs();
+			lock.lock();
+			if (--m_busy == 0)
+				m_done.notify_one();
+		}
+	}
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_lock;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	dtParallelJobFn m_job;
+	void* m_jobData;
+	int m_jobCount;
+	std::atomic<int> m_nextJob;
+	int m_busy;
+	unsigned int m_generation;
+	bool m_quit;
+};
+}
+
+void threadParallelFor(void* /*userData*/, int jobCount, dtParallelJobFn job, void* jobData)
+{
+	static WorkerPool pool;
+	pool.run(jobCount, job, jobData);
+}
@@ -0,0 +1,15 @@
+#ifndef TESTS_TESTPARALLEL_H
+#define TESTS_TESTPARALLEL_H
+
+#include "DetourNavMesh.h"
+
+/// A #dtParallelForFn that runs the jobs backwards on the calling thread, so the result
+/// must not depend on the job order. @p userData points to an int counting the calls.
+void reverseParallelFor(void* userData, int jobCount, dtParallelJobFn job, void* jobData);
+
+/// A #dtParallelForFn on a persistent pool of min(hardware threads, 8) threads, the calling
+/// thread included. The workers start on the first call and live until exit, so benchmarks
+/// that call it once per phase do not time thread creation.
+void threadParallelFor(void* userData, int jobCount, dtParallelJobFn job, void* jobData);
+
+#endif  // TESTS_TESTPARALLEL_H
@@ -0,0 +1,76 @@
+#include "TestTiles.h"
+
+#include <string.h>
+#include <vector>
+
+#include "DetourNavMeshBuilder.h"
+
+unsigned char* buildGridTestTile(int tx, int ty, int cells, int* dataSize)
+{
+	std::vector<unsigned short> verts;
+	for (int z = 0; z <= cells; ++z)
+	{
+		for (int x = 0; x <= cells; ++x)
+		{
+			verts.push_back((unsigned short)x);
+			verts.push_back(0);
+			verts.push_back((unsigned short)z);
+		}
+	}
+
+	std::vector<unsigned short> polys;
+	for (int z = 0; z < cells; ++z)
+	{
+		for (int x = 0; x < cells; ++x)
+		{
+			const unsigned short v0 = (unsigned short)(z * (cells + 1) + x);
+			polys.push_back(v0);
+			polys.push_back((unsigned short)(v0 + cells + 1));
+			polys.push_back((unsigned short)(v0 + cells + 2));
+			polys.push_back((unsigned short)(v0 + 1));
+
+			// Edge order: x-, z+, x+, z-. Portal direction codes match.
+			const int nx[4] = { x - 1, x, x + 1, x };
+			const int nz[4] = { z, z + 1, z, z - 1 };
+			for (int e = 0; e < 4; ++e)
+			{
+				if (nx[e] < 0 || nx[e] >= cells || nz[e] < 0 || nz[e] >= cells)
+					polys.push_back((unsigned short)(0x8000 | e));
+				else
+					polys.push_back((unsigned short)(nz[e] * cells + nx[e]));
+			}
+		}
+	}
+
+	const int polyCount = cells * cells;
+	std::vector<unsigned short> flags(polyCount, 1);
+	std::vector<unsigned char> areas(polyCount, 0);
+
+	dtNavMeshCreateParams params;
+	memset(&params, 0, sizeof(params));
+	params.verts = verts.data();
+	params.vertCount = (int)verts.size() / 3;
+	params.polys = polys.data();
+	params.polyFlags = flags.data();
+	params.polyAreas = areas.data();
+	params.polyCount = polyCount;
+	params.nvp = 4;
+	params.tileX = tx;
+	params.tileY = ty;
+	params.bmin[0] = (float)(tx * cells);
+	params.bmin[2] = (float)(ty * cells);
+	params.bmax[0] = params.bmin[0] + cells;
+	params.bmax[1] = 1.0f;
+	params.bmax[2] = params.bmin[2] + cells;
+	params.walkableHeight = 2.0f;
+	params.walkableRadius = 0.5f;
+	params.walkableClimb = 0.5f;
+	params.cs = 1.0f;
+	params.ch = 1.0f;
+	params.buildBvTree = true;
+
+	unsigned char* data = 0;
+	if (!dtCreateNavMeshData(&params, &data, dataSize))
+		return 0;
+	return data;
+}
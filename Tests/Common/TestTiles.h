@@ -0,0 +1,8 @@
+#ifndef TESTS_TESTTILES_H
+#define TESTS_TESTTILES_H
+
+/// Builds a flat cells x cells tile at (tx, ty) with one quad per cell (cs = ch = 1),
+/// portals on all four tile borders. Returns dtAlloc'd data, or 0 on failure.
+unsigned char* buildGridTestTile(int tx, int ty, int cells, int* dataSize);
+
+#endif  // TESTS_TESTTILES_H
@@ -0,0 +1,340 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+#include "DetourFlowField.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNavMeshQuery.h"
+#include "TestParallel.h"
+#include "TestTiles.h"
+#include <vector>
+
+#include "Bench.h"
+
+#ifdef BENCH_ENABLED
+
+static const int kBlockTiles = 20;
+static const int kTileCells = 24;
+
+struct BlockTiles
+{
+	std::vector<unsigned char*> data;
+	std::vector<int> sizes;
+
+	BlockTiles()
+	{
+		for (int ty = 0; ty < kBlockTiles; ++ty)
+		{
+			for (int tx = 0; tx < kBlockTiles; ++tx)
+			{
+				int size = 0;
+				data.push_back(buildGridTestTile(tx, ty, kTileCells, &size));
+				sizes.push_back(size);
+			}
+		}
+	}
+
+	~BlockTiles()
+	{
+		for (size_t i = 0; i < data.size(); ++i)
+			dtFree(data[i]);
+	}
+};
+
+static BlockTiles& blockTiles()
+{
+	static BlockTiles tiles;
+	return tiles;
+}
+
+static void loadBlock(bool batch, dtParallelForFn parallelFor)
+{
+	BlockTiles& tiles = blockTiles();
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	params.tileWidth = (float)kTileCells;
+	params.tileHeight = (float)kTileCells;
+	params.maxTiles = kBlockTiles * kBlockTiles;
+	params.maxPolys = kTileCells * kTileCells;
+
+	dtNavMesh mesh;
+	REQUIRE(dtStatusSucceed(mesh.init(&params)));
+	if (batch)
+		mesh.beginBatchAdd();
+	// The nav mesh does not own the data, so the tiles can be loaded again.
+	for (size_t i = 0; i < tiles.data.size(); ++i)
+		REQUIRE(dtStatusSucceed(mesh.addTile(tiles.data[i], tiles.sizes[i], DT_TILE_DEFER_LINKS, 0, 0)));
+	if (batch)
+		REQUIRE(dtStatusSucceed(mesh.endBatchAdd(parallelFor, 0)));
+	for (int i = 0; i < mesh.getMaxTiles(); ++i)
+	{
+		const dtMeshTile* tile = mesh.getTile(i);
+		if (tile->header)
+			mesh.removeTile(mesh.getTileRef(tile), 0, 0);
+	}
+}
+
+BM_WALL(dtNavMesh_AddTileBlock20x20, 5)
+{
+	loadBlock(false, 0);
+}
+
+BM_WALL(dtNavMesh_BatchAddTileBlock20x20, 5)
+{
+	loadBlock(true, 0);
+}
+
+BM_WALL(dtNavMesh_BatchAddTileBlock20x20Parallel, 5)
+{
+	loadBlock(true, threadParallelFor);
+}
+
+struct CompactBlockTiles
+{
+	std::vector<unsigned char*> data;
+	std::vector<int> sizes;
+
+	CompactBlockTiles()
+	{
+		BlockTiles& tiles = blockTiles();
+		int64_t fullBytes = 0;
+		int64_t compactBytes = 0;
+		for (size_t i = 0; i < tiles.data.size(); ++i)
+		{
+			unsigned char* compact = 0;
+			int compactSize = 0;
+			dtCompactNavMeshData(tiles.data[i], tiles.sizes[i], &compact, &compactSize);
+			data.push_back(compact);
+			sizes.push_back(compactSize);
+			fullBytes += tiles.sizes[i];
+			compactBytes += compactSize;
+		}
+		printf("Compact tiles: %ld -> %ld bytes (%.2fx)\n", (int64_t)fullBytes, (int64_t)compactBytes,
+			   compactBytes > 0 ? double(fullBytes) / double(compactBytes) : 0.0);
+	}
+
+	~CompactBlockTiles()
+	{
+		for (size_t i = 0; i < data.size(); ++i)
+			dtFree(data[i]);
+	}
+};
+
+static CompactBlockTiles& compactBlockTiles()
+{
+	static CompactBlockTiles tiles;
+	return tiles;
+}
+
+BM_WALL(dtCompactNavMeshData_Block20x20, 5)
+{
+	BlockTiles& tiles = blockTiles();
+	for (size_t i = 0; i < tiles.data.size(); ++i)
+	{
+		unsigned char* compact = 0;
+		int compactSize = 0;
+		REQUIRE(dtCompactNavMeshData(tiles.data[i], tiles.sizes[i], &compact, &compactSize));
+		dtFree(compact);
+	}
+}
+
+BM_WALL(dtExpandNavMeshData_Block20x20, 5)
+{
+	CompactBlockTiles& tiles = compactBlockTiles();
+	for (size_t i = 0; i < tiles.data.size(); ++i)
+	{
+		unsigned char* expanded = 0;
+		int expandedSize = 0;
+		REQUIRE(dtExpandNavMeshData(tiles.data[i], tiles.sizes[i], &expanded, &expandedSize));
+		dtFree(expanded);
+	}
+}
+
+// First touch of a cold tile: the whole block is added and linked, from the full tile
+// data or expanded from the compact copy.
+static void firstTouchBlock(bool compact)
+{
+	BlockTiles& tiles = blockTiles();
+	CompactBlockTiles& compactTiles = compactBlockTiles();
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	params.tileWidth = (float)kTileCells;
+	params.tileHeight = (float)kTileCells;
+	params.maxTiles = kBlockTiles * kBlockTiles;
+	params.maxPolys = kTileCells * kTileCells;
+
+	dtNavMesh mesh;
+	REQUIRE(dtStatusSucceed(mesh.init(&params)));
+	mesh.beginBatchAdd();
+	for (size_t i = 0; i < tiles.data.size(); ++i)
+	{
+		if (compact)
+		{
+			unsigned char* expanded = 0;
+			int expandedSize = 0;
+			REQUIRE(dtExpandNavMeshData(compactTiles.data[i], compactTiles.sizes[i], &expanded, &expandedSize));
+			REQUIRE(dtStatusSucceed(mesh.addTile(expanded, expandedSize, DT_TILE_FREE_DATA | DT_TILE_DEFER_LINKS, 0, 0)));
+		}
+		else
+		{
+			REQUIRE(dtStatusSucceed(mesh.addTile(tiles.data[i], tiles.sizes[i], DT_TILE_DEFER_LINKS, 0, 0)));
+		}
+	}
+	REQUIRE(dtStatusSucceed(mesh.endBatchAdd(0, 0)));
+}
+
+BM_WALL(dtNavMesh_FirstTouchBlock20x20Full, 5)
+{
+	firstTouchBlock(false);
+}
+
+BM_WALL(dtNavMesh_FirstTouchBlock20x20Compact, 5)
+{
+	firstTouchBlock(true);
+}
+
+static const int kCrowdAgents = 64;
+static const float kCrowdRadius = 40.0f;
+
+// The central 6x6 tiles of the block, agents on a ring around the goal.
+struct CrowdBlock
+{
+	dtNavMesh mesh;
+	dtNavMeshQuery query;
+	dtQueryFilter filter;
+	float goalPos[3];
+	dtPolyRef goalRef;
+	dtPolyRef agentRefs[kCrowdAgents];
+	float agentPos[kCrowdAgents][3];
+
+	// With expandCompact the tiles come from the compact copies, as after a first touch.
+	explicit CrowdBlock(bool expandCompact) : goalRef(0)
+	{
+		BlockTiles& tiles = blockTiles();
+		CompactBlockTiles& compactTiles = compactBlockTiles();
+		dtNavMeshParams params;
+		memset(&params, 0, sizeof(params));
+		params.tileWidth = (float)kTileCells;
+		params.tileHeight = (float)kTileCells;
+		params.maxTiles = kBlockTiles * kBlockTiles;
+		params.maxPolys = kTileCells * kTileCells;
+		mesh.init(&params);
+		for (int ty = 7; ty < 13; ++ty)
+		{
+			for (int tx = 7; tx < 13; ++tx)
+			{
+				const int i = ty * kBlockTiles + tx;
+				if (expandCompact)
+				{
+					unsigned char* expanded = 0;
+					int expandedSize = 0;
+					dtExpandNavMeshData(compactTiles.data[i], compactTiles.sizes[i], &expanded, &expandedSize);
+					mesh.addTile(expanded, expandedSize, DT_TILE_FREE_DATA, 0, 0);
+				}
+				else
+				{
+					mesh.addTile(tiles.data[i], tiles.sizes[i], 0, 0, 0);
+				}
+			}
+		}
+		query.init(&mesh, 65535);
+
+		const float ext[3] = { 1.0f, 2.0f, 1.0f };
+		goalPos[0] = 10.5f * kTileCells;
+		goalPos[1] = 0.0f;
+		goalPos[2] = 10.5f * kTileCells;
+		query.findNearestPoly(goalPos, ext, &filter, &goalRef, 0);
+		for (int i = 0; i < kCrowdAgents; ++i)
+		{
+			const float a = (float)i / kCrowdAgents * 6.2831853f;
+			agentPos[i][0] = goalPos[0] + cosf(a) * kCrowdRadius * 0.8f;
+			agentPos[i][1] = 0.0f;
+			agentPos[i][2] = goalPos[2] + sinf(a) * kCrowdRadius * 0.8f;
+			agentRefs[i] = 0;
+			query.findNearestPoly(agentPos[i], ext, &filter, &agentRefs[i], 0);
+		}
+	}
+};
+
+static CrowdBlock& crowdBlock()
+{
+	static CrowdBlock block(false);
+	return block;
+}
+
+static CrowdBlock& expandedCrowdBlock()
+{
+	static CrowdBlock block(true);
+	return block;
+}
+
+// Builds both blocks outside the timed loops.
+TEST_CASE("CrowdBlock setup")
+{
+	REQUIRE(crowdBlock().goalRef != 0);
+	REQUIRE(expandedCrowdBlock().goalRef != 0);
+}
+
+static void findPath64Agents(CrowdBlock& block)
+{
+	dtPolyRef path[256];
+	for (int i = 0; i < kCrowdAgents; ++i)
+	{
+		int pathCount = 0;
+		REQUIRE(dtStatusSucceed(block.query.findPath(block.agentRefs[i], block.goalRef, block.agentPos[i], block.goalPos,
+													 &block.filter, path, &pathCount, 256)));
+	}
+}
+
+static void findNearestPoly64Agents(CrowdBlock& block)
+{
+	const float ext[3] = { 1.0f, 2.0f, 1.0f };
+	for (int i = 0; i < kCrowdAgents; ++i)
+	{
+		dtPolyRef ref = 0;
+		REQUIRE(dtStatusSucceed(block.query.findNearestPoly(block.agentPos[i], ext, &block.filter, &ref, 0)));
+	}
+}
+
+BM_WALL(dtNavMeshQuery_FindPath64Agents, 5)
+{
+	findPath64Agents(crowdBlock());
+}
+
+BM_WALL(dtNavMeshQuery_FindPath64AgentsExpanded, 5)
+{
+	findPath64Agents(expandedCrowdBlock());
+}
+
+BM_WALL(dtNavMeshQuery_FindNearestPoly64Agents, 50)
+{
+	findNearestPoly64Agents(crowdBlock());
+}
+
+BM_WALL(dtNavMeshQuery_FindNearestPoly64AgentsExpanded, 50)
+{
+	findNearestPoly64Agents(expandedCrowdBlock());
+}
+
+BM_WALL(dtFlowField_Build64Agents, 5)
+{
+	CrowdBlock& block = crowdBlock();
+	static dtFlowField field;
+	if (!field.getNavMesh())
+		REQUIRE(dtStatusSucceed(field.init(&block.mesh, 65535)));
+	REQUIRE(dtStatusSucceed(field.build(block.goalRef, block.goalPos, kCrowdRadius, &block.filter)));
+	dtPolyRef path[256];
+	for (int i = 0; i < kCrowdAgents; ++i)
+	{
+		int pathCount = 0;
+		REQUIRE(dtStatusSucceed(field.getPath(block.agentRefs[i], path, &pathCount, 256)));
+	}
+}
+
+#undef BM
+#endif  // BENCH_ENABLED
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourNode.h"
+#include <vector>
+
+#include "Bench.h"
+
+#ifdef BENCH_ENABLED
+
+static const int kGridSize = 96;
+static const int kMaxSearchNodes = 16384;
+
+// Single tile, one quad per cell. Wall columns every 8 cells with the gap
+// alternating between the top and bottom rows, so the path snakes through the
+// whole grid and the open list grows large.
+static bool isGridCellBlocked(int x, int z)
+{
+	if ((x % 8) != 4)
+		return false;
+	const bool gapAtTop = ((x / 8) % 2) == 0;
+	return gapAtTop ? z < kGridSize - 2 : z > 1;
+}
+
+static unsigned char* buildGridTile(int* dataSize)
+{
+	const int nvp = 4;
+	std::vector<unsigned short> verts;
+	for (int z = 0; z <= kGridSize; ++z)
+	{
+		for (int x = 0; x <= kGridSize; ++x)
+		{
+			verts.push_back((unsigned short)x);
+			verts.push_back(0);
+			verts.push_back((unsigned short)z);
+		}
+	}
+
+	std::vector<int> polyIndex(kGridSize * kGridSize, -1);
+	int polyCount = 0;
+	for (int i = 0; i < kGridSize * kGridSize; ++i)
+	{
+		if (!isGridCellBlocked(i % kGridSize, i / kGridSize))
+			polyIndex[i] = polyCount++;
+	}
+
+	std::vector<unsigned short> polys;
+	for (int z = 0; z < kGridSize; ++z)
+	{
+		for (int x = 0; x < kGridSize; ++x)
+		{
+			if (polyIndex[z * kGridSize + x] < 0)
+				continue;
+			const unsigned short v0 = (unsigned short)(z * (kGridSize + 1) + x);
+			polys.push_back(v0);
+			polys.push_back((unsigned short)(v0 + kGridSize + 1));
+			polys.push_back((unsigned short)(v0 + kGridSize + 2));
+			polys.push_back((unsigned short)(v0 + 1));
+
+			// Edge order: x-, z+, x+, z-.
+			const int nx[4] = { x - 1, x, x + 1, x };
+			const int nz[4] = { z, z + 1, z, z - 1 };
+			for (int e = 0; e < 4; ++e)
+			{
+				int nei = -1;
+				if (nx[e] >= 0 && nx[e] < kGridSize && nz[e] >= 0 && nz[e] < kGridSize)
+					nei = polyIndex[nz[e] * kGridSize + nx[e]];
+				polys.push_back(nei >= 0 ? (unsigned short)nei : 0xffff);
+			}
+		}
+	}
+
+	std::vector<unsigned short> flags(polyCount, 1);
+	std::vector<unsigned char> areas(polyCount, 0);
+
+	dtNavMeshCreateParams params;
+	memset(&params, 0, sizeof(params));
+	params.verts = verts.data();
+	params.vertCount = (int)verts.size() / 3;
+	params.polys = polys.data();
+	params.polyFlags = flags.data();
+	params.polyAreas = areas.data();
+	params.polyCount = polyCount;
+	params.nvp = nvp;
+	params.bmax[0] = (float)kGridSize;
+	params.bmax[1] = 1.0f;
+	params.bmax[2] = (float)kGridSize;
+	params.walkableHeight = 2.0f;
+	params.walkableRadius = 0.5f;
+	params.walkableClimb = 0.5f;
+	params.cs = 1.0f;
+	params.ch = 1.0f;
+	params.buildBvTree = true;
+
+	unsigned char* data = 0;
+	if (!dtCreateNavMeshData(&params, &data, dataSize))
+		return 0;
+	return data;
+}
+
+struct GridQueryFixture
+{
+	dtNavMesh* mesh;
+	dtNavMeshQuery* query;
+	dtPolyRef startRef;
+	dtPolyRef endRef;
+	float startPos[3];
+	float endPos[3];
+
+	GridQueryFixture() : mesh(0), query(0), startRef(0), endRef(0)
+	{
+		int dataSize = 0;
+		unsigned char* data = buildGridTile(&dataSize);
+		mesh = dtAllocNavMesh();
+		query = dtAllocNavMeshQuery();
+		if (!data || !mesh || !query)
+			return;
+		if (dtStatusFailed(mesh->init(data, dataSize, DT_TILE_FREE_DATA)))
+			return;
+		query->init(mesh, kMaxSearchNodes);
+
+		const float ext[3] = { 0.5f, 1.0f, 0.5f };
+		dtQueryFilter filter;
+		const float start[3] = { 0.5f, 0.0f, 0.5f };
+		const float end[3] = { kGridSize - 0.5f, 0.0f, kGridSize - 0.5f };
+		query->findNearestPoly(start, ext, &filter, &startRef, startPos);
+		query->findNearestPoly(end, ext, &filter, &endRef, endPos);
+	}
+
+	~GridQueryFixture()
+	{
+		dtFreeNavMeshQuery(query);
+		dtFreeNavMesh(mesh);
+	}
+};
+
+static GridQueryFixture& gridFixture()
+{
+	static GridQueryFixture fixture;
+	return fixture;
+}
+
+BM(dtNavMeshQuery_FindPathSnake, 100)
+{
+	GridQueryFixture& fx = gridFixture();
+	dtQueryFilter filter;
+	static dtPolyRef path[4096];
+	int pathCount = 0;
+	const dtStatus status = fx.query->findPath(fx.startRef, fx.endRef, fx.startPos, fx.endPos, &filter, path, &pathCount, 4096);
+	REQUIRE(dtStatusSucceed(status));
+	REQUIRE((status & DT_PARTIAL_RESULT) == 0);
+	REQUIRE(path[pathCount - 1] == fx.endRef);
+}
+
+BM(dtNavMeshQuery_FindPolysAroundCircle, 100)
+{
+	GridQueryFixture& fx = gridFixture();
+	dtQueryFilter filter;
+	static dtPolyRef result[4096];
+	int resultCount = 0;
+	const float center[3] = { kGridSize * 0.5f, 0.0f, kGridSize * 0.5f };
+	const float ext[3] = { 0.5f, 1.0f, 0.5f };
+	dtPolyRef centerRef = 0;
+	float centerPos[3];
+	fx.query->findNearestPoly(center, ext, &filter, &centerRef, centerPos);
+	REQUIRE(dtStatusSucceed(fx.query->findPolysAroundCircle(centerRef, centerPos, 30.0f, &filter, result, 0, 0, &resultCount, 4096)));
+	REQUIRE(resultCount > 0);
+}
+
+BM(dtNodePool_GetNodeAndClear, 1000)
+{
+	static dtNodePool pool(kMaxSearchNodes, (int)dtNextPow2(kMaxSearchNodes / 4));
+	pool.clear();
+	for (int i = 0; i < 4096; ++i)
+	{
+		const dtPolyRef ref = (dtPolyRef)(0x10000 + i * 3);
+		pool.getNode(ref, 0);
+		pool.getNode(ref, 1);
+	}
+	for (int i = 0; i < 4096; ++i)
+		pool.findNode((dtPolyRef)(0x10000 + i * 3), 1);
+}
+
+BM(dtNodeQueue_PushModifyPop, 1000)
+{
+	static dtNode nodes[4096];
+	static dtNodeQueue queue(4096);
+	queue.clear();
+	for (int i = 0; i < 4096; ++i)
+	{
+		nodes[i].total = (float)((i * 7919) % 4096);
+		queue.push(&nodes[i]);
+	}
+	for (int i = 0; i < 4096; i += 4)
+	{
+		nodes[i].total -= 100.0f;
+		queue.modify(&nodes[i]);
+	}
+	while (!queue.empty())
+		queue.pop();
+}
+
+#undef BM
+#endif  // BENCH_ENABLED
@@ -1,6 +1,14 @@
 #include "catch2/catch_all.hpp"
 
+#include <math.h>
+#include <string.h>
+
 #include "DetourCommon.h"
+#include "DetourFlowField.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNode.h"
+#include "TestParallel.h"
 
 TEST_CASE("dtRandomPointInConvexPoly")
 {
@@ -31,3 +39,630 @@ TEST_CASE("dtRandomPointInConvexPoly")
 		REQUIRE(out[2] == Catch::Approx(0));
 	}
 }
+
+// Builds a 10x10 tile (cs = 1) holding a single quad, with optional portals on the x- / x+ edges.
+static unsigned char* buildQuadTile(int tx, int ty, unsigned short portalMinX, unsigned short portalMaxX, unsigned short polyFlags, int* dataSize)
+{
+	const unsigned short verts[] = {
+		0, 0, 0,
+		0, 0, 10,
+		10, 0, 10,
+		10, 0, 0,
+	};
+	const int nvp = 6;
+	const unsigned short polys[nvp * 2] = {
+		0, 1, 2, 3, 0xffff, 0xffff,
+		portalMinX, 0, portalMaxX, 0, 0, 0,
+	};
+	const unsigned char areas[] = { 1 };
+
+	dtNavMeshCreateParams params;
+	memset(&params, 0, sizeof(params));
+	params.verts = verts;
+	params.vertCount = 4;
+	params.polys = polys;
+	params.polyFlags = &polyFlags;
+	params.polyAreas = areas;
+	params.polyCount = 1;
+	params.nvp = nvp;
+	params.tileX = tx;
+	params.tileY = ty;
+	params.bmin[0] = tx * 10.0f;
+	params.bmin[2] = ty * 10.0f;
+	params.bmax[0] = params.bmin[0] + 10.0f;
+	params.bmax[1] = 1.0f;
+	params.bmax[2] = params.bmin[2] + 10.0f;
+	params.walkableHeight = 2.0f;
+	params.walkableRadius = 0.5f;
+	params.walkableClimb = 0.5f;
+	params.cs = 1.0f;
+	params.ch = 1.0f;
+	params.buildBvTree = true;
+
+	unsigned char* data = 0;
+	if (!dtCreateNavMeshData(&params, &data, dataSize))
+		return 0;
+	return data;
+}
+
+static int countLinksTo(const dtNavMesh& mesh, const dtMeshTile* from, const dtMeshTile* to)
+{
+	const unsigned int toIndex = mesh.decodePolyIdTile(mesh.getTileRef(to));
+	int count = 0;
+	for (int i = 0; i < from->header->polyCount; ++i)
+	{
+		for (unsigned int j = from->polys[i].firstLink; j != DT_NULL_LINK; j = from->links[j].next)
+		{
+			if (from->links[j].ref && mesh.decodePolyIdTile(from->links[j].ref) == toIndex)
+				++count;
+		}
+	}
+	return count;
+}
+
+TEST_CASE("dtNavMesh::replaceTile")
+{
+	dtNavMeshParams navParams;
+	memset(&navParams, 0, sizeof(navParams));
+	navParams.tileWidth = 10.0f;
+	navParams.tileHeight = 10.0f;
+	navParams.maxTiles = 4;
+	navParams.maxPolys = 16;
+
+	dtNavMesh mesh;
+	REQUIRE(dtStatusSucceed(mesh.init(&navParams)));
+
+	int sizeA = 0, sizeB = 0;
+	unsigned char* dataA = buildQuadTile(0, 0, 0, 0x8000 | 2, 1, &sizeA);
+	unsigned char* dataB = buildQuadTile(1, 0, 0x8000 | 0, 0, 1, &sizeB);
+	REQUIRE(dataA);
+	REQUIRE(dataB);
+
+	dtTileRef refA = 0, refB = 0;
+	REQUIRE(dtStatusSucceed(mesh.addTile(dataA, sizeA, DT_TILE_FREE_DATA, 0, &refA)));
+	REQUIRE(dtStatusSucceed(mesh.addTile(dataB, sizeB, DT_TILE_FREE_DATA, 0, &refB)));
+	const dtMeshTile* tileA = mesh.getTileByRef(refA);
+	REQUIRE(countLinksTo(mesh, tileA, mesh.getTileByRef(refB)) == 1);
+
+	SECTION("Swaps the tile in place and reconnects the neighbours")
+	{
+		int sizeNew = 0;
+		unsigned char* dataNew = buildQuadTile(1, 0, 0x8000 | 0, 0, 2, &sizeNew);
+		REQUIRE(dataNew);
+
+		dtTileRef newRef = 0;
+		REQUIRE(dtStatusSucceed(mesh.replaceTile(dataNew, sizeNew, DT_TILE_FREE_DATA, &newRef)));
+		REQUIRE(newRef != refB);
+		REQUIRE(mesh.decodePolyIdTile(newRef) == mesh.decodePolyIdTile(refB));
+		REQUIRE(mesh.getTileByRef(refB) == 0);
+
+		const dtMeshTile* tileB = mesh.getTileAt(1, 0, 0);
+		REQUIRE(tileB);
+		REQUIRE(tileB->data == dataNew);
+		REQUIRE(tileB->polys[0].flags == 2);
+		REQUIRE(countLinksTo(mesh, tileA, tileB) == 1);
+		REQUIRE(countLinksTo(mesh, tileB, tileA) == 1);
+	}
+
+	SECTION("Rejected data keeps the old tile")
+	{
+		int sizeBad = 0;
+		unsigned char* dataBad = buildQuadTile(1, 0, 0x8000 | 0, 0, 2, &sizeBad);
+		REQUIRE(dataBad);
+		((dtMeshHeader*)dataBad)->version = 0;
+
+		REQUIRE(dtStatusFailed(mesh.replaceTile(dataBad, sizeBad, DT_TILE_FREE_DATA, 0)));
+		REQUIRE(mesh.getTileByRef(refB) == mesh.getTileAt(1, 0, 0));
+		REQUIRE(mesh.getTileAt(1, 0, 0)->data == dataB);
+		REQUIRE(countLinksTo(mesh, tileA, mesh.getTileByRef(refB)) == 1);
+		dtFree(dataBad);
+	}
+
+	SECTION("Adds the tile when the location is empty")
+	{
+		int sizeC = 0;
+		unsigned char* dataC = buildQuadTile(0, 1, 0, 0, 1, &sizeC);
+		REQUIRE(dataC);
+
+		dtTileRef refC = 0;
+		REQUIRE(dtStatusSucceed(mesh.replaceTile(dataC, sizeC, DT_TILE_FREE_DATA, &refC)));
+		REQUIRE(mesh.getTileByRef(refC) == mesh.getTileAt(0, 1, 0));
+	}
+
+	SECTION("Returns the old data when the nav mesh does not own it")
+	{
+		int sizeD = 0;
+		unsigned char* dataD = buildQuadTile(0, 1, 0, 0, 1, &sizeD);
+		REQUIRE(dataD);
+		REQUIRE(dtStatusSucceed(mesh.addTile(dataD, sizeD, 0, 0, 0)));
+
+		int sizeE = 0;
+		unsigned char* dataE = buildQuadTile(0, 1, 0, 0, 3, &sizeE);
+		REQUIRE(dataE);
+
+		unsigned char* oldData = 0;
+		int oldSize = 0;
+		REQUIRE(dtStatusSucceed(mesh.replaceTile(dataE, sizeE, DT_TILE_FREE_DATA, 0, &oldData, &oldSize)));
+		REQUIRE(oldData == dataD);
+		REQUIRE(oldSize == sizeD);
+		dtFree(oldData);
+	}
+}
+
+static bool addRowTile(dtNavMesh& mesh, int tx, int flags)
+{
+	int size = 0;
+	unsigned char* data = buildQuadTile(tx, 0, 0x8000 | 0, 0x8000 | 2, 1, &size);
+	if (!data)
+		return false;
+	if (dtStatusFailed(mesh.addTile(data, size, DT_TILE_FREE_DATA | flags, 0, 0)))
+	{
+		dtFree(data);
+		return false;
+	}
+	return true;
+}
+
+static bool isRowLinked(const dtNavMesh& mesh, int count)
+{
+	for (int tx = 0; tx + 1 < count; ++tx)
+	{
+		const dtMeshTile* a = mesh.getTileAt(tx, 0, 0);
+		const dtMeshTile* b = mesh.getTileAt(tx + 1, 0, 0);
+		if (!a || !b || countLinksTo(mesh, a, b) != 1 || countLinksTo(mesh, b, a) != 1)
+			return false;
+	}
+	return true;
+}
+
+TEST_CASE("dtNavMesh::endBatchAdd")
+{
+	dtNavMeshParams navParams;
+	memset(&navParams, 0, sizeof(navParams));
+	navParams.tileWidth = 10.0f;
+	navParams.tileHeight = 10.0f;
+	navParams.maxTiles = 8;
+	navParams.maxPolys = 16;
+
+	dtNavMesh mesh;
+	REQUIRE(dtStatusSucceed(mesh.init(&navParams)));
+
+	SECTION("Links the deferred tiles at the end of the batch")
+	{
+		mesh.beginBatchAdd();
+		for (int tx = 0; tx < 5; ++tx)
+			REQUIRE(addRowTile(mesh, tx, DT_TILE_DEFER_LINKS));
+		REQUIRE(countLinksTo(mesh, mesh.getTileAt(0, 0, 0), mesh.getTileAt(1, 0, 0)) == 0);
+
+		REQUIRE(dtStatusSucceed(mesh.endBatchAdd()));
+		REQUIRE(isRowLinked(mesh, 5));
+		REQUIRE((mesh.getTileAt(2, 0, 0)->flags & DT_TILE_DEFER_LINKS) == 0);
+	}
+
+	SECTION("Parallel jobs link the batch and the tiles around it")
+	{
+		REQUIRE(addRowTile(mesh, 0, 0));
+		REQUIRE(addRowTile(mesh, 1, 0));
+		mesh.beginBatchAdd();
+		REQUIRE(addRowTile(mesh, 3, DT_TILE_DEFER_LINKS));
+		REQUIRE(addRowTile(mesh, 2, DT_TILE_DEFER_LINKS));
+		REQUIRE(addRowTile(mesh, 4, 0));
+
+		int calls = 0;
+		REQUIRE(dtStatusSucceed(mesh.endBatchAdd(reverseParallelFor, &calls)));
+		REQUIRE(calls == 2);
+		REQUIRE(isRowLinked(mesh, 5));
+	}
+
+	SECTION("Deferring outside of a batch links right away")
+	{
+		REQUIRE(addRowTile(mesh, 0, DT_TILE_DEFER_LINKS));
+		REQUIRE(addRowTile(mesh, 1, DT_TILE_DEFER_LINKS));
+		REQUIRE(isRowLinked(mesh, 2));
+		REQUIRE((mesh.getTileAt(1, 0, 0)->flags & DT_TILE_DEFER_LINKS) == 0);
+	}
+}
+
+TEST_CASE("dtNodePool")
+{
+	dtNodePool pool(16, 4);
+
+	SECTION("Returns the same node for the same ref and state")
+	{
+		dtNode* a = pool.getNode(100, 0);
+		dtNode* b = pool.getNode(100, 1);
+		REQUIRE(a);
+		REQUIRE(b);
+		REQUIRE(a != b);
+		REQUIRE(pool.getNode(100, 0) == a);
+		REQUIRE(pool.findNode(100, 1) == b);
+		REQUIRE(pool.findNode(100, 2) == 0);
+		REQUIRE(pool.getNodeCount() == 2);
+	}
+
+	SECTION("findNodes returns the newest node first")
+	{
+		dtNode* first = pool.getNode(7, 0);
+		pool.getNode(8, 0);
+		dtNode* second = pool.getNode(7, 3);
+
+		dtNode* nodes[DT_MAX_STATES_PER_NODE];
+		REQUIRE(pool.findNodes(7, nodes, DT_MAX_STATES_PER_NODE) == 2);
+		REQUIRE(nodes[0] == second);
+		REQUIRE(nodes[1] == first);
+		REQUIRE(pool.findNodes(7, nodes, 1) == 1);
+		REQUIRE(nodes[0] == second);
+	}
+
+	SECTION("Fails when full and forgets everything on clear")
+	{
+		for (int i = 0; i < 16; ++i)
+			REQUIRE(pool.getNode((dtPolyRef)(i * 64 + 1)));
+		REQUIRE(pool.getNode(5000) == 0);
+		REQUIRE(pool.findNode(65, 0));
+
+		// Enough clears to wrap the generation stamp.
+		for (int i = 0; i < (1 << DT_NODE_STAMP_BITS) + 3; ++i)
+		{
+			pool.clear();
+			REQUIRE(pool.findNode(65, 0) == 0);
+			REQUIRE(pool.getNodeCount() == 0);
+			if ((i & 1023) == 0)
+				REQUIRE(pool.getNode((dtPolyRef)(i + 1)));
+		}
+		dtNode* node = pool.getNode(65, 0);
+		REQUIRE(node);
+		REQUIRE(node->flags == 0);
+		REQUIRE(pool.getNodeAtIdx(pool.getNodeIdx(node)) == node);
+	}
+}
+
+TEST_CASE("dtNodeQueue")
+{
+	dtNode nodes[64];
+	memset(nodes, 0, sizeof(nodes));
+	dtNodeQueue queue(64);
+
+	for (int i = 0; i < 64; ++i)
+	{
+		nodes[i].total = (float)((i * 37) % 64);
+		queue.push(&nodes[i]);
+	}
+
+	SECTION("Pops in order of total")
+	{
+		float last = -1.0f;
+		while (!queue.empty())
+		{
+			dtNode* node = queue.pop();
+			REQUIRE(node->total >= last);
+			last = node->total;
+		}
+	}
+
+	SECTION("modify moves a decreased node up")
+	{
+		dtNode* target = 0;
+		for (int i = 0; i < 64; ++i)
+		{
+			if (nodes[i].total == 50.0f)
+				target = &nodes[i];
+		}
+		REQUIRE(target);
+		target->total = -1.0f;
+		queue.modify(target);
+		REQUIRE(queue.top() == target);
+		REQUIRE(queue.pop() == target);
+		REQUIRE(queue.pop()->total == 0.0f);
+	}
+}
+
+static const int kTerrainCells = 8;
+
+// Builds a sloped 4x4 m tile (cs = 0.5) with one quad per cell, a detail mesh with a raised
+// centre vertex per quad and one off-mesh connection leaving the tile.
+static unsigned char* buildTerrainTile(int* dataSize)
+{
+	const float cs = 0.5f;
+	const float ch = 0.25f;
+	const int nvp = 4;
+	const int polyCount = kTerrainCells * kTerrainCells;
+
+	unsigned short verts[(kTerrainCells + 1) * (kTerrainCells + 1) * 3];
+	for (int z = 0; z <= kTerrainCells; ++z)
+	{
+		for (int x = 0; x <= kTerrainCells; ++x)
+		{
+			unsigned short* v = &verts[(z * (kTerrainCells + 1) + x) * 3];
+			v[0] = (unsigned short)x;
+			v[1] = (unsigned short)((x * 3 + z * 5) % 7);
+			v[2] = (unsigned short)z;
+		}
+	}
+
+	unsigned short polys[polyCount * nvp * 2];
+	unsigned int detailMeshes[polyCount * 4];
+	float detailVerts[polyCount * 5 * 3];
+	unsigned char detailTris[polyCount * 4 * 4];
+	for (int z = 0; z < kTerrainCells; ++z)
+	{
+		for (int x = 0; x < kTerrainCells; ++x)
+		{
+			const int ip = z * kTerrainCells + x;
+			const unsigned short v0 = (unsigned short)(z * (kTerrainCells + 1) + x);
+			unsigned short* p = &polys[ip * nvp * 2];
+			p[0] = v0;
+			p[1] = (unsigned short)(v0 + kTerrainCells + 1);
+			p[2] = (unsigned short)(v0 + kTerrainCells + 2);
+			p[3] = (unsigned short)(v0 + 1);
+			const int nx[4] = { x - 1, x, x + 1, x };
+			const int nz[4] = { z, z + 1, z, z - 1 };
+			for (int e = 0; e < 4; ++e)
+			{
+				const bool inside = nx[e] >= 0 && nx[e] < kTerrainCells && nz[e] >= 0 && nz[e] < kTerrainCells;
+				p[nvp + e] = inside ? (unsigned short)(nz[e] * kTerrainCells + nx[e]) : 0;
+			}
+
+			// The detail mesh starts with the poly vertices, then the centre.
+			float* dv = &detailVerts[ip * 5 * 3];
+			for (int j = 0; j < 4; ++j)
+			{
+				const unsigned short* v = &verts[p[j] * 3];
+				dv[j * 3 + 0] = v[0] * cs;
+				dv[j * 3 + 1] = v[1] * ch;
+				dv[j * 3 + 2] = v[2] * cs;
+			}
+			dv[12] = (x + 0.5f) * cs;
+			dv[13] = (dv[1] + dv[4] + dv[7] + dv[10]) * 0.25f + 0.1f;
+			dv[14] = (z + 0.5f) * cs;
+
+			unsigned int* dm = &detailMeshes[ip * 4];
+			dm[0] = ip * 5;
+			dm[1] = 5;
+			dm[2] = ip * 4;
+			dm[3] = 4;
+			for (int j = 0; j < 4; ++j)
+			{
+				unsigned char* t = &detailTris[(ip * 4 + j) * 4];
+				t[0] = 4;
+				t[1] = (unsigned char)j;
+				t[2] = (unsigned char)((j + 1) % 4);
+				t[3] = DT_DETAIL_EDGE_BOUNDARY << 2;
+			}
+		}
+	}
+
+	unsigned short flags[polyCount];
+	unsigned char areas[polyCount];
+	for (int i = 0; i < polyCount; ++i)
+	{
+		flags[i] = 1;
+		areas[i] = (unsigned char)(i % 3);
+	}
+
+	const float offMeshVerts[] = { 1.25f, 0.5f, 1.25f, 40.0f, 3.0f, -12.0f };
+	const float offMeshRad = 0.6f;
+	const unsigned short offMeshFlags = 1;
+	const unsigned char offMeshArea = 2;
+	const unsigned char offMeshDir = DT_OFFMESH_CON_BIDIR;
+	const unsigned int offMeshId = 77;
+
+	dtNavMeshCreateParams params;
+	memset(&params, 0, sizeof(params));
+	params.verts = verts;
+	params.vertCount = (kTerrainCells + 1) * (kTerrainCells + 1);
+	params.polys = polys;
+	params.polyFlags = flags;
+	params.polyAreas = areas;
+	params.polyCount = polyCount;
+	params.nvp = nvp;
+	params.detailMeshes = detailMeshes;
+	params.detailVerts = detailVerts;
+	params.detailVertsCount = polyCount * 5;
+	params.detailTris = detailTris;
+	params.detailTriCount = polyCount * 4;
+	params.offMeshConVerts = offMeshVerts;
+	params.offMeshConRad = &offMeshRad;
+	params.offMeshConFlags = &offMeshFlags;
+	params.offMeshConAreas = &offMeshArea;
+	params.offMeshConDir = &offMeshDir;
+	params.offMeshConUserID = &offMeshId;
+	params.offMeshConCount = 1;
+	params.bmax[0] = kTerrainCells * cs;
+	params.bmax[1] = 6 * ch + 1.0f;
+	params.bmax[2] = kTerrainCells * cs;
+	params.walkableHeight = 2.0f;
+	params.walkableRadius = 0.5f;
+	params.walkableClimb = 0.5f;
+	params.cs = cs;
+	params.ch = ch;
+	params.buildBvTree = true;
+
+	unsigned char* data = 0;
+	if (!dtCreateNavMeshData(&params, &data, dataSize))
+		return 0;
+	return data;
+}
+
+TEST_CASE("dtCompactNavMeshData")
+{
+	int size = 0;
+	unsigned char* data = buildTerrainTile(&size);
+	REQUIRE(data);
+
+	unsigned char* compact = 0;
+	int compactSize = 0;
+	REQUIRE(dtCompactNavMeshData(data, size, &compact, &compactSize));
+	REQUIRE(compactSize * 2 < size);
+
+	unsigned char* expanded = 0;
+	int expandedSize = 0;
+	REQUIRE(dtExpandNavMeshData(compact, compactSize, &expanded, &expandedSize));
+	REQUIRE(expandedSize == size);
+
+	dtNavMeshParams navParams;
+	memset(&navParams, 0, sizeof(navParams));
+	navParams.tileWidth = kTerrainCells * 0.5f;
+	navParams.tileHeight = kTerrainCells * 0.5f;
+	navParams.maxTiles = 1;
+	navParams.maxPolys = 128;
+
+	dtNavMesh original, roundTrip;
+	REQUIRE(dtStatusSucceed(original.init(&navParams)));
+	REQUIRE(dtStatusSucceed(roundTrip.init(&navParams)));
+	REQUIRE(dtStatusSucceed(original.addTile(data, size, DT_TILE_FREE_DATA, 0, 0)));
+	REQUIRE(dtStatusSucceed(roundTrip.addTile(expanded, expandedSize, DT_TILE_FREE_DATA, 0, 0)));
+	const dtMeshTile* a = original.getTileAt(0, 0, 0);
+	const dtMeshTile* b = roundTrip.getTileAt(0, 0, 0);
+	REQUIRE(a);
+	REQUIRE(b);
+
+	SECTION("Keeps the topology and the search data exact")
+	{
+		REQUIRE(memcmp(a->header, b->header, sizeof(dtMeshHeader)) == 0);
+		for (int i = 0; i < a->header->polyCount; ++i)
+		{
+			const dtPoly& pa = a->polys[i];
+			const dtPoly& pb = b->polys[i];
+			REQUIRE(memcmp(pa.verts, pb.verts, sizeof(pa.verts)) == 0);
+			REQUIRE(memcmp(pa.neis, pb.neis, sizeof(pa.neis)) == 0);
+			REQUIRE(pa.flags == pb.flags);
+			REQUIRE(pa.vertCount == pb.vertCount);
+			REQUIRE(pa.areaAndtype == pb.areaAndtype);
+		}
+		REQUIRE(memcmp(a->detailMeshes, b->detailMeshes, sizeof(dtPolyDetail) * a->header->detailMeshCount) == 0);
+		REQUIRE(memcmp(a->detailTris, b->detailTris, 4 * a->header->detailTriCount) == 0);
+		REQUIRE(memcmp(a->bvTree, b->bvTree, sizeof(dtBVNode) * a->header->bvNodeCount) == 0);
+		REQUIRE(memcmp(a->offMeshCons, b->offMeshCons, sizeof(dtOffMeshConnection) * a->header->offMeshConCount) == 0);
+	}
+
+	SECTION("Vertices move by less than half a millimetre")
+	{
+		// Off-mesh start points are snapped to the mesh when the tile is added, the end points stay as given.
+		for (int i = 0; i < a->header->vertCount * 3; ++i)
+			REQUIRE(fabsf(a->verts[i] - b->verts[i]) < 0.0005f);
+		const float* end = &b->verts[(a->header->vertCount - 1) * 3];
+		REQUIRE(end[0] == 40.0f);
+		REQUIRE(end[1] == 3.0f);
+		REQUIRE(end[2] == -12.0f);
+		for (int i = 0; i < a->header->detailVertCount * 3; ++i)
+			REQUIRE(fabsf(a->detailVerts[i] - b->detailVerts[i]) < 0.0005f);
+	}
+
+	SECTION("The expanded tile links like the original")
+	{
+		int linksA = 0, linksB = 0;
+		for (int i = 0; i < a->header->polyCount; ++i)
+		{
+			for (unsigned int j = a->polys[i].firstLink; j != DT_NULL_LINK; j = a->links[j].next)
+				++linksA;
+			for (unsigned int j = b->polys[i].firstLink; j != DT_NULL_LINK; j = b->links[j].next)
+				++linksB;
+		}
+		REQUIRE(linksA > 0);
+		REQUIRE(linksA == linksB);
+	}
+
+	SECTION("Rejects data of the other format")
+	{
+		unsigned char* out = 0;
+		int outSize = 0;
+		REQUIRE_FALSE(dtCompactNavMeshData(compact, compactSize, &out, &outSize));
+		REQUIRE_FALSE(dtExpandNavMeshData(a->data, a->dataSize, &out, &outSize));
+		REQUIRE_FALSE(dtExpandNavMeshData(compact, compactSize - 4, &out, &outSize));
+	}
+
+	dtFree(compact);
+}
+
+static dtPolyRef rowPolyRef(const dtNavMesh& mesh, int tx)
+{
+	const dtMeshTile* tile = mesh.getTileAt(tx, 0, 0);
+	return tile ? mesh.getPolyRefBase(tile) : 0;
+}
+
+TEST_CASE("dtFlowField")
+{
+	dtNavMeshParams navParams;
+	memset(&navParams, 0, sizeof(navParams));
+	navParams.tileWidth = 10.0f;
+	navParams.tileHeight = 10.0f;
+	navParams.maxTiles = 8;
+	navParams.maxPolys = 16;
+
+	dtNavMesh mesh;
+	REQUIRE(dtStatusSucceed(mesh.init(&navParams)));
+	for (int tx = 0; tx < 5; ++tx)
+		REQUIRE(addRowTile(mesh, tx, 0));
+
+	dtQueryFilter filter;
+	const float goalPos[3] = { 5.0f, 0.0f, 5.0f };
+
+	dtFlowField field;
+	REQUIRE(dtStatusSucceed(field.init(&mesh, 16)));
+	REQUIRE(dtStatusSucceed(field.build(rowPolyRef(mesh, 0), goalPos, 100.0f, &filter)));
+	REQUIRE(field.getPolyCount() == 5);
+
+	SECTION("Next hops lead to the goal")
+	{
+		float lastCost = -1.0f;
+		for (int tx = 0; tx < 5; ++tx)
+		{
+			dtPolyRef nextRef = 0;
+			float steerPos[3];
+			float cost = 0.0f;
+			REQUIRE(field.getNextHop(rowPolyRef(mesh, tx), &nextRef, steerPos, &cost));
+			REQUIRE(nextRef == (tx > 0 ? rowPolyRef(mesh, tx - 1) : 0));
+			REQUIRE(steerPos[0] == Catch::Approx(tx > 0 ? tx * 10.0f : 5.0f));
+			REQUIRE(cost > lastCost);
+			lastCost = cost;
+		}
+
+		dtPolyRef path[8];
+		int pathCount = 0;
+		REQUIRE(field.getPath(rowPolyRef(mesh, 4), path, &pathCount, 8) == DT_SUCCESS);
+		REQUIRE(pathCount == 5);
+		REQUIRE(path[4] == rowPolyRef(mesh, 0));
+
+		REQUIRE(field.getPath(rowPolyRef(mesh, 4), path, &pathCount, 2) == (DT_SUCCESS | DT_PARTIAL_RESULT));
+		REQUIRE(pathCount == 2);
+	}
+
+	SECTION("Radius limits the field")
+	{
+		REQUIRE(dtStatusSucceed(field.build(rowPolyRef(mesh, 0), goalPos, 20.0f, &filter)));
+		REQUIRE(field.getPolyCount() == 3);
+		REQUIRE_FALSE(field.getNextHop(rowPolyRef(mesh, 3), 0, 0, 0));
+	}
+
+	SECTION("Update follows the tiles")
+	{
+		REQUIRE(dtStatusSucceed(mesh.removeTile(mesh.getTileRef(mesh.getTileAt(2, 0, 0)), 0, 0)));
+		REQUIRE(dtStatusSucceed(field.update()));
+		REQUIRE(field.getPolyCount() == 2);
+		REQUIRE_FALSE(field.getNextHop(rowPolyRef(mesh, 4), 0, 0, 0));
+
+		REQUIRE(addRowTile(mesh, 2, 0));
+		REQUIRE(dtStatusSucceed(field.update()));
+		REQUIRE(field.getPolyCount() == 5);
+
+		dtPolyRef nextRef = 0;
+		float cost = 0.0f;
+		REQUIRE(field.getNextHop(rowPolyRef(mesh, 4), &nextRef, 0, &cost));
+		REQUIRE(nextRef == rowPolyRef(mesh, 3));
+
+		dtFlowField fresh;
+		REQUIRE(dtStatusSucceed(fresh.init(&mesh, 16)));
+		REQUIRE(dtStatusSucceed(fresh.build(rowPolyRef(mesh, 0), goalPos, 100.0f, &filter)));
+		float freshCost = 0.0f;
+		REQUIRE(fresh.getNextHop(rowPolyRef(mesh, 4), 0, 0, &freshCost));
+		REQUIRE(cost == Catch::Approx(freshCost));
+	}
+
+	SECTION("Update fails when the goal is gone")
+	{
+		REQUIRE(dtStatusSucceed(mesh.removeTile(mesh.getTileRef(mesh.getTileAt(0, 0, 0)), 0, 0)));
+		REQUIRE(dtStatusFailed(field.update()));
+		REQUIRE(field.getGoalRef() == 0);
+	}
+}
@@ -0,0 +1,182 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+#include "DetourCrowd.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourObstacleAvoidance.h"
+#include "TestParallel.h"
+#include "TestTiles.h"
+#include <vector>
+
+#include "Bench.h"
+
+#ifdef BENCH_ENABLED
+
+static const int kCrowdBenchTiles = 6;
+static const int kCrowdBenchTileCells = 32;
+static const int kCrowdBenchAgents = 2000;
+
+// Agents crossing the block toward the mirrored point, so most of them keep moving.
+struct CrowdBench
+{
+	dtNavMesh mesh;
+	dtNavMeshQuery query;
+	dtCrowd crowd;
+
+	explicit CrowdBench(bool parallel)
+	{
+		dtNavMeshParams navParams;
+		memset(&navParams, 0, sizeof(navParams));
+		navParams.tileWidth = (float)kCrowdBenchTileCells;
+		navParams.tileHeight = (float)kCrowdBenchTileCells;
+		navParams.maxTiles = kCrowdBenchTiles * kCrowdBenchTiles;
+		navParams.maxPolys = kCrowdBenchTileCells * kCrowdBenchTileCells;
+		mesh.init(&navParams);
+		for (int ty = 0; ty < kCrowdBenchTiles; ++ty)
+		{
+			for (int tx = 0; tx < kCrowdBenchTiles; ++tx)
+			{
+				int size = 0;
+				unsigned char* data = buildGridTestTile(tx, ty, kCrowdBenchTileCells, &size);
+				if (data)
+					mesh.addTile(data, size, DT_TILE_FREE_DATA, 0, 0);
+			}
+		}
+		query.init(&mesh, 512);
+		crowd.init(kCrowdBenchAgents, 0.5f, &mesh);
+		if (parallel)
+			crowd.setParallelFor(threadParallelFor, 0, 16);
+
+		dtCrowdAgentParams ap;
+		memset(&ap, 0, sizeof(ap));
+		ap.radius = 0.4f;
+		ap.height = 2.0f;
+		ap.maxAcceleration = 8.0f;
+		ap.maxSpeed = 3.5f;
+		ap.collisionQueryRange = ap.radius * 12.0f;
+		ap.pathOptimizationRange = ap.radius * 30.0f;
+		ap.separationWeight = 2.0f;
+		ap.updateFlags = DT_CROWD_ANTICIPATE_TURNS | DT_CROWD_OPTIMIZE_VIS | DT_CROWD_OPTIMIZE_TOPO |
+						 DT_CROWD_OBSTACLE_AVOIDANCE | DT_CROWD_SEPARATION;
+
+		const float size = (float)(kCrowdBenchTiles * kCrowdBenchTileCells);
+		const float halfExtents[3] = { 1.0f, 2.0f, 1.0f };
+		unsigned int seed = 12345;
+		for (int i = 0; i < kCrowdBenchAgents; ++i)
+		{
+			float pos[3];
+			float target[3];
+			seed = seed * 1664525u + 1013904223u;
+			pos[0] = (float)(seed >> 8) / 16777216.0f * size;
+			seed = seed * 1664525u + 1013904223u;
+			pos[2] = (float)(seed >> 8) / 16777216.0f * size;
+			pos[1] = 0.0f;
+			dtVset(target, size - pos[0], 0.0f, size - pos[2]);
+
+			const int idx = crowd.addAgent(pos, &ap);
+			dtPolyRef targetRef = 0;
+			float targetNearest[3];
+			if (idx >= 0 && dtStatusSucceed(query.findNearestPoly(target, halfExtents, crowd.getFilter(0), &targetRef, targetNearest)))
+				crowd.requestMoveTarget(idx, targetRef, targetNearest);
+		}
+
+		// Let the path queue settle so the timed frames are steady state.
+		for (int frame = 0; frame < 20; ++frame)
+			crowd.update(0.05f, 0);
+	}
+};
+
+static CrowdBench& serialCrowd()
+{
+	static CrowdBench bench(false);
+	return bench;
+}
+
+static CrowdBench& parallelCrowd()
+{
+	static CrowdBench bench(true);
+	return bench;
+}
+
+BM_WALL(dtCrowd_Update2000Agents, 20)
+{
+	serialCrowd().crowd.update(0.05f, 0);
+}
+
+BM_WALL(dtCrowd_Update2000AgentsParallel, 20)
+{
+	parallelCrowd().crowd.update(0.05f, 0);
+}
+
+// A crowded neighbourhood: the obstacle query at its default capacity, full.
+struct AvoidanceBench
+{
+	dtObstacleAvoidanceQuery query;
+	dtObstacleAvoidanceParams params;
+	float vel[3];
+	float dvel[3];
+
+	AvoidanceBench()
+	{
+		query.init(6, 8);
+		for (int i = 0; i < 6; ++i)
+		{
+			const float p[3] = { cosf(i * 1.047f) * 1.5f, 0, sinf(i * 1.047f) * 1.5f };
+			const float v[3] = { -p[2] * 0.5f, 0, p[0] * 0.5f };
+			query.addCircle(p, 0.6f, v, v);
+		}
+		for (int i = 0; i < 8; ++i)
+		{
+			const float p[3] = { -4.0f + i, 0, 3.0f };
+			const float q[3] = { -3.0f + i, 0, 3.0f + (i & 1) };
+			query.addSegment(p, q);
+		}
+
+		memset(&params, 0, sizeof(params));
+		params.velBias = 0.4f;
+		params.weightDesVel = 2.0f;
+		params.weightCurVel = 0.75f;
+		params.weightSide = 0.75f;
+		params.weightToi = 2.5f;
+		params.horizTime = 2.5f;
+		params.gridSize = 33;
+		params.adaptiveDivs = 7;
+		params.adaptiveRings = 2;
+		params.adaptiveDepth = 5;
+
+		dtVset(vel, 0.5f, 0, 1.0f);
+		dtVset(dvel, 1.0f, 0, 3.0f);
+	}
+};
+
+static AvoidanceBench& avoidanceBench()
+{
+	static AvoidanceBench bench;
+	return bench;
+}
+
+BM_WALL(dtObstacleAvoidanceQuery_SampleAdaptive, 20000)
+{
+	AvoidanceBench& b = avoidanceBench();
+	const float pos[3] = { 0, 0, 0 };
+	float nvel[3];
+	b.query.sampleVelocityAdaptive(pos, 0.6f, 3.5f, b.vel, b.dvel, nvel, &b.params, 0);
+}
+
+BM_WALL(dtObstacleAvoidanceQuery_SampleGrid, 2000)
+{
+	AvoidanceBench& b = avoidanceBench();
+	const float pos[3] = { 0, 0, 0 };
+	float nvel[3];
+	b.query.sampleVelocityGrid(pos, 0.6f, 3.5f, b.vel, b.dvel, nvel, &b.params, 0);
+}
+
+#undef BM
+#endif  // BENCH_ENABLED
@@ -0,0 +1,187 @@
+#include "catch2/catch_all.hpp"
+
+#include <string.h>
+#include <vector>
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+#include "DetourCrowd.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourObstacleAvoidance.h"
+#include "TestParallel.h"
+#include "TestTiles.h"
+
+static const int kCrowdTileCells = 16;
+
+static void addCrowdAgents(dtCrowd& crowd, const dtNavMeshQuery& query, int count, float size)
+{
+	dtCrowdAgentParams ap;
+	memset(&ap, 0, sizeof(ap));
+	ap.radius = 0.4f;
+	ap.height = 2.0f;
+	ap.maxAcceleration = 8.0f;
+	ap.maxSpeed = 3.5f;
+	ap.collisionQueryRange = ap.radius * 12.0f;
+	ap.pathOptimizationRange = ap.radius * 30.0f;
+	ap.separationWeight = 2.0f;
+	ap.updateFlags = DT_CROWD_ANTICIPATE_TURNS | DT_CROWD_OPTIMIZE_VIS | DT_CROWD_OPTIMIZE_TOPO |
+					 DT_CROWD_OBSTACLE_AVOIDANCE | DT_CROWD_SEPARATION;
+
+	const float halfExtents[3] = { 1.0f, 2.0f, 1.0f };
+	unsigned int seed = 12345;
+	for (int i = 0; i < count; ++i)
+	{
+		float pos[3];
+		float target[3];
+		seed = seed * 1664525u + 1013904223u;
+		pos[0] = (float)(seed >> 8) / 16777216.0f * size;
+		seed = seed * 1664525u + 1013904223u;
+		pos[2] = (float)(seed >> 8) / 16777216.0f * size;
+		pos[1] = 0.0f;
+		dtVset(target, size - pos[0], 0.0f, size - pos[2]);
+
+		const int idx = crowd.addAgent(pos, &ap);
+		REQUIRE(idx >= 0);
+
+		dtPolyRef targetRef = 0;
+		float targetNearest[3];
+		REQUIRE(dtStatusSucceed(query.findNearestPoly(target, halfExtents, crowd.getFilter(0), &targetRef, targetNearest)));
+		REQUIRE(crowd.requestMoveTarget(idx, targetRef, targetNearest));
+	}
+}
+
+TEST_CASE("dtCrowd::setParallelFor")
+{
+	const int tiles = 3;
+	dtNavMeshParams navParams;
+	memset(&navParams, 0, sizeof(navParams));
+	navParams.tileWidth = (float)kCrowdTileCells;
+	navParams.tileHeight = (float)kCrowdTileCells;
+	navParams.maxTiles = tiles * tiles;
+	navParams.maxPolys = kCrowdTileCells * kCrowdTileCells;
+
+	dtNavMesh mesh;
+	REQUIRE(dtStatusSucceed(mesh.init(&navParams)));
+	for (int ty = 0; ty < tiles; ++ty)
+	{
+		for (int tx = 0; tx < tiles; ++tx)
+		{
+			int size = 0;
+			unsigned char* data = buildGridTestTile(tx, ty, kCrowdTileCells, &size);
+			REQUIRE(data);
+			REQUIRE(dtStatusSucceed(mesh.addTile(data, size, DT_TILE_FREE_DATA, 0, 0)));
+		}
+	}
+
+	dtNavMeshQuery query;
+	REQUIRE(dtStatusSucceed(query.init(&mesh, 512)));
+
+	const int agentCount = 40;
+	const float size = (float)(tiles * kCrowdTileCells);
+	dtCrowd serial;
+	dtCrowd parallel;
+	REQUIRE(serial.init(agentCount, 0.5f, &mesh));
+	REQUIRE(parallel.init(agentCount, 0.5f, &mesh));
+	addCrowdAgents(serial, query, agentCount, size);
+	addCrowdAgents(parallel, query, agentCount, size);
+
+	SECTION("Parallel update matches the serial one")
+	{
+		int calls = 0;
+		REQUIRE(parallel.setParallelFor(reverseParallelFor, &calls, 7));
+
+		for (int frame = 0; frame < 60; ++frame)
+		{
+			serial.update(0.1f, 0);
+			parallel.update(0.1f, 0);
+		}
+		REQUIRE(calls > 0);
+
+		for (int i = 0; i < agentCount; ++i)
+		{
+			const dtCrowdAgent* a = serial.getAgent(i);
+			const dtCrowdAgent* b = parallel.getAgent(i);
+			REQUIRE(memcmp(a->npos, b->npos, sizeof(a->npos)) == 0);
+			REQUIRE(memcmp(a->vel, b->vel, sizeof(a->vel)) == 0);
+			REQUIRE(a->corridor.getFirstPoly() == b->corridor.getFirstPoly());
+		}
+		REQUIRE(serial.getVelocitySampleCount() == parallel.getVelocitySampleCount());
+	}
+
+	SECTION("Rejects invalid job counts")
+	{
+		int calls = 0;
+		REQUIRE_FALSE(parallel.setParallelFor(reverseParallelFor, &calls, 0));
+		REQUIRE_FALSE(parallel.setParallelFor(reverseParallelFor, &calls, DT_CROWD_MAX_JOBS + 1));
+		REQUIRE(parallel.setParallelFor(0, 0, 1));
+		parallel.update(0.1f, 0);
+		REQUIRE(calls == 0);
+	}
+}
+
+TEST_CASE("dtObstacleAvoidanceQuery batched sampling")
+{
+	// The debug data path scores one sample at a time, without it samples are scored in batches.
+	dtObstacleAvoidanceQuery query;
+	REQUIRE(query.init(6, 8));
+	dtObstacleAvoidanceDebugData debug;
+	REQUIRE(debug.init(33 * 33));
+
+	dtObstacleAvoidanceParams params;
+	memset(&params, 0, sizeof(params));
+	params.velBias = 0.4f;
+	params.weightDesVel = 2.0f;
+	params.weightCurVel = 0.75f;
+	params.weightSide = 0.75f;
+	params.weightToi = 2.5f;
+	params.horizTime = 2.5f;
+	params.gridSize = 33;
+	params.adaptiveDivs = 7;
+	params.adaptiveRings = 2;
+	params.adaptiveDepth = 5;
+
+	unsigned int seed = 12345;
+	struct Rand
+	{
+		static float next(unsigned int& s)
+		{
+			s = s * 1664525u + 1013904223u;
+			return (float)(s >> 8) / (float)(1 << 24);
+		}
+	};
+
+	const float pos[3] = { 0, 0, 0 };
+	const float rad = 0.6f;
+	const float vmax = 3.5f;
+	for (int iter = 0; iter < 50; ++iter)
+	{
+		query.reset();
+		for (int i = 0; i < 6; ++i)
+		{
+			const float p[3] = { Rand::next(seed) * 6.0f - 3.0f, 0, Rand::next(seed) * 6.0f - 3.0f };
+			const float v[3] = { Rand::next(seed) * 2.0f - 1.0f, 0, Rand::next(seed) * 2.0f - 1.0f };
+			query.addCircle(p, 0.6f, v, v);
+		}
+		for (int i = 0; i < 4; ++i)
+		{
+			const float p[3] = { Rand::next(seed) * 8.0f - 4.0f, 0, Rand::next(seed) * 8.0f - 4.0f };
+			const float q[3] = { Rand::next(seed) * 8.0f - 4.0f, 0, Rand::next(seed) * 8.0f - 4.0f };
+			query.addSegment(p, q);
+		}
+		const float vel[3] = { Rand::next(seed) * 2.0f - 1.0f, 0, Rand::next(seed) * 2.0f - 1.0f };
+		const float dvel[3] = { Rand::next(seed) * 6.0f - 3.0f, 0, Rand::next(seed) * 6.0f - 3.0f };
+
+		float scalarVel[3], batchVel[3];
+		int scalarCount = query.sampleVelocityAdaptive(pos, rad, vmax, vel, dvel, scalarVel, &params, &debug);
+		int batchCount = query.sampleVelocityAdaptive(pos, rad, vmax, vel, dvel, batchVel, &params, 0);
+		REQUIRE(scalarCount == batchCount);
+		REQUIRE(dtVdist2D(scalarVel, batchVel) < 1e-4f);
+
+		scalarCount = query.sampleVelocityGrid(pos, rad, vmax, vel, dvel, scalarVel, &params, &debug);
+		batchCount = query.sampleVelocityGrid(pos, rad, vmax, vel, dvel, batchVel, &params, 0);
+		REQUIRE(scalarCount == batchCount);
+		REQUIRE(dtVdist2D(scalarVel, batchVel) < 1e-4f);
+	}
+}
@@ -0,0 +1,133 @@
+#include "catch2/catch_all.hpp"
+
+#include "DetourTileCacheBuilder.h"
+#include "DetourTileCacheCompressor.h"
+
+#include <string.h>
+#include <vector>
+
+static std::vector<unsigned char> roundTrip(const std::vector<unsigned char>& input, int* outCompressedSize = nullptr)
+{
+	std::vector<unsigned char> compressed(dtLZCompressBound((int)input.size()));
+	const int n = dtLZCompress(input.data(), (int)input.size(), compressed.data(), (int)compressed.size());
+	REQUIRE(n > 0);
+	REQUIRE(n <= (int)compressed.size());
+	if (outCompressedSize)
+		*outCompressedSize = n;
+
+	std::vector<unsigned char> output(input.size() + 16, 0xcd);
+	const int m = dtLZDecompress(compressed.data(), n, output.data(), (int)output.size());
+	REQUIRE(m == (int)input.size());
+	output.resize(m);
+	return output;
+}
+
+TEST_CASE("dtLZCompress")
+{
+	SECTION("Empty and tiny inputs round trip")
+	{
+		for (int size = 0; size <= 20; ++size)
+		{
+			std::vector<unsigned char> input(size);
+			for (int i = 0; i < size; ++i)
+				input[i] = (unsigned char)(i * 7);
+			CHECK(roundTrip(input) == input);
+		}
+	}
+
+	SECTION("Repetitive data shrinks and round trips")
+	{
+		// Height field like data: long runs and repeated rows.
+		std::vector<unsigned char> input(64 * 64 * 4);
+		for (size_t i = 0; i < input.size(); ++i)
+			input[i] = (unsigned char)((i / 256) % 3 == 0 ? 0 : (i % 64) / 8);
+		int compressedSize = 0;
+		CHECK(roundTrip(input, &compressedSize) == input);
+		CHECK(compressedSize * 4 < (int)input.size());
+	}
+
+	SECTION("Overlapping runs and long lengths round trip")
+	{
+		std::vector<unsigned char> input(5000, 42);
+		for (int i = 0; i < 300; ++i)
+			input.push_back((unsigned char)i);
+		input.insert(input.end(), 1000, 0);
+		CHECK(roundTrip(input) == input);
+	}
+
+	SECTION("Incompressible data stays within the bound")
+	{
+		std::vector<unsigned char> input(100000);
+		unsigned int state = 12345;
+		for (size_t i = 0; i < input.size(); ++i)
+		{
+			state = state * 1103515245u + 12345u;
+			input[i] = (unsigned char)(state >> 24);
+		}
+		CHECK(roundTrip(input) == input);
+	}
+
+	SECTION("Too small destination fails")
+	{
+		std::vector<unsigned char> input(1000, 1);
+		input[500] = 2;
+		unsigned char out[4];
+		CHECK(dtLZCompress(input.data(), (int)input.size(), out, sizeof(out)) == 0);
+	}
+}
+
+TEST_CASE("dtLZDecompress")
+{
+	std::vector<unsigned char> input(4096);
+	for (size_t i = 0; i < input.size(); ++i)
+		input[i] = (unsigned char)((i % 97) < 50 ? 7 : i % 13);
+	std::vector<unsigned char> compressed(dtLZCompressBound((int)input.size()));
+	const int n = dtLZCompress(input.data(), (int)input.size(), compressed.data(), (int)compressed.size());
+	REQUIRE(n > 0);
+
+	SECTION("Should fail when the output does not fit")
+	{
+		std::vector<unsigned char> output(input.size() - 1);
+		CHECK(dtLZDecompress(compressed.data(), n, output.data(), (int)output.size()) == -1);
+	}
+
+	SECTION("Should fail on truncated input without overrunning")
+	{
+		std::vector<unsigned char> output(input.size());
+		for (int len = 1; len < n; ++len)
+		{
+			const int m = dtLZDecompress(compressed.data(), len, output.data(), (int)output.size());
+			CHECK(m < (int)input.size());
+		}
+	}
+
+	SECTION("Should reject offsets before the start of the output")
+	{
+		// Token: no literals, match of 4 at offset 1 with nothing decoded yet.
+		const unsigned char bad[] = { 0x00, 0x01, 0x00, 0x10, 'a' };
+		unsigned char output[16];
+		CHECK(dtLZDecompress(bad, sizeof(bad), output, sizeof(output)) == -1);
+	}
+}
+
+TEST_CASE("dtTileCacheLZCompressor")
+{
+	dtTileCacheLZCompressor comp;
+
+	std::vector<unsigned char> buffer(48 * 48 * 3, 0);
+	for (int i = 0; i < 48 * 48; ++i)
+		buffer[i] = (unsigned char)(i / 48 < 24 ? 10 : 12);
+
+	std::vector<unsigned char> compressed(comp.maxCompressedSize((int)buffer.size()));
+	int compressedSize = 0;
+	REQUIRE(dtStatusSucceed(comp.compress(buffer.data(), (int)buffer.size(), compressed.data(), (int)compressed.size(), &compressedSize)));
+	CHECK(compressedSize < (int)buffer.size() / 4);
+
+	std::vector<unsigned char> output(buffer.size());
+	int outputSize = 0;
+	REQUIRE(dtStatusSucceed(comp.decompress(compressed.data(), compressedSize, output.data(), (int)output.size(), &outputSize)));
+	CHECK(outputSize == (int)buffer.size());
+	CHECK(output == buffer);
+
+	CHECK(dtStatusFailed(comp.decompress(compressed.data(), compressedSize, output.data(), 10, &outputSize)));
+}